@@ -35,6 +35,7 @@
   */
 
 #include "filter.h"
+#include "filter_instr.h"
 
 // Example of defining a structure for processing a notch filter for data1
 FilterTypeDef filter_nt_data1;
@@ -59,6 +60,25 @@ FilterTypeDef filter_nt_data1;
   * @retval None
   */
 void init_filter(FilterTypeDef *filter, FilterClassType class, float fs,  float notch_cut, float low_cut, float high_cut) {
+    init_filter_q(filter, class, fs, notch_cut, low_cut, high_cut, 0.0f);
+}
+
+
+/**
+  * @brief  ˲ʼ (ָƷ)
+  * @note   ʽ init_filter ͬ (alpha = sin(w0) / (2 / q)), ֻ q ʹĬֵ,  (filter_design.h) ʹ.
+  *         q <= 0 ʱʹ init_filter Ĭֵ: NOTCH Ϊ 30, LOWPASS / HIGHPASS Ϊ 0.707,
+  *         BANDPASS / BANDSTOP Ϊ center_freq / bandwith. ͨʹƵʼΪ sqrt(low_cut * high_cut).
+  * @param  filter:     ˲ṹַ
+  * @param  class:      ˲
+  * @param  fs:         Ƶ (hz)
+  * @param  notch_cut:  ݲƵ
+  * @param  low_cut:    ͨ˲ֹƵ
+  * @param  high_cut:   ͨ˲ֹƵ
+  * @param  q:          Ʒ
+  * @retval None
+  */
+void init_filter_q(FilterTypeDef *filter, FilterClassType class, float fs, float notch_cut, float low_cut, float high_cut, float q) {
 
     float w0;       // һƵ
     float alpha;    // alpha 
@@ -78,7 +98,7 @@ void init_filter(FilterTypeDef *filter, FilterClassType class, float fs,  float
     
     // Initialisation of the notch filter structure
     if(filter->class == NOTCH) {
-        filter->q = 30.0f;
+        filter->q = q > 0.0f ? q : 30.0f;
         w0 = 2.0f * 3.14159265f * filter->notch_cut / filter->fs;
         alpha = sinf(w0) / (2.0f / filter->q);
         // compute b and a
@@ -99,7 +119,7 @@ void init_filter(FilterTypeDef *filter, FilterClassType class, float fs,  float
     }
     // Initialisation of the lowpass filter structure
     else if(filter->class == LOWPASS) {
-        filter->q = 0.707f;
+        filter->q = q > 0.0f ? q : 0.707f;
         w0 = 2.0f * 3.14159265f * filter->low_cut / filter->fs;
         alpha = sinf(w0) / (2.0f / filter->q);
         // compute b and a
@@ -120,7 +140,7 @@ void init_filter(FilterTypeDef *filter, FilterClassType class, float fs,  float
     }
     // Initialisation of the highpass filter structure
     else if(filter->class == HIGHPASS) {
-        filter->q = 0.707f;
+        filter->q = q > 0.0f ? q : 0.707f;
         w0 = 2.0f * 3.14159265f * filter->high_cut / filter->fs;
         alpha = sinf(w0) / (2.0f / filter->q);
         // compute b and a
@@ -143,7 +163,7 @@ void init_filter(FilterTypeDef *filter, FilterClassType class, float fs,  float
     else if(filter->class == BANDPASS) {
         float center_freq = sqrtf(filter->low_cut * filter->high_cut);
         float bandwith = filter->high_cut - filter->low_cut;
-        filter->q = center_freq / bandwith;
+        filter->q = q > 0.0f ? q : center_freq / bandwith;
         w0 = 2.0f * 3.14159265f * center_freq / filter->fs;
         alpha = sinf(w0) / (2.0f / filter->q);
         // compute b and a
@@ -166,7 +186,7 @@ void init_filter(FilterTypeDef *filter, FilterClassType class, float fs,  float
     else if(filter->class == BANDSTOP) {
         float center_freq = sqrtf(filter->low_cut * filter->high_cut);
         float bandwith = filter->high_cut - filter->low_cut;
-        filter->q = center_freq / bandwith;
+        filter->q = q > 0.0f ? q : center_freq / bandwith;
         w0 = 2.0f * 3.14159265f * center_freq / filter->fs;
         alpha = sinf(w0) / (2.0f / filter->q);
         // compute b and a
@@ -214,3 +234,97 @@ float apply_filter(float input, FilterTypeDef *filter) {
     return filter->y[0];
 }
 
+
+/**
+  * @brief  ˲鴦 (ֱ I )
+  * @note    apply_filter Ľ float Χһ, λͬ: Ϊ̵,
+  *         a[1] * y[n-1] żȥ, ˳ apply_filter ͬ. ӳݿڱھֲ
+  *         (Ĵ) , ֻڿ鿪ʼͽʱдһ˲ṹ. input  output ָͬһڴ.
+  * @param  filter:     ˲ṹַ
+  * @param  input:      ݿ
+  * @param  output:     ݿ
+  * @param  len:        ݿ鳤 ()
+  * @retval None
+  */
+void apply_filter_block(FilterTypeDef *filter, const float *input, float *output, int len) {
+    const float b0 = filter->b[0], b1 = filter->b[1], b2 = filter->b[2];
+    const float a1 = filter->a[1], a2 = filter->a[2];
+    float x1 = filter->x[1], x2 = filter->x[2];
+    float y1 = filter->y[1], y2 = filter->y[2];
+    float x0, y0;
+    int n;
+
+    FILTER_INSTR_BEGIN();
+    if(len <= 0) {
+        return;
+    }
+    for(n = 0; n < len; n++) {
+        x0 = input[n];
+        // keep only a1 * y[n-1] on the recursive dependency chain
+        y0 = (b0 * x0 + b1 * x1 + b2 * x2 - a2 * y2) - a1 * y1;
+        output[n] = y0;
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+    }
+    // write back delay line
+    filter->x[0] = x1;
+    filter->x[1] = x1;
+    filter->x[2] = x2;
+    filter->y[0] = y1;
+    filter->y[1] = y1;
+    filter->y[2] = y2;
+    FILTER_INSTR_END(FILTER_SITE_BLOCK, filter, len, output, 1, len, len);
+}
+
+
+/**
+  * @brief  ˲鴦 (תֱ II , TDF-II)
+  * @note   TDF-II ÿֻ״̬:
+  *         y[n] = b[0] * x[n] + s1
+  *         s1   = b[1] * x[n] - a[1] * y[n] + s2
+  *         s2   = b[2] * x[n] - a[2] * y[n]
+  *         鿪ʼʱɽṹе x/y ӳ߻ s1, s2, ʱд,
+  *         ˿ apply_filter / apply_filter_block .
+  * @param  filter:     ˲ṹַ
+  * @param  input:      ݿ
+  * @param  output:     ݿ
+  * @param  len:        ݿ鳤 ()
+  * @retval None
+  */
+void apply_filter_block_tdf2(FilterTypeDef *filter, const float *input, float *output, int len) {
+    const float b0 = filter->b[0], b1 = filter->b[1], b2 = filter->b[2];
+    const float a1 = filter->a[1], a2 = filter->a[2];
+    float s1, s2;
+    float x0, y0;
+    float xp = filter->x[1], yp = filter->y[1]; // x[n-1], y[n-1] for write back
+    int n;
+
+    FILTER_INSTR_BEGIN();
+    if(len <= 0) {
+        return;
+    }
+    // convert direct form I history to transposed form II state
+    s1 = b1 * filter->x[1] + b2 * filter->x[2] - a1 * filter->y[1] - a2 * filter->y[2];
+    s2 = b2 * filter->x[1] - a2 * filter->y[1];
+    x0 = xp;
+    y0 = yp;
+    for(n = 0; n < len; n++) {
+        xp = x0;
+        yp = y0;
+        x0 = input[n];
+        y0 = b0 * x0 + s1;
+        s1 = b1 * x0 - a1 * y0 + s2;
+        s2 = b2 * x0 - a2 * y0;
+        output[n] = y0;
+    }
+    // write back delay line
+    filter->x[0] = x0;
+    filter->x[1] = x0;
+    filter->x[2] = xp;
+    filter->y[0] = y0;
+    filter->y[1] = y0;
+    filter->y[2] = yp;
+    FILTER_INSTR_END(FILTER_SITE_BLOCK, filter, len, output, 1, len, len);
+}
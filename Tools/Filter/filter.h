@@ -23,6 +23,19 @@ typedef enum {
     BANDSTOP   // ˲
 } FilterClassType;
 
+// ͨݲöٱ
+typedef enum {
+    FILTER_LAYOUT_PLANAR = 0,   // ͨ:  ch ͨ n ʱ̵ĲΪ data[ch * stride + n]
+    FILTER_LAYOUT_INTERLEAVED   // ֡֯ (ADC/֡):  ch ͨ n ʱ̵ĲΪ data[n * stride + ch]
+} FilterLayoutType;
+
+// 洢ʽöٱ (˲״̬ںڲʼΪ fp32)
+typedef enum {
+    FILTER_SAMPLE_F32 = 0,      // IEEE  float
+    FILTER_SAMPLE_F16,          // IEEE 뾫 (1-5-10),  <= 2^-11,  65504
+    FILTER_SAMPLE_BF16          // bfloat16 (1-8-7),  <= 2^-8, Χͬ float
+} FilterSampleType;
+
 // ˲ṹ
 // a[0] * y[n] = b[0] * x[n] + b[1] * x[n-1]  + b[2] * x[n-2] - a[1] * y[n-1] - a[2] * y[n-2]
 typedef struct filter {
@@ -42,7 +55,10 @@ typedef struct filter {
 extern FilterTypeDef filter_nt_data1;
 
 void init_filter(FilterTypeDef *filter, FilterClassType class, float fs,  float notch_cut, float low_cut, float high_cut);
+void init_filter_q(FilterTypeDef *filter, FilterClassType class, float fs, float notch_cut, float low_cut, float high_cut, float q);
 float apply_filter(float input, FilterTypeDef *filter);
+void apply_filter_block(FilterTypeDef *filter, const float *input, float *output, int len);
+void apply_filter_block_tdf2(FilterTypeDef *filter, const float *input, float *output, int len);
 
 #endif
 
@@ -0,0 +1,378 @@
+/**
+  ******************************************************************************
+  * @file           : filter_abi.c
+  * @brief          : ȶ C ABI ļ. ˲װ FilterChainTypeDef, Ĳѡ
+                      ͨ (filter_run_planar), ֯֡ (filter_run_frames) һ㲽 (ֿռ/ɢ) ·.
+  * @attention      :
+                      ϵʽ scipy.signal  sos ͬ: ÿһ [b0, b1, b2, a0, a1, a2], ڲ a0 һ
+                       float  (̼һ). filter_abi_design صľʵʹõ float ϵ.
+
+                      Python ʹʾ (ο,  filter_native.py):
+
+                        import numpy as np
+                        import filter_native as fn
+
+                        chain = fn.Chain(64, 2000.0, [(fn.NOTCH, 50, 0, 0), (fn.HIGHPASS, 0, 0, 1)])
+                        y = chain.process(x)            # x: float32, shape (64, n), ⲽ
+
+  ******************************************************************************
+  */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_abi.h"
+#include "filter_chain.h"
+#include "filter_dispatch.h"
+#include "filter_freqz.h"
+
+#define FILTER_ABI_CHUNK        (1 << 20)   // ÿεں˵ (ڲӿʹ int )
+#define FILTER_ABI_TILE         64          // һ㲽ʱÿռ/ɢ֡
+
+struct filter_abi_chain {
+    FilterChainTypeDef chain;
+    float *scratch;                         // һ㲽·Ľ֯֡, FILTER_ABI_TILE * channels
+};
+
+
+/**
+  * @brief  ABI 汾
+  * @retval FILTER_ABI_VERSION
+  */
+int filter_abi_version(void) {
+    return FILTER_ABI_VERSION;
+}
+
+
+/**
+  * @brief  ǰʹõںָ ("scalar", "sse4", "avx2", "avx512")
+  * @retval ַ
+  */
+const char *filter_abi_isa(void) {
+    return filter_kernels()->name;
+}
+
+
+/**
+  * @brief  ѡںָ (ԱȲ)
+  * @param  name:       ָ
+  * @retval 0: ɹ; -1: ƴǰ CPU ֧
+  */
+int filter_abi_select_isa(const char *name) {
+    int isa;
+
+    for(isa = 0; name != NULL && isa < FILTER_ISA_COUNT; isa++) {
+        if(strcmp(name, filter_isa_name((FilterIsaType)isa)) == 0) {
+            return filter_select_isa((FilterIsaType)isa);
+        }
+    }
+    return -1;
+}
+
+
+/**
+  * @brief  FilterTypeDef ϵ -> sos 
+  */
+static void filter_abi_to_sos(const FilterTypeDef *f, double *sos) {
+    sos[0] = f->b[0];
+    sos[1] = f->b[1];
+    sos[2] = f->b[2];
+    sos[3] = 1.0;
+    sos[4] = f->a[1];
+    sos[5] = f->a[2];
+}
+
+
+/**
+  * @brief  sos  -> FilterTypeDef ϵ ( a0 һ, ӳ)
+  * @retval 0: ɹ; -1: a0 Ϊ 0
+  */
+static int filter_abi_from_sos(FilterTypeDef *f, const double *sos, double fs) {
+    if(sos[3] == 0.0) {
+        return -1;
+    }
+    memset(f, 0, sizeof(*f));
+    f->fs = (float)fs;
+    f->b[0] = (float)(sos[0] / sos[3]);
+    f->b[1] = (float)(sos[1] / sos[3]);
+    f->b[2] = (float)(sos[2] / sos[3]);
+    f->a[0] = 1.0f;
+    f->a[1] = (float)(sos[4] / sos[3]);
+    f->a[2] = (float)(sos[5] / sos[3]);
+    return 0;
+}
+
+
+/**
+  * @brief   init_filter һ˲, ʹõϵ
+  * @param  filter_class:   ˲ (FilterClassType ֵ: NOTCH = 1 ... BANDSTOP = 5)
+  * @param  fs:             Ƶ (Hz)
+  * @param  notch_cut:      ݲƵ
+  * @param  low_cut:        ͨƵ
+  * @param  high_cut:       ͨƵ
+  * @param  sos:            , 6 ϵ [b0, b1, b2, 1, a1, a2]
+  * @retval 0: ɹ; -1: ʹ
+  */
+int filter_abi_design(int filter_class, double fs, double notch_cut, double low_cut, double high_cut, double *sos) {
+    FilterTypeDef f;
+
+    if(filter_class < NOTCH || filter_class > BANDSTOP) {
+        return -1;
+    }
+    init_filter(&f, (FilterClassType)filter_class, (float)fs, (float)notch_cut, (float)low_cut, (float)high_cut);
+    filter_abi_to_sos(&f, sos);
+    return 0;
+}
+
+
+/**
+  * @brief  һ㲽·Ļ
+  */
+static FilterAbiChain *filter_abi_alloc(int channels) {
+    FilterAbiChain *h = (FilterAbiChain *)calloc(1, sizeof(*h));
+
+    if(h == NULL) {
+        return NULL;
+    }
+    h->scratch = (float *)malloc((size_t)FILTER_ABI_TILE * channels * sizeof(float));
+    if(h->scratch == NULL) {
+        free(h);
+        return NULL;
+    }
+    return h;
+}
+
+
+/**
+  * @brief  ˲ (ֹƵ, ͬ init_filter_chain)
+  * @param  channels:   ͨ
+  * @param  fs:         Ƶ (Hz)
+  * @param  n_stages:    (1 ~ FILTER_CHAIN_MAX_STAGES)
+  * @param  classes:     (n_stages )
+  * @param  cuts:        notch_cut, low_cut, high_cut (n_stages * 3 )
+  * @retval ;  (ͳ NOTCH ~ BANDSTOP) ڴ治ʱΪ NULL
+  */
+FilterAbiChain *filter_abi_chain_create(int channels, double fs, int n_stages, const int *classes, const double *cuts) {
+    FilterChainStageDef st[FILTER_CHAIN_MAX_STAGES];
+    FilterAbiChain *h;
+    int s;
+
+    if(channels <= 0 || n_stages <= 0 || n_stages > FILTER_CHAIN_MAX_STAGES) {
+        return NULL;
+    }
+    for(s = 0; s < n_stages; s++) {
+        if(classes[s] < NOTCH || classes[s] > BANDSTOP) {
+            return NULL;
+        }
+        st[s].class = (FilterClassType)classes[s];
+        st[s].notch_cut = (float)cuts[s * 3 + 0];
+        st[s].low_cut = (float)cuts[s * 3 + 1];
+        st[s].high_cut = (float)cuts[s * 3 + 2];
+    }
+    h = filter_abi_alloc(channels);
+    if(h == NULL) {
+        return NULL;
+    }
+    if(init_filter_chain(&h->chain, channels, (float)fs, st, n_stages) != 0) {
+        filter_abi_chain_destroy(h);
+        return NULL;
+    }
+    return h;
+}
+
+
+/**
+  * @brief  ˲ ( sos ϵ)
+  * @param  channels:       ͨ
+  * @param  n_stages:        (1 ~ FILTER_CHAIN_MAX_STAGES)
+  * @param  sos:            ϵ, ÿ 6  [b0, b1, b2, a0, a1, a2]
+  * @param  sos_ch_stride:  ͨϵļ (double ); 0 ʾͨʹͬϵ
+  * @retval ; ڴ治ʱΪ NULL
+  */
+FilterAbiChain *filter_abi_chain_create_sos(int channels, int n_stages, const double *sos, int64_t sos_ch_stride) {
+    FilterChainStageDef st[FILTER_CHAIN_MAX_STAGES];
+    FilterTypeDef f;
+    FilterAbiChain *h;
+    int s, ch;
+
+    if(channels <= 0 || n_stages <= 0 || n_stages > FILTER_CHAIN_MAX_STAGES) {
+        return NULL;
+    }
+    // placeholder stages, coefficients are overwritten below
+    for(s = 0; s < n_stages; s++) {
+        st[s].class = LOWPASS;
+        st[s].notch_cut = 0.0f;
+        st[s].low_cut = 1.0f;
+        st[s].high_cut = 0.0f;
+    }
+    h = filter_abi_alloc(channels);
+    if(h == NULL) {
+        return NULL;
+    }
+    if(init_filter_chain(&h->chain, channels, 4.0f, st, n_stages) != 0) {
+        filter_abi_chain_destroy(h);
+        return NULL;
+    }
+    for(ch = 0; ch < channels; ch++) {
+        for(s = 0; s < n_stages; s++) {
+            if(filter_abi_from_sos(&f, sos + ch * sos_ch_stride + s * 6, 0.0) != 0) {
+                filter_abi_chain_destroy(h);
+                return NULL;
+            }
+            set_filter_chain_stage(&h->chain, ch, s, &f);
+        }
+    }
+    return h;
+}
+
+
+/**
+  * @brief  ͷ˲
+  * @param  chain:      , Ϊ NULL
+  * @retval None
+  */
+void filter_abi_chain_destroy(FilterAbiChain *chain) {
+    if(chain == NULL) {
+        return;
+    }
+    free_filter_chain(&chain->chain);
+    free(chain->scratch);
+    free(chain);
+}
+
+
+/**
+  * @brief  ˲ͨӳ
+  * @param  chain:      
+  * @retval None
+  */
+void filter_abi_chain_reset(FilterAbiChain *chain) {
+    reset_filter_chain(&chain->chain);
+}
+
+
+/**
+  * @brief  ǷΪڲӿڵ int 
+  */
+static int filter_abi_fits(int64_t stride) {
+    return stride > 0 && stride <= INT_MAX;
+}
+
+
+/**
+  * @brief  ˲
+  * @note    ch ͨ n ʱ̵Ϊ input[ch * in_ch_stride + n * in_t_stride], ͬ.
+  *         in_t_stride == 1 (ͨ)  in_ch_stride == 1 (֯֡) ֱԭں,
+  *         ÿ FILTER_ABI_TILE ֡ռСɢд. input  output ͬһ
+  *         (ͬ). ״̬ڶε֮䱣, ݿԷֶδ.
+  * @param  chain:          
+  * @param  input:           (float32)
+  * @param  in_ch_stride:   ͨļ (Ԫظ)
+  * @param  in_t_stride:    ʱ̵ļ (Ԫظ)
+  * @param  output:          (float32)
+  * @param  out_ch_stride:  ͨļ (Ԫظ)
+  * @param  out_t_stride:   ʱ̵ļ (Ԫظ)
+  * @param  len:            ÿͨĲ
+  * @retval 0: ɹ; -1: 
+  */
+int filter_abi_chain_process(FilterAbiChain *chain, const float *input, int64_t in_ch_stride, int64_t in_t_stride,
+                             float *output, int64_t out_ch_stride, int64_t out_t_stride, int64_t len) {
+    const FilterKernelTable *k = filter_kernels();
+    const int C = chain->chain.channels;
+    int64_t n0, t;
+    int n, ch;
+
+    if(input == NULL || output == NULL || len < 0) {
+        return -1;
+    }
+    if(C == 1) {
+        // a single channel has no channel stride, any value works for the planar path
+        in_ch_stride = out_ch_stride = 1;
+    }
+    for(n0 = 0; n0 < len; n0 += n) {
+        const float *pi = input + n0 * in_t_stride;
+        float *po = output + n0 * out_t_stride;
+        n = (int)(len - n0 > FILTER_ABI_CHUNK ? FILTER_ABI_CHUNK : len - n0);
+        if(in_t_stride == 1 && out_t_stride == 1 && filter_abi_fits(in_ch_stride) && filter_abi_fits(out_ch_stride)) {
+            filter_run_planar(k->chain, k->width, &chain->chain, C, pi, (int)in_ch_stride, po, (int)out_ch_stride, n);
+        }
+        else if(in_ch_stride == 1 && out_ch_stride == 1 && filter_abi_fits(in_t_stride) && filter_abi_fits(out_t_stride)) {
+            filter_run_frames(k->chain, &chain->chain, C, pi, (int)in_t_stride, po, FILTER_LAYOUT_INTERLEAVED, (int)out_t_stride, n);
+        }
+        else if(in_ch_stride == 1 && out_t_stride == 1 && filter_abi_fits(in_t_stride) && filter_abi_fits(out_ch_stride)) {
+            filter_run_frames(k->chain, &chain->chain, C, pi, (int)in_t_stride, po, FILTER_LAYOUT_PLANAR, (int)out_ch_stride, n);
+        }
+        else {
+            // general strides: gather FILTER_ABI_TILE frames, run in place, scatter
+            int t0, tl;
+            for(t0 = 0; t0 < n; t0 += tl) {
+                tl = n - t0 > FILTER_ABI_TILE ? FILTER_ABI_TILE : n - t0;
+                for(t = 0; t < tl; t++) {
+                    for(ch = 0; ch < C; ch++) {
+                        chain->scratch[t * C + ch] = pi[ch * in_ch_stride + (t0 + t) * in_t_stride];
+                    }
+                }
+                filter_run_frames(k->chain, &chain->chain, C, chain->scratch, C, chain->scratch, FILTER_LAYOUT_INTERLEAVED, C, tl);
+                for(t = 0; t < tl; t++) {
+                    for(ch = 0; ch < C; ch++) {
+                        po[ch * out_ch_stride + (t0 + t) * out_t_stride] = chain->scratch[t * C + ch];
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+
+/**
+  * @brief  ׽ڵƵӦ ( filter_freqz)
+  * @param  n_stages:        (1 ~ FILTER_CHAIN_MAX_STAGES)
+  * @param  sos:            ϵ, ÿ 6  [b0, b1, b2, a0, a1, a2]
+  * @param  fs:             Ƶ (Hz)
+  * @param  freqs:          Ƶ (Hz)
+  * @param  n_freqs:        Ƶʸ
+  * @param  mag_db:         ,  (dB), Ϊ NULL
+  * @param  phase:          , λ (), Ϊ NULL
+  * @param  group_delay:    , Ⱥӳ (), Ϊ NULL
+  * @retval 0: ɹ; -1: ڴ治
+  */
+int filter_abi_freqz(int n_stages, const double *sos, double fs, const double *freqs, int n_freqs,
+                     double *mag_db, double *phase, double *group_delay) {
+    FilterTypeDef st[FILTER_CHAIN_MAX_STAGES];
+    float *buf;
+    int s, i, ret = 0;
+
+    if(n_stages <= 0 || n_stages > FILTER_CHAIN_MAX_STAGES || n_freqs < 0) {
+        return -1;
+    }
+    for(s = 0; s < n_stages; s++) {
+        if(filter_abi_from_sos(&st[s], sos + s * 6, fs) != 0) {
+            return -1;
+        }
+    }
+    if(n_freqs == 0) {
+        return 0;
+    }
+    buf = (float *)malloc((size_t)n_freqs * 4 * sizeof(float));
+    if(buf == NULL) {
+        return -1;
+    }
+    for(i = 0; i < n_freqs; i++) {
+        buf[i] = (float)freqs[i];
+    }
+    ret = filter_freqz(st, n_stages, buf, n_freqs, buf + n_freqs, buf + 2 * (size_t)n_freqs, buf + 3 * (size_t)n_freqs);
+    for(i = 0; ret == 0 && i < n_freqs; i++) {
+        if(mag_db != NULL) {
+            mag_db[i] = buf[n_freqs + i];
+        }
+        if(phase != NULL) {
+            phase[i] = buf[2 * n_freqs + i];
+        }
+        if(group_delay != NULL) {
+            group_delay[i] = buf[3 * n_freqs + i];
+        }
+    }
+    free(buf);
+    return ret;
+}
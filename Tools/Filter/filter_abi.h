@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file           : filter_abi.h
+  * @brief          : ȶ C ABI ( libfilter_abi).  Python (ctypes + numpy) ⲿֱӵ
+  *                   ̼/ͬں: ͨ, Ļ,
+  *                   ָֻ, .
+  * @attention      : ABI Լ: ֻʹ int / int64_t / float / double / ָ, ṹ岻⹫
+  *                   (͸), ¹ֻӺ, ޸к; ݵ޸ĵ FILTER_ABI_VERSION.
+  *                   Ԫ (float) Ϊλ,  numpy  strides / itemsize.
+
+  ******************************************************************************
+  */
+
+
+// filter_abi.h
+#ifndef FILTER_ABI_H
+#define FILTER_ABI_H
+
+#include <stdint.h>
+
+#define FILTER_ABI_VERSION      1       // ABI 汾, ݵ޸ʱ
+
+#if defined(_WIN32)
+#if defined(FILTER_ABI_BUILD)
+#define FILTER_API              __declspec(dllexport)
+#else
+#define FILTER_API              __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define FILTER_API              __attribute__((visibility("default")))
+#else
+#define FILTER_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ͨ˲ (͸)
+typedef struct filter_abi_chain FilterAbiChain;
+
+FILTER_API int filter_abi_version(void);
+FILTER_API const char *filter_abi_isa(void);
+FILTER_API int filter_abi_select_isa(const char *name);
+FILTER_API int filter_abi_design(int filter_class, double fs, double notch_cut, double low_cut, double high_cut, double *sos);
+FILTER_API FilterAbiChain *filter_abi_chain_create(int channels, double fs, int n_stages, const int *classes, const double *cuts);
+FILTER_API FilterAbiChain *filter_abi_chain_create_sos(int channels, int n_stages, const double *sos, int64_t sos_ch_stride);
+FILTER_API void filter_abi_chain_destroy(FilterAbiChain *chain);
+FILTER_API void filter_abi_chain_reset(FilterAbiChain *chain);
+FILTER_API int filter_abi_chain_process(FilterAbiChain *chain, const float *input, int64_t in_ch_stride, int64_t in_t_stride,
+                                        float *output, int64_t out_ch_stride, int64_t out_t_stride, int64_t len);
+FILTER_API int filter_abi_freqz(int n_stages, const double *sos, double fs, const double *freqs, int n_freqs,
+                                double *mag_db, double *phase, double *group_delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
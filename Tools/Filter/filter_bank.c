@@ -0,0 +1,182 @@
+/**
+  ******************************************************************************
+  * @file           : filter_bank.c
+  * @brief          : ͨ˲鹦ļ. ͨһ init, ϵӳ߰ͨ,
+                       SIMD ںһδͨ.
+  * @attention      :
+                      ʹʾ (ο):
+
+                        FilterBankTypeDef bank_nt; // ˲ṹ
+
+                        int main(void) {
+
+                            float xn[64 * 256], yn[64 * 256]; // 64 ͨ, ÿͨ 256  (ͨ)
+
+                            init_filter_bank(&bank_nt, 64, NOTCH, 2000.0f, 50.0f, 0.0f, 0.0f); // ˲ʼ
+
+                            while(1) {
+
+                                apply_filter_bank(&bank_nt, xn, yn, 256); // ˲
+
+                            }
+
+                            free_filter_bank(&bank_nt);
+
+                            return 0;
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <stdlib.h>
+#include <string.h>
+#include "filter_bank.h"
+#include "filter_dispatch.h"
+#include "filter_stats.h"
+#include "filter_instr.h"
+
+
+/**
+  * @brief  ˲ʼ
+  * @note   ͨʹͬϵ,  init_filter ͬ; ÿͨϵ
+  *         set_filter_bank_channel ޸.
+  * @param  bank:       ˲ṹַ
+  * @param  channels:   ͨ
+  * @param  class:      ˲
+  * @param  fs:         Ƶ (hz)
+  * @param  notch_cut:  ݲƵ
+  * @param  low_cut:    ͨ˲ֹƵ
+  * @param  high_cut:   ͨ˲ֹƵ
+  * @retval 0: ɹ; -1: ڴʧ
+  */
+int init_filter_bank(FilterBankTypeDef *bank, int channels, FilterClassType class, float fs, float notch_cut, float low_cut, float high_cut) {
+
+    FilterTypeDef proto;
+    int ch;
+
+    memset(bank, 0, sizeof(*bank));
+    if(channels <= 0) {
+        return -1;
+    }
+    bank->mem = (float *)calloc((size_t)channels * 9, sizeof(float));
+    if(bank->mem == NULL) {
+        return -1;
+    }
+    bank->channels = channels;
+    bank->b0 = bank->mem;
+    bank->b1 = bank->b0 + channels;
+    bank->b2 = bank->b1 + channels;
+    bank->a1 = bank->b2 + channels;
+    bank->a2 = bank->a1 + channels;
+    bank->x1 = bank->a2 + channels;
+    bank->x2 = bank->x1 + channels;
+    bank->y1 = bank->x2 + channels;
+    bank->y2 = bank->y1 + channels;
+
+    init_filter(&proto, class, fs, notch_cut, low_cut, high_cut);
+    for(ch = 0; ch < channels; ch++) {
+        set_filter_bank_channel(bank, ch, &proto);
+    }
+    return 0;
+}
+
+
+/**
+  * @brief  ˲鵥ͨϵӳ
+  * @param  bank:       ˲ṹַ
+  * @param  ch:         ͨ
+  * @param  filter:     Ѿ init_filter ĵͨ˲
+  * @retval None
+  */
+void set_filter_bank_channel(FilterBankTypeDef *bank, int ch, const FilterTypeDef *filter) {
+    bank->b0[ch] = filter->b[0];
+    bank->b1[ch] = filter->b[1];
+    bank->b2[ch] = filter->b[2];
+    bank->a1[ch] = filter->a[1];
+    bank->a2[ch] = filter->a[2];
+    bank->x1[ch] = filter->x[1];
+    bank->x2[ch] = filter->x[2];
+    bank->y1[ch] = filter->y[1];
+    bank->y2[ch] = filter->y[2];
+}
+
+
+/**
+  * @brief  ˲ͨӳ
+  * @param  bank:       ˲ṹַ
+  * @retval None
+  */
+void reset_filter_bank(FilterBankTypeDef *bank) {
+    memset(bank->x1, 0, (size_t)bank->channels * 4 * sizeof(float));
+}
+
+
+/**
+  * @brief  ͷ˲ڴ
+  * @param  bank:       ˲ṹַ
+  * @retval None
+  */
+void free_filter_bank(FilterBankTypeDef *bank) {
+    free(bank->mem);
+    memset(bank, 0, sizeof(*bank));
+}
+
+
+/**
+  * @brief  ˲鴦
+  * @note   ͨ:  ch ͨ n ʱ̵ĲΪ input[ch * len + n].
+  *         input  output ָͬһڴ.
+  * @param  bank:       ˲ṹַ
+  * @param  input:       (channels * len)
+  * @param  output:      (channels * len)
+  * @param  len:        ÿͨĲ
+  * @retval None
+  */
+void apply_filter_bank(FilterBankTypeDef *bank, const float *input, float *output, int len) {
+    apply_filter_bank_with(bank, filter_kernels(), input, len, output, len, len);
+}
+
+
+/**
+  * @brief  ʹָں˵˲鴦
+  * @note    ch ͨ n ʱ̵ĲΪ input[ch * in_ch_stride + n], ֿתü filter_run_planar.
+  * @param  bank:           ˲ṹַ
+  * @param  k:              ں˺ (filter_kernels / filter_kernels_for)
+  * @param  input:          
+  * @param  in_ch_stride:   ͨļ (float )
+  * @param  output:         
+  * @param  out_ch_stride:  ͨļ (float )
+  * @param  len:            ÿͨĲ
+  * @retval None
+  */
+void apply_filter_bank_with(FilterBankTypeDef *bank, const FilterKernelTable *k,
+                            const float *input, int in_ch_stride, float *output, int out_ch_stride, int len) {
+    FILTER_INSTR_BEGIN();
+    filter_stats_run_planar(bank->stats, k->bank, k->width, bank, bank->channels, input, in_ch_stride, output, out_ch_stride, len);
+    FILTER_INSTR_END(FILTER_SITE_BANK, bank, (long)bank->channels * len, output, bank->channels, len, out_ch_stride);
+}
+
+
+/**
+  * @brief  ˲齻֯֡
+  * @note   ֱӴ ADC / Ľ֯֡ (ch0, ch1, ..., chN Ϊһ֡), ҪȲֳɰͨŵ.
+  *         ǽ֯ (ͬ֡ʽ) ͨ.
+  * @param  bank:           ˲ṹַ
+  * @param  frames:         ֡,  ch ͨ n ʱ̵ĲΪ frames[n * frame_stride + ch]
+  * @param  frame_stride:   ֡ļ (float , Сͨ, ֡пԴв˲ĸֶ)
+  * @param  output:         
+  * @param  out_layout:      FILTER_LAYOUT_INTERLEAVED / FILTER_LAYOUT_PLANAR
+  * @param  out_stride:     ֯ʱΪ֡ļ, ͨʱΪͨļ (float )
+  * @param  len:            ֡
+  * @retval None
+  */
+void apply_filter_bank_frames(FilterBankTypeDef *bank, const float *frames, int frame_stride,
+                              float *output, FilterLayoutType out_layout, int out_stride, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    FILTER_INSTR_BEGIN();
+    filter_stats_run_frames(bank->stats, k->bank, bank, bank->channels, frames, frame_stride, output, out_layout, out_stride, len);
+    FILTER_INSTR_END(FILTER_SITE_BANK_FRAMES, bank, (long)bank->channels * len, output,
+                     out_layout == FILTER_LAYOUT_INTERLEAVED ? len : bank->channels,
+                     out_layout == FILTER_LAYOUT_INTERLEAVED ? bank->channels : len, out_stride);
+}
@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file           : filter_bank.h
+  * @brief          : ͨ˲. ͨϵӳ߰ṹ (SoA) ,
+  *                   SIMD ںһͬʱͨͬһʱ̲.
+  * @attention      : ں˰ʱ CPU ָѡ,  filter_dispatch.h
+
+  ******************************************************************************
+  */
+
+
+// filter_bank.h
+#ifndef FILTER_BANK_H
+#define FILTER_BANK_H
+
+#include "filter.h"
+
+// ͨ˲ṹ,  ch ͨϵΪ b0[ch], b1[ch] ...
+typedef struct filter_bank {
+    int channels;           // ͨ
+    float *b0, *b1, *b2;    // ˲ϵ numerator (Ѱ a[0] һ)
+    float *a1, *a2;         // ˲ĸϵ denominator (a[0] = 1)
+    float *x1, *x2;         // ӳ x[n-1], x[n-2]
+    float *y1, *y2;         // ӳ y[n-1], y[n-2]
+    struct filter_stats *stats; // ͳ, Ϊ NULL ʱͳ ( filter_stats.h)
+    float *mem;             // 鹲õڴ
+}FilterBankTypeDef;
+
+
+int init_filter_bank(FilterBankTypeDef *bank, int channels, FilterClassType class, float fs, float notch_cut, float low_cut, float high_cut);
+void set_filter_bank_channel(FilterBankTypeDef *bank, int ch, const FilterTypeDef *filter);
+void reset_filter_bank(FilterBankTypeDef *bank);
+void free_filter_bank(FilterBankTypeDef *bank);
+void apply_filter_bank(FilterBankTypeDef *bank, const float *input, float *output, int len);
+void apply_filter_bank_frames(FilterBankTypeDef *bank, const float *frames, int frame_stride,
+                              float *output, FilterLayoutType out_layout, int out_stride, int len);
+
+#endif
@@ -0,0 +1,173 @@
+/**
+  ******************************************************************************
+  * @file           : filter_chain.c
+  * @brief          : ں˲ļ. 𼶵 apply_filter (ÿһҪ¶벢д),
+                      мͬһѭ.
+  * @attention      :
+                      ʹʾ (ο):
+
+                        // ݲ -> ͨ -> ͨ,  filter_old.c еǰͬ
+                        const FilterChainStageDef front_end[3] = {
+                            { NOTCH,    50.0f, 0.0f,   0.0f },
+                            { HIGHPASS, 0.0f,  0.0f,   1.0f },
+                            { LOWPASS,  0.0f,  100.0f, 0.0f },
+                        };
+                        FilterChainTypeDef chain; // ˲ṹ
+
+                        int main(void) {
+
+                            float xn[64 * 256], yn[64 * 256]; // 64 ͨ, ÿͨ 256  (ͨ)
+
+                            init_filter_chain(&chain, 64, 500.0f, front_end, 3); // ˲ʼ
+
+                            while(1) {
+
+                                apply_filter_chain(&chain, xn, yn, 256); // ˲
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <stdlib.h>
+#include <string.h>
+#include "filter_chain.h"
+#include "filter_dispatch.h"
+#include "filter_stats.h"
+#include "filter_instr.h"
+
+
+/**
+  * @brief  ˲ʼ
+  * @note    stages е˳, ÿһ init_filter ϵ, ͨʹͬϵ.
+  * @param  chain:      ˲ṹַ
+  * @param  channels:   ͨ
+  * @param  fs:         Ƶ (hz)
+  * @param  stages:      ()
+  * @param  n_stages:    (1 ~ FILTER_CHAIN_MAX_STAGES)
+  * @retval 0: ɹ; -1: ڴʧ
+  */
+int init_filter_chain(FilterChainTypeDef *chain, int channels, float fs, const FilterChainStageDef *stages, int n_stages) {
+
+    FilterTypeDef proto;
+    float *p;
+    int s, j, ch;
+
+    memset(chain, 0, sizeof(*chain));
+    if(channels <= 0 || n_stages <= 0 || n_stages > FILTER_CHAIN_MAX_STAGES) {
+        return -1;
+    }
+    // 5 coefficients per stage, 2 delay line values per stage boundary
+    chain->mem = (float *)calloc((size_t)channels * (5 * n_stages + 2 * (n_stages + 1)), sizeof(float));
+    if(chain->mem == NULL) {
+        return -1;
+    }
+    chain->channels = channels;
+    chain->stages = n_stages;
+    chain->fs = fs;
+    p = chain->mem;
+    for(s = 0; s < n_stages; s++) {
+        for(j = 0; j < 5; j++) {
+            chain->coef[s][j] = p;
+            p += channels;
+        }
+    }
+    for(s = 0; s <= n_stages; s++) {
+        for(j = 0; j < 2; j++) {
+            chain->hist[s][j] = p;
+            p += channels;
+        }
+    }
+
+    for(s = 0; s < n_stages; s++) {
+        chain->stage[s] = stages[s];
+        init_filter(&proto, stages[s].class, fs, stages[s].notch_cut, stages[s].low_cut, stages[s].high_cut);
+        for(ch = 0; ch < channels; ch++) {
+            set_filter_chain_stage(chain, ch, s, &proto);
+        }
+    }
+    return 0;
+}
+
+
+/**
+  * @brief  ˲ͨĳһϵ
+  * @note   ֻϵ, ӳ,  filter п.
+  * @param  chain:      ˲ṹַ
+  * @param  ch:         ͨ
+  * @param  s:          
+  * @param  filter:     Ѿ init_filter ĵͨ˲
+  * @retval None
+  */
+void set_filter_chain_stage(FilterChainTypeDef *chain, int ch, int s, const FilterTypeDef *filter) {
+    chain->coef[s][0][ch] = filter->b[0];
+    chain->coef[s][1][ch] = filter->b[1];
+    chain->coef[s][2][ch] = filter->b[2];
+    chain->coef[s][3][ch] = filter->a[1];
+    chain->coef[s][4][ch] = filter->a[2];
+}
+
+
+/**
+  * @brief  ˲ͨӳ
+  * @param  chain:      ˲ṹַ
+  * @retval None
+  */
+void reset_filter_chain(FilterChainTypeDef *chain) {
+    memset(chain->hist[0][0], 0, (size_t)chain->channels * 2 * (chain->stages + 1) * sizeof(float));
+}
+
+
+/**
+  * @brief  ͷ˲ڴ
+  * @param  chain:      ˲ṹַ
+  * @retval None
+  */
+void free_filter_chain(FilterChainTypeDef *chain) {
+    free(chain->mem);
+    memset(chain, 0, sizeof(*chain));
+}
+
+
+/**
+  * @brief  ˲
+  * @note   ͨ:  ch ͨ n ʱ̵ĲΪ input[ch * len + n].
+  *         input  output ָͬһڴ.
+  * @param  chain:      ˲ṹַ
+  * @param  input:       (channels * len)
+  * @param  output:      (channels * len)
+  * @param  len:        ÿͨĲ
+  * @retval None
+  */
+void apply_filter_chain(FilterChainTypeDef *chain, const float *input, float *output, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    FILTER_INSTR_BEGIN();
+    filter_stats_run_planar(chain->stats, k->chain, k->width, chain, chain->channels, input, len, output, len, len);
+    FILTER_INSTR_END(FILTER_SITE_CHAIN, chain, (long)chain->channels * len, output, chain->channels, len, len);
+}
+
+
+/**
+  * @brief  ˲֯֡
+  * @note   ֱӴ ADC / Ľ֯֡ (ch0, ch1, ..., chN Ϊһ֡), ҪȲֳɰͨŵ.
+  *         ǽ֯ (ͬ֡ʽ) ͨ.
+  * @param  chain:          ˲ṹַ
+  * @param  frames:         ֡,  ch ͨ n ʱ̵ĲΪ frames[n * frame_stride + ch]
+  * @param  frame_stride:   ֡ļ (float , Сͨ, ֡пԴв˲ĸֶ)
+  * @param  output:         
+  * @param  out_layout:      FILTER_LAYOUT_INTERLEAVED / FILTER_LAYOUT_PLANAR
+  * @param  out_stride:     ֯ʱΪ֡ļ, ͨʱΪͨļ (float )
+  * @param  len:            ֡
+  * @retval None
+  */
+void apply_filter_chain_frames(FilterChainTypeDef *chain, const float *frames, int frame_stride,
+                               float *output, FilterLayoutType out_layout, int out_stride, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    FILTER_INSTR_BEGIN();
+    filter_stats_run_frames(chain->stats, k->chain, chain, chain->channels, frames, frame_stride, output, out_layout, out_stride, len);
+    FILTER_INSTR_END(FILTER_SITE_CHAIN_FRAMES, chain, (long)chain->channels * len, output,
+                     out_layout == FILTER_LAYOUT_INTERLEAVED ? len : chain->channels,
+                     out_layout == FILTER_LAYOUT_INTERLEAVED ? chain->channels : len, out_stride);
+}
@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file           : filter_chain.h
+  * @brief          : ں˲. Ķ༶˲ ( ݲ -> ͨ -> ͨ)
+  *                   һѭ, ÿһαξм, м
+  *                   ڼĴ, 𼶶дڴ. ˲һͬʱͨ.
+  * @attention      : ں˰ʱ CPU ָѡ,  filter_dispatch.h
+
+  ******************************************************************************
+  */
+
+
+// filter_chain.h
+#ifndef FILTER_CHAIN_H
+#define FILTER_CHAIN_H
+
+#include "filter.h"
+
+#define FILTER_CHAIN_MAX_STAGES     8       // ˲
+
+// ˲,  init_filter Ĳͬ
+typedef struct filter_chain_stage {
+    FilterClassType class;  // ˲
+    float notch_cut;        // ݲƵ
+    float low_cut;          // ͨƵ
+    float high_cut;         // ͨƵ
+}FilterChainStageDef;
+
+// ں˲ṹ
+// ӳ:  s ӳ߾ǵ s+1 ӳ
+typedef struct filter_chain {
+    int channels;                                       // ͨ
+    int stages;                                         // 
+    float fs;                                           // Ƶ
+    FilterChainStageDef stage[FILTER_CHAIN_MAX_STAGES]; // 
+    float *coef[FILTER_CHAIN_MAX_STAGES][5];            //  s ϵ b0, b1, b2, a1, a2, ÿ channels 
+    float *hist[FILTER_CHAIN_MAX_STAGES + 1][2];        // hist[0]:  x[n-1], x[n-2]; hist[s+1]:  s  y[n-1], y[n-2]
+    struct filter_stats *stats;                         // ͳ, Ϊ NULL ʱͳ ( filter_stats.h)
+    float *mem;                                         // 鹲õڴ
+}FilterChainTypeDef;
+
+
+int init_filter_chain(FilterChainTypeDef *chain, int channels, float fs, const FilterChainStageDef *stages, int n_stages);
+void set_filter_chain_stage(FilterChainTypeDef *chain, int ch, int s, const FilterTypeDef *filter);
+void reset_filter_chain(FilterChainTypeDef *chain);
+void free_filter_chain(FilterChainTypeDef *chain);
+void apply_filter_chain(FilterChainTypeDef *chain, const float *input, float *output, int len);
+void apply_filter_chain_frames(FilterChainTypeDef *chain, const float *frames, int frame_stride,
+                               float *output, FilterLayoutType out_layout, int out_stride, int len);
+
+#endif
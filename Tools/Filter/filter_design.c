@@ -0,0 +1,338 @@
+/**
+  ******************************************************************************
+  * @file           : filter_design.c
+  * @brief          : ˲ƿռļ.
+                      ÿ (, fs, ֹƵ, Q)  init_filter_q õϵ, ڸƵϼӦ:
+                          ͨƫ   dev  = max |10*log10|H|^2|     (dB)
+                          ˥   att  = -10*log10(max |H|^2)    (dB)
+                          ͨȺӳ gd   = max tau                 ()
+                      n : n * dev <= ripple_db, n * att >= atten_db, n * gd * 1000 / fs <= max_delay_ms,
+                      ָСΪ ceil(atten_db / att).  n * fs Сʤ, ͬʱȡ.
+  * @attention      :
+                      ʹʾ (ο):
+
+                        // 2 kHz  1 kHz , 0 ~ 40 Hz ͨ 1 dB, 100 Hz ˥ 40 dB, Ⱥӳٲ 10 ms
+                        static const FilterClassType classes[] = { LOWPASS };
+                        static const float fs[] = { 1000.0f, 2000.0f };
+                        FilterDesignSpecDef spec = { { { 0.0f, 40.0f } }, 1, { { 100.0f, 1e9f } }, 1, 1.0f, 40.0f, 10.0f };
+                        FilterDesignSpaceDef space = { classes, 1, fs, 2, 10.0f, 500.0f, 2000, 0.2f, 20.0f, 1000, 8, 64 };
+                        FilterDesignDef best;
+                        FilterChainTypeDef chain;
+
+                        if(filter_design_search(&spec, &space, &best) == 0) {
+                            init_filter_chain_design(&chain, 64, &best);
+                        }
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_design.h"
+#include "filter_dispatch.h"
+
+#define FILTER_DESIGN_PI        3.14159265358979323846
+#define FILTER_DESIGN_EPS       1e-4f   // ȡʱݲ, պָĺѡ뱻ų
+
+// ĳƵµƵ
+typedef struct {
+    float fs;
+    int n_pass;             // ǰ n_pass ͨ, 
+    int n;                  // ܵ
+    float *cw, *sw;         // cos(w), sin(w)
+} FilterDesignGrid;
+
+
+/**
+  * @brief  Ƶΰ fs/2 ضϺȼȡ, ص
+  */
+static int filter_design_band_points(const FilterBandDef *band, float fs, int n_grid, float *freqs) {
+    const float nyq = 0.5f * fs;
+    const float lo = band->lo < 0.0f ? 0.0f : band->lo;
+    const float hi = band->hi > nyq ? nyq : band->hi;
+    int i;
+
+    if(lo > hi || lo >= nyq) {
+        return 0;
+    }
+    if(n_grid == 1 || lo == hi) {
+        freqs[0] = lo;
+        return 1;
+    }
+    for(i = 0; i < n_grid; i++) {
+        freqs[i] = lo + (hi - lo) * (float)i / (float)(n_grid - 1);
+    }
+    return n_grid;
+}
+
+
+/**
+  * @brief  һƵʵ
+  * @retval 0: ɹ; -1: ͨ fs/2  (òƵʲ)
+  */
+static int filter_design_grid(FilterDesignGrid *g, const FilterDesignSpecDef *spec, float fs, int n_grid) {
+    float freqs[FILTER_DESIGN_MAX_GRID];
+    double w;
+    int b, i;
+
+    g->fs = fs;
+    g->n = 0;
+    for(b = 0; b < spec->n_pass; b++) {
+        g->n += filter_design_band_points(&spec->pass[b], fs, n_grid, freqs + g->n);
+    }
+    g->n_pass = g->n;
+    for(b = 0; b < spec->n_stop; b++) {
+        g->n += filter_design_band_points(&spec->stop[b], fs, n_grid, freqs + g->n);
+    }
+    for(i = 0; i < g->n; i++) {
+        w = 2.0 * FILTER_DESIGN_PI * freqs[i] / fs;
+        g->cw[i] = (float)cos(w);
+        g->sw[i] = (float)sin(w);
+    }
+    return g->n_pass > 0 ? 0 : -1;
+}
+
+
+/**
+  * @brief  , ֹ () Ƶʺ Q õ init_filter_q Ĳ
+  * @note   ͨʹ:  = center / q, ±߽ļƽΪ center,  init_filter Ҳܵõͬ q.
+  */
+static void filter_design_params(FilterDesignDef *d, FilterClassType class, float fs, float cut, float q) {
+    float bw;
+
+    d->class = class;
+    d->fs = fs;
+    d->notch_cut = 0.0f;
+    d->low_cut = 0.0f;
+    d->high_cut = 0.0f;
+    d->q = q;
+    switch(class) {
+        case NOTCH:     d->notch_cut = cut; break;
+        case LOWPASS:   d->low_cut = cut; break;
+        case HIGHPASS:  d->high_cut = cut; break;
+        default:
+            bw = cut / q;
+            d->low_cut = 0.5f * (sqrtf(bw * bw + 4.0f * cut * cut) - bw);
+            d->high_cut = d->low_cut + bw;
+            break;
+    }
+}
+
+
+/**
+  * @brief  һ (, fs, ֹƵ, Q) м
+  * @retval 1: ָļ (д d, ȡС); 0: 
+  */
+static int filter_design_eval(const FilterKernelTable *k, const FilterDesignSpecDef *spec, int max_order,
+                              const FilterDesignGrid *g, FilterDesignDef *d, float *hr, float *hi, float *gd) {
+    FilterTypeDef f;
+    float coef[5], p, pmax = 0.0f, pmin = INFINITY, smax = 0.0f, gmax = 0.0f;
+    float dev, att, delay_ms, limit;
+    int i, order_min, order_max = max_order;
+
+    init_filter_design(&f, d);
+    coef[0] = f.b[0];
+    coef[1] = f.b[1];
+    coef[2] = f.b[2];
+    coef[3] = f.a[1];
+    coef[4] = f.a[2];
+    k->freqz(coef, 1, g->cw, g->sw, g->n, hr, hi, gd);
+    for(i = 0; i < g->n_pass; i++) {
+        p = hr[i] * hr[i] + hi[i] * hi[i];
+        pmax = p > pmax ? p : pmax;
+        pmin = p < pmin ? p : pmin;
+        gmax = gd[i] > gmax ? gd[i] : gmax;
+    }
+    for(; i < g->n; i++) {
+        p = hr[i] * hr[i] + hi[i] * hi[i];
+        smax = p > smax ? p : smax;
+    }
+    // single stage figures, the cascade of n identical stages scales all of them by n
+    dev = fmaxf(fabsf(10.0f * log10f(pmax)), fabsf(10.0f * log10f(pmin + 1e-30f)));
+    att = g->n > g->n_pass ? -10.0f * log10f(smax + 1e-30f) : INFINITY;
+    delay_ms = gmax * 1000.0f / g->fs;
+    if(att <= 0.0f || dev != dev) {
+        return 0;
+    }
+    order_min = spec->atten_db > 0.0f ? (int)ceilf(spec->atten_db / att - FILTER_DESIGN_EPS) : 1;
+    order_min = order_min < 1 ? 1 : order_min;
+    if(dev > 0.0f) {
+        limit = spec->ripple_db / dev + FILTER_DESIGN_EPS;
+        order_max = limit < (float)order_max ? (int)limit : order_max;
+    }
+    if(spec->max_delay_ms > 0.0f && delay_ms > 0.0f) {
+        limit = spec->max_delay_ms / delay_ms + FILTER_DESIGN_EPS;
+        order_max = limit < (float)order_max ? (int)limit : order_max;
+    }
+    if(order_min > order_max) {
+        return 0;
+    }
+    d->order = order_min;
+    d->cost = (float)order_min * g->fs;
+    d->ripple_db = (float)order_min * dev;
+    d->atten_db = (float)order_min * att;
+    d->delay_ms = (float)order_min * delay_ms;
+    return 1;
+}
+
+
+/**
+  * @brief  a Ƿ b (С, ˥, κѡС, ֤߳̽ȷ)
+  */
+static int filter_design_better(const FilterDesignDef *a, long long ia, const FilterDesignDef *b, long long ib) {
+    if(a->order == 0) {
+        return 0;
+    }
+    if(b->order == 0 || a->cost != b->cost) {
+        return b->order == 0 || a->cost < b->cost;
+    }
+    if(a->atten_db != b->atten_db) {
+        return a->atten_db > b->atten_db;
+    }
+    return ia < ib;
+}
+
+
+/**
+  * @brief  ƿռ
+  * @note   ѡΪ n_classes * n_fs * n_cut * n_q * max_order, ֹƵʲ fs/2 ĺѡ.
+  *         ʱ OpenMP  (, fs, ֹƵ, Q) ̲߳, ߳޹.
+  * @param  spec:       ָ
+  * @param  space:      ѡռ
+  * @param  best:       , ָС; ûҵʱ order Ϊ 0. evaluated Ϊĺѡ
+  * @retval 0: ҵ; -1: , ڴ治ûָ
+  */
+int filter_design_search(const FilterDesignSpecDef *spec, const FilterDesignSpaceDef *space, FilterDesignDef *best) {
+    const FilterKernelTable *k = filter_kernels();
+    const int n_cut = space->n_cut, n_q = space->n_q, n_fs = space->n_fs;
+    const long long n_cells = (long long)space->n_classes * n_fs * n_cut * n_q;
+    const int max_grid = (spec->n_pass + spec->n_stop) * space->n_grid;
+    FilterDesignGrid *grids;
+    float *mem;
+    long long evaluated = 0, best_idx = -1, cell;
+    int i;
+
+    memset(best, 0, sizeof(*best));
+    if(spec->n_pass < 1 || spec->n_pass > FILTER_DESIGN_MAX_BANDS || spec->n_stop < 0 ||
+       spec->n_stop > FILTER_DESIGN_MAX_BANDS || space->n_grid < 1 || max_grid > FILTER_DESIGN_MAX_GRID ||
+       space->n_classes < 1 || n_fs < 1 || n_cut < 1 || n_q < 1 || space->cut_min <= 0.0f ||
+       space->cut_max < space->cut_min || space->q_min <= 0.0f || space->q_max < space->q_min ||
+       space->max_order < 1 || space->max_order > FILTER_CHAIN_MAX_STAGES) {
+        return -1;
+    }
+    grids = (FilterDesignGrid *)malloc(sizeof(FilterDesignGrid) * n_fs);
+    mem = (float *)malloc(sizeof(float) * 2 * max_grid * n_fs);
+    if(grids == NULL || mem == NULL) {
+        free(grids);
+        free(mem);
+        return -1;
+    }
+    for(i = 0; i < n_fs; i++) {
+        grids[i].cw = mem + (size_t)2 * max_grid * i;
+        grids[i].sw = grids[i].cw + max_grid;
+        if(filter_design_grid(&grids[i], spec, space->fs[i], space->n_grid) != 0) {
+            grids[i].n = 0;
+        }
+    }
+
+#if defined(_OPENMP)
+    #pragma omp parallel
+#endif
+    {
+        float hr[FILTER_DESIGN_MAX_GRID], hi[FILTER_DESIGN_MAX_GRID], gd[FILTER_DESIGN_MAX_GRID];
+        FilterDesignDef local, d;
+        long long local_idx = -1, local_eval = 0, c;
+        int iq, icut, ifs, icl;
+        float cut, q;
+
+        memset(&local, 0, sizeof(local));
+#if defined(_OPENMP)
+        #pragma omp for schedule(dynamic, 256)
+#endif
+        for(cell = 0; cell < n_cells; cell++) {
+            c = cell;
+            iq = (int)(c % n_q);
+            c /= n_q;
+            icut = (int)(c % n_cut);
+            c /= n_cut;
+            ifs = (int)(c % n_fs);
+            icl = (int)(c / n_fs);
+            cut = n_cut > 1 ? space->cut_min * powf(space->cut_max / space->cut_min, (float)icut / (float)(n_cut - 1))
+                            : space->cut_min;
+            q = n_q > 1 ? space->q_min * powf(space->q_max / space->q_min, (float)iq / (float)(n_q - 1)) : space->q_min;
+            if(grids[ifs].n == 0 || cut >= 0.5f * grids[ifs].fs) {
+                continue;
+            }
+            local_eval += space->max_order;
+            filter_design_params(&d, space->classes[icl], grids[ifs].fs, cut, q);
+            d.order = 0;
+            if(filter_design_eval(k, spec, space->max_order, &grids[ifs], &d, hr, hi, gd) &&
+               filter_design_better(&d, cell, &local, local_idx)) {
+                local = d;
+                local_idx = cell;
+            }
+        }
+#if defined(_OPENMP)
+        #pragma omp critical
+#endif
+        {
+            evaluated += local_eval;
+            if(filter_design_better(&local, local_idx, best, best_idx)) {
+                *best = local;
+                best_idx = local_idx;
+            }
+        }
+    }
+
+    best->evaluated = evaluated;
+    free(grids);
+    free(mem);
+    return best->order > 0 ? 0 : -1;
+}
+
+
+/**
+  * @brief  ƽʼһ˲ (еһ)
+  * @param  filter:     ˲ṹַ
+  * @param  design:     ƽ
+  * @retval None
+  */
+void init_filter_design(FilterTypeDef *filter, const FilterDesignDef *design) {
+    init_filter_q(filter, design->class, design->fs, design->notch_cut, design->low_cut, design->high_cut, design->q);
+}
+
+
+/**
+  * @brief  ƽʼ˲ (design->order ͬĶ˲, ͨͬ)
+  * @param  chain:      ˲ṹַ
+  * @param  channels:   ͨ
+  * @param  design:     ƽ
+  * @retval 0: ɹ; -1: Чڴʧ
+  */
+int init_filter_chain_design(FilterChainTypeDef *chain, int channels, const FilterDesignDef *design) {
+    FilterChainStageDef stages[FILTER_CHAIN_MAX_STAGES];
+    FilterTypeDef f;
+    int s, ch;
+
+    if(design->order < 1 || design->order > FILTER_CHAIN_MAX_STAGES) {
+        return -1;
+    }
+    for(s = 0; s < design->order; s++) {
+        stages[s].class = design->class;
+        stages[s].notch_cut = design->notch_cut;
+        stages[s].low_cut = design->low_cut;
+        stages[s].high_cut = design->high_cut;
+    }
+    if(init_filter_chain(chain, channels, design->fs, stages, design->order) != 0) {
+        return -1;
+    }
+    // init_filter_chain uses the default q, overwrite with the designed one
+    init_filter_design(&f, design);
+    for(ch = 0; ch < channels; ch++) {
+        for(s = 0; s < design->order; s++) {
+            set_filter_chain_stage(chain, ch, s, &f);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file           : filter_design.h
+  * @brief          : ˲ƿռ.  (, Ƶ, ֹ/Ƶ, Q, ) ɵĺѡռ
+  *                   кѡ, ָ (ͨ, ˥, ͨȺӳ) У, ָ
+  *                   С ( * Ƶ) , ֹԴ Q ͽֹƵ.
+  * @attention      : ĸʹͬϵ, n ķ (dB) Ⱥӳǵ n , ÿ
+  *                   (, Ƶ, ֹƵ, Q) ֻһεӦ, ɵõָС.
+  *                   Ӧ SIMD freqz ں˼, ʱ OpenMP ̲߳.
+  *                   q  init_filter Ĺʽͬ (alpha = sin(w0) / (2 / q)), ݲʹ q ԽСԽխ.
+
+  ******************************************************************************
+  */
+
+
+// filter_design.h
+#ifndef FILTER_DESIGN_H
+#define FILTER_DESIGN_H
+
+#include "filter.h"
+#include "filter_chain.h"
+
+#define FILTER_DESIGN_MAX_BANDS     2       // ͨ / ԵƵ
+#define FILTER_DESIGN_MAX_GRID      1024    // ƵκϼƵ
+
+// Ƶνṹ
+typedef struct filter_band {
+    float lo;               // ±߽ (Hz)
+    float hi;               // ϱ߽ (Hz),  fs/2 ʱ fs/2 
+}FilterBandDef;
+
+// ָṹ
+typedef struct filter_design_spec {
+    FilterBandDef pass[FILTER_DESIGN_MAX_BANDS];    // ͨ
+    int n_pass;                                     // ͨ
+    FilterBandDef stop[FILTER_DESIGN_MAX_BANDS];    // 
+    int n_stop;                                     // 
+    float ripple_db;        // ͨ 0 dB +- ripple_db 
+    float atten_db;         // 벻 -atten_db
+    float max_delay_ms;     // ͨȺӳ (), <= 0 ʾ
+}FilterDesignSpecDef;
+
+// ѡռṹ
+typedef struct filter_design_space {
+    const FilterClassType *classes; // ѡ
+    int n_classes;                  // 
+    const float *fs;                // ѡƵ (Hz)
+    int n_fs;                       // Ƶ
+    float cut_min, cut_max;         // ֹƵ (NOTCH / BANDPASS / BANDSTOP ΪƵ) Χ (Hz), ȡֵ
+    int n_cut;                      // ֹƵȡֵ
+    float q_min, q_max;             // Q Χ, ȡֵ
+    int n_q;                        // Q ȡֵ
+    int max_order;                  //  (1 ~ FILTER_CHAIN_MAX_STAGES)
+    int n_grid;                     // ÿƵε ()
+}FilterDesignSpaceDef;
+
+// ƽṹ
+typedef struct filter_design {
+    FilterClassType class;  // 
+    float fs;               // Ƶ
+    float notch_cut;        // ݲƵ
+    float low_cut;          // ͨƵ (ͨʹʱΪ±߽)
+    float high_cut;         // ͨƵ (ͨʹʱΪϱ߽)
+    float q;                // Ʒ (init_filter_q  q)
+    int order;              // , 0 ʾûҵָ
+    float cost;             // : ÿÿͨĶ׽ڴ (order * fs)
+    float ripple_db;        // ʵͨƫ (dB)
+    float atten_db;         // ʵС˥ (dB)
+    float delay_ms;         // ʵͨȺӳ ()
+    long long evaluated;    // ĺѡ ()
+}FilterDesignDef;
+
+
+int filter_design_search(const FilterDesignSpecDef *spec, const FilterDesignSpaceDef *space, FilterDesignDef *best);
+void init_filter_design(FilterTypeDef *filter, const FilterDesignDef *design);
+int init_filter_chain_design(FilterChainTypeDef *chain, int channels, const FilterDesignDef *design);
+
+#endif
@@ -0,0 +1,219 @@
+/**
+  ******************************************************************************
+  * @file           : filter_design_tool.c
+  * @brief          : ˲й. ָںѡռС ( filter_design.h),
+                      ӡ init_filter_q ,  filter_freqz ڸƵϸ.
+  * @attention      :
+                      ÷: filter_design_tool key=value ...
+                        class=lowpass,highpass,notch,bandpass,bandstop  ѡ (Ĭ lowpass)
+                        fs=1000,2000        ѡƵ Hz (Ĭ 2000)
+                        pass=0:40           ͨ, ͨöŷָ,  pass=0:45,55:1000
+                        stop=100:1e9         (ѡ), ϱ߽糬 fs/2 ʱ fs/2 
+                        ripple=1            ͨ dB (Ĭ 1)
+                        atten=40            ˥ dB (Ĭ 40)
+                        delay=0             ͨȺӳ ms, 0 ʾ (Ĭ 0)
+                        cut=1:1000:2000     ֹ/ƵʷΧȡֵ (Ĭ 1:1000:2000)
+                        q=0.01:50:1000      Q Χȡֵ (Ĭ 0.01:50:1000), ʽͬ init_filter, ݲ q ԽСݲԽխ
+                        order=8              1 ~ FILTER_CHAIN_MAX_STAGES (Ĭ 8)
+                        grid=64             ÿƵε, С 2, ƵκϼƲ FILTER_DESIGN_MAX_GRID (Ĭ 64)
+                      : filter_design_tool class=notch,bandstop fs=2000 pass=0:45,55:1000 stop=49.9:50.1 atten=20 ripple=0.5 cut=45:55:2001
+
+  ******************************************************************************
+  */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "filter_design.h"
+#include "filter_freqz.h"
+
+#define TOOL_MAX_LIST   8
+
+static const char *const tool_class_names[] = { "", "notch", "lowpass", "highpass", "bandpass", "bandstop" };
+static const char *const tool_class_enums[] = { "", "NOTCH", "LOWPASS", "HIGHPASS", "BANDPASS", "BANDSTOP" };
+
+static double tool_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// "a:b,c:d" -> bands, returns count or -1
+static int tool_bands(const char *s, FilterBandDef *bands) {
+    int n = 0;
+
+    while(*s != '\0' && n < FILTER_DESIGN_MAX_BANDS) {
+        char *end;
+        bands[n].lo = strtof(s, &end);
+        if(*end != ':') {
+            return -1;
+        }
+        bands[n].hi = strtof(end + 1, &end);
+        n++;
+        s = *end == ',' ? end + 1 : end;
+    }
+    return *s == '\0' ? n : -1;
+}
+
+// "min:max:count"
+static int tool_range(const char *s, float *lo, float *hi, int *n) {
+    return sscanf(s, "%f:%f:%d", lo, hi, n) == 3 ? 0 : -1;
+}
+
+// whole-name match: "f=" or "fsx=" is not fs
+static int tool_key(const char *arg, size_t klen, const char *key) {
+    return klen == strlen(key) && strncmp(arg, key, klen) == 0;
+}
+
+// one number followed by stop or the end of the string; returns the position after it, NULL if not a number
+static const char *tool_float(const char *s, float *value, char stop) {
+    char *end;
+
+    *value = strtof(s, &end);
+    return end != s && (*end == '\0' || *end == stop) ? end : NULL;
+}
+
+// whole string is a base-10 integer in lo..hi; returns -1 otherwise
+static int tool_int(const char *s, int *value, long lo, long hi) {
+    char *end;
+    long v;
+
+    errno = 0;
+    v = strtol(s, &end, 10);
+    if(end == s || *end != '\0' || errno == ERANGE || v < lo || v > hi) {
+        return -1;
+    }
+    *value = (int)v;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+
+    FilterClassType classes[TOOL_MAX_LIST] = { LOWPASS };
+    float fs[TOOL_MAX_LIST] = { 2000.0f };
+    FilterDesignSpecDef spec;
+    FilterDesignSpaceDef space;
+    FilterDesignDef best;
+    FilterTypeDef stages[FILTER_CHAIN_MAX_STAGES];
+    float freqs[2], mag[2];
+    double t0, dt;
+    int i, b, s, bad = 0;
+
+    memset(&spec, 0, sizeof(spec));
+    spec.pass[0].lo = 0.0f;
+    spec.pass[0].hi = 40.0f;
+    spec.n_pass = 1;
+    spec.ripple_db = 1.0f;
+    spec.atten_db = 40.0f;
+    space.classes = classes;
+    space.n_classes = 1;
+    space.fs = fs;
+    space.n_fs = 1;
+    space.cut_min = 1.0f;
+    space.cut_max = 1000.0f;
+    space.n_cut = 2000;
+    space.q_min = 0.01f;
+    space.q_max = 50.0f;
+    space.n_q = 1000;
+    space.max_order = 8;
+    space.n_grid = 64;
+
+    for(i = 1; i < argc; i++) {
+        const char *v = strchr(argv[i], '=');
+        const size_t klen = v != NULL ? (size_t)(v - argv[i]) : 0;
+        if(v++ == NULL) {
+            bad = 1;
+        }
+        else if(tool_key(argv[i], klen, "class")) {
+            char buf[256], *tok;
+            strncpy(buf, v, sizeof(buf) - 1);
+            buf[sizeof(buf) - 1] = '\0';
+            space.n_classes = 0;
+            for(tok = strtok(buf, ","); tok != NULL && space.n_classes < TOOL_MAX_LIST; tok = strtok(NULL, ",")) {
+                for(b = NOTCH; b <= BANDSTOP && strcmp(tok, tool_class_names[b]) != 0; b++) {
+                }
+                bad |= b > BANDSTOP;
+                classes[space.n_classes++] = (FilterClassType)b;
+            }
+        }
+        else if(tool_key(argv[i], klen, "fs")) {
+            // stop at the first element that is not a number, or when the list is full
+            const char *end = v;
+            for(space.n_fs = 0; space.n_fs < TOOL_MAX_LIST; end++) {
+                end = tool_float(end, &fs[space.n_fs++], ',');
+                if(end == NULL || *end == '\0') {
+                    break;
+                }
+            }
+            bad |= end == NULL || *end != '\0';
+        }
+        else if(tool_key(argv[i], klen, "pass")) {
+            bad |= (spec.n_pass = tool_bands(v, spec.pass)) < 0;
+        }
+        else if(tool_key(argv[i], klen, "stop")) {
+            bad |= (spec.n_stop = tool_bands(v, spec.stop)) < 0;
+        }
+        else if(tool_key(argv[i], klen, "ripple")) {
+            bad |= tool_float(v, &spec.ripple_db, '\0') == NULL;
+        }
+        else if(tool_key(argv[i], klen, "atten")) {
+            bad |= tool_float(v, &spec.atten_db, '\0') == NULL;
+        }
+        else if(tool_key(argv[i], klen, "delay")) {
+            bad |= tool_float(v, &spec.max_delay_ms, '\0') == NULL;
+        }
+        else if(tool_key(argv[i], klen, "cut")) {
+            bad |= tool_range(v, &space.cut_min, &space.cut_max, &space.n_cut);
+        }
+        else if(tool_key(argv[i], klen, "q")) {
+            bad |= tool_range(v, &space.q_min, &space.q_max, &space.n_q);
+        }
+        else if(tool_key(argv[i], klen, "order")) {
+            bad |= tool_int(v, &space.max_order, 1, FILTER_CHAIN_MAX_STAGES);
+        }
+        else if(tool_key(argv[i], klen, "grid")) {
+            bad |= tool_int(v, &space.n_grid, 2, FILTER_DESIGN_MAX_GRID);
+        }
+        else {
+            bad = 1;
+        }
+    }
+    // every band gets n_grid points, the search rejects grids larger than FILTER_DESIGN_MAX_GRID
+    bad |= (spec.n_pass + spec.n_stop) * space.n_grid > FILTER_DESIGN_MAX_GRID;
+    if(bad) {
+        fprintf(stderr, "usage: %s [class=..] [fs=..] [pass=lo:hi[,lo:hi]] [stop=lo:hi[,lo:hi]] [ripple=dB] [atten=dB]"
+                        " [delay=ms] [cut=min:max:n] [q=min:max:n] [order=n] [grid=n]\n", argv[0]);
+        return 1;
+    }
+
+    t0 = tool_seconds();
+    if(filter_design_search(&spec, &space, &best) != 0) {
+        dt = tool_seconds() - t0;
+        printf("no design meets the spec (%lld candidates, %.2f s)\n", best.evaluated, dt);
+        return 2;
+    }
+    dt = tool_seconds() - t0;
+    printf("candidates   %lld in %.2f s (%.1f M/s)\n", best.evaluated, dt, best.evaluated / dt * 1e-6);
+    printf("design       %s, fs %g Hz, %d stage(s), cost %g biquads/s per channel\n",
+           tool_class_names[best.class], best.fs, best.order, best.cost);
+    printf("init         init_filter_q(&f, %s, %gf, %gf, %gf, %gf, %gf)\n", tool_class_enums[best.class],
+           best.fs, best.notch_cut, best.low_cut, best.high_cut, best.q);
+    printf("measured     ripple %.3f dB, attenuation %.2f dB, group delay %.3f ms\n",
+           best.ripple_db, best.atten_db, best.delay_ms);
+
+    // cross-check band edges with the production frequency response
+    for(s = 0; s < best.order; s++) {
+        init_filter_design(&stages[s], &best);
+    }
+    for(b = 0; b < spec.n_pass + spec.n_stop; b++) {
+        const FilterBandDef *band = b < spec.n_pass ? &spec.pass[b] : &spec.stop[b - spec.n_pass];
+        freqs[0] = band->lo;
+        freqs[1] = band->hi < 0.5f * best.fs ? band->hi : 0.5f * best.fs;
+        filter_freqz(stages, best.order, freqs, 2, mag, NULL, NULL);
+        printf("%s %7g Hz %8.2f dB, %7g Hz %8.2f dB\n", b < spec.n_pass ? "pass edge " : "stop edge ",
+               freqs[0], mag[0], freqs[1], mag[1]);
+    }
+    return 0;
+}
@@ -0,0 +1,381 @@
+/**
+  ******************************************************************************
+  * @file           : filter_dispatch.c
+  * @brief          : ˲ںʱַ. ͨ CPUID  SSE4.1 / AVX2 + FMA / AVX-512F,
+                      ѡǰ CPU ֵ֧ں. ͬһִļڲͬͺŵķ
+                      ں.
+  * @attention      : ֻ x86 ƽ̨ʹ GCC/Clang ʱŻ SIMD ں (FILTER_HAVE_X86_KERNELS),
+                      ƽ̨ ( STM32) ֻбں.
+
+  ******************************************************************************
+  */
+
+#include <stdlib.h>
+#include <string.h>
+#include "filter_dispatch.h"
+
+extern const FilterKernelTable filter_kernels_scalar;
+#if defined(FILTER_HAVE_X86_KERNELS)
+extern const FilterKernelTable filter_kernels_sse4;
+extern const FilterKernelTable filter_kernels_avx2;
+extern const FilterKernelTable filter_kernels_avx512;
+#endif
+
+#define FILTER_TILE_LEN         64      // ֿתʱÿĲ
+#define FILTER_TILE_CH          16      // ֿתʱÿͨ (С)
+#define FILTER_HALF_TILE_LEN    32      // 16 λ֯֡ÿ֡
+#define FILTER_HALF_TILE_CH     128     // 16 λ֯֡ÿͨ (ÿ֡һת 128 )
+
+// ֿ黺ĸ, ʹ֯· (же) ջ֡ûзֿ黺
+#if defined(_MSC_VER)
+#define FILTER_NOINLINE         __declspec(noinline)
+#elif defined(__GNUC__)
+#define FILTER_NOINLINE         __attribute__((noinline))
+#else
+#define FILTER_NOINLINE
+#endif
+
+static const FilterKernelTable *filter_kernels_current = NULL;
+
+static const char *const filter_isa_names[FILTER_ISA_COUNT] = { "scalar", "sse4", "avx2", "avx512" };
+
+
+/**
+  * @brief  ȡָ
+  * @param  isa:        ָ
+  * @retval ָַ
+  */
+const char *filter_isa_name(FilterIsaType isa) {
+    if(isa < 0 || isa >= FILTER_ISA_COUNT) {
+        return "unknown";
+    }
+    return filter_isa_names[isa];
+}
+
+
+/**
+  * @brief  ⵱ǰ CPU (Լϵͳ) Ƿָָ֧ں
+  * @param  isa:        ָ
+  * @retval 1: ֧; 0: ֻ֧ûбð汾ں
+  */
+int filter_cpu_supports(FilterIsaType isa) {
+    switch(isa) {
+        case FILTER_ISA_SCALAR: return 1;
+#if defined(FILTER_HAVE_X86_KERNELS)
+        // __builtin_cpu_supports also checks that the OS saves the wide registers (XGETBV)
+        case FILTER_ISA_SSE4:   __builtin_cpu_init(); return __builtin_cpu_supports("sse4.1") != 0;
+        case FILTER_ISA_AVX2:   __builtin_cpu_init(); return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+                                                         && __builtin_cpu_supports("f16c");
+        case FILTER_ISA_AVX512: __builtin_cpu_init(); return __builtin_cpu_supports("avx512f") != 0;
+#endif
+        default: return 0;
+    }
+}
+
+
+/**
+  * @brief  ȡָָں˺
+  * @param  isa:        ָ
+  * @retval ں˺; ǰ CPU ֧ʱ NULL
+  */
+const FilterKernelTable *filter_kernels_for(FilterIsaType isa) {
+    if(!filter_cpu_supports(isa)) {
+        return NULL;
+    }
+    switch(isa) {
+        case FILTER_ISA_SCALAR: return &filter_kernels_scalar;
+#if defined(FILTER_HAVE_X86_KERNELS)
+        case FILTER_ISA_SSE4:   return &filter_kernels_sse4;
+        case FILTER_ISA_AVX2:   return &filter_kernels_avx2;
+        case FILTER_ISA_AVX512: return &filter_kernels_avx512;
+#endif
+        default: return NULL;
+    }
+}
+
+
+/**
+  * @brief  ǿѡָָں (ܶԱ)
+  * @param  isa:        ָ
+  * @retval 0: ɹ; -1: ǰ CPU ֧
+  */
+int filter_select_isa(FilterIsaType isa) {
+    const FilterKernelTable *k = filter_kernels_for(isa);
+    if(k == NULL) {
+        return -1;
+    }
+    filter_kernels_current = k;
+    return 0;
+}
+
+
+/**
+  * @brief  ȡǰʹõں˺
+  * @note   ״εʱѡĿں,  FILTER_ISA ָ汾.
+  *         ߳ͬʱ״εʱõͬĽ, Ҫ.
+  * @retval ں˺
+  */
+const FilterKernelTable *filter_kernels(void) {
+    const FilterKernelTable *k = filter_kernels_current;
+    const char *env;
+    int isa;
+
+    if(k != NULL) {
+        return k;
+    }
+    env = getenv("FILTER_ISA");
+    if(env != NULL) {
+        for(isa = 0; isa < FILTER_ISA_COUNT; isa++) {
+            if(strcmp(env, filter_isa_names[isa]) == 0) {
+                k = filter_kernels_for((FilterIsaType)isa);
+            }
+        }
+    }
+    for(isa = FILTER_ISA_COUNT - 1; k == NULL && isa >= 0; isa--) {
+        k = filter_kernels_for((FilterIsaType)isa);
+    }
+    filter_kernels_current = k;
+    return k;
+}
+
+
+/**
+  * @brief  ͨ (planar) жͨں
+  * @note   ͨںҪͬһʱ̵Ķͨ, ˰ FILTER_TILE_CH ͨ x FILTER_TILE_LEN 
+  *         ֿתõջϵС (פ L1 cache) , תд. ں (width == 1)
+  *         ֱͨ. input  output ָͬһڴ.
+  *         ں˲ʱ (絥) output Ϊ NULL.
+  * @param  fn:             ͨں
+  * @param  width:          ں
+  * @param  obj:            ں˴Ķ (˲˲)
+  * @param  channels:       ͨ
+  * @param  input:          ,  ch ͨ n ʱ̵ĲΪ input[ch * in_ch_stride + n]
+  * @param  in_ch_stride:   ͨļ (float )
+  * @param  output:         , ͬ
+  * @param  out_ch_stride:  ͨļ (float )
+  * @param  len:            ÿͨĲ
+  * @retval None
+  */
+void filter_run_planar(FilterLaneKernel fn, int width, void *obj, int channels,
+                       const float *input, int in_ch_stride, float *output, int out_ch_stride, int len) {
+
+    float tile[FILTER_TILE_LEN * FILTER_TILE_CH];
+    int ch0, n0, lanes, tl, l, t;
+
+    if(len <= 0) {
+        return;
+    }
+    if(width == 1) {
+        for(ch0 = 0; ch0 < channels; ch0++) {
+            fn(obj, ch0, 1, input + (size_t)ch0 * in_ch_stride, 1,
+               output != NULL ? output + (size_t)ch0 * out_ch_stride : NULL, 1, len);
+        }
+        return;
+    }
+    for(ch0 = 0; ch0 < channels; ch0 += FILTER_TILE_CH) {
+        lanes = channels - ch0;
+        if(lanes > FILTER_TILE_CH) {
+            lanes = FILTER_TILE_CH;
+        }
+        for(n0 = 0; n0 < len; n0 += FILTER_TILE_LEN) {
+            tl = len - n0;
+            if(tl > FILTER_TILE_LEN) {
+                tl = FILTER_TILE_LEN;
+            }
+            // planar -> interleaved
+            for(l = 0; l < lanes; l++) {
+                const float *src = input + (size_t)(ch0 + l) * in_ch_stride + n0;
+                for(t = 0; t < tl; t++) {
+                    tile[t * FILTER_TILE_CH + l] = src[t];
+                }
+            }
+            fn(obj, ch0, lanes, tile, FILTER_TILE_CH, tile, FILTER_TILE_CH, tl);
+            // interleaved -> planar
+            for(l = 0; output != NULL && l < lanes; l++) {
+                float *dst = output + (size_t)(ch0 + l) * out_ch_stride + n0;
+                for(t = 0; t < tl; t++) {
+                    dst[t] = tile[t * FILTER_TILE_CH + l];
+                }
+            }
+        }
+    }
+}
+
+
+/**
+  * @brief  ֯֡, ͨ: һ FILTER_TILE_LEN ֡, ÿ FILTER_TILE_CH ͨд tile תд
+  */
+static FILTER_NOINLINE void filter_frames_planar_tile(FilterLaneKernel fn, void *obj, int channels,
+                                                      const float *frames, int frame_stride, float *output, int out_stride, int n0, int tl) {
+
+    float tile[FILTER_TILE_LEN * FILTER_TILE_CH];
+    int ch0, lanes, l, t;
+
+    for(ch0 = 0; ch0 < channels; ch0 += FILTER_TILE_CH) {
+        lanes = channels - ch0;
+        if(lanes > FILTER_TILE_CH) {
+            lanes = FILTER_TILE_CH;
+        }
+        fn(obj, ch0, lanes, frames + (size_t)n0 * frame_stride + ch0, frame_stride, tile, FILTER_TILE_CH, tl);
+        // interleaved -> planar
+        for(l = 0; l < lanes; l++) {
+            float *dst = output + (size_t)(ch0 + l) * out_stride + n0;
+            for(t = 0; t < tl; t++) {
+                dst[t] = tile[t * FILTER_TILE_CH + l];
+            }
+        }
+    }
+}
+
+
+/**
+  * @brief  ֡֯ (interleaved) жͨں
+  * @note   ںֱ frame_stride Ϊ֡жȡͬһʱ̵ͨ, ҪȲֳɰͨŵ.
+  *          FILTER_TILE_LEN ֿ֡鴦, ʹͨ鹲õ֡ cache .
+  *         Ϊ֯ʱںֱд, ʹջϵĻ (filter_dma жһ);
+  *         Ϊͨʱ, ںдջϵС (4 KB) תд.
+  *         ں˲ʱ (絥) output Ϊ NULL.
+  * @param  fn:             ͨں
+  * @param  obj:            ں˴Ķ (˲˲)
+  * @param  channels:       ͨ
+  * @param  frames:         ֡,  ch ͨ n ʱ̵ĲΪ frames[n * frame_stride + ch]
+  * @param  frame_stride:   ֡ļ (float , С channels)
+  * @param  output:         
+  * @param  out_layout:     
+  * @param  out_stride:     ֯ʱΪ֡ļ, ͨʱΪͨļ (float )
+  * @param  len:            ֡ (ÿͨĲ)
+  * @retval None
+  */
+void filter_run_frames(FilterLaneKernel fn, void *obj, int channels,
+                       const float *frames, int frame_stride, float *output, FilterLayoutType out_layout, int out_stride, int len) {
+
+    int n0, tl;
+
+    for(n0 = 0; n0 < len; n0 += FILTER_TILE_LEN) {
+        tl = len - n0;
+        if(tl > FILTER_TILE_LEN) {
+            tl = FILTER_TILE_LEN;
+        }
+        if(out_layout == FILTER_LAYOUT_INTERLEAVED || output == NULL) {
+            fn(obj, 0, channels, frames + (size_t)n0 * frame_stride, frame_stride,
+               output != NULL ? output + (size_t)n0 * out_stride : NULL, out_stride, tl);
+            continue;
+        }
+        filter_frames_planar_tile(fn, obj, channels, frames, frame_stride, output, out_stride, n0, tl);
+    }
+}
+
+
+/**
+  * @brief  16 λ, ֵͨ: һ FILTER_TILE_CH ͨ x FILTER_TILE_LEN , ͨתתõ tile
+  */
+static void filter_half_planar_tile(FilterLaneKernel fn, const FilterKernelTable *k, void *obj, int ch0, int lanes, FilterSampleType fmt,
+                                    const uint16_t *input, int in_stride,
+                                    uint16_t *output, FilterLayoutType out_layout, int out_stride, int n0, int tl) {
+
+    float tile[FILTER_TILE_LEN * FILTER_TILE_CH];
+    float row[FILTER_TILE_LEN];
+    int l, t;
+
+    for(l = 0; l < lanes; l++) {
+        k->half_load(fmt, input + (size_t)(ch0 + l) * in_stride + n0, row, tl);
+        for(t = 0; t < tl; t++) {
+            tile[t * FILTER_TILE_CH + l] = row[t];
+        }
+    }
+    fn(obj, ch0, lanes, tile, FILTER_TILE_CH, tile, FILTER_TILE_CH, tl);
+    if(output == NULL) {
+        return;
+    }
+    if(out_layout == FILTER_LAYOUT_INTERLEAVED) {
+        for(t = 0; t < tl; t++) {
+            k->half_store(fmt, tile + t * FILTER_TILE_CH, output + (size_t)(n0 + t) * out_stride + ch0, lanes);
+        }
+        return;
+    }
+    for(l = 0; l < lanes; l++) {
+        for(t = 0; t < tl; t++) {
+            row[t] = tile[t * FILTER_TILE_CH + l];
+        }
+        k->half_store(fmt, row, output + (size_t)(ch0 + l) * out_stride + n0, tl);
+    }
+}
+
+
+/**
+  * @brief  16 λ, ֯֡: һ FILTER_HALF_TILE_LEN ֡ x FILTER_HALF_TILE_CH ͨ, ÿ֡ת, Ҫת
+  */
+static void filter_half_frames_tile(FilterLaneKernel fn, const FilterKernelTable *k, void *obj, int ch0, int lanes, FilterSampleType fmt,
+                                    const uint16_t *input, int in_stride,
+                                    uint16_t *output, FilterLayoutType out_layout, int out_stride, int n0, int tl) {
+
+    float tile[FILTER_HALF_TILE_LEN * FILTER_HALF_TILE_CH];
+    float row[FILTER_HALF_TILE_LEN];
+    int l, t;
+
+    for(t = 0; t < tl; t++) {
+        k->half_load(fmt, input + (size_t)(n0 + t) * in_stride + ch0, tile + t * FILTER_HALF_TILE_CH, lanes);
+    }
+    fn(obj, ch0, lanes, tile, FILTER_HALF_TILE_CH, tile, FILTER_HALF_TILE_CH, tl);
+    if(output == NULL) {
+        return;
+    }
+    if(out_layout == FILTER_LAYOUT_INTERLEAVED) {
+        for(t = 0; t < tl; t++) {
+            k->half_store(fmt, tile + t * FILTER_HALF_TILE_CH, output + (size_t)(n0 + t) * out_stride + ch0, lanes);
+        }
+        return;
+    }
+    for(l = 0; l < lanes; l++) {
+        for(t = 0; t < tl; t++) {
+            row[t] = tile[t * FILTER_HALF_TILE_CH + l];
+        }
+        k->half_store(fmt, row, output + (size_t)(ch0 + l) * out_stride + n0, tl);
+    }
+}
+
+
+/**
+  * @brief  16 λ (fp16 / bf16) жͨں
+  * @note   ֿʱתΪ float 浽ջϵС (פ L1 cache),
+  *         ںڻ fp32  (״̬ۼӶ fp32), дʱת 16 λ.
+  *         ڴеֻ float һС. ֵͨ밴ͨ (ͬ filter_run_planar),
+  *         ֯֡밴ʱ, ÿ֡һת FILTER_HALF_TILE_CH ͨ, Ҫת.
+  * @param  fn:             ͨں
+  * @param  k:              ṩʽתں˺
+  * @param  obj:            ں˴Ķ
+  * @param  channels:       ͨ
+  * @param  fmt:            ʽ FILTER_SAMPLE_F16 / FILTER_SAMPLE_BF16
+  * @param  input:          
+  * @param  in_layout:      벼
+  * @param  in_stride:      ͨʱΪͨļ, ֯ʱΪ֡ļ ()
+  * @param  output:         , Ϊ NULL
+  * @param  out_layout:     
+  * @param  out_stride:     ͬ in_stride
+  * @param  len:            ÿͨĲ
+  * @retval None
+  */
+void filter_run_half(FilterLaneKernel fn, const FilterKernelTable *k, void *obj, int channels, FilterSampleType fmt,
+                     const uint16_t *input, FilterLayoutType in_layout, int in_stride,
+                     uint16_t *output, FilterLayoutType out_layout, int out_stride, int len) {
+
+    int ch0, n0, lanes, tl;
+
+    if(in_layout == FILTER_LAYOUT_INTERLEAVED) {
+        for(n0 = 0; n0 < len; n0 += FILTER_HALF_TILE_LEN) {
+            tl = len - n0 > FILTER_HALF_TILE_LEN ? FILTER_HALF_TILE_LEN : len - n0;
+            for(ch0 = 0; ch0 < channels; ch0 += FILTER_HALF_TILE_CH) {
+                lanes = channels - ch0 > FILTER_HALF_TILE_CH ? FILTER_HALF_TILE_CH : channels - ch0;
+                filter_half_frames_tile(fn, k, obj, ch0, lanes, fmt, input, in_stride, output, out_layout, out_stride, n0, tl);
+            }
+        }
+        return;
+    }
+    for(ch0 = 0; ch0 < channels; ch0 += FILTER_TILE_CH) {
+        lanes = channels - ch0 > FILTER_TILE_CH ? FILTER_TILE_CH : channels - ch0;
+        for(n0 = 0; n0 < len; n0 += FILTER_TILE_LEN) {
+            tl = len - n0 > FILTER_TILE_LEN ? FILTER_TILE_LEN : len - n0;
+            filter_half_planar_tile(fn, k, obj, ch0, lanes, fmt, input, in_stride, output, out_layout, out_stride, n0, tl);
+        }
+    }
+}
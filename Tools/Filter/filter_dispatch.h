@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file           : filter_dispatch.h
+  * @brief          : ˲ںʱַ. ͬһͬʱ, SSE4, AVX2, AVX-512
+  *                   汾ں, ״ʹʱͨ CPUID ѡǰ CPU ֵ֧汾.
+  * @attention      :  FILTER_ISA=scalar|sse4|avx2|avx512 ǿָ (֧ʱ).
+
+  ******************************************************************************
+  */
+
+
+// filter_dispatch.h
+#ifndef FILTER_DISPATCH_H
+#define FILTER_DISPATCH_H
+
+#include <stdint.h>
+#include "filter_bank.h"
+
+struct filter_spectrum;
+
+// ָöٱ, ֵԽԽ
+typedef enum {
+    FILTER_ISA_SCALAR = 0,  //  C ʵ, ƽ̨
+    FILTER_ISA_SSE4,        // SSE4.1, 4 ͨ/
+    FILTER_ISA_AVX2,        // AVX2 + FMA, 8 ͨ/
+    FILTER_ISA_AVX512,      // AVX-512F, 16 ͨ/
+    FILTER_ISA_COUNT
+} FilterIsaType;
+
+// ͨں:  obj ͨ [ch0, ch0 + lanes),  l ͨ n ʱ̵Ĳλ in[n * in_stride + l]
+typedef void (*FilterLaneKernel)(void *obj, int ch0, int lanes,
+                                 const float *in, int in_stride, float *out, int out_stride, int len);
+
+// ں˺
+typedef struct filter_kernels {
+    FilterIsaType isa;      // ָ
+    const char *name;       // ָ
+    int width;              //  (ÿͨ)
+    FilterLaneKernel bank;  // ˲ں, obj Ϊ FilterBankTypeDef
+    FilterLaneKernel chain; // ں˲ں, obj Ϊ FilterChainTypeDef
+    // ƵӦں:  n Ƶ (cw/sw ΪһƵʵ/) 㼶˲ĸӦȺӳ
+    void (*freqz)(const float *coef, int stages, const float *cw, const float *sw, int n,
+                  float *hr, float *hi, float *gd);
+    FilterLaneKernel goertzel;  // Goertzel ں, obj Ϊ ToneMonitorTypeDef, û
+    // 16 λʽ (FILTER_SAMPLE_F16 / FILTER_SAMPLE_BF16)  float ֮ת, n 
+    void (*half_load)(FilterSampleType fmt, const uint16_t *src, float *dst, int n);
+    void (*half_store)(FilterSampleType fmt, const float *src, uint16_t *dst, int n);
+    // Welch / STFT ֶں: λдӵ start ֡ʼ nfft ֡Ӵ, FFT, ۼӹ
+    void (*spectrum)(struct filter_spectrum *spec, int start);
+}FilterKernelTable;
+
+
+const FilterKernelTable *filter_kernels(void);
+const FilterKernelTable *filter_kernels_for(FilterIsaType isa);
+int filter_cpu_supports(FilterIsaType isa);
+int filter_select_isa(FilterIsaType isa);
+const char *filter_isa_name(FilterIsaType isa);
+void filter_run_planar(FilterLaneKernel fn, int width, void *obj, int channels,
+                       const float *input, int in_ch_stride, float *output, int out_ch_stride, int len);
+void filter_run_frames(FilterLaneKernel fn, void *obj, int channels,
+                       const float *frames, int frame_stride, float *output, FilterLayoutType out_layout, int out_stride, int len);
+void filter_run_half(FilterLaneKernel fn, const FilterKernelTable *k, void *obj, int channels, FilterSampleType fmt,
+                     const uint16_t *input, FilterLayoutType in_layout, int in_stride,
+                     uint16_t *output, FilterLayoutType out_layout, int out_stride, int len);
+void apply_filter_bank_with(FilterBankTypeDef *bank, const FilterKernelTable *k,
+                            const float *input, int in_ch_stride, float *output, int out_ch_stride, int len);
+
+#endif
@@ -0,0 +1,253 @@
+/**
+  ******************************************************************************
+  * @file           : filter_dma.c
+  * @brief          : DMA ƹһ鴦ļ.  filter_old.c ÿϵһ˲:
+                      ÿ DMA ж֮ (frames ֡) һο˲.
+  * @attention      :
+                      ʹʾ (STM32 HAL, ο):
+
+                        #define CH      4       // ADC ɨͨ
+                        #define FRAMES  64      // ֡
+
+                        uint16_t adc_buf[2 * FRAMES * CH];      // ADC ѭ DMA 
+                        float tx_buf[2 * FRAMES * CH];          // ڷƹһ
+                        FilterChainTypeDef chain;
+                        FilterDmaTypeDef dma;
+
+                        int uart_tx(void *ctx, const void *data, int bytes) {
+                            return HAL_UART_Transmit_DMA(&huart1, (uint8_t *)data, bytes) == HAL_OK ? 0 : -1;
+                        }
+                        void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc) { filter_dma_half_cplt(&dma); }
+                        void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc) { filter_dma_cplt(&dma); }
+                        void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) { filter_dma_tx_done(&dma); }
+
+                        int main(void) {
+
+                            init_filter_chain(&chain, CH, 500.0f, front_end, 3);
+                            init_filter_dma(&dma, &chain, FILTER_DMA_U16, adc_buf, tx_buf, FRAMES);
+                            dma.offset = 2048.0f;   // 12 λ ADC е
+                            dma.transmit = uart_tx;
+                            HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adc_buf, 2 * FRAMES * CH);
+
+                            while(1) {
+
+                                filter_dma_poll(&dma); // дİ뻺 (Ҳֱже filter_dma_process_half)
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <stddef.h>
+#include <string.h>
+#include "filter_dma.h"
+
+// ԭӱȽϽ: *p  expected ʱΪ desired ط 0. Ĭʹñڽ;
+// Cortex-M0 û LDREX/STREX ں˿жΪжϺȽϸֵ
+#ifndef FILTER_DMA_CAS
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FILTER_DMA_CAS(p, expected, desired)    (_InterlockedCompareExchange((volatile long *)(p), (desired), (expected)) == (expected))
+#else
+static int filter_dma_cas(volatile int *p, int expected, int desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#define FILTER_DMA_CAS(p, expected, desired)    filter_dma_cas(p, expected, desired)
+#endif
+#endif
+
+
+/**
+  * @brief  DMA ƹҿ鴦ʼ
+  * @param  dma:        DMA 鴦ṹַ
+  * @param  chain:      ѳʼ˲
+  * @param  fmt:        ADC ʽ
+  * @param  rx:         ADC ѭ DMA  (2 * frames * channels , ͨ֯)
+  * @param  tx:         ƹһ (2 * frames * channels  float)
+  * @param  frames:     ֡
+  * @retval 0: ɹ; -1:  (ͨ FILTER_DMA_SCRATCH)
+  */
+int init_filter_dma(FilterDmaTypeDef *dma, FilterChainTypeDef *chain, FilterDmaSampleType fmt,
+                    const void *rx, float *tx, int frames) {
+    memset(dma, 0, sizeof(*dma));
+    if(chain == NULL || rx == NULL || tx == NULL || frames <= 0 || chain->channels > FILTER_DMA_SCRATCH) {
+        return -1;
+    }
+    dma->chain = chain;
+    dma->fmt = fmt;
+    dma->frames = frames;
+    dma->offset = 0.0f;
+    dma->scale = 1.0f;
+    dma->rx = rx;
+    dma->tx = tx;
+    dma->sending = -1;
+    dma->active = -1;
+    return 0;
+}
+
+
+/**
+  * @brief  ǰ뻺д (же)
+  */
+static void filter_dma_mark(FilterDmaTypeDef *dma, int half) {
+    // һεݻû, ڴʱ
+    if(dma->ready[half] || dma->active == half) {
+        dma->rx_overruns++;
+    }
+    dma->ready[half] = 1;
+}
+
+
+/**
+  * @brief  ADC DMA 봫ɻص (ǰ뻺д),  HAL_ADC_ConvHalfCpltCallback е
+  * @param  dma:        DMA 鴦ṹַ
+  * @retval None
+  */
+void filter_dma_half_cplt(FilterDmaTypeDef *dma) {
+    filter_dma_mark(dma, 0);
+}
+
+
+/**
+  * @brief  ADC DMA ɻص (뻺д),  HAL_ADC_ConvCpltCallback е
+  * @param  dma:        DMA 鴦ṹַ
+  * @retval None
+  */
+void filter_dma_cplt(FilterDmaTypeDef *dma) {
+    filter_dma_mark(dma, 1);
+}
+
+
+/**
+  * @brief  ڷɻص,  HAL_UART_TxCpltCallback е
+  * @param  dma:        DMA 鴦ṹַ
+  * @retval None
+  */
+void filter_dma_tx_done(FilterDmaTypeDef *dma) {
+    const int half = dma->sending;
+
+    // ͷŰͷŴ, 쵽ʱһһѾд
+    if(half >= 0) {
+        dma->tx_busy[half] = 0;
+        dma->sending = -1;
+    }
+}
+
+
+/**
+  * @brief  ADC Ϊ float: dst[i] = (rx[first + i] - offset) * scale
+  */
+static void filter_dma_convert(const FilterDmaTypeDef *dma, size_t first, float *dst, size_t count) {
+    const float offset = dma->offset, scale = dma->scale;
+    size_t i;
+
+    switch(dma->fmt) {
+        case FILTER_DMA_U16: {
+            const uint16_t *x = (const uint16_t *)dma->rx + first;
+            for(i = 0; i < count; i++) {
+                dst[i] = ((float)x[i] - offset) * scale;
+            }
+            break;
+        }
+        case FILTER_DMA_I16: {
+            const int16_t *x = (const int16_t *)dma->rx + first;
+            for(i = 0; i < count; i++) {
+                dst[i] = ((float)x[i] - offset) * scale;
+            }
+            break;
+        }
+        case FILTER_DMA_I32: {
+            const int32_t *x = (const int32_t *)dma->rx + first;
+            for(i = 0; i < count; i++) {
+                dst[i] = ((float)x[i] - offset) * scale;
+            }
+            break;
+        }
+        default: {
+            const float *x = (const float *)dma->rx + first;
+            for(i = 0; i < count; i++) {
+                dst[i] = (x[i] - offset) * scale;
+            }
+            break;
+        }
+    }
+}
+
+
+/**
+  * @brief  : ADC Ϊ float д뷢ͻĶӦһ, ԭؿ˲, ͹
+  * @note    DMA жֱӵ (ʱҪ filter_dma_poll). ڷһʱ (ڴ)
+  *         Ȼ˲Ա˲״̬, һ벻,  tx_overruns; ڷ͵ǡһ,
+  *          dma->scratch зֶ˲, Ķ DMA ڶȡ.
+  *         ݴڽṹ, ֯˲·Ҳʹջϵķֿ黺, жջֻɴӱ
+  *         ˲ں˵ĵ, ͨ֡޹:  GCC -O3 -fstack-usage ͳƱں
+  *         Լ 1.4 KB (󲿷ںаչϵӳ), жѹջ.
+  * @param  dma:        DMA 鴦ṹַ
+  * @param  half:       0: ǰ; 1: 
+  * @retval None
+  */
+void filter_dma_process_half(FilterDmaTypeDef *dma, int half) {
+    const int C = dma->chain->channels;
+    const size_t n = (size_t)dma->frames * C;
+    const size_t base = (size_t)half * n;
+    float *y = dma->tx + base;
+    float *scratch = dma->scratch;
+    int busy = dma->tx_busy[half];
+    int f, k, step;
+
+    if(busy) {
+        // һԹ鴮: ˲дݴ, ֻΪƽ˲״̬
+        step = FILTER_DMA_SCRATCH / C;
+        for(f = 0; f < dma->frames; f += step) {
+            k = dma->frames - f < step ? dma->frames - f : step;
+            filter_dma_convert(dma, base + (size_t)f * C, scratch, (size_t)k * C);
+            apply_filter_chain_frames(dma->chain, scratch, C, scratch, FILTER_LAYOUT_INTERLEAVED, C, k);
+        }
+    }
+    else {
+        filter_dma_convert(dma, base, y, n);
+        // ԭ˲: ֡ͬһ齻֯
+        apply_filter_chain_frames(dma->chain, y, C, y, FILTER_LAYOUT_INTERLEAVED, C, dma->frames);
+    }
+    dma->halves++;
+    if(dma->transmit == NULL) {
+        return;
+    }
+    // 촮: вΪбһԭӲ, жϿ֮ͷŴ
+    if(busy || !FILTER_DMA_CAS(&dma->sending, -1, half)) {
+        // ڻûһ, һ벻
+        dma->tx_overruns++;
+        return;
+    }
+    dma->tx_busy[half] = 1;
+    if(dma->transmit(dma->ctx, y, (int)(n * sizeof(float))) != 0) {
+        dma->tx_busy[half] = 0;
+        dma->sending = -1;
+        dma->tx_overruns++;
+    }
+}
+
+
+/**
+  * @brief  ѭе: ʱ˳дİ뻺
+  * @param  dma:        DMA 鴦ṹַ
+  * @retval δİ뻺
+  */
+int filter_dma_poll(FilterDmaTypeDef *dma) {
+    int count = 0;
+    int half;
+
+    while(dma->ready[dma->next]) {
+        half = dma->next;
+        // ٴ: ڼ DMA ٴдһʱ filter_dma_mark λ ( rx_overruns), һִ, ᶪʧ
+        dma->active = half;
+        dma->ready[half] = 0;
+        filter_dma_process_half(dma, half);
+        dma->active = -1;
+        dma->next ^= 1;
+        count++;
+    }
+    return count;
+}
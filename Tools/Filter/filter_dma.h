@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : filter_dma.h
+  * @brief          : DMA ƹһ鴦. ADC ѭ DMA дջ, 봫 / ж
+  *                   ֱʾǰ / 뻺Ѿд; ÿֻԸдİһο˲
+  *                   (˲, ֯֡), ֱдڷƹһ,  DMA Ӹô, ٸ.
+  * @attention      :  STM32 HAL,  HAL صеöӦӿڼ ( filter_dma.c ʹʾ).
+  *                   Ͽ filter_dma_sim ģ DMA 봮ڽвԺ.
+
+  ******************************************************************************
+  */
+
+
+// filter_dma.h
+#ifndef FILTER_DMA_H
+#define FILTER_DMA_H
+
+#include <stdint.h>
+#include "filter_chain.h"
+
+// Ͱڷʱ˲ʹõݴС (float , λ FilterDmaTypeDef ), ͨܳ
+#ifndef FILTER_DMA_SCRATCH
+#define FILTER_DMA_SCRATCH  256
+#endif
+
+// ADC ʽöٱ
+typedef enum {
+    FILTER_DMA_U16 = 0,     // ޷ 16 λ (Ƭ ADC, Ҷ)
+    FILTER_DMA_I16,         // з 16 λ
+    FILTER_DMA_I32,         // з 32 λ (ⲿ 24 λ ADC)
+    FILTER_DMA_F32          // float
+} FilterDmaSampleType;
+
+// DMA ƹҿ鴦ṹ
+typedef struct filter_dma {
+    FilterChainTypeDef *chain;          // ˲ (˲ 1 ), ͨÿ֡ ADC ͨ
+    FilterDmaSampleType fmt;            // ADC ʽ
+    int frames;                         // ֡ (ÿ֡ channels )
+    float offset;                       // 뻻: x = (adc - offset) * scale
+    float scale;
+    const void *rx;                     // ADC ѭ DMA , 2 * frames * channels 
+    float *tx;                          // ƹһ, 2 * frames * channels  float,  h Ϊ tx + h * frames * channels
+    volatile uint8_t ready[2];          // ж 1:  h ջд, ȴ
+    volatile uint8_t tx_busy[2];        //  h 뷢ͻɴڷ
+    int next;                           // һҪİ뻺 (֤ʱ˳)
+    volatile int active;                // filter_dma_poll ڴİ뻺, -1: 
+    volatile int sending;               // ڷ͵İ뻺, -1:  (ж)
+    unsigned long halves;               // Ѵİ뻺
+    unsigned long rx_overruns;          // δֱ DMA дĴ (ϲ)
+    unsigned long tx_overruns;          // дʱͻڷ͵Ĵ (ڴ)
+    // ͹:  data ʼ bytes ֽ ( DMA), ɺ filter_dma_tx_done;  0 ʾ
+    int (*transmit)(void *ctx, const void *data, int bytes);
+    void *ctx;                          // ͹Ӳ
+    float scratch[FILTER_DMA_SCRATCH];  // Ͱڷʱ˲ݴ (ռжջ)
+}FilterDmaTypeDef;
+
+
+int init_filter_dma(FilterDmaTypeDef *dma, FilterChainTypeDef *chain, FilterDmaSampleType fmt,
+                    const void *rx, float *tx, int frames);
+void filter_dma_half_cplt(FilterDmaTypeDef *dma);
+void filter_dma_cplt(FilterDmaTypeDef *dma);
+void filter_dma_tx_done(FilterDmaTypeDef *dma);
+void filter_dma_process_half(FilterDmaTypeDef *dma, int half);
+int filter_dma_poll(FilterDmaTypeDef *dma);
+
+#endif
@@ -0,0 +1,162 @@
+/**
+  ******************************************************************************
+  * @file           : filter_dma_sim.c
+  * @brief          : DMA ƹҿ鴦ģ. ģ ADC ѭ DMA İ봫/ж봮 DMA ,
+                       filter_dma , ͳÿĴʱ (ڰ뻺ڵ CPU ռ),
+                      /, ֱӵ apply_filter_chain_frames ĽȽ.
+  * @attention      :
+                      ÷: filter_dma_sim [channels] [frames] [fs] [seconds] [baud]
+                        channels    ADC ͨ (Ĭ 4)
+                        frames      ֡ (Ĭ 64)
+                        fs          Ƶ Hz (Ĭ 500)
+                        seconds     ģʱ s (Ĭ 600)
+                        baud        ڲ, 0 ʾ (Ĭ 2000000, ÿֽ 10 λ)
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "filter_dma.h"
+
+#define SIM_PI      3.14159265358979323846
+
+// ģ⴮: ¼͵ (յ), ʼ㷢ʱ
+typedef struct {
+    const float *tx_lo, *tx_hi;     // ƹһΧ, ڼ㿽
+    float *wire;                    // յ
+    size_t wire_len, wire_cap;      // float 
+    double busy_until;              // ʱ (ģʱ, s)
+    double now;                     // ǰģʱ
+    double baud;                    // , 0: 
+    unsigned long copies;           // ָ벻ڷͻڵĴ (ӦΪ 0)
+} SimUart;
+
+static int sim_transmit(void *ctx, const void *data, int bytes) {
+    SimUart *u = (SimUart *)ctx;
+    const float *p = (const float *)data;
+    const size_t n = (size_t)bytes / sizeof(float);
+
+    if(p < u->tx_lo || p + n > u->tx_hi) {
+        u->copies++;
+    }
+    if(u->wire_len + n <= u->wire_cap) {
+        memcpy(u->wire + u->wire_len, p, n * sizeof(float));
+    }
+    u->wire_len += n;
+    u->busy_until = u->now + (u->baud > 0.0 ? bytes * 10.0 / u->baud : 0.0);
+    return 0;
+}
+
+static double sim_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+
+    const FilterChainStageDef front_end[3] = {
+        { NOTCH,    50.0f, 0.0f,   0.0f },
+        { HIGHPASS, 0.0f,  0.0f,   1.0f },
+        { LOWPASS,  0.0f,  100.0f, 0.0f },
+    };
+    const int C = argc > 1 ? atoi(argv[1]) : 4;
+    const int F = argc > 2 ? atoi(argv[2]) : 64;
+    const float fs = argc > 3 ? (float)atof(argv[3]) : 500.0f;
+    const double seconds = argc > 4 ? atof(argv[4]) : 600.0;
+    const double baud = argc > 5 ? atof(argv[5]) : 2000000.0;
+    const double period = F / (double)fs;                   // one half buffer
+    const long halves = (long)(seconds / period);
+    const size_t half_n = (size_t)F * C;
+    FilterChainTypeDef chain, ref;
+    FilterDmaTypeDef dma;
+    SimUart uart;
+    uint16_t *rx;
+    float *tx, *ref_in;
+    double t0, dt, busy_sum = 0.0, busy_max = 0.0, err = 0.0;
+    long h, n, sample = 0;
+    size_t i;
+    int ch, f;
+
+    if(C <= 0 || F <= 0 || fs <= 0.0f || halves <= 0) {
+        fprintf(stderr, "usage: %s [channels] [frames] [fs] [seconds] [baud]\n", argv[0]);
+        return 1;
+    }
+    rx = (uint16_t *)malloc(2 * half_n * sizeof(uint16_t));
+    tx = (float *)malloc(2 * half_n * sizeof(float));
+    ref_in = (float *)malloc((size_t)halves * half_n * sizeof(float));
+    memset(&uart, 0, sizeof(uart));
+    uart.wire_cap = (size_t)halves * half_n;
+    uart.wire = (float *)malloc(uart.wire_cap * sizeof(float));
+    if(rx == NULL || tx == NULL || ref_in == NULL || uart.wire == NULL
+       || init_filter_chain(&chain, C, fs, front_end, 3) != 0 || init_filter_chain(&ref, C, fs, front_end, 3) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    init_filter_dma(&dma, &chain, FILTER_DMA_U16, rx, tx, F);
+    dma.offset = 2048.0f;
+    dma.transmit = sim_transmit;
+    dma.ctx = &uart;
+    uart.tx_lo = tx;
+    uart.tx_hi = tx + 2 * half_n;
+    uart.baud = baud;
+
+    for(h = 0; h < halves; h++) {
+        // the adc dma fills one half: 12 bit, 10 Hz signal + 50 Hz mains + noise
+        uint16_t *dst = rx + (size_t)(h & 1) * half_n;
+        for(f = 0; f < F; f++, sample++) {
+            const double t = sample / (double)fs;
+            for(ch = 0; ch < C; ch++) {
+                double v = 2048.0 + 600.0 * sin(2.0 * SIM_PI * 10.0 * t + ch) + 300.0 * sin(2.0 * SIM_PI * 50.0 * t) + (rand() % 64 - 32);
+                dst[(size_t)f * C + ch] = (uint16_t)v;
+                ref_in[(size_t)h * half_n + (size_t)f * C + ch] = (float)dst[(size_t)f * C + ch] - 2048.0f;
+            }
+        }
+        // advance simulated time to the interrupt, finish the uart transfer if due
+        uart.now = (h + 1) * period;
+        if(dma.sending >= 0 && uart.busy_until <= uart.now) {
+            filter_dma_tx_done(&dma);
+        }
+        if(h & 1) {
+            filter_dma_cplt(&dma);
+        }
+        else {
+            filter_dma_half_cplt(&dma);
+        }
+        t0 = sim_seconds();
+        filter_dma_poll(&dma);
+        dt = sim_seconds() - t0;
+        busy_sum += dt;
+        busy_max = dt > busy_max ? dt : busy_max;
+    }
+
+    // reference: one pass over the whole record, compare with what arrived on the wire
+    apply_filter_chain_frames(&ref, ref_in, C, ref_in, FILTER_LAYOUT_INTERLEAVED, C, (int)(halves * F));
+    n = dma.tx_overruns == 0 ? (long)uart.wire_len : 0;
+    for(i = 0; i < (size_t)n; i++) {
+        double d = fabs((double)uart.wire[i] - ref_in[i]);
+        err = d > err ? d : err;
+    }
+
+    printf("channels %d, frames/half %d, fs %.0f Hz, half period %.3f ms, %ld halves\n", C, F, fs, period * 1e3, halves);
+    printf("processing: %.1f ns/sample, mean %.2f us/half (%.3f%% cpu), max %.2f us/half\n",
+           busy_sum / ((double)halves * half_n) * 1e9, busy_sum / halves * 1e6, busy_sum / (halves * period) * 100.0, busy_max * 1e6);
+    printf("rx overruns %lu, tx overruns %lu, zero-copy violations %lu\n", dma.rx_overruns, dma.tx_overruns, uart.copies);
+    if(n > 0) {
+        printf("max |wire - reference| = %g over %ld samples\n", err, n);
+    }
+    else {
+        printf("uart too slow for the data rate, wire comparison skipped\n");
+    }
+    free_filter_chain(&chain);
+    free_filter_chain(&ref);
+    free(rx);
+    free(tx);
+    free(ref_in);
+    free(uart.wire);
+    return (uart.copies == 0 && err < 1e-3) ? 0 : 1;
+}
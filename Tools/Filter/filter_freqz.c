@@ -0,0 +1,193 @@
+/**
+  ******************************************************************************
+  * @file           : filter_freqz.c
+  * @brief          : ƵӦļ.  scipy.signal.freqz / group_delay һ:
+                      Ϊ 20*log10|H|, λΪ angle(H) (, չ), ȺӳٵλΪ.
+  * @attention      :
+                      ʹʾ (ο):
+
+                        FilterTypeDef lp;
+                        float freqs[1000], mag[1000], phase[1000], gd[1000];
+
+                        init_filter(&lp, LOWPASS, 2000.0f, 0.0f, 100.0f, 0.0f);
+                        for(i = 0; i < 1000; i++) {
+                            freqs[i] = 1000.0f * i / 999; // 0 ~ fs/2
+                        }
+                        filter_freqz(&lp, 1, freqs, 1000, mag, phase, gd);
+
+                        // У: -3 dB Ӧ 100 Hz +- 2 Hz 
+                        FilterDesignCheckDef check = { &lp, 1, FILTER_CHECK_CROSSING, 100.0f, -3.0f, 2.0f };
+                        filter_check_designs(&check, 1, 4096);
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdlib.h>
+#include "filter_freqz.h"
+#include "filter_chain.h"
+#include "filter_dispatch.h"
+
+#define FILTER_FREQZ_CHUNK      256     // ÿεں˵Ƶʸ (ջϻ)
+#define FILTER_FREQZ_PI         3.14159265358979323846
+
+
+/**
+  * @brief  ѼĸϵںҪĸʽ (b0, b1, b2, a1, a2,  a[0] һ)
+  */
+static void filter_freqz_pack(const FilterTypeDef *stages, int n_stages, float *coef) {
+    int s;
+    for(s = 0; s < n_stages; s++) {
+        const float a0 = stages[s].a[0];
+        coef[s * 5 + 0] = stages[s].b[0] / a0;
+        coef[s * 5 + 1] = stages[s].b[1] / a0;
+        coef[s * 5 + 2] = stages[s].b[2] / a0;
+        coef[s * 5 + 3] = stages[s].a[1] / a0;
+        coef[s * 5 + 4] = stages[s].a[2] / a0;
+    }
+}
+
+
+/**
+  * @brief  һƵϵĸӦȺӳ (n <= FILTER_FREQZ_CHUNK)
+  */
+static void filter_freqz_chunk(const FilterKernelTable *k, const float *coef, int n_stages, float fs,
+                               const float *freqs, int n, float *hr, float *hi, float *gd) {
+    float cw[FILTER_FREQZ_CHUNK], sw[FILTER_FREQZ_CHUNK];
+    double w;
+    int i;
+
+    for(i = 0; i < n; i++) {
+        w = 2.0 * FILTER_FREQZ_PI * freqs[i] / fs;
+        cw[i] = (float)cos(w);
+        sw[i] = (float)sin(w);
+    }
+    k->freqz(coef, n_stages, cw, sw, n, hr, hi, gd);
+}
+
+
+/**
+  * @brief  ƵӦ㺯
+  * @note   Ƶȡ stages[0].fs. ݲĵ |H| = 0 ƵʴΪ -inf.
+  * @param  stages:         ĸ˲ (˲ʱ n_stages = 1)
+  * @param  n_stages:        (1 ~ FILTER_CHAIN_MAX_STAGES)
+  * @param  freqs:          Ƶ (Hz)
+  * @param  n_freqs:        Ƶʸ
+  * @param  mag_db:         ,  (dB), Ϊ NULL
+  * @param  phase:          , λ (), Ϊ NULL
+  * @param  group_delay:    , Ⱥӳ (), Ϊ NULL
+  * @retval 0: ɹ; -1: 
+  */
+int filter_freqz(const FilterTypeDef *stages, int n_stages, const float *freqs, int n_freqs,
+                 float *mag_db, float *phase, float *group_delay) {
+
+    const FilterKernelTable *k = filter_kernels();
+    float coef[FILTER_CHAIN_MAX_STAGES * 5];
+    float hr[FILTER_FREQZ_CHUNK], hi[FILTER_FREQZ_CHUNK], gd[FILTER_FREQZ_CHUNK];
+    int i0, n, i;
+
+    if(n_stages <= 0 || n_stages > FILTER_CHAIN_MAX_STAGES || n_freqs < 0) {
+        return -1;
+    }
+    filter_freqz_pack(stages, n_stages, coef);
+    for(i0 = 0; i0 < n_freqs; i0 += FILTER_FREQZ_CHUNK) {
+        n = n_freqs - i0;
+        if(n > FILTER_FREQZ_CHUNK) {
+            n = FILTER_FREQZ_CHUNK;
+        }
+        filter_freqz_chunk(k, coef, n_stages, stages[0].fs, freqs + i0, n, hr, hi, gd);
+        for(i = 0; i < n; i++) {
+            if(mag_db != NULL) {
+                mag_db[i0 + i] = 10.0f * log10f(hr[i] * hr[i] + hi[i] * hi[i]);
+            }
+            if(phase != NULL) {
+                phase[i0 + i] = atan2f(hi[i], hr[i]);
+            }
+            if(group_delay != NULL) {
+                group_delay[i0 + i] = gd[i];
+            }
+        }
+    }
+    return 0;
+}
+
+
+/**
+  * @brief  Уһѡ
+  */
+static void filter_check_one(const FilterKernelTable *k, FilterDesignCheckDef *check, int n_grid) {
+    float coef[FILTER_CHAIN_MAX_STAGES * 5];
+    float freqs[FILTER_FREQZ_CHUNK], hr[FILTER_FREQZ_CHUNK], hi[FILTER_FREQZ_CHUNK], gd[FILTER_FREQZ_CHUNK];
+    const float fs = check->stages[0].fs;
+    const float step = 0.5f * fs / (float)(n_grid - 1);
+    float prev_f = 0.0f, prev_m = 0.0f, m, f, best = -1.0f;
+    int i0, n, i;
+
+    filter_freqz_pack(check->stages, check->n_stages, coef);
+    if(check->type != FILTER_CHECK_CROSSING) {
+        filter_freqz_chunk(k, coef, check->n_stages, fs, &check->freq, 1, hr, hi, gd);
+        check->measured = 10.0f * log10f(hr[0] * hr[0] + hi[0] * hi[0]);
+        check->pass = (check->type == FILTER_CHECK_BELOW) ? (check->measured <= check->level_db)
+                                                          : (check->measured >= check->level_db);
+        return;
+    }
+    // scan 0 ~ fs/2 and keep the crossing closest to the expected frequency
+    for(i0 = 0; i0 < n_grid; i0 += FILTER_FREQZ_CHUNK) {
+        n = n_grid - i0;
+        if(n > FILTER_FREQZ_CHUNK) {
+            n = FILTER_FREQZ_CHUNK;
+        }
+        for(i = 0; i < n; i++) {
+            freqs[i] = step * (float)(i0 + i);
+        }
+        filter_freqz_chunk(k, coef, check->n_stages, fs, freqs, n, hr, hi, gd);
+        for(i = 0; i < n; i++) {
+            m = 10.0f * log10f(hr[i] * hr[i] + hi[i] * hi[i] + 1e-30f) - check->level_db;
+            f = freqs[i];
+            if(i0 + i > 0 && ((prev_m < 0.0f) != (m < 0.0f))) {
+                // linear interpolation between grid points
+                float fc = prev_f + (f - prev_f) * prev_m / (prev_m - m);
+                if(best < 0.0f || fabsf(fc - check->freq) < fabsf(best - check->freq)) {
+                    best = fc;
+                }
+            }
+            prev_f = f;
+            prev_m = m;
+        }
+    }
+    check->measured = best;
+    check->pass = (best >= 0.0f) && (fabsf(best - check->freq) <= check->tol);
+}
+
+
+/**
+  * @brief  Уѡ
+  * @note   ÿ 0 ~ fs/2  n_grid ȼƵϼӦ; ʱ OpenMP ̲߳.
+  *         дÿУṹ measured  pass.
+  * @param  checks:     У
+  * @param  n_checks:   У
+  * @param  n_grid:     Ƶ (С 2), ֻӰ FILTER_CHECK_CROSSING
+  * @retval ͨĸ; -1: 
+  */
+int filter_check_designs(FilterDesignCheckDef *checks, int n_checks, int n_grid) {
+
+    const FilterKernelTable *k = filter_kernels();
+    int i, passed = 0;
+
+    if(n_grid < 2) {
+        return -1;
+    }
+    for(i = 0; i < n_checks; i++) {
+        if(checks[i].n_stages <= 0 || checks[i].n_stages > FILTER_CHAIN_MAX_STAGES) {
+            return -1;
+        }
+    }
+#if defined(_OPENMP)
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+:passed)
+#endif
+    for(i = 0; i < n_checks; i++) {
+        filter_check_one(k, &checks[i], n_grid);
+        passed += checks[i].pass;
+    }
+    return passed;
+}
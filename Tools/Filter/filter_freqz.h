@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file           : filter_freqz.h
+  * @brief          : ƵӦ. 㵥˲༶ķƵ, ƵȺӳ,
+  *                    filter.h ĩβ python freqz ֤ű, ϲҪ python/scipy.
+  *                   ģʽһβУѡ ( -3 dB ֹƵʼ).
+  * @attention      : ӦȺӳ SIMD ں˰Ƶʲм,  filter_dispatch.h
+
+  ******************************************************************************
+  */
+
+
+// filter_freqz.h
+#ifndef FILTER_FREQZ_H
+#define FILTER_FREQZ_H
+
+#include "filter.h"
+
+// Уöٱ
+typedef enum {
+    FILTER_CHECK_CROSSING = 0,  // ƵߴԽ level_db Ƶ ( freq һ)  freq  tol Hz
+    FILTER_CHECK_BELOW,         // freq ķȲ level_db (ݲ)
+    FILTER_CHECK_ABOVE          // freq ķȲ level_db (ͨ)
+} FilterCheckType;
+
+// Уṹ
+typedef struct filter_design_check {
+    const FilterTypeDef *stages;    // ѡ (ĸ˲)
+    int n_stages;                   // 
+    FilterCheckType type;           // У
+    float freq;                     // ĴԽƵʻƵ (Hz)
+    float level_db;                 // ƽ (dB),  -3
+    float tol;                      // ԽƵݲ (Hz),  FILTER_CHECK_CROSSING ʹ
+    float measured;                 // : ʵ⴩ԽƵ (Hz, ûдԽʱΪ -1)  freq ķ (dB)
+    int pass;                       // : 1 ͨ, 0 δͨ
+}FilterDesignCheckDef;
+
+
+int filter_freqz(const FilterTypeDef *stages, int n_stages, const float *freqs, int n_freqs,
+                 float *mag_db, float *phase, float *group_delay);
+int filter_check_designs(FilterDesignCheckDef *checks, int n_checks, int n_grid);
+
+#endif
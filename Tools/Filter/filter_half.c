@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @file           : filter_half.c
+  * @brief          : 16 λļ. ʽת (ƽ̨, Ҳ SIMD תβ)
+                      Լ鴦 / ˲ 16 λӿ.
+  * @attention      :
+                      ʹʾ (ο):
+
+                        FilterBankTypeDef bank; // ˲ṹ
+
+                        int main(void) {
+
+                            uint16_t xn[4096 * 256], yn[4096 * 256]; // 4096 ͨ, ÿͨ 256  (fp16, ͨ)
+
+                            init_filter_bank(&bank, 4096, NOTCH, 2000.0f, 50.0f, 0.0f, 0.0f);
+
+                            while(1) {
+
+                                apply_filter_bank_half(&bank, FILTER_SAMPLE_F16, xn, yn, 256); // ڴΪ float ӿڵһ
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <string.h>
+#include "filter_half.h"
+#include "filter_dispatch.h"
+#include "filter_stats.h"
+#include "filter_instr.h"
+
+#define FILTER_HALF_BLOCK       256     // ͨ鴦ʱ float ת (פ L1 cache)
+
+
+/**
+  * @brief  16 λתΪ float
+  * @param  fmt:        ʽ FILTER_SAMPLE_F16 / FILTER_SAMPLE_BF16
+  * @param  h:          16 λ
+  * @retval float ֵ
+  */
+float filter_half_to_f32(FilterSampleType fmt, uint16_t h) {
+    uint32_t x, em;
+    float f;
+
+    if(fmt == FILTER_SAMPLE_BF16) {
+        x = (uint32_t)h << 16;
+    }
+    else {
+        em = h & 0x7fffu;
+        if(em >= 0x7c00u) {
+            // Inf / NaN, NaN becomes quiet (same as vcvtph2ps)
+            x = 0x7f800000u | ((em & 0x3ffu) << 13) | ((em & 0x3ffu) != 0 ? 0x400000u : 0u);
+        }
+        else if(em >= 0x0400u) {
+            // normal: rebias exponent 15 -> 127
+            x = (em << 13) + 0x38000000u;
+        }
+        else {
+            // zero / subnormal: em * 2^-24
+            f = (float)em * 5.9604644775390625e-8f;
+            memcpy(&x, &f, sizeof(x));
+        }
+        x |= (uint32_t)(h & 0x8000u) << 16;
+    }
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+
+/**
+  * @brief  float תΪ 16 λ (뵽ż)
+  * @param  fmt:        ʽ FILTER_SAMPLE_F16 / FILTER_SAMPLE_BF16
+  * @param  f:          float ֵ
+  * @retval 16 λ; fp16 ΧʱΪ +-Inf
+  */
+uint16_t filter_f32_to_half(FilterSampleType fmt, float f) {
+    uint32_t x, ax, sign;
+    float a;
+
+    memcpy(&x, &f, sizeof(x));
+    if(fmt == FILTER_SAMPLE_BF16) {
+        if((x & 0x7fffffffu) > 0x7f800000u) {
+            return (uint16_t)((x >> 16) | 0x40u);   // keep NaN quiet
+        }
+        return (uint16_t)((x + 0x7fffu + ((x >> 16) & 1u)) >> 16);
+    }
+    sign = (x >> 16) & 0x8000u;
+    ax = x & 0x7fffffffu;
+    if(ax >= 0x7f800000u) {
+        // Inf, or quiet NaN keeping the upper payload bits (same as vcvtps2ph)
+        return (uint16_t)(sign | 0x7c00u | (ax > 0x7f800000u ? 0x200u | ((ax >> 13) & 0x3ffu) : 0u));
+    }
+    if(ax >= 0x477ff000u) {
+        // >= 65520 rounds to infinity
+        return (uint16_t)(sign | 0x7c00u);
+    }
+    if(ax < 0x38800000u) {
+        // below 2^-14: adding 0.5 puts the fp16 subnormal unit (2^-24) at the last mantissa bit, the FPU rounds
+        memcpy(&a, &ax, sizeof(a));
+        a += 0.5f;
+        memcpy(&ax, &a, sizeof(ax));
+        return (uint16_t)(sign | (ax - 0x3f000000u));
+    }
+    // rebias exponent 127 -> 15 and round to nearest even on the 13 dropped bits
+    ax += 0xc8000fffu + ((ax >> 13) & 1u);
+    return (uint16_t)(sign | (ax >> 13));
+}
+
+
+/**
+  * @brief  ͨ˲鴦 (16 λ)
+  * @note   ÿ FILTER_HALF_BLOCK תջϵ float ,  apply_filter_block תд.
+  *         input  output ָͬһڴ.
+  * @param  filter:     ˲ṹַ
+  * @param  fmt:        ʽ FILTER_SAMPLE_F16 / FILTER_SAMPLE_BF16
+  * @param  input:      
+  * @param  output:     
+  * @param  len:        
+  * @retval None
+  */
+void apply_filter_block_half(FilterTypeDef *filter, FilterSampleType fmt, const uint16_t *input, uint16_t *output, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    float buf[FILTER_HALF_BLOCK];
+    int n0, seg;
+
+    for(n0 = 0; n0 < len; n0 += seg) {
+        seg = len - n0;
+        if(seg > FILTER_HALF_BLOCK) {
+            seg = FILTER_HALF_BLOCK;
+        }
+        k->half_load(fmt, input + n0, buf, seg);
+        apply_filter_block(filter, buf, buf, seg);
+        k->half_store(fmt, buf, output + n0, seg);
+    }
+}
+
+
+/**
+  * @brief  ˲鴦 (16 λ, ͨ)
+  * @note    ch ͨ n ʱ̵ĲΪ input[ch * len + n]. ͳʱ鷢.
+  * @param  bank:       ˲ṹַ
+  * @param  fmt:        ʽ FILTER_SAMPLE_F16 / FILTER_SAMPLE_BF16
+  * @param  input:       (channels * len)
+  * @param  output:      (channels * len)
+  * @param  len:        ÿͨĲ
+  * @retval None
+  */
+void apply_filter_bank_half(FilterBankTypeDef *bank, FilterSampleType fmt, const uint16_t *input, uint16_t *output, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    int n0, seg;
+
+    FILTER_INSTR_BEGIN();
+    for(n0 = 0; n0 < len; n0 += seg) {
+        seg = filter_stats_segment(bank->stats, len - n0);
+        filter_run_half(k->bank, k, bank, bank->channels, fmt, input + n0, FILTER_LAYOUT_PLANAR, len,
+                        output + n0, FILTER_LAYOUT_PLANAR, len, seg);
+        filter_stats_advance(bank->stats, seg);
+    }
+    FILTER_INSTR_END(FILTER_SITE_BANK, bank, (long)bank->channels * len, NULL, 0, 0, 0);
+}
+
+
+/**
+  * @brief  ˲齻֯֡ (16 λ)
+  * @param  bank:           ˲ṹַ
+  * @param  fmt:            ʽ FILTER_SAMPLE_F16 / FILTER_SAMPLE_BF16
+  * @param  frames:         ֡,  ch ͨ n ʱ̵ĲΪ frames[n * frame_stride + ch]
+  * @param  frame_stride:   ֡ļ ()
+  * @param  output:         
+  * @param  out_layout:      FILTER_LAYOUT_INTERLEAVED / FILTER_LAYOUT_PLANAR
+  * @param  out_stride:     ֯ʱΪ֡ļ, ͨʱΪͨļ ()
+  * @param  len:            ֡
+  * @retval None
+  */
+void apply_filter_bank_frames_half(FilterBankTypeDef *bank, FilterSampleType fmt, const uint16_t *frames, int frame_stride,
+                                   uint16_t *output, FilterLayoutType out_layout, int out_stride, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    int n0, seg;
+
+    FILTER_INSTR_BEGIN();
+    for(n0 = 0; n0 < len; n0 += seg) {
+        seg = filter_stats_segment(bank->stats, len - n0);
+        filter_run_half(k->bank, k, bank, bank->channels, fmt, frames + (size_t)n0 * frame_stride, FILTER_LAYOUT_INTERLEAVED, frame_stride,
+                        output + (out_layout == FILTER_LAYOUT_INTERLEAVED ? (size_t)n0 * out_stride : (size_t)n0),
+                        out_layout, out_stride, seg);
+        filter_stats_advance(bank->stats, seg);
+    }
+    FILTER_INSTR_END(FILTER_SITE_BANK_FRAMES, bank, (long)bank->channels * len, NULL, 0, 0, 0);
+}
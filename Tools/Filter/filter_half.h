@@ -0,0 +1,32 @@
+/**
+  ******************************************************************************
+  * @file           : filter_half.h
+  * @brief          : 16 λ (fp16 / bf16). ͨ (ǧͨ x 2 kHz) ʱ鴦˲
+  *                   ڴ,  16 λſʹڴ; ˲״̬ں
+  *                   Ȼ fp32, ֻڶ/дʱת (x86 ʹ F16C / AVX-512 תָ).
+  * @attention      : : ֻһ (ż), ڵݹۻ.
+  *                   fp16  <= 2^-11 (Լ -66 dB), ֵ 65504, 16 λ ADC ֵԾȷʾ,
+  *                   24 λ ADC ֵҪ, Ϊ Inf.
+  *                   bf16  <= 2^-8 (Լ -48 dB), Χ float ͬ, ʺϷȿȴ.
+  *                   : ֯֡ (apply_filter_bank_frames_half) ÿ֡ת, ; ֵͨ
+  *                   Ҫת, ֻڴȷʵƿ (߳, Զ cache) ʱŸ.
+
+  ******************************************************************************
+  */
+
+
+// filter_half.h
+#ifndef FILTER_HALF_H
+#define FILTER_HALF_H
+
+#include <stdint.h>
+#include "filter_bank.h"
+
+float filter_half_to_f32(FilterSampleType fmt, uint16_t h);
+uint16_t filter_f32_to_half(FilterSampleType fmt, float f);
+void apply_filter_block_half(FilterTypeDef *filter, FilterSampleType fmt, const uint16_t *input, uint16_t *output, int len);
+void apply_filter_bank_half(FilterBankTypeDef *bank, FilterSampleType fmt, const uint16_t *input, uint16_t *output, int len);
+void apply_filter_bank_frames_half(FilterBankTypeDef *bank, FilterSampleType fmt, const uint16_t *frames, int frame_stride,
+                                   uint16_t *output, FilterLayoutType out_layout, int out_stride, int len);
+
+#endif
@@ -0,0 +1,267 @@
+/**
+  ******************************************************************************
+  * @file           : filter_instr.c
+  * @brief          : ˲ȵ׮ļ.
+                      ÿ̵߳һμ¼ʱһ,  CAS ҵȫ (ֻɾ, ߳˳
+                      Ȼ). ֻ߳д (ԭ relaxed 洢, Ҫ lock ǰ׺),
+                      ߳ԭ relaxed ȡ, , ֮ͬ䲻֤ͬһʱ.
+  * @attention      :
+                      ʹʾ (ο, Ҫ -DFILTER_INSTRUMENT=ON):
+
+                        FilterInstrRecordDef rec[32];
+                        int i, n;
+
+                        filter_instr_set_saturation(32767.0f); // 16 λ ADC 
+                        ...
+                        n = filter_instr_snapshot(rec, 32);
+                        for(i = 0; i < n; i++) {
+                            printf("%s %p %.1f cycles/sample max %llu nan %llu\n", filter_instr_site_name(rec[i].site), rec[i].obj,
+                                   (double)rec[i].cycles / rec[i].samples, (unsigned long long)rec[i].max_cycles,
+                                   (unsigned long long)rec[i].nan);
+                        }
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_instr.h"
+
+#if defined(FILTER_INSTRUMENT)
+
+#if !defined(__GNUC__)
+#error "FILTER_INSTRUMENT requires GCC or Clang (__thread and __atomic builtins)"
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+#define FILTER_INSTR_LOAD(p)        __atomic_load_n((p), __ATOMIC_RELAXED)
+#define FILTER_INSTR_STORE(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+
+//  (, ʵ) ϵļ
+typedef struct {
+    const void *obj;            // ʵ,  key 
+    int key;                    // 0: ; site + 1: ռ (release 洢,  acquire ȡ)
+    uint64_t count[7];          // calls, samples, cycles, max_cycles, nan, inf, saturated
+} FilterInstrSlot;
+
+// ÿ̵߳ļ
+typedef struct filter_instr_thread {
+    FilterInstrSlot slot[FILTER_INSTR_SLOTS];
+    struct filter_instr_thread *next;
+} FilterInstrThread;
+
+static FilterInstrThread *filter_instr_threads = NULL;     // ̼߳ͷ
+static __thread FilterInstrThread *filter_instr_self = NULL;
+static float filter_instr_saturation = HUGE_VALF;
+
+
+/**
+  * @brief  ǰ̵߳ļ, һεʱ䲢ҵȫ
+  */
+static FilterInstrThread *filter_instr_thread(void) {
+    FilterInstrThread *t = filter_instr_self, *head;
+
+    if(t != NULL) {
+        return t;
+    }
+    t = (FilterInstrThread *)calloc(1, sizeof(*t));
+    if(t == NULL) {
+        return NULL;
+    }
+    head = __atomic_load_n(&filter_instr_threads, __ATOMIC_RELAXED);
+    do {
+        t->next = head;
+    } while(!__atomic_compare_exchange_n(&filter_instr_threads, &head, t, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    filter_instr_self = t;
+    return t;
+}
+
+
+/**
+  * @brief  ڵǰ̵߳ļв (, ʵ) , ûռһλ
+  * @note   ֻ̻߳ռλ, Ҫ CAS. λϲʵ NULL.
+  */
+static FilterInstrSlot *filter_instr_slot(FilterInstrThread *t, FilterInstrSiteType site, const void *obj) {
+    const unsigned h = (unsigned)(((uintptr_t)obj >> 4) * 2654435761u + (unsigned)site);
+    FilterInstrSlot *s;
+    int i;
+
+    for(i = 0; i < FILTER_INSTR_SLOTS; i++) {
+        s = &t->slot[(h + i) % FILTER_INSTR_SLOTS];
+        if(s->key == 0) {
+            s->obj = obj;
+            __atomic_store_n(&s->key, (int)site + 1, __ATOMIC_RELEASE);
+            return s;
+        }
+        if(s->key == (int)site + 1 && s->obj == obj) {
+            return s;
+        }
+    }
+    return obj != NULL ? filter_instr_slot(t, site, NULL) : NULL;
+}
+
+
+/**
+  * @brief  ȡڼ (x86: rdtsc; ƽ̨: ʱ)
+  * @retval ڼ
+  */
+uint64_t filter_instr_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint64_t)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+
+/**
+  * @brief  ¼һڵ ( FILTER_INSTR_END )
+  * @param  site:       
+  * @param  obj:        ˲ʵַ
+  * @param  t0:         ڴڼ
+  * @param  samples:    Ĳ (֮ͨ)
+  * @param  out:        , Ϊ NULL ʱ
+  * @param  rows:       
+  * @param  cols:       ÿмĵ
+  * @param  row_stride: еļ (float )
+  * @retval None
+  */
+void filter_instr_record(FilterInstrSiteType site, const void *obj, uint64_t t0, long samples,
+                         const float *out, int rows, int cols, int row_stride) {
+    const uint64_t dt = filter_instr_cycles() - t0;
+    const float sat = filter_instr_saturation;
+    FilterInstrThread *t = filter_instr_thread();
+    FilterInstrSlot *s;
+    uint64_t nan = 0, inf = 0, over = 0;
+    float a;
+    int r, c;
+
+    if(t == NULL || (s = filter_instr_slot(t, site, obj)) == NULL) {
+        return;
+    }
+    for(r = 0; out != NULL && r < rows; r++) {
+        const float *p = out + (size_t)r * row_stride;
+        for(c = 0; c < cols; c++) {
+            a = fabsf(p[c]);
+            nan += (a != a);
+            inf += (a == HUGE_VALF);
+            over += (a >= sat);
+        }
+    }
+    // only this thread writes the slot, plain read-modify-store is enough
+    FILTER_INSTR_STORE(&s->count[0], s->count[0] + 1);
+    FILTER_INSTR_STORE(&s->count[1], s->count[1] + (uint64_t)samples);
+    FILTER_INSTR_STORE(&s->count[2], s->count[2] + dt);
+    if(dt > s->count[3]) {
+        FILTER_INSTR_STORE(&s->count[3], dt);
+    }
+    FILTER_INSTR_STORE(&s->count[4], s->count[4] + nan);
+    FILTER_INSTR_STORE(&s->count[5], s->count[5] + inf);
+    FILTER_INSTR_STORE(&s->count[6], s->count[6] + over);
+}
+
+#endif /* FILTER_INSTRUMENT */
+
+
+/**
+  * @brief  ׮Ƿ
+  * @retval 1: ; 0: δ
+  */
+int filter_instr_enabled(void) {
+#if defined(FILTER_INSTRUMENT)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+/**
+  * @brief  ñ,  |y| >= level Ϊ (Ĭ +Inf, ֻͳ Inf)
+  * @param  level:      
+  * @retval None
+  */
+void filter_instr_set_saturation(float level) {
+#if defined(FILTER_INSTRUMENT)
+    filter_instr_saturation = level;
+#else
+    (void)level;
+#endif
+}
+
+
+/**
+  * @brief  ׮: ̵߳ļ, ͬһͬһʵϲΪһ¼
+  * @note   ̵߳, ڴ߳.
+  * @param  records:        ¼
+  * @param  max_records:    ɵļ¼
+  * @retval ¼ ( max_records Ĳֶ); δò׮ʱΪ 0
+  */
+int filter_instr_snapshot(FilterInstrRecordDef *records, int max_records) {
+#if defined(FILTER_INSTRUMENT)
+    FilterInstrThread *t;
+    FilterInstrRecordDef *rec;
+    const FilterInstrSlot *s;
+    uint64_t v;
+    int n = 0, i, j, key;
+
+    for(t = __atomic_load_n(&filter_instr_threads, __ATOMIC_ACQUIRE); t != NULL; t = t->next) {
+        for(i = 0; i < FILTER_INSTR_SLOTS; i++) {
+            s = &t->slot[i];
+            key = __atomic_load_n(&s->key, __ATOMIC_ACQUIRE);
+            if(key == 0) {
+                continue;
+            }
+            for(j = 0; j < n; j++) {
+                if((int)records[j].site == key - 1 && records[j].obj == s->obj) {
+                    break;
+                }
+            }
+            if(j == n) {
+                if(n == max_records) {
+                    continue;
+                }
+                memset(&records[n], 0, sizeof(records[n]));
+                records[n].site = (FilterInstrSiteType)(key - 1);
+                records[n].obj = s->obj;
+                n++;
+            }
+            rec = &records[j];
+            rec->calls += FILTER_INSTR_LOAD(&s->count[0]);
+            rec->samples += FILTER_INSTR_LOAD(&s->count[1]);
+            rec->cycles += FILTER_INSTR_LOAD(&s->count[2]);
+            v = FILTER_INSTR_LOAD(&s->count[3]);
+            rec->max_cycles = v > rec->max_cycles ? v : rec->max_cycles;
+            rec->nan += FILTER_INSTR_LOAD(&s->count[4]);
+            rec->inf += FILTER_INSTR_LOAD(&s->count[5]);
+            rec->saturated += FILTER_INSTR_LOAD(&s->count[6]);
+        }
+    }
+    return n;
+#else
+    (void)records;
+    (void)max_records;
+    return 0;
+#endif
+}
+
+
+/**
+  * @brief  
+  * @param  site:       
+  * @retval ַ
+  */
+const char *filter_instr_site_name(FilterInstrSiteType site) {
+    static const char *const names[FILTER_SITE_COUNT] = {
+        "filter_block", "bank", "bank_frames", "chain", "chain_frames", "running", "tone", "spectrum",
+    };
+    return (site >= 0 && site < FILTER_SITE_COUNT) ? names[site] : "unknown";
+}
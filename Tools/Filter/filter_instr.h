@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file           : filter_instr.h
+  * @brief          : ˲ȵ׮. ڸ鴦ͳÿ˲ʵĴ, ÿķѵ
+  *                   CPU  (x86 Ϊ rdtsc), 󵥿ʱԼе NaN/Inf/͵.
+  *                   ̷ֿ߳, ֻ߳д, ; սӿڻ߳.
+  * @attention      : ڿ:  FILTER_INSTRUMENT (CMake ѡ -DFILTER_INSTRUMENT=ON) ʱЧ,
+  *                   δʱ׮չΪ, ں˺Ͳ׮ʱȫͬ, սӿڷ 0 ¼.
+  *                   ӿ apply_filter ׮ (һڼĴ봦һ൱).
+
+  ******************************************************************************
+  */
+
+
+// filter_instr.h
+#ifndef FILTER_INSTR_H
+#define FILTER_INSTR_H
+
+#include <stdint.h>
+
+#define FILTER_INSTR_SLOTS          64      // ÿ߳¼ (, ʵ) , ĺϲʵ NULL
+
+// ׮öٱ
+typedef enum {
+    FILTER_SITE_BLOCK = 0,      // apply_filter_block / apply_filter_block_tdf2
+    FILTER_SITE_BANK,           // apply_filter_bank / apply_filter_bank_with
+    FILTER_SITE_BANK_FRAMES,    // apply_filter_bank_frames
+    FILTER_SITE_CHAIN,          // apply_filter_chain
+    FILTER_SITE_CHAIN_FRAMES,   // apply_filter_chain_frames
+    FILTER_SITE_RUNNING,        // apply_running_filter / apply_running_filter_frames
+    FILTER_SITE_TONE,           // apply_tone_monitor / apply_tone_monitor_frames
+    FILTER_SITE_SPECTRUM,       // apply_filter_spectrum / apply_filter_spectrum_frames
+    FILTER_SITE_COUNT
+} FilterInstrSiteType;
+
+// ׮ռ¼, ͬһͬһʵ߳ϵļ֮
+typedef struct filter_instr_record {
+    FilterInstrSiteType site;   // 
+    const void *obj;            // ˲ʵַ (FilterTypeDef / FilterBankTypeDef ...)
+    uint64_t calls;             // ô
+    uint64_t samples;           // Ĳ (֮ͨ)
+    uint64_t cycles;            // 
+    uint64_t max_cycles;        // 󵥴ε
+    uint64_t nan;               // е NaN 
+    uint64_t inf;               // е Inf 
+    uint64_t saturated;         //  |y| >= ޵ĸ
+}FilterInstrRecordDef;
+
+
+int filter_instr_enabled(void);
+void filter_instr_set_saturation(float level);
+int filter_instr_snapshot(FilterInstrRecordDef *records, int max_records);
+const char *filter_instr_site_name(FilterInstrSiteType site);
+uint64_t filter_instr_cycles(void);
+void filter_instr_record(FilterInstrSiteType site, const void *obj, uint64_t t0, long samples,
+                         const float *out, int rows, int cols, int row_stride);
+
+/*
+ * ڲ׮ (ڲʹ):
+ * FILTER_INSTR_BEGIN()                     ¼ڼ, ںͷ
+ * FILTER_INSTR_END(site, obj, samples, out, rows, cols, row_stride)
+ *                                          ¼һε; out Ϊ NULL ʱ,
+ *                                           out[r * row_stride + c] (r < rows, c < cols)
+ */
+#if defined(FILTER_INSTRUMENT)
+#define FILTER_INSTR_BEGIN()        const uint64_t filter_instr_t0_ = filter_instr_cycles()
+#define FILTER_INSTR_END(site, obj, samples, out, rows, cols, row_stride) \
+    filter_instr_record((site), (obj), filter_instr_t0_, (long)(samples), (out), (rows), (cols), (row_stride))
+#else
+#define FILTER_INSTR_BEGIN()        do { } while(0)
+#define FILTER_INSTR_END(site, obj, samples, out, rows, cols, row_stride) do { } while(0)
+#endif
+
+#endif
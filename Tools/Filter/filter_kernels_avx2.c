@@ -0,0 +1,11 @@
+/**
+  ******************************************************************************
+  * @file           : filter_kernels_avx2.c
+  * @brief          : ˲ں AVX2 + FMA 汾 (ѡ -mavx2 -mfma)
+  * @attention      : ںʵּ filter_kernels_impl.h
+
+  ******************************************************************************
+  */
+
+#define FILTER_SIMD_AVX2
+#include "filter_kernels_impl.h"
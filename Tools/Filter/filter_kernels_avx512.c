@@ -0,0 +1,11 @@
+/**
+  ******************************************************************************
+  * @file           : filter_kernels_avx512.c
+  * @brief          : ˲ں AVX-512 汾 (ѡ -mavx512f)
+  * @attention      : ںʵּ filter_kernels_impl.h
+
+  ******************************************************************************
+  */
+
+#define FILTER_SIMD_AVX512
+#include "filter_kernels_impl.h"
@@ -0,0 +1,640 @@
+/**
+  ******************************************************************************
+  * @file           : filter_kernels_impl.h
+  * @brief          : ˲ȵں˵ͨʵ.  filter_kernels_<isa>.c ڶ
+  *                   FILTER_SIMD_<ISA> ֮, ÿָһݶں˺.
+  * @attention      : ҪֱӰļ.
+
+  ******************************************************************************
+  */
+
+
+#include <math.h>
+#include <stddef.h>
+#include "filter_simd.h"
+#include "filter_dispatch.h"
+#include "filter_chain.h"
+#include "filter_tone.h"
+#include "filter_stats.h"
+#include "filter_half.h"
+#include "filter_spectrum.h"
+
+extern const FilterKernelTable filter_kernels_scalar;
+
+// ͳۼ, һͨʱפĴ
+typedef struct {
+    VEC sum, sq, min, max, env, k;
+} FilterStatsAcc;
+
+FILTER_INLINE void FILTER_KFN(stats_load)(FilterStatsAcc *a, const FilterStatsTypeDef *st, int c) {
+    a->sum = VLOAD(st->sum + c);
+    a->sq = VLOAD(st->sum_sq + c);
+    a->min = VLOAD(st->min + c);
+    a->max = VLOAD(st->max + c);
+    a->env = VLOAD(st->env + c);
+    a->k = VSET1(st->env_coeff);
+}
+
+FILTER_INLINE void FILTER_KFN(stats_add)(FilterStatsAcc *a, VEC y) {
+    a->sum = VADD(a->sum, y);
+    a->sq = VFMADD(y, y, a->sq);
+    a->min = VMIN(a->min, y);
+    a->max = VMAX(a->max, y);
+    a->env = VFMADD(a->k, VSUB(VABS(y), a->env), a->env);
+}
+
+FILTER_INLINE void FILTER_KFN(stats_store)(const FilterStatsAcc *a, FilterStatsTypeDef *st, int c) {
+    VSTORE(st->sum + c, a->sum);
+    VSTORE(st->sum_sq + c, a->sq);
+    VSTORE(st->min + c, a->min);
+    VSTORE(st->max + c, a->max);
+    VSTORE(st->env + c, a->env);
+}
+
+// single channel version for the channels left over after the last full vector
+FILTER_INLINE void FILTER_KFN(stats_add1)(FilterStatsTypeDef *st, int c, float y) {
+    st->sum[c] += y;
+    st->sum_sq[c] += y * y;
+    st->min[c] = y < st->min[c] ? y : st->min[c];
+    st->max[c] = y > st->max[c] ? y : st->max[c];
+    st->env[c] += st->env_coeff * (fabsf(y) - st->env[c]);
+}
+
+
+/**
+  * @brief  ˲ں, һȵͨ
+  * @note   ST Ϊڳ: Ϊ 1 ʱͬһѭۼͳ, Ϊ 0 ʱ벻ͳȫͬ.
+  */
+FILTER_INLINE void FILTER_KFN(bank_group)(FilterBankTypeDef *bank, const int ST, int c,
+                                         const float *pi, int in_stride, float *po, int out_stride, int len) {
+    const VEC b0 = VLOAD(bank->b0 + c), b1 = VLOAD(bank->b1 + c), b2 = VLOAD(bank->b2 + c);
+    const VEC a1 = VLOAD(bank->a1 + c), a2 = VLOAD(bank->a2 + c);
+    VEC x1 = VLOAD(bank->x1 + c), x2 = VLOAD(bank->x2 + c);
+    VEC y1 = VLOAD(bank->y1 + c), y2 = VLOAD(bank->y2 + c);
+    FilterStatsAcc acc;
+    int n;
+
+    if(ST) {
+        FILTER_KFN(stats_load)(&acc, bank->stats, c);
+    }
+    for(n = 0; n < len; n++) {
+        VEC x0 = VLOAD(pi);
+        VEC t = VFMADD(b0, x0, VFMADD(b1, x1, VFNMADD(a2, y2, VMUL(b2, x2))));
+        VEC y0 = VFNMADD(a1, y1, t);
+        VSTORE(po, y0);
+        if(ST) {
+            FILTER_KFN(stats_add)(&acc, y0);
+        }
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        pi += in_stride;
+        po += out_stride;
+    }
+    VSTORE(bank->x1 + c, x1);
+    VSTORE(bank->x2 + c, x2);
+    VSTORE(bank->y1 + c, y1);
+    VSTORE(bank->y2 + c, y2);
+    if(ST) {
+        FILTER_KFN(stats_store)(&acc, bank->stats, c);
+    }
+}
+
+
+/**
+  * @brief  ˲ں (ֱ I , ÿԪضӦһͨ)
+  * @note   y[n] = (b[0] * x[n] + b[1] * x[n-1] + b[2] * x[n-2] - a[2] * y[n-2]) - a[1] * y[n-1]
+  *         ݹֻ a[1] * y[n-1] һγ˼. һͨñ봦.
+  *         in  out ָͬһڴ (in_stride == out_stride). ͳʱͬʱۼͳ.
+  * @param  obj:        ˲ṹַ (FilterBankTypeDef)
+  * @param  ch0:        һͨ
+  * @param  lanes:      ͨ
+  * @param  in:         , ͨ ch0 + l  n ʱ̵ĲΪ in[n * in_stride + l]
+  * @param  in_stride:  ʱ̵ļ (float )
+  * @param  out:        , ͬ
+  * @param  out_stride: ʱ̵ļ (float )
+  * @param  len:        
+  * @retval None
+  */
+static void FILTER_KFN(bank)(void *obj, int ch0, int lanes,
+                             const float *in, int in_stride, float *out, int out_stride, int len) {
+    FilterBankTypeDef *bank = (FilterBankTypeDef *)obj;
+    FilterStatsTypeDef *st = bank->stats;
+    int g, n;
+
+    for(g = 0; g + VW <= lanes; g += VW) {
+        if(st != NULL) {
+            FILTER_KFN(bank_group)(bank, 1, ch0 + g, in + g, in_stride, out + g, out_stride, len);
+        }
+        else {
+            FILTER_KFN(bank_group)(bank, 0, ch0 + g, in + g, in_stride, out + g, out_stride, len);
+        }
+    }
+    // remaining channels
+    for(; g < lanes; g++) {
+        const int c = ch0 + g;
+        const float b0 = bank->b0[c], b1 = bank->b1[c], b2 = bank->b2[c];
+        const float a1 = bank->a1[c], a2 = bank->a2[c];
+        float x1 = bank->x1[c], x2 = bank->x2[c];
+        float y1 = bank->y1[c], y2 = bank->y2[c];
+        const float *pi = in + g;
+        float *po = out + g;
+        for(n = 0; n < len; n++) {
+            float x0 = *pi;
+            float y0 = (b0 * x0 + b1 * x1 + b2 * x2 - a2 * y2) - a1 * y1;
+            *po = y0;
+            if(st != NULL) {
+                FILTER_KFN(stats_add1)(st, c, y0);
+            }
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            pi += in_stride;
+            po += out_stride;
+        }
+        bank->x1[c] = x1;
+        bank->x2[c] = x2;
+        bank->y1[c] = y1;
+        bank->y2[c] = y2;
+    }
+}
+
+
+/**
+  * @brief  ˲ں, һȵͨ
+  * @note   S Ϊڳ ( chain ں˰), ѭȫչ, ϵ, ӳߺͼ
+  *         ھֲ, ÿֻһ, дһ. ST ĺͬ bank_group.
+  */
+FILTER_INLINE void FILTER_KFN(chain_group)(FilterChainTypeDef *chain, const int S, const int ST, int c,
+                                          const float *pi, int in_stride, float *po, int out_stride, int len) {
+    VEC k[FILTER_CHAIN_MAX_STAGES][5];
+    VEC h[FILTER_CHAIN_MAX_STAGES + 1][2];
+    VEC v, t;
+    FilterStatsAcc acc;
+    int s, j, n;
+
+    for(s = 0; s < S; s++) {
+        for(j = 0; j < 5; j++) {
+            k[s][j] = VLOAD(chain->coef[s][j] + c);
+        }
+    }
+    for(s = 0; s <= S; s++) {
+        h[s][0] = VLOAD(chain->hist[s][0] + c);
+        h[s][1] = VLOAD(chain->hist[s][1] + c);
+    }
+    if(ST) {
+        FILTER_KFN(stats_load)(&acc, chain->stats, c);
+    }
+    for(n = 0; n < len; n++) {
+        v = VLOAD(pi);
+        for(s = 0; s < S; s++) {
+            // h[s] is the input history of stage s, h[s + 1] its output history
+            t = VFMADD(k[s][0], v, VFMADD(k[s][1], h[s][0], VFNMADD(k[s][4], h[s + 1][1], VMUL(k[s][2], h[s][1]))));
+            h[s][1] = h[s][0];
+            h[s][0] = v;
+            v = VFNMADD(k[s][3], h[s + 1][0], t);
+        }
+        h[S][1] = h[S][0];
+        h[S][0] = v;
+        VSTORE(po, v);
+        if(ST) {
+            FILTER_KFN(stats_add)(&acc, v);
+        }
+        pi += in_stride;
+        po += out_stride;
+    }
+    for(s = 0; s <= S; s++) {
+        VSTORE(chain->hist[s][0] + c, h[s][0]);
+        VSTORE(chain->hist[s][1] + c, h[s][1]);
+    }
+    if(ST) {
+        FILTER_KFN(stats_store)(&acc, chain->stats, c);
+    }
+}
+
+
+/**
+  * @brief  ɵΪڳ chain_group
+  */
+FILTER_INLINE void FILTER_KFN(chain_stages)(FilterChainTypeDef *chain, const int ST, int c,
+                                           const float *pi, int in_stride, float *po, int out_stride, int len) {
+    switch(chain->stages) {
+        case 1: FILTER_KFN(chain_group)(chain, 1, ST, c, pi, in_stride, po, out_stride, len); break;
+        case 2: FILTER_KFN(chain_group)(chain, 2, ST, c, pi, in_stride, po, out_stride, len); break;
+        case 3: FILTER_KFN(chain_group)(chain, 3, ST, c, pi, in_stride, po, out_stride, len); break;
+        case 4: FILTER_KFN(chain_group)(chain, 4, ST, c, pi, in_stride, po, out_stride, len); break;
+        case 5: FILTER_KFN(chain_group)(chain, 5, ST, c, pi, in_stride, po, out_stride, len); break;
+        case 6: FILTER_KFN(chain_group)(chain, 6, ST, c, pi, in_stride, po, out_stride, len); break;
+        case 7: FILTER_KFN(chain_group)(chain, 7, ST, c, pi, in_stride, po, out_stride, len); break;
+        default: FILTER_KFN(chain_group)(chain, FILTER_CHAIN_MAX_STAGES, ST, c, pi, in_stride, po, out_stride, len); break;
+    }
+}
+
+
+/**
+  * @brief  ں˲ں
+  * @note   ˲ںͬ, obj Ϊ FilterChainTypeDef. һͨñ봦.
+  *         ͳʱͬʱۼͳ.
+  */
+static void FILTER_KFN(chain)(void *obj, int ch0, int lanes,
+                              const float *in, int in_stride, float *out, int out_stride, int len) {
+    FilterChainTypeDef *chain = (FilterChainTypeDef *)obj;
+    const int S = chain->stages;
+    int g, n, s;
+
+    for(g = 0; g + VW <= lanes; g += VW) {
+        const float *pi = in + g;
+        float *po = out + g;
+        if(chain->stats != NULL) {
+            FILTER_KFN(chain_stages)(chain, 1, ch0 + g, pi, in_stride, po, out_stride, len);
+        }
+        else {
+            FILTER_KFN(chain_stages)(chain, 0, ch0 + g, pi, in_stride, po, out_stride, len);
+        }
+    }
+    // remaining channels, delay lines stay in the chain arrays
+    for(; g < lanes; g++) {
+        const int c = ch0 + g;
+        const float *pi = in + g;
+        float *po = out + g;
+        for(n = 0; n < len; n++) {
+            float v = *pi;
+            for(s = 0; s < S; s++) {
+                float *const *k = chain->coef[s];
+                float y = (k[0][c] * v + k[1][c] * chain->hist[s][0][c] + k[2][c] * chain->hist[s][1][c]
+                           - k[4][c] * chain->hist[s + 1][1][c]) - k[3][c] * chain->hist[s + 1][0][c];
+                chain->hist[s][1][c] = chain->hist[s][0][c];
+                chain->hist[s][0][c] = v;
+                v = y;
+            }
+            chain->hist[S][1][c] = chain->hist[S][0][c];
+            chain->hist[S][0][c] = v;
+            *po = v;
+            if(chain->stats != NULL) {
+                FILTER_KFN(stats_add1)(chain->stats, c, v);
+            }
+            pi += in_stride;
+            po += out_stride;
+        }
+    }
+}
+
+
+/**
+  * @brief  ƵӦں, ÿԪضӦһƵ
+  * @note   z^-1 = cos(w) - j*sin(w), z^-2 = cos(2w) - j*sin(2w). ÿһ:
+  *         B = b0 + b1*z^-1 + b2*z^-2, A = 1 + a1*z^-1 + a2*z^-2, H *= B / A,
+  *         Ⱥӳ += Re((b1*z^-1 + 2*b2*z^-2) / B) - Re((a1*z^-1 + 2*a2*z^-2) / A) (λ: ).
+  *         һƵʽں˴.
+  * @param  coef:       ϵ b0, b1, b2, a1, a2 (stages * 5 , a0 ѹһΪ 1)
+  * @param  stages:     
+  * @param  cw:         cos(w)
+  * @param  sw:         sin(w)
+  * @param  n:          Ƶʸ
+  * @param  hr:         , Ӧʵ
+  * @param  hi:         , Ӧ鲿
+  * @param  gd:         , Ⱥӳ ()
+  * @retval None
+  */
+static void FILTER_KFN(freqz)(const float *coef, int stages, const float *cw, const float *sw, int n,
+                              float *hr, float *hi, float *gd) {
+    const VEC one = VSET1(1.0f), two = VSET1(2.0f), tiny = VSET1(1e-30f);
+    int i, st;
+
+    for(i = 0; i + VW <= n; i += VW) {
+        const VEC c = VLOAD(cw + i), s = VLOAD(sw + i);
+        const VEC c2 = VFNMADD(one, one, VMUL(two, VMUL(c, c)));   // cos(2w) = 2cos^2(w) - 1
+        const VEC s2 = VMUL(two, VMUL(s, c));                       // sin(2w) = 2sin(w)cos(w)
+        VEC Hr = one, Hi = VZERO(), G = VZERO();
+        for(st = 0; st < stages; st++) {
+            const float *k = coef + st * 5;
+            const VEC b0 = VSET1(k[0]), b1 = VSET1(k[1]), b2 = VSET1(k[2]);
+            const VEC a1 = VSET1(k[3]), a2 = VSET1(k[4]);
+            const VEC Br = VFMADD(b2, c2, VFMADD(b1, c, b0));
+            const VEC Bi = VSUB(VZERO(), VFMADD(b2, s2, VMUL(b1, s)));
+            const VEC Ar = VFMADD(a2, c2, VFMADD(a1, c, one));
+            const VEC Ai = VSUB(VZERO(), VFMADD(a2, s2, VMUL(a1, s)));
+            const VEC Dbr = VFMADD(VMUL(two, b2), c2, VMUL(b1, c));
+            const VEC Dbi = VSUB(VZERO(), VFMADD(VMUL(two, b2), s2, VMUL(b1, s)));
+            const VEC Dar = VFMADD(VMUL(two, a2), c2, VMUL(a1, c));
+            const VEC Dai = VSUB(VZERO(), VFMADD(VMUL(two, a2), s2, VMUL(a1, s)));
+            const VEC Bm = VADD(VFMADD(Br, Br, VMUL(Bi, Bi)), tiny);
+            const VEC Am = VFMADD(Ar, Ar, VMUL(Ai, Ai));
+            // H = H * B / A
+            const VEC Tr = VFNMADD(Hi, Bi, VMUL(Hr, Br));
+            const VEC Ti = VFMADD(Hi, Br, VMUL(Hr, Bi));
+            Hr = VDIV(VFMADD(Ti, Ai, VMUL(Tr, Ar)), Am);
+            Hi = VDIV(VFNMADD(Tr, Ai, VMUL(Ti, Ar)), Am);
+            G = VADD(G, VSUB(VDIV(VFMADD(Dbi, Bi, VMUL(Dbr, Br)), Bm), VDIV(VFMADD(Dai, Ai, VMUL(Dar, Ar)), Am)));
+        }
+        VSTORE(hr + i, Hr);
+        VSTORE(hi + i, Hi);
+        VSTORE(gd + i, G);
+    }
+#if VW > 1
+    if(i < n) {
+        filter_kernels_scalar.freqz(coef, stages, cw + i, sw + i, n - i, hr + i, hi + i, gd + i);
+    }
+#endif
+}
+
+
+/**
+  * @brief  Goertzel ں, ÿԪضӦһͨ
+  * @note   Ƶѭ, ÿƵֻ״̬פĴ,  (פ L1 cache) Ƶظȡ.
+  *         ͨƽƵѭ֮ǰۼһ, Ƶ޹ (ûƵʱҲۼ), βһ.
+  *         obj Ϊ ToneMonitorTypeDef, û (out ʹ).
+  */
+static void FILTER_KFN(goertzel)(void *obj, int ch0, int lanes,
+                                 const float *in, int in_stride, float *out, int out_stride, int len) {
+    ToneMonitorTypeDef *mon = (ToneMonitorTypeDef *)obj;
+    const int C = mon->channels;
+    int g, n, b;
+
+    (void)out;
+    (void)out_stride;
+    for(g = 0; g + VW <= lanes; g += VW) {
+        const int c = ch0 + g;
+        VEC e = VLOAD(mon->energy + c);
+        const float *pe = in + g;
+        for(n = 0; n < len; n++) {
+            VEC x = VLOAD(pe);
+            e = VADD(e, VMUL(x, x));
+            pe += in_stride;
+        }
+        VSTORE(mon->energy + c, e);
+        for(b = 0; b < mon->bins; b++) {
+            const VEC k = VSET1(mon->coeff[b]);
+            VEC s1 = VLOAD(mon->s1 + b * C + c), s2 = VLOAD(mon->s2 + b * C + c);
+            const float *pi = in + g;
+            for(n = 0; n < len; n++) {
+                VEC s0 = VFMADD(k, s1, VSUB(VLOAD(pi), s2));
+                s2 = s1;
+                s1 = s0;
+                pi += in_stride;
+            }
+            VSTORE(mon->s1 + b * C + c, s1);
+            VSTORE(mon->s2 + b * C + c, s2);
+        }
+    }
+    // remaining channels
+    for(; g < lanes; g++) {
+        const int c = ch0 + g;
+        for(n = 0; n < len; n++) {
+            const float x = in[(size_t)n * in_stride + g];
+            mon->energy[c] += x * x;
+            for(b = 0; b < mon->bins; b++) {
+                const float s0 = x + mon->coeff[b] * mon->s1[b * C + c] - mon->s2[b * C + c];
+                mon->s2[b * C + c] = mon->s1[b * C + c];
+                mon->s1[b * C + c] = s0;
+            }
+        }
+    }
+}
+
+
+/**
+  * @brief  һͨ (һʱ)
+  */
+FILTER_INLINE VEC FILTER_KFN(spectrum_load)(const float *p, int lanes, float *tmp) {
+    int l;
+
+    if(lanes == VW) {
+        return VLOAD(p);
+    }
+    for(l = 0; l < VW; l++) {
+        tmp[l] = l < lanes ? p[l] : 0.0f;
+    }
+    return VLOAD(tmp);
+}
+
+
+/**
+  * @brief  洢 (add = 1 ʱۼ) һͨǰ lanes Ԫ
+  */
+FILTER_INLINE void FILTER_KFN(spectrum_store)(float *p, VEC v, int lanes, int add, float *tmp) {
+    int l;
+
+    if(lanes == VW) {
+        VSTORE(p, add ? VADD(VLOAD(p), v) : v);
+        return;
+    }
+    VSTORE(tmp, v);
+    for(l = 0; l < lanes; l++) {
+        p[l] = add ? p[l] + tmp[l] : tmp[l];
+    }
+}
+
+
+/**
+  * @brief  Welch / STFT ֶں, ÿԪضӦһͨ
+  * @note   nfft ʵΰż/ nfft/2 㸴 z[m] = x[2m] + i x[2m+1], װ빤ʱͬʱ
+  *         ȥֵ, Ӵλת (ʵ鲿ڴ, ߵַ 4 KB );  2 ֳ X[k] (k = 0 ~ nfft/2):
+  *             X[k] = E[k] - i W^k O[k], E = (Z[k] + Z*[M-k]) / 2, O = (Z[k] - Z*[M-k]) / 2, W = exp(-2 pi i / nfft)
+  *         |X[k]|^2 ۼӵ acc, on_frame Ϊ NULL ʱͬʱд power (δ). һͨͬһݴ.
+  */
+static void FILTER_KFN(spectrum)(FilterSpectrumTypeDef *spec, int start) {
+    const int C = spec->channels, N = spec->nfft, M = N / 2;
+    const float *tc = spec->tw_cos, *ts = spec->tw_sin;
+    float *z = spec->work;
+    float tmp[VW];
+    int c, lanes, m, t, h, j, i, k;
+
+    for(c = 0; c < C; c += VW) {
+        const float *ring = spec->ring + c;
+        VEC mean = VZERO();
+        lanes = C - c < VW ? C - c : VW;
+        if(spec->detrend) {
+            VEC sum = VZERO();
+            for(t = 0; t < N; t++) {
+                sum = VADD(sum, FILTER_KFN(spectrum_load)(ring + (size_t)t * C, lanes, tmp));
+            }
+            mean = VMUL(sum, VSET1(1.0f / (float)N));
+        }
+        // detrend, window, even/odd packing and bit reversal in one pass over the ring
+        for(m = 0, t = start; m < M; m++) {
+            const int r = spec->rev[m];
+            VEC x0 = FILTER_KFN(spectrum_load)(ring + (size_t)t * C, lanes, tmp);
+            VEC x1 = FILTER_KFN(spectrum_load)(ring + (size_t)((t + 1) & (N - 1)) * C, lanes, tmp);
+            VSTORE(z + (size_t)r * 2 * VW, VMUL(VSUB(x0, mean), VSET1(spec->window[2 * m])));
+            VSTORE(z + (size_t)r * 2 * VW + VW, VMUL(VSUB(x1, mean), VSET1(spec->window[2 * m + 1])));
+            t = (t + 2) & (N - 1);
+        }
+        // radix-2 butterflies, twiddle of stage h is exp(-2 pi i j / 2h) = W^(j * M / h);
+        // one radix-2 stage when log2(M) is odd, then stages h and 2h fused (radix-2^2) to halve the passes over z
+        h = 1;
+        if((M & 0x55555555) == 0) {
+            for(i = 0; i < M; i += 2) {
+                float *a = z + (size_t)i * 2 * VW, *b = a + 2 * VW;
+                VEC xr = VLOAD(b), xi = VLOAD(b + VW), yr = VLOAD(a), yi = VLOAD(a + VW);
+                VSTORE(a, VADD(yr, xr));
+                VSTORE(a + VW, VADD(yi, xi));
+                VSTORE(b, VSUB(yr, xr));
+                VSTORE(b + VW, VSUB(yi, xi));
+            }
+            h = 2;
+        }
+        for(; h < M; h *= 4) {
+            const int step = M / h;
+            for(j = 0; j < h; j++) {
+                const VEC w1r = VSET1(tc[j * step]), w1i = VSET1(ts[j * step]);
+                const VEC w2r = VSET1(tc[j * step / 2]), w2i = VSET1(ts[j * step / 2]);
+                for(i = j; i < M; i += 4 * h) {
+                    float *p0 = z + (size_t)i * 2 * VW, *p1 = p0 + (size_t)h * 2 * VW;
+                    float *p2 = p1 + (size_t)h * 2 * VW, *p3 = p2 + (size_t)h * 2 * VW;
+                    VEC a0r = VLOAD(p0), a0i = VLOAD(p0 + VW), a1r = VLOAD(p1), a1i = VLOAD(p1 + VW);
+                    VEC a2r = VLOAD(p2), a2i = VLOAD(p2 + VW), a3r = VLOAD(p3), a3i = VLOAD(p3 + VW);
+                    // stage h: (a0, a1) and (a2, a3) with W^(j * M / h)
+                    VEC tr = VFMADD(a1r, w1r, VMUL(a1i, w1i)), ti = VFNMADD(a1r, w1i, VMUL(a1i, w1r));
+                    VEC b0r = VADD(a0r, tr), b0i = VADD(a0i, ti), b1r = VSUB(a0r, tr), b1i = VSUB(a0i, ti);
+                    VEC ur = VFMADD(a3r, w1r, VMUL(a3i, w1i)), ui = VFNMADD(a3r, w1i, VMUL(a3i, w1r));
+                    VEC b2r = VADD(a2r, ur), b2i = VADD(a2i, ui), b3r = VSUB(a2r, ur), b3i = VSUB(a2i, ui);
+                    // stage 2h: (b0, b2) with W^(j * M / 2h), (b1, b3) with the same twiddle times -i
+                    tr = VFMADD(b2r, w2r, VMUL(b2i, w2i));
+                    ti = VFNMADD(b2r, w2i, VMUL(b2i, w2r));
+                    ur = VFMADD(b3r, w2r, VMUL(b3i, w2i));
+                    ui = VFNMADD(b3r, w2i, VMUL(b3i, w2r));
+                    VSTORE(p0, VADD(b0r, tr));
+                    VSTORE(p0 + VW, VADD(b0i, ti));
+                    VSTORE(p2, VSUB(b0r, tr));
+                    VSTORE(p2 + VW, VSUB(b0i, ti));
+                    VSTORE(p1, VADD(b1r, ui));
+                    VSTORE(p1 + VW, VSUB(b1i, ur));
+                    VSTORE(p3, VSUB(b1r, ui));
+                    VSTORE(p3 + VW, VADD(b1i, ur));
+                }
+            }
+        }
+        // split into the real transform and accumulate |X[k]|^2
+        for(k = 0; k <= M; k++) {
+            VEC p;
+            if(k == 0 || k == M) {
+                VEC zr = VLOAD(z), zi = VLOAD(z + VW);
+                VEC x = k == 0 ? VADD(zr, zi) : VSUB(zr, zi);
+                p = VMUL(x, x);
+            }
+            else {
+                const VEC half = VSET1(0.5f), wr = VSET1(tc[k]), wi = VSET1(ts[k]);
+                VEC ar = VLOAD(z + (size_t)k * 2 * VW), ai = VLOAD(z + (size_t)k * 2 * VW + VW);
+                VEC br = VLOAD(z + (size_t)(M - k) * 2 * VW), bi = VLOAD(z + (size_t)(M - k) * 2 * VW + VW);
+                VEC er = VMUL(VADD(ar, br), half), ei = VMUL(VSUB(ai, bi), half);
+                VEC or_ = VMUL(VSUB(ar, br), half), oi = VMUL(VADD(ai, bi), half);
+                VEC xr = VFNMADD(wi, or_, VFMADD(wr, oi, er));
+                VEC xi = VFNMADD(wi, oi, VFNMADD(wr, or_, ei));
+                p = VFMADD(xr, xr, VMUL(xi, xi));
+            }
+            FILTER_KFN(spectrum_store)(spec->acc + (size_t)k * C + c, p, lanes, 1, tmp);
+            if(spec->on_frame != NULL) {
+                FILTER_KFN(spectrum_store)(spec->power + (size_t)k * C + c, p, lanes, 0, tmp);
+            }
+        }
+    }
+}
+
+
+/**
+  * @brief  16 λתΪ float (n )
+  * @note   fp16 ʹ F16C (AVX2 汾) / AVX-512F  vcvtph2ps; bf16 ֻ 16 λ.
+  *         һĲԼ SSE4 / 汾 filter_half_to_f32.
+  */
+static void FILTER_KFN(half_load)(FilterSampleType fmt, const uint16_t *src, float *dst, int n) {
+    int i = 0;
+
+#if defined(FILTER_SIMD_AVX512)
+    if(fmt == FILTER_SAMPLE_F16) {
+        for(; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(src + i))));
+        }
+    }
+    else {
+        for(; i + 16 <= n; i += 16) {
+            __m512i w = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(src + i)));
+            _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(_mm512_slli_epi32(w, 16)));
+        }
+    }
+#elif defined(FILTER_SIMD_AVX2)
+    if(fmt == FILTER_SAMPLE_F16) {
+        for(; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+        }
+    }
+    else {
+        for(; i + 8 <= n; i += 8) {
+            __m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(_mm256_slli_epi32(w, 16)));
+        }
+    }
+#endif
+    for(; i < n; i++) {
+        dst[i] = filter_half_to_f32(fmt, src[i]);
+    }
+}
+
+
+/**
+  * @brief  float תΪ 16 λ (n , 뵽ż)
+  * @note   bf16: (x + 0x7fff + ((x >> 16) & 1)) >> 16, NaN Ϊ quiet NaN.
+  */
+static void FILTER_KFN(half_store)(FilterSampleType fmt, const float *src, uint16_t *dst, int n) {
+    int i = 0;
+
+#if defined(FILTER_SIMD_AVX512)
+    if(fmt == FILTER_SAMPLE_F16) {
+        for(; i + 16 <= n; i += 16) {
+            _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+        }
+    }
+    else {
+        const __m512i one = _mm512_set1_epi32(1), bias = _mm512_set1_epi32(0x7fff), qnan = _mm512_set1_epi32(0x40);
+        for(; i + 16 <= n; i += 16) {
+            __m512 v = _mm512_loadu_ps(src + i);
+            __m512i x = _mm512_castps_si512(v);
+            __m512i r = _mm512_srli_epi32(_mm512_add_epi32(_mm512_add_epi32(x, bias),
+                                                           _mm512_and_si512(_mm512_srli_epi32(x, 16), one)), 16);
+            __m512i q = _mm512_or_si512(_mm512_srli_epi32(x, 16), qnan);
+            r = _mm512_mask_blend_epi32(_mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q), r, q);
+            _mm256_storeu_si256((__m256i *)(dst + i), _mm512_cvtepi32_epi16(r));
+        }
+    }
+#elif defined(FILTER_SIMD_AVX2)
+    if(fmt == FILTER_SAMPLE_F16) {
+        for(; i + 8 <= n; i += 8) {
+            _mm_storeu_si128((__m128i *)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+        }
+    }
+    else {
+        const __m256i one = _mm256_set1_epi32(1), bias = _mm256_set1_epi32(0x7fff), qnan = _mm256_set1_epi32(0x40);
+        for(; i + 8 <= n; i += 8) {
+            __m256 v = _mm256_loadu_ps(src + i);
+            __m256i x = _mm256_castps_si256(v);
+            __m256i r = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(x, bias),
+                                                           _mm256_and_si256(_mm256_srli_epi32(x, 16), one)), 16);
+            __m256i q = _mm256_or_si256(_mm256_srli_epi32(x, 16), qnan);
+            r = _mm256_blendv_epi8(r, q, _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+            // values are < 2^16, packus keeps them; gather the two 64 bit halves of each lane
+            r = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0x08);
+            _mm_storeu_si128((__m128i *)(dst + i), _mm256_castsi256_si128(r));
+        }
+    }
+#endif
+    for(; i < n; i++) {
+        dst[i] = filter_f32_to_half(fmt, src[i]);
+    }
+}
+
+
+// kernel table of this instruction set
+const FilterKernelTable FILTER_KFN(kernels) = {
+    FILTER_SIMD_ISA,
+    FILTER_SIMD_NAME,
+    VW,
+    FILTER_KFN(bank),
+    FILTER_KFN(chain),
+    FILTER_KFN(freqz),
+    FILTER_KFN(goertzel),
+    FILTER_KFN(half_load),
+    FILTER_KFN(half_store),
+    FILTER_KFN(spectrum),
+};
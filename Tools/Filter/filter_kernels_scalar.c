@@ -0,0 +1,11 @@
+/**
+  ******************************************************************************
+  * @file           : filter_kernels_scalar.c
+  * @brief          : ˲ں˱汾, ƽ̨, Ϊû SIMD ֧ʱĺʵ
+  * @attention      : ںʵּ filter_kernels_impl.h
+
+  ******************************************************************************
+  */
+
+#define FILTER_SIMD_SCALAR
+#include "filter_kernels_impl.h"
@@ -0,0 +1,11 @@
+/**
+  ******************************************************************************
+  * @file           : filter_kernels_sse4.c
+  * @brief          : ˲ں SSE4.1 汾 (ѡ -msse4.1)
+  * @attention      : ںʵּ filter_kernels_impl.h
+
+  ******************************************************************************
+  */
+
+#define FILTER_SIMD_SSE4
+#include "filter_kernels_impl.h"
@@ -0,0 +1,238 @@
+# -*- coding: utf-8 -*-
+"""
+filter_native.py: libfilter_abi (filter_abi.h) 的 ctypes 封装
+
+Python 验证脚本通过本模块直接调用与固件/主机相同的生产内核, 不再用纯 Python 重新实现滤波.
+numpy 数组按原步长传入, 不复制数据 (要求 float32; 其它类型先转换一次).
+
+库文件查找顺序: 环境变量 FILTER_ABI_LIB, 本文件所在目录, 本目录下的 _build / build.
+
+示例:
+    import numpy as np
+    import filter_native as fn
+
+    chain = fn.Chain(64, 2000.0, [(fn.NOTCH, 50, 0, 0), (fn.HIGHPASS, 0, 0, 1)])
+    x = np.random.randn(64, 20000).astype(np.float32)
+    y = chain.process(x)                    # 每行一个通道
+    y = chain.process(x.T, axis=0)          # 每列一个通道 (交织帧), 不复制
+    mag_db, phase, gd = fn.freqz(chain.sos, 2000.0, np.linspace(0, 1000, 512))
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+ABI_VERSION = 1
+
+# 滤波器类型, 与 filter.h 中的 FilterClassType 一致
+NOTCH = 1
+LOWPASS = 2
+HIGHPASS = 3
+BANDPASS = 4
+BANDSTOP = 5
+
+_f32p = ctypes.POINTER(ctypes.c_float)
+_f64p = ctypes.POINTER(ctypes.c_double)
+
+
+def _find_library():
+    env = os.environ.get("FILTER_ABI_LIB")
+    if env:
+        return env
+    here = os.path.dirname(os.path.abspath(__file__))
+    if os.name == "nt":
+        names = ["filter_abi.dll", "libfilter_abi.dll"]
+    elif os.uname().sysname == "Darwin":
+        names = ["libfilter_abi.dylib"]
+    else:
+        names = ["libfilter_abi.so"]
+    for sub in ("", "_build", "build"):
+        for name in names:
+            path = os.path.join(here, sub, name)
+            if os.path.exists(path):
+                return path
+    raise OSError("libfilter_abi not found, build Tools/Filter with cmake or set FILTER_ABI_LIB")
+
+
+def _load():
+    lib = ctypes.CDLL(_find_library())
+    lib.filter_abi_version.restype = ctypes.c_int
+    lib.filter_abi_version.argtypes = []
+    lib.filter_abi_isa.restype = ctypes.c_char_p
+    lib.filter_abi_isa.argtypes = []
+    lib.filter_abi_select_isa.restype = ctypes.c_int
+    lib.filter_abi_select_isa.argtypes = [ctypes.c_char_p]
+    lib.filter_abi_design.restype = ctypes.c_int
+    lib.filter_abi_design.argtypes = [ctypes.c_int, ctypes.c_double, ctypes.c_double, ctypes.c_double,
+                                      ctypes.c_double, _f64p]
+    lib.filter_abi_chain_create.restype = ctypes.c_void_p
+    lib.filter_abi_chain_create.argtypes = [ctypes.c_int, ctypes.c_double, ctypes.c_int,
+                                            ctypes.POINTER(ctypes.c_int), _f64p]
+    lib.filter_abi_chain_create_sos.restype = ctypes.c_void_p
+    lib.filter_abi_chain_create_sos.argtypes = [ctypes.c_int, ctypes.c_int, _f64p, ctypes.c_int64]
+    lib.filter_abi_chain_destroy.restype = None
+    lib.filter_abi_chain_destroy.argtypes = [ctypes.c_void_p]
+    lib.filter_abi_chain_reset.restype = None
+    lib.filter_abi_chain_reset.argtypes = [ctypes.c_void_p]
+    lib.filter_abi_chain_process.restype = ctypes.c_int
+    lib.filter_abi_chain_process.argtypes = [ctypes.c_void_p, _f32p, ctypes.c_int64, ctypes.c_int64,
+                                             _f32p, ctypes.c_int64, ctypes.c_int64, ctypes.c_int64]
+    lib.filter_abi_freqz.restype = ctypes.c_int
+    lib.filter_abi_freqz.argtypes = [ctypes.c_int, _f64p, ctypes.c_double, _f64p, ctypes.c_int,
+                                     _f64p, _f64p, _f64p]
+    if lib.filter_abi_version() != ABI_VERSION:
+        raise OSError("libfilter_abi version %d, expected %d" % (lib.filter_abi_version(), ABI_VERSION))
+    return lib
+
+
+_lib = _load()
+
+
+def isa():
+    """
+    当前使用的内核指令集
+    Returns:
+        name (str): "scalar", "sse4", "avx2" 或 "avx512"
+    """
+    return _lib.filter_abi_isa().decode()
+
+
+def select_isa(name):
+    """
+    选择内核指令集 (对比不同指令集的结果)
+    Args:
+        name (str): "scalar", "sse4", "avx2" 或 "avx512"
+    """
+    if _lib.filter_abi_select_isa(name.encode()) != 0:
+        raise ValueError("ISA %r not available" % name)
+
+
+def design(filter_class, sample_freq, notch_cut=0.0, low_cut=0.0, high_cut=0.0):
+    """
+    用生产代码 (init_filter) 设计一级滤波器
+    Args:
+        filter_class (int): NOTCH / LOWPASS / HIGHPASS / BANDPASS / BANDSTOP
+        sample_freq (float): 采样频率 (Hz)
+        notch_cut (float): 陷波频率 (Hz)
+        low_cut (float): 低通频率 (Hz)
+        high_cut (float): 高通频率 (Hz)
+    Returns:
+        sos (numpy.ndarray): [b0, b1, b2, 1, a1, a2], 即固件实际使用的 float 系数, 可直接用于 scipy.signal
+    """
+    sos = np.zeros(6)
+    if _lib.filter_abi_design(filter_class, sample_freq, notch_cut, low_cut, high_cut,
+                              sos.ctypes.data_as(_f64p)) != 0:
+        raise ValueError("invalid filter class %r" % filter_class)
+    return sos
+
+
+def freqz(sos, sample_freq, freqs):
+    """
+    用生产代码 (filter_freqz) 计算级联二阶节的频率响应
+    Args:
+        sos (array_like): 形状 (n_stages, 6), 每行 [b0, b1, b2, a0, a1, a2]
+        sample_freq (float): 采样频率 (Hz)
+        freqs (array_like): 频率 (Hz)
+    Returns:
+        mag_db (numpy.ndarray): 幅度 (dB)
+        phase (numpy.ndarray): 相位 (弧度)
+        group_delay (numpy.ndarray): 群延迟 (采样点)
+    """
+    sos = np.ascontiguousarray(np.atleast_2d(sos), dtype=np.float64)
+    if sos.ndim != 2 or sos.shape[1] != 6:
+        raise ValueError("sos must have shape (n_stages, 6)")
+    freqs = np.ascontiguousarray(freqs, dtype=np.float64).ravel()
+    mag_db = np.empty_like(freqs)
+    phase = np.empty_like(freqs)
+    gd = np.empty_like(freqs)
+    if _lib.filter_abi_freqz(sos.shape[0], sos.ctypes.data_as(_f64p), sample_freq,
+                             freqs.ctypes.data_as(_f64p), freqs.size, mag_db.ctypes.data_as(_f64p),
+                             phase.ctypes.data_as(_f64p), gd.ctypes.data_as(_f64p)) != 0:
+        raise ValueError("invalid sos")
+    return mag_db, phase, gd
+
+
+class Chain:
+    """
+    多通道滤波器链 (FilterChainTypeDef), 状态在多次 process 之间保持
+    """
+
+    def __init__(self, channels, sample_freq=None, stages=None, sos=None):
+        """
+        Args:
+            channels (int): 通道数
+            sample_freq (float): 采样频率 (Hz), 按类型设计时使用
+            stages (list): 按类型设计, 每级 (filter_class, notch_cut, low_cut, high_cut)
+            sos (array_like): 或直接给系数, 形状 (n_stages, 6) 所有通道相同, 或 (channels, n_stages, 6) 每通道不同
+        """
+        self.channels = int(channels)
+        self._h = None
+        if sos is None:
+            classes = (ctypes.c_int * len(stages))(*[int(s[0]) for s in stages])
+            cuts = np.array([s[1:4] for s in stages], dtype=np.float64)
+            self._h = _lib.filter_abi_chain_create(self.channels, sample_freq, len(stages), classes,
+                                                   cuts.ctypes.data_as(_f64p))
+            self.sos = np.array([design(s[0], sample_freq, *s[1:4]) for s in stages])
+        else:
+            sos = np.ascontiguousarray(sos, dtype=np.float64)
+            if sos.ndim not in (2, 3) or sos.shape[-1] != 6:
+                raise ValueError("sos must have shape (n_stages, 6) or (channels, n_stages, 6)")
+            if sos.ndim == 3 and sos.shape[0] != self.channels:
+                raise ValueError("sos has %d channels, chain has %d channels" % (sos.shape[0], self.channels))
+            ch_stride = 0 if sos.ndim == 2 else sos.shape[1] * 6
+            self._h = _lib.filter_abi_chain_create_sos(self.channels, sos.shape[-2], sos.ctypes.data_as(_f64p),
+                                                       ch_stride)
+            self.sos = sos
+        if not self._h:
+            raise ValueError("invalid chain parameters")
+
+    def __del__(self):
+        if self._h:
+            _lib.filter_abi_chain_destroy(self._h)
+            self._h = None
+
+    def reset(self):
+        """
+        清零所有通道的延迟线
+        """
+        _lib.filter_abi_chain_reset(self._h)
+
+    def process(self, x, axis=-1, out=None):
+        """
+        滤波 (生产内核, 按步长直接读写 numpy 数组)
+        Args:
+            x (numpy.ndarray): 二维输入, 单通道时也可以是一维; 非 float32 时先转换
+            axis (int): 时间轴, 另一维为通道 (长度必须等于 channels)
+            out (numpy.ndarray): 输出, 形状与 x 相同的 float32 数组, 可以是 x 本身 (原地滤波); None 时新分配
+        Returns:
+            y (numpy.ndarray): 滤波结果
+        """
+        x = np.asarray(x)
+        if x.dtype != np.float32:
+            x = x.astype(np.float32)
+        if x.ndim not in (1, 2):
+            raise ValueError("x must be 1-D or 2-D")
+        transpose = x.ndim == 2 and axis % 2 == 0
+        x2 = x[np.newaxis] if x.ndim == 1 else x
+        if transpose:
+            x2 = x2.T
+        if x2.shape[0] != self.channels:
+            raise ValueError("channel axis has %d entries, chain has %d channels" % (x2.shape[0], self.channels))
+        if out is None:
+            out = np.empty_like(x, order="K")
+        if out.dtype != np.float32 or out.shape != x.shape:
+            raise ValueError("out must be a float32 array shaped like x")
+        o2 = out[np.newaxis] if out.ndim == 1 else out
+        if transpose:
+            o2 = o2.T
+        isz = x2.itemsize
+        if any(st % isz for st in x2.strides + o2.strides):
+            raise ValueError("strides must be multiples of the element size")
+        ret = _lib.filter_abi_chain_process(self._h, x2.ctypes.data_as(_f32p),
+                                            x2.strides[0] // isz, x2.strides[1] // isz,
+                                            o2.ctypes.data_as(_f32p),
+                                            o2.strides[0] // isz, o2.strides[1] // isz, x2.shape[1])
+        if ret != 0:
+            raise ValueError("filter_abi_chain_process failed")
+        return out
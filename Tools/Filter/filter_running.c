@@ -0,0 +1,456 @@
+/**
+  ******************************************************************************
+  * @file           : filter_running.c
+  * @brief          : ƽȡ˲ļ.
+                      ƽ: sum += x[n] - x[n-W], y[n] = sum / W                      O(1)
+                      CIC:      N  (ȫ) -> ȡ R -> N ״ (),  R^N   O(N)
+                      ֵ: ֵΪĵĴ󶥶 + С, λɾɵĲ       O(log W)
+  * @attention      :
+                      ʹʾ (ο):
+
+                        RunningFilterTypeDef ma, cic; // 廬˲ṹ
+
+                        int main(void) {
+
+                            init_running_filter(&ma, MOVING_AVERAGE, 64, 4000, 0); // 64 ͨ, 4000 㻬ƽ
+                            init_running_filter(&cic, CIC_DECIMATOR, 64, 16, 3);  // 64 ͨ, 3  CIC, 16 ȡ
+
+                            while(1) {
+
+                                apply_running_filter(&ma, xn, yn, 256);           // ÿͨ 256 
+                                n = apply_running_filter(&cic, xn, zn, 256);      // ÿͨ n 
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_running.h"
+#include "filter_instr.h"
+
+#define RUNNING_TILE_LEN        256     // ֯֡ʱÿδ֡, ʹͨõ֡ cache 
+
+// ͨĻֵ˫ͼ
+typedef struct {
+    float *data;    // λ (ڵĲ)
+    int *heap;      // ָѴ洢м: heap[0] Ϊֵ, heap[-1], heap[-2] ... Ϊ󶥶, heap[1], heap[2] ... ΪС
+    int *pos;       // data ± -> λ
+    int *min_ct;    // СԪ
+    int *max_ct;    // 󶥶Ԫ
+    int n;          // 
+} RunningMedianView;
+
+
+/**
+  * @brief  ˲ʼ
+  * @param  filter:     ˲ṹַ
+  * @param  class:      ˲
+  * @param  channels:   ͨ
+  * @param  window:      (MOVING_AVERAGE / MOVING_MEDIAN) ȡ R (CIC_DECIMATOR)
+  * @param  stages:     CIC  N (1 ~ RUNNING_CIC_MAX_STAGES), ͺ
+  * @retval 0: ɹ; -1: ڴʧ
+  */
+int init_running_filter(RunningFilterTypeDef *filter, RunningFilterClassType class, int channels, int window, int stages) {
+
+    const size_t C = (size_t)channels, W = (size_t)window;
+    size_t bytes;
+    char *p;
+
+    memset(filter, 0, sizeof(*filter));
+    if(channels <= 0 || window <= 0) {
+        return -1;
+    }
+    if(class == MOVING_AVERAGE) {
+        bytes = C * sizeof(double) + C * W * sizeof(float);
+    }
+    else if(class == CIC_DECIMATOR) {
+        if(stages <= 0 || stages > RUNNING_CIC_MAX_STAGES) {
+            return -1;
+        }
+        bytes = C * 2 * (size_t)stages * sizeof(int64_t);
+    }
+    else if(class == MOVING_MEDIAN) {
+        bytes = C * W * (sizeof(float) + 2 * sizeof(int)) + C * 2 * sizeof(int);
+    }
+    else {
+        return -1;
+    }
+    filter->mem = calloc(1, bytes);
+    if(filter->mem == NULL) {
+        return -1;
+    }
+    filter->class = class;
+    filter->channels = channels;
+    filter->window = window;
+    filter->stages = stages;
+    // 8 byte members first to keep them aligned
+    p = (char *)filter->mem;
+    if(class == MOVING_AVERAGE) {
+        filter->sum = (double *)p;
+        filter->ring = (float *)(p + C * sizeof(double));
+    }
+    else if(class == CIC_DECIMATOR) {
+        filter->cic = (int64_t *)p;
+    }
+    else {
+        filter->ring = (float *)p;
+        filter->heap = (int *)(p + C * W * sizeof(float));
+        filter->heap_pos = filter->heap + C * W;
+        filter->min_count = filter->heap_pos + C * W;
+        filter->max_count = filter->min_count + C;
+    }
+    reset_running_filter(filter);
+    return 0;
+}
+
+
+/**
+  * @brief  㻬˲ͨ״̬
+  * @param  filter:     ˲ṹַ
+  * @retval None
+  */
+void reset_running_filter(RunningFilterTypeDef *filter) {
+
+    const int W = filter->window;
+    int ch, i;
+
+    filter->pos = 0;
+    filter->count = 0;
+    filter->phase = 0;
+    if(filter->class == MOVING_AVERAGE) {
+        memset(filter->sum, 0, (size_t)filter->channels * sizeof(double));
+    }
+    else if(filter->class == CIC_DECIMATOR) {
+        memset(filter->cic, 0, (size_t)filter->channels * 2 * filter->stages * sizeof(int64_t));
+    }
+    else {
+        for(ch = 0; ch < filter->channels; ch++) {
+            int *heap = filter->heap + (size_t)ch * W + W / 2;
+            int *pos = filter->heap_pos + (size_t)ch * W;
+            // initial fill pattern: median, max, min, max, min ...
+            for(i = 0; i < W; i++) {
+                pos[i] = ((i + 1) / 2) * ((i & 1) ? -1 : 1);
+                heap[pos[i]] = i;
+            }
+            filter->min_count[ch] = 0;
+            filter->max_count[ch] = 0;
+        }
+    }
+}
+
+
+/**
+  * @brief  ͷŻ˲ڴ
+  * @param  filter:     ˲ṹַ
+  * @retval None
+  */
+void free_running_filter(RunningFilterTypeDef *filter) {
+    free(filter->mem);
+    memset(filter, 0, sizeof(*filter));
+}
+
+
+/**
+  * @brief  ƽ, һͨ
+  */
+static int running_mean_channel(RunningFilterTypeDef *f, int ch, const float *in, int in_stride, float *out, int out_stride, int len) {
+    const int W = f->window;
+    float *ring = f->ring + (size_t)ch * W;
+    double sum = f->sum[ch];
+    double inv = 1.0 / (double)(f->count > 0 ? f->count : 1);
+    int pos = f->pos, count = f->count, n;
+    float x;
+
+    for(n = 0; n < len; n++) {
+        x = in[(size_t)n * in_stride];
+        if(count == W) {
+            sum -= ring[pos];
+        }
+        else {
+            count++;
+            inv = 1.0 / (double)count;
+        }
+        ring[pos] = x;
+        sum += x;
+        if(++pos == W) {
+            pos = 0;
+        }
+        out[(size_t)n * out_stride] = (float)(sum * inv);
+    }
+    f->sum[ch] = sum;
+    return len;
+}
+
+
+/**
+  * @brief  CIC ȡ, һͨ
+  * @note   ״ӳٰ޷ 64 λ, ״е.
+  * @retval 
+  */
+static int running_cic_channel(RunningFilterTypeDef *f, int ch, const float *in, int in_stride, float *out, int out_stride, int len) {
+    const int N = f->stages, R = f->window;
+    int64_t *integ = f->cic + (size_t)ch * 2 * N;
+    int64_t *comb = integ + N;
+    const double gain = pow((double)R, (double)N);
+    uint64_t acc[RUNNING_CIC_MAX_STAGES];
+    uint64_t y, t;
+    int phase = f->phase, produced = 0, n, s;
+
+    for(s = 0; s < N; s++) {
+        acc[s] = (uint64_t)integ[s];
+    }
+    for(n = 0; n < len; n++) {
+        acc[0] += (uint64_t)(int64_t)lrintf(in[(size_t)n * in_stride]);
+        for(s = 1; s < N; s++) {
+            acc[s] += acc[s - 1];
+        }
+        if(++phase == R) {
+            phase = 0;
+            y = acc[N - 1];
+            for(s = 0; s < N; s++) {
+                t = y;
+                y -= (uint64_t)comb[s];
+                comb[s] = (int64_t)t;
+            }
+            out[(size_t)produced * out_stride] = (float)((double)(int64_t)y / gain);
+            produced++;
+        }
+    }
+    for(s = 0; s < N; s++) {
+        integ[s] = (int64_t)acc[s];
+    }
+    return produced;
+}
+
+
+// returns 1 if heap[i] < heap[j]
+static int median_less(const RunningMedianView *m, int i, int j) {
+    return m->data[m->heap[i]] < m->data[m->heap[j]];
+}
+
+// swaps heap items i and j and keeps the position index up to date
+static int median_exchange(RunningMedianView *m, int i, int j) {
+    int t = m->heap[i];
+    m->heap[i] = m->heap[j];
+    m->heap[j] = t;
+    m->pos[m->heap[i]] = i;
+    m->pos[m->heap[j]] = j;
+    return 1;
+}
+
+// swaps i and j if heap[i] < heap[j], returns 1 if swapped
+static int median_cmp_exchange(RunningMedianView *m, int i, int j) {
+    return median_less(m, i, j) && median_exchange(m, i, j);
+}
+
+// restores the min heap property below i
+static void median_min_sort_down(RunningMedianView *m, int i) {
+    for(i *= 2; i <= *m->min_ct; i *= 2) {
+        if(i < *m->min_ct && median_less(m, i + 1, i)) {
+            ++i;
+        }
+        if(!median_cmp_exchange(m, i, i / 2)) {
+            break;
+        }
+    }
+}
+
+// restores the max heap property below i (negative positions)
+static void median_max_sort_down(RunningMedianView *m, int i) {
+    for(i *= 2; i >= -*m->max_ct; i *= 2) {
+        if(i > -*m->max_ct && median_less(m, i, i - 1)) {
+            --i;
+        }
+        if(!median_cmp_exchange(m, i / 2, i)) {
+            break;
+        }
+    }
+}
+
+// restores the min heap property above i, returns 1 if the item reached the median
+static int median_min_sort_up(RunningMedianView *m, int i) {
+    while(i > 0 && median_cmp_exchange(m, i, i / 2)) {
+        i /= 2;
+    }
+    return i == 0;
+}
+
+// restores the max heap property above i, returns 1 if the item reached the median
+static int median_max_sort_up(RunningMedianView *m, int i) {
+    while(i < 0 && median_cmp_exchange(m, i / 2, i)) {
+        i /= 2;
+    }
+    return i == 0;
+}
+
+// replaces the oldest sample (data[idx]) with v
+static void median_insert(RunningMedianView *m, int idx, float v) {
+    const int p = m->pos[idx];
+    const float old = m->data[idx];
+
+    m->data[idx] = v;
+    if(p > 0) {
+        // new item is in the min heap
+        if(*m->min_ct < (m->n - 1) / 2) {
+            (*m->min_ct)++;
+        }
+        else if(v > old) {
+            median_min_sort_down(m, p);
+            return;
+        }
+        if(median_min_sort_up(m, p) && median_cmp_exchange(m, 0, -1)) {
+            median_max_sort_down(m, -1);
+        }
+    }
+    else if(p < 0) {
+        // new item is in the max heap
+        if(*m->max_ct < m->n / 2) {
+            (*m->max_ct)++;
+        }
+        else if(v < old) {
+            median_max_sort_down(m, p);
+            return;
+        }
+        if(median_max_sort_up(m, p) && *m->min_ct > 0 && median_cmp_exchange(m, 1, 0)) {
+            median_min_sort_down(m, 1);
+        }
+    }
+    else {
+        // new item is at the median
+        if(*m->max_ct > 0 && median_max_sort_up(m, -1)) {
+            median_max_sort_down(m, -1);
+        }
+        if(*m->min_ct > 0 && median_min_sort_up(m, 1)) {
+            median_min_sort_down(m, 1);
+        }
+    }
+}
+
+
+/**
+  * @brief  ֵ, һͨ
+  * @note   ڲΪżʱмƽֵ.
+  */
+static int running_median_channel(RunningFilterTypeDef *f, int ch, const float *in, int in_stride, float *out, int out_stride, int len) {
+    const int W = f->window;
+    RunningMedianView m;
+    int pos = f->pos, n;
+    float v;
+
+    m.data = f->ring + (size_t)ch * W;
+    m.heap = f->heap + (size_t)ch * W + W / 2;
+    m.pos = f->heap_pos + (size_t)ch * W;
+    m.min_ct = &f->min_count[ch];
+    m.max_ct = &f->max_count[ch];
+    m.n = W;
+    for(n = 0; n < len; n++) {
+        median_insert(&m, pos, in[(size_t)n * in_stride]);
+        if(++pos == W) {
+            pos = 0;
+        }
+        v = m.data[m.heap[0]];
+        if(*m.min_ct < *m.max_ct) {
+            v = 0.5f * (v + m.data[m.heap[-1]]);
+        }
+        out[(size_t)n * out_stride] = v;
+    }
+    return len;
+}
+
+
+/**
+  * @brief  ʱֿ鴦ͨ, ÿƽõдλ/ȡλ
+  * @retval ÿͨ
+  */
+static int running_filter_run(RunningFilterTypeDef *f, const float *in, size_t in_ch_stride, int in_stride,
+                              float *out, size_t out_ch_stride, int out_stride, int len) {
+    int n0, tl, ch, got = 0, produced = 0;
+
+    for(n0 = 0; n0 < len; n0 += tl) {
+        tl = len - n0;
+        if(tl > RUNNING_TILE_LEN) {
+            tl = RUNNING_TILE_LEN;
+        }
+        for(ch = 0; ch < f->channels; ch++) {
+            const float *pi = in + ch * in_ch_stride + (size_t)n0 * in_stride;
+            float *po = out + ch * out_ch_stride + (size_t)produced * out_stride;
+            if(f->class == MOVING_AVERAGE) {
+                got = running_mean_channel(f, ch, pi, in_stride, po, out_stride, tl);
+            }
+            else if(f->class == CIC_DECIMATOR) {
+                got = running_cic_channel(f, ch, pi, in_stride, po, out_stride, tl);
+            }
+            else {
+                got = running_median_channel(f, ch, pi, in_stride, po, out_stride, tl);
+            }
+        }
+        produced += got;
+        if(f->class == CIC_DECIMATOR) {
+            f->phase = (f->phase + tl) % f->window;
+        }
+        else {
+            f->pos = (f->pos + tl) % f->window;
+            f->count = (f->count + tl < f->window) ? f->count + tl : f->window;
+        }
+    }
+    return produced;
+}
+
+
+/**
+  * @brief  ˲ (ͨ)
+  * @note    ch ͨ n ʱ̵Ϊ input[ch * len + n], Ϊ output[ch * len + k].
+  *         CIC ÿͨĵɷֵ (԰ len ļ),  len .
+  * @param  filter:     ˲ṹַ
+  * @param  input:       (channels * len)
+  * @param  output:      (channels * len)
+  * @param  len:        ÿͨ
+  * @retval ÿͨ
+  */
+int apply_running_filter(RunningFilterTypeDef *filter, const float *input, float *output, int len) {
+    int produced;
+
+    FILTER_INSTR_BEGIN();
+    if(len <= 0) {
+        return 0;
+    }
+    produced = running_filter_run(filter, input, (size_t)len, 1, output, (size_t)len, 1, len);
+    FILTER_INSTR_END(FILTER_SITE_RUNNING, filter, (long)filter->channels * len, output, filter->channels, produced, len);
+    return produced;
+}
+
+
+/**
+  * @brief  ˲֯֡
+  * @param  filter:         ˲ṹַ
+  * @param  frames:         ֡,  ch ͨ n ʱ̵ĲΪ frames[n * frame_stride + ch]
+  * @param  frame_stride:   ֡ļ (float )
+  * @param  output:         
+  * @param  out_layout:      FILTER_LAYOUT_INTERLEAVED / FILTER_LAYOUT_PLANAR
+  * @param  out_stride:     ֯ʱΪ֡ļ, ͨʱΪͨļ (float )
+  * @param  len:            ֡
+  * @retval ÿͨ (CIC Ϊȡ֡)
+  */
+int apply_running_filter_frames(RunningFilterTypeDef *filter, const float *frames, int frame_stride,
+                                float *output, FilterLayoutType out_layout, int out_stride, int len) {
+    int produced;
+
+    FILTER_INSTR_BEGIN();
+    if(len <= 0) {
+        return 0;
+    }
+    if(out_layout == FILTER_LAYOUT_INTERLEAVED) {
+        produced = running_filter_run(filter, frames, 1, frame_stride, output, 1, out_stride, len);
+        FILTER_INSTR_END(FILTER_SITE_RUNNING, filter, (long)filter->channels * len, output, produced, filter->channels, out_stride);
+    }
+    else {
+        produced = running_filter_run(filter, frames, 1, frame_stride, output, (size_t)out_stride, 1, len);
+        FILTER_INSTR_END(FILTER_SITE_RUNNING, filter, (long)filter->channels * len, output, filter->channels, produced, out_stride);
+    }
+    return produced;
+}
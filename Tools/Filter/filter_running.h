@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file           : filter_running.h
+  * @brief          : ƽȡ˲: ƽ (), ༶ CIC ȡ˲, ֵ (˫).
+  *                   ƽ CIC ÿļ봰޹ (O(1)), ֵΪ O(log ),
+  *                   ǧƽ̴ڴͬ. ӿ˲һ: ͨ, ͨŻ֯֡.
+  * @attention      : CIC ڲʹ 64 λۼ (ģ״), 밴 ADC ֵ ().
+  *                   Ϊ˲/˲һ: ں˰׽ڵ 5 ϵ 2 ӳչ,
+  *                   ˲״̬ǰĻλͶ, CIC ,
+  *                   Žѭƻں˵Ĺ̶ṹ. Ҫʱ˲:
+  *                   apply_filter_chain(&chain, xn, yn, len); n = apply_running_filter(&f, yn, zn, len);
+  *                   ͨͨŵ/Լ֯֡ (apply_*_frames) Ĳͬ.
+
+  ******************************************************************************
+  */
+
+
+// filter_running.h
+#ifndef FILTER_RUNNING_H
+#define FILTER_RUNNING_H
+
+#include <stdint.h>
+#include "filter.h"
+
+#define RUNNING_CIC_MAX_STAGES      6       // CIC 
+
+// ˲öٱ
+typedef enum {
+    MOVING_AVERAGE=1,   // ƽ
+    CIC_DECIMATOR,      // CIC ȡ˲ (-״, ӳ M = 1)
+    MOVING_MEDIAN       // ֵ
+} RunningFilterClassType;
+
+// ˲ṹ
+typedef struct running_filter {
+    RunningFilterClassType class;   // ˲
+    int channels;                   // ͨ
+    int window;                     //  (ƽ/ֵ), CIC ʱΪȡ R
+    int stages;                     // CIC  N
+    int pos;                        // λдλ (ͨ)
+    int count;                      // дĲ ( window)
+    int phase;                      // CIC ȡλ (0 ~ R-1)
+    float *ring;                    // ƽ/ֵ: ͨ window ,  ch ͨΪ ring[ch * window ...]
+    double *sum;                    // ƽ: ͨڵĺ
+    int64_t *cic;                   // CIC: ͨ N  N ״ӳ,  ch ͨΪ cic[ch * 2N ...]
+    int *heap;                      // ֵ: ͨ˫ ( ring ±), ֵΪ
+    int *heap_pos;                  // ֵ: ring ± -> λ
+    int *min_count;                 // ֵ: ͨСԪ
+    int *max_count;                 // ֵ: ͨ󶥶Ԫ
+    void *mem;                      // 鹲õڴ
+}RunningFilterTypeDef;
+
+
+int init_running_filter(RunningFilterTypeDef *filter, RunningFilterClassType class, int channels, int window, int stages);
+void reset_running_filter(RunningFilterTypeDef *filter);
+void free_running_filter(RunningFilterTypeDef *filter);
+int apply_running_filter(RunningFilterTypeDef *filter, const float *input, float *output, int len);
+int apply_running_filter_frames(RunningFilterTypeDef *filter, const float *frames, int frame_stride,
+                                float *output, FilterLayoutType out_layout, int out_stride, int len);
+
+#endif
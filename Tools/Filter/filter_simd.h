@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file           : filter_simd.h
+  * @brief          : ˲ SIMD . ÿָ汾ںļڰļ֮ǰ
+  *                   FILTER_SIMD_SCALAR / FILTER_SIMD_SSE4 / FILTER_SIMD_AVX2 / FILTER_SIMD_AVX512
+  *                   ֮һ, ͬһںԴ (filter_kernels_impl.h) ɱָͬİ汾.
+  * @attention      : ںʵļڲʹ, ڶӿ.
+
+  ******************************************************************************
+  */
+
+
+// filter_simd.h
+#ifndef FILTER_SIMD_H
+#define FILTER_SIMD_H
+
+/*
+ * VEC              , ÿԪ (lane) Ӧһͨ
+ * VW                (float )
+ * VLOAD(p)         Ƕ VW  float
+ * VSTORE(p, v)     Ƕ洢 VW  float
+ * VSET1(x)         㲥
+ * VADD/VSUB/VMUL   ԪؼӼ
+ * VDIV             Ԫس
+ * VMIN/VMAX        ԪС/ֵ
+ * VABS(a)          Ԫؾֵ
+ * VFMADD(a, b, c)  a * b + c
+ * VFNMADD(a, b, c) c - a * b
+ */
+
+#if defined(FILTER_SIMD_AVX512)
+
+#include <immintrin.h>
+#define FILTER_SIMD_SUFFIX      avx512
+#define FILTER_SIMD_ISA         FILTER_ISA_AVX512
+#define FILTER_SIMD_NAME        "avx512"
+#define VW                      16
+typedef __m512 VEC;
+#define VLOAD(p)                _mm512_loadu_ps(p)
+#define VSTORE(p, v)            _mm512_storeu_ps((p), (v))
+#define VSET1(x)                _mm512_set1_ps(x)
+#define VZERO()                 _mm512_setzero_ps()
+#define VADD(a, b)              _mm512_add_ps((a), (b))
+#define VSUB(a, b)              _mm512_sub_ps((a), (b))
+#define VMUL(a, b)              _mm512_mul_ps((a), (b))
+#define VDIV(a, b)              _mm512_div_ps((a), (b))
+#define VMIN(a, b)              _mm512_min_ps((a), (b))
+#define VMAX(a, b)              _mm512_max_ps((a), (b))
+#define VABS(a)                 _mm512_abs_ps(a)
+#define VFMADD(a, b, c)         _mm512_fmadd_ps((a), (b), (c))
+#define VFNMADD(a, b, c)        _mm512_fnmadd_ps((a), (b), (c))
+
+#elif defined(FILTER_SIMD_AVX2)
+
+#include <immintrin.h>
+#define FILTER_SIMD_SUFFIX      avx2
+#define FILTER_SIMD_ISA         FILTER_ISA_AVX2
+#define FILTER_SIMD_NAME        "avx2"
+#define VW                      8
+typedef __m256 VEC;
+#define VLOAD(p)                _mm256_loadu_ps(p)
+#define VSTORE(p, v)            _mm256_storeu_ps((p), (v))
+#define VSET1(x)                _mm256_set1_ps(x)
+#define VZERO()                 _mm256_setzero_ps()
+#define VADD(a, b)              _mm256_add_ps((a), (b))
+#define VSUB(a, b)              _mm256_sub_ps((a), (b))
+#define VMUL(a, b)              _mm256_mul_ps((a), (b))
+#define VDIV(a, b)              _mm256_div_ps((a), (b))
+#define VMIN(a, b)              _mm256_min_ps((a), (b))
+#define VMAX(a, b)              _mm256_max_ps((a), (b))
+#define VABS(a)                 _mm256_andnot_ps(_mm256_set1_ps(-0.0f), (a))
+#define VFMADD(a, b, c)         _mm256_fmadd_ps((a), (b), (c))
+#define VFNMADD(a, b, c)        _mm256_fnmadd_ps((a), (b), (c))
+
+#elif defined(FILTER_SIMD_SSE4)
+
+#include <smmintrin.h>
+#define FILTER_SIMD_SUFFIX      sse4
+#define FILTER_SIMD_ISA         FILTER_ISA_SSE4
+#define FILTER_SIMD_NAME        "sse4"
+#define VW                      4
+typedef __m128 VEC;
+#define VLOAD(p)                _mm_loadu_ps(p)
+#define VSTORE(p, v)            _mm_storeu_ps((p), (v))
+#define VSET1(x)                _mm_set1_ps(x)
+#define VZERO()                 _mm_setzero_ps()
+#define VADD(a, b)              _mm_add_ps((a), (b))
+#define VSUB(a, b)              _mm_sub_ps((a), (b))
+#define VMUL(a, b)              _mm_mul_ps((a), (b))
+#define VDIV(a, b)              _mm_div_ps((a), (b))
+#define VMIN(a, b)              _mm_min_ps((a), (b))
+#define VMAX(a, b)              _mm_max_ps((a), (b))
+#define VABS(a)                 _mm_andnot_ps(_mm_set1_ps(-0.0f), (a))
+// SSE4.1 has no FMA, use separate multiply and add
+#define VFMADD(a, b, c)         _mm_add_ps(_mm_mul_ps((a), (b)), (c))
+#define VFNMADD(a, b, c)        _mm_sub_ps((c), _mm_mul_ps((a), (b)))
+
+#elif defined(FILTER_SIMD_SCALAR)
+
+#include <math.h>
+#define FILTER_SIMD_SUFFIX      scalar
+#define FILTER_SIMD_ISA         FILTER_ISA_SCALAR
+#define FILTER_SIMD_NAME        "scalar"
+#define VW                      1
+typedef float VEC;
+#define VLOAD(p)                (*(p))
+#define VSTORE(p, v)            (*(p) = (v))
+#define VSET1(x)                (x)
+#define VZERO()                 (0.0f)
+#define VADD(a, b)              ((a) + (b))
+#define VSUB(a, b)              ((a) - (b))
+#define VMUL(a, b)              ((a) * (b))
+#define VDIV(a, b)              ((a) / (b))
+#define VMIN(a, b)              ((a) < (b) ? (a) : (b))
+#define VMAX(a, b)              ((a) > (b) ? (a) : (b))
+#define VABS(a)                 fabsf(a)
+#define VFMADD(a, b, c)         ((a) * (b) + (c))
+#define VFNMADD(a, b, c)        ((c) - (a) * (b))
+
+#else
+#error "filter_simd.h: define one of FILTER_SIMD_SCALAR/SSE4/AVX2/AVX512 before including"
+#endif
+
+// force inlining so that compile time constant loop counts are unrolled
+#if defined(__GNUC__)
+#define FILTER_INLINE           static inline __attribute__((always_inline))
+#else
+#define FILTER_INLINE           static inline
+#endif
+
+// FILTER_KFN(bank) -> filter_bank_avx2 ...
+#define FILTER_KFN_CAT2(name, suffix)   filter_##name##_##suffix
+#define FILTER_KFN_CAT(name, suffix)    FILTER_KFN_CAT2(name, suffix)
+#define FILTER_KFN(name)                FILTER_KFN_CAT(name, FILTER_SIMD_SUFFIX)
+
+#endif /* FILTER_SIMD_H */
@@ -0,0 +1,325 @@
+/**
+  ******************************************************************************
+  * @file           : filter_spectrum.c
+  * @brief          : ʽ Welch  / STFT ļ.
+                      ÿ:    X[k] = sum_n w[n] * (x[n] - mean) * exp(-2 pi i k n / nfft)
+                      ܶ:    P[k] = c_k * |X[k]|^2 / (fs * sum(w^2)),  c_k = 2 (ֱ nfft/2 Ϊ 1)
+                      Welch:   ÿ average ε P[k] ȡƽ
+  * @attention      :
+                      ʹʾ (ο):
+
+                        FilterSpectrumTypeDef raw_spec, out_spec;   // ˲ǰĹ
+
+                        void publish(const FilterSpectrumTypeDef *spec, void *ctx) {
+                            //  spec->psd ͵,  filter_spectrum_peak ֵ
+                        }
+
+                        int main(void) {
+
+                            // 64 ͨ, 2 kHz, 1024  Hann , 50% ص, ÿ 8  (Լ 2.3 s) һ
+                            init_filter_spectrum(&raw_spec, 64, 2000.0f, 1024, 512, FILTER_WINDOW_HANN, 8);
+                            init_filter_spectrum(&out_spec, 64, 2000.0f, 1024, 512, FILTER_WINDOW_HANN, 8);
+                            out_spec.on_psd = publish;
+
+                            while(1) {
+
+                                apply_filter_spectrum(&raw_spec, xn, 256);
+                                apply_filter_chain(&chain, xn, yn, 256);
+                                apply_filter_spectrum(&out_spec, yn, 256);
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_spectrum.h"
+#include "filter_dispatch.h"
+#include "filter_instr.h"
+
+#define FILTER_SPECTRUM_PI      3.14159265358979323846
+#define FILTER_SPECTRUM_LANES   16          //  (AVX-512) , ʱлָҲ
+
+
+/**
+  * @brief   (ڴ, ĸΪ nfft)
+  */
+static double filter_spectrum_window(FilterWindowType window, int n, int nfft) {
+    const double x = 2.0 * FILTER_SPECTRUM_PI * n / nfft;
+
+    switch(window) {
+        case FILTER_WINDOW_HANN:        return 0.5 - 0.5 * cos(x);
+        case FILTER_WINDOW_HAMMING:     return 0.54 - 0.46 * cos(x);
+        case FILTER_WINDOW_BLACKMAN:    return 0.42 - 0.5 * cos(x) + 0.08 * cos(2.0 * x);
+        default:                        return 1.0;
+    }
+}
+
+
+/**
+  * @brief  ʽ׳ʼ
+  * @note   㴰 FFT ƻ, 价λ, ֮ٷڴ.
+  * @param  spec:       ʽ׽ṹַ
+  * @param  channels:   ͨ
+  * @param  fs:         Ƶ (Hz)
+  * @param  nfft:       FFT  (ÿγ), 2 , FILTER_SPECTRUM_MIN_NFFT ~ FILTER_SPECTRUM_MAX_NFFT
+  * @param  overlap:    صĵ, 0 ~ nfft - 1 (Hann ͨȡ nfft / 2)
+  * @param  window:     
+  * @param  average:    ÿƽĶ (>= 1)
+  * @retval 0: ɹ; -1: ڴʧ
+  */
+int init_filter_spectrum(FilterSpectrumTypeDef *spec, int channels, float fs, int nfft, int overlap,
+                         FilterWindowType window, int average) {
+
+    const int M = nfft / 2;
+    double w, sum_sq = 0.0;
+    size_t C, bins;
+    int n, bits, r, b;
+
+    memset(spec, 0, sizeof(*spec));
+    if(channels <= 0 || fs <= 0.0f || nfft < FILTER_SPECTRUM_MIN_NFFT || nfft > FILTER_SPECTRUM_MAX_NFFT ||
+       (nfft & (nfft - 1)) != 0 || overlap < 0 || overlap >= nfft || average <= 0) {
+        return -1;
+    }
+    C = (size_t)channels;
+    bins = (size_t)M + 1;
+    spec->mem = (float *)calloc((size_t)nfft * 2 + bins + C * nfft + (size_t)nfft * FILTER_SPECTRUM_LANES + 3 * bins * C,
+                                sizeof(float));
+    spec->rev = (int *)malloc((size_t)M * sizeof(int));
+    if(spec->mem == NULL || spec->rev == NULL) {
+        free_filter_spectrum(spec);
+        return -1;
+    }
+    spec->channels = channels;
+    spec->nfft = nfft;
+    spec->hop = nfft - overlap;
+    spec->bins = M + 1;
+    spec->average = average;
+    spec->detrend = 1;
+    spec->fs = fs;
+    spec->window = spec->mem;
+    spec->tw_cos = spec->window + nfft;
+    spec->tw_sin = spec->tw_cos + M;
+    spec->bin_scale = spec->tw_sin + M;
+    spec->ring = spec->bin_scale + bins;
+    spec->work = spec->ring + C * nfft;
+    spec->acc = spec->work + (size_t)nfft * FILTER_SPECTRUM_LANES;
+    spec->psd = spec->acc + bins * C;
+    spec->power = spec->psd + bins * C;
+
+    for(n = 0; n < nfft; n++) {
+        w = filter_spectrum_window(window, n, nfft);
+        spec->window[n] = (float)w;
+        sum_sq += w * w;
+    }
+    // plan: twiddles of the nfft point real transform, bit reversal of the nfft / 2 point complex transform
+    for(n = 0; n < M; n++) {
+        spec->tw_cos[n] = (float)cos(2.0 * FILTER_SPECTRUM_PI * n / nfft);
+        spec->tw_sin[n] = (float)sin(2.0 * FILTER_SPECTRUM_PI * n / nfft);
+    }
+    for(bits = 0; (1 << bits) < M; bits++) {
+    }
+    for(n = 0; n < M; n++) {
+        for(r = 0, b = 0; b < bits; b++) {
+            r |= ((n >> b) & 1) << (bits - 1 - b);
+        }
+        spec->rev[n] = r;
+    }
+    for(n = 0; n <= M; n++) {
+        spec->bin_scale[n] = (float)((n == 0 || n == M ? 1.0 : 2.0) / (fs * sum_sq));
+    }
+    reset_filter_spectrum(spec);
+    return 0;
+}
+
+
+/**
+  * @brief  ջλ뵱ǰƽ, ¿ʼֶ (ѷ psd )
+  * @param  spec:       ʽ׽ṹַ
+  * @retval None
+  */
+void reset_filter_spectrum(FilterSpectrumTypeDef *spec) {
+    memset(spec->ring, 0, (size_t)spec->channels * spec->nfft * sizeof(float));
+    memset(spec->acc, 0, (size_t)spec->channels * spec->bins * sizeof(float));
+    spec->head = 0;
+    spec->pending = spec->nfft;
+    spec->segments = 0;
+}
+
+
+/**
+  * @brief  ͷʽڴ
+  * @param  spec:       ʽ׽ṹַ
+  * @retval None
+  */
+void free_filter_spectrum(FilterSpectrumTypeDef *spec) {
+    free(spec->mem);
+    free(spec->rev);
+    memset(spec, 0, sizeof(*spec));
+}
+
+
+/**
+  * @brief  λдһ:  FFT ں, Ҫʱ STFT ֡ Welch ƽ
+  */
+static void filter_spectrum_segment(FilterSpectrumTypeDef *spec) {
+    const size_t C = (size_t)spec->channels;
+    size_t k, ch;
+    float s;
+
+    filter_kernels()->spectrum(spec, spec->head);
+    spec->pending = spec->hop;
+    spec->total_segments++;
+    if(spec->on_frame != NULL) {
+        for(k = 0; k < (size_t)spec->bins; k++) {
+            s = spec->bin_scale[k];
+            for(ch = 0; ch < C; ch++) {
+                spec->power[k * C + ch] *= s;
+            }
+        }
+        spec->on_frame(spec, spec->ctx);
+    }
+    if(++spec->segments < spec->average) {
+        return;
+    }
+    for(k = 0; k < (size_t)spec->bins; k++) {
+        s = spec->bin_scale[k] / (float)spec->average;
+        for(ch = 0; ch < C; ch++) {
+            spec->psd[k * C + ch] = spec->acc[k * C + ch] * s;
+        }
+    }
+    memset(spec->acc, 0, C * spec->bins * sizeof(float));
+    spec->segments = 0;
+    spec->psds++;
+    if(spec->on_psd != NULL) {
+        spec->on_psd(spec, spec->ctx);
+    }
+}
+
+
+/**
+  * @brief  д뻷λ֡
+  */
+static int filter_spectrum_span(const FilterSpectrumTypeDef *spec, int remain) {
+    int seg = spec->nfft - spec->head;
+
+    if(seg > spec->pending) {
+        seg = spec->pending;
+    }
+    return seg < remain ? seg : remain;
+}
+
+
+/**
+  * @brief  ʽ״ (ͨŵ)
+  * @note    ch ͨ n ʱ̵ĲΪ input[ch * len + n]; 鳤, ԿԽα߽.
+  * @param  spec:       ʽ׽ṹַ
+  * @param  input:       (channels * len), ˲
+  * @param  len:        ÿͨĲ
+  * @retval None
+  */
+void apply_filter_spectrum(FilterSpectrumTypeDef *spec, const float *input, int len) {
+    const int C = spec->channels;
+    int n0, seg, c0, ch, t;
+
+    FILTER_INSTR_BEGIN();
+    for(n0 = 0; n0 < len; n0 += seg) {
+        float *dst = spec->ring + (size_t)spec->head * C;
+        seg = filter_spectrum_span(spec, len - n0);
+        // transpose in groups of channels so that every row write is one contiguous cache line
+        for(c0 = 0; c0 < C; c0 += FILTER_SPECTRUM_LANES) {
+            const int lanes = C - c0 < FILTER_SPECTRUM_LANES ? C - c0 : FILTER_SPECTRUM_LANES;
+            const float *src = input + (size_t)c0 * len + n0;
+            for(t = 0; t < seg; t++) {
+                for(ch = 0; ch < lanes; ch++) {
+                    dst[(size_t)t * C + c0 + ch] = src[(size_t)ch * len + t];
+                }
+            }
+        }
+        spec->head = (spec->head + seg) & (spec->nfft - 1);
+        spec->pending -= seg;
+        if(spec->pending == 0) {
+            filter_spectrum_segment(spec);
+        }
+    }
+    FILTER_INSTR_END(FILTER_SITE_SPECTRUM, spec, (long)C * len, NULL, 0, 0, 0);
+}
+
+
+/**
+  * @brief  ʽ״ (֯֡)
+  * @param  spec:           ʽ׽ṹַ
+  * @param  frames:         ֡,  ch ͨ n ʱ̵ĲΪ frames[n * frame_stride + ch]
+  * @param  frame_stride:   ֡ļ (float )
+  * @param  len:            ֡
+  * @retval None
+  */
+void apply_filter_spectrum_frames(FilterSpectrumTypeDef *spec, const float *frames, int frame_stride, int len) {
+    const int C = spec->channels;
+    int n0, seg, t;
+
+    FILTER_INSTR_BEGIN();
+    for(n0 = 0; n0 < len; n0 += seg) {
+        float *dst = spec->ring + (size_t)spec->head * C;
+        seg = filter_spectrum_span(spec, len - n0);
+        if(frame_stride == C) {
+            memcpy(dst, frames + (size_t)n0 * C, (size_t)seg * C * sizeof(float));
+        }
+        else {
+            for(t = 0; t < seg; t++) {
+                memcpy(dst + (size_t)t * C, frames + (size_t)(n0 + t) * frame_stride, (size_t)C * sizeof(float));
+            }
+        }
+        spec->head = (spec->head + seg) & (spec->nfft - 1);
+        spec->pending -= seg;
+        if(spec->pending == 0) {
+            filter_spectrum_segment(spec);
+        }
+    }
+    FILTER_INSTR_END(FILTER_SITE_SPECTRUM, spec, (long)C * len, NULL, 0, 0, 0);
+}
+
+
+/**
+  * @brief  ƵӦƵ
+  * @param  spec:       ʽ׽ṹַ
+  * @param  bin:        Ƶ, 0 ~ bins - 1
+  * @retval Ƶ (Hz)
+  */
+float filter_spectrum_freq(const FilterSpectrumTypeDef *spec, int bin) {
+    return (float)bin * spec->fs / (float)spec->nfft;
+}
+
+
+/**
+  * @brief  һηĹĳͨķֵ (ֱ)
+  * @param  spec:       ʽ׽ṹַ
+  * @param  ch:         ͨ
+  * @param  freq:       , ֵƵ (Hz), Ϊ NULL
+  * @param  psd:        , ֵܶ (V^2/Hz), Ϊ NULL
+  * @retval ֵƵ; -1: ûз
+  */
+int filter_spectrum_peak(const FilterSpectrumTypeDef *spec, int ch, float *freq, float *psd) {
+    const int C = spec->channels;
+    int k, best = 1;
+
+    if(spec->psds == 0) {
+        return -1;
+    }
+    for(k = 2; k < spec->bins; k++) {
+        if(spec->psd[k * C + ch] > spec->psd[best * C + ch]) {
+            best = k;
+        }
+    }
+    if(freq != NULL) {
+        *freq = filter_spectrum_freq(spec, best);
+    }
+    if(psd != NULL) {
+        *psd = spec->psd[best * C + ch];
+    }
+    return best;
+}
@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file           : filter_spectrum.h
+  * @brief          : ʽ Welch  / ʱҶ任 (STFT). ֱӽ˲ͬһݿ,
+  *                    nfft ֶ (ڶص overlap ), Ӵʵ FFT, ÿ average ƽһ
+  *                   ߹ܶ; ÿεĹҲͨص֡ȡ (STFT / ʱƵͼ).
+  * @attention      : FFT ƻ (λת, ת) 봰ڳʼʱһ, ֮ͨ, жθ.
+  *                   ͨΪԪͬʱ FFT, ں˰ʱ CPU ָѡ,  filter_dispatch.h
+  *                    scipy.signal.welch(x, fs, window, nperseg=nfft, noverlap=overlap,
+  *                   detrend='constant'  False, scaling='density') һ.
+
+  ******************************************************************************
+  */
+
+
+// filter_spectrum.h
+#ifndef FILTER_SPECTRUM_H
+#define FILTER_SPECTRUM_H
+
+#include "filter.h"
+
+#define FILTER_SPECTRUM_MIN_NFFT    4       // С FFT 
+#define FILTER_SPECTRUM_MAX_NFFT    65536   //  FFT 
+
+// öٱ (ڴ,  scipy.signal.get_window Ĭֵͬ)
+typedef enum {
+    FILTER_WINDOW_RECT = 0, // δ
+    FILTER_WINDOW_HANN,     // 
+    FILTER_WINDOW_HAMMING,  // 
+    FILTER_WINDOW_BLACKMAN  // 
+} FilterWindowType;
+
+// ʽ׽ṹ
+typedef struct filter_spectrum {
+    int channels;           // ͨ
+    int nfft;               // FFT  (2 )
+    int hop;                // εļ (nfft - overlap)
+    int bins;               // Ƶ nfft / 2 + 1
+    int average;            // ÿƽĶ
+    int detrend;            // 1: ÿμȥֵ (detrend='constant'); 0: ȥ
+    float fs;               // Ƶ
+    int head;               // λһ֡дλ
+    int pending;            // һλҪ֡
+    int segments;           // ǰƽۼӵĶ
+    unsigned long total_segments;       // ɵĶ
+    unsigned long psds;                 // ѷĹ
+    float *window;          // , nfft 
+    int *rev;               // FFT ƻ: nfft / 2 㸴 FFT λת ()
+    float *tw_cos, *tw_sin; // FFT ƻ: ת exp(-2 pi i k / nfft), k = 0 ~ nfft / 2 - 1
+    float *bin_scale;       // ƵܶȻϵ (,  1 / (fs * sum(w^2)))
+    float *ring;            //  nfft ֡,  t ֡ ch ͨΪ ring[t * channels + ch]
+    float *work;            // FFT  (nfft * 16  float, )
+    float *acc;             // ǰƽ |X[k]|^2 ۼ,  k Ƶ ch ͨΪ acc[k * channels + ch]
+    float *psd;             // : һηĹܶ (V^2/Hz), ͬ acc
+    float *power;           // : һεĹܶ (STFT һ֡),  on_frame Ϊ NULL ʱ, ͬ acc
+    void (*on_frame)(const struct filter_spectrum *spec, void *ctx);    // ÿνʱĻص (STFT), Ϊ NULL
+    void (*on_psd)(const struct filter_spectrum *spec, void *ctx);      // ÿηʱĻص, Ϊ NULL
+    void *ctx;              // ص
+    float *mem;             //  float 鹲õڴ
+}FilterSpectrumTypeDef;
+
+
+int init_filter_spectrum(FilterSpectrumTypeDef *spec, int channels, float fs, int nfft, int overlap,
+                         FilterWindowType window, int average);
+void reset_filter_spectrum(FilterSpectrumTypeDef *spec);
+void free_filter_spectrum(FilterSpectrumTypeDef *spec);
+void apply_filter_spectrum(FilterSpectrumTypeDef *spec, const float *input, int len);
+void apply_filter_spectrum_frames(FilterSpectrumTypeDef *spec, const float *frames, int frame_stride, int len);
+float filter_spectrum_freq(const FilterSpectrumTypeDef *spec, int bin);
+int filter_spectrum_peak(const FilterSpectrumTypeDef *spec, int ch, float *freq, float *psd);
+
+#endif
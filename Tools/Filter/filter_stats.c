@@ -0,0 +1,239 @@
+/**
+  ******************************************************************************
+  * @file           : filter_stats.c
+  * @brief          : ˲ͳƹļ. ˲֮ٶͨһμ/ֵ/ֵ,
+                      ͳ˲˲ںдͬһѭۼ.
+  * @attention      :
+                      ʹʾ (ο):
+
+                        FilterChainTypeDef chain; // ˲ṹ
+                        FilterStatsTypeDef stats; // ͳƽṹ
+
+                        void publish(const FilterStatsTypeDef *st, void *ctx) {
+                            // st->rms[ch], st->peak[ch], st->mean[ch], st->envelope[ch] ...
+                        }
+
+                        int main(void) {
+
+                            init_filter_chain(&chain, 64, 2000.0f, front_end, 3);
+                            init_filter_stats(&stats, 64, 200, 2000.0f, 0.05f); // ÿ 200 㷢һ, ʱ䳣 50 ms
+                            stats.on_block = publish;
+                            attach_filter_chain_stats(&chain, &stats);
+
+                            while(1) {
+
+                                apply_filter_chain(&chain, xn, yn, 256); // ˲ͳ
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_stats.h"
+
+
+/**
+  * @brief  ˲ͳƳʼ
+  * @param  stats:      ͳƽṹַ
+  * @param  channels:   ͨ
+  * @param  block:      鳤 (), ÿһ鷢һν
+  * @param  fs:         Ƶ (hz)
+  * @param  env_tau:    ʱ䳣 (s), Сڵ 0 ʱ缴Ϊ |y|
+  * @retval 0: ɹ; -1: ڴʧ
+  */
+int init_filter_stats(FilterStatsTypeDef *stats, int channels, int block, float fs, float env_tau) {
+
+    size_t n;
+
+    memset(stats, 0, sizeof(*stats));
+    if(channels <= 0 || block <= 0) {
+        return -1;
+    }
+    n = (size_t)channels;
+    stats->mem = (float *)calloc(n * 11, sizeof(float));
+    if(stats->mem == NULL) {
+        return -1;
+    }
+    stats->channels = channels;
+    stats->block = block;
+    stats->env_coeff = (env_tau > 0.0f && fs > 0.0f) ? (float)(1.0 - exp(-1.0 / ((double)fs * env_tau))) : 1.0f;
+    stats->sum = stats->mem;
+    stats->sum_sq = stats->sum + n;
+    stats->min = stats->sum_sq + n;
+    stats->max = stats->min + n;
+    stats->env = stats->max + n;
+    stats->mean = stats->env + n;
+    stats->rms = stats->mean + n;
+    stats->peak = stats->rms + n;
+    stats->lo = stats->peak + n;
+    stats->hi = stats->lo + n;
+    stats->envelope = stats->hi + n;
+    reset_filter_stats(stats);
+    return 0;
+}
+
+
+/**
+  * @brief  㵱ǰۼֵ
+  */
+static void filter_stats_clear(FilterStatsTypeDef *stats) {
+    int ch;
+
+    memset(stats->sum, 0, (size_t)stats->channels * 2 * sizeof(float));
+    for(ch = 0; ch < stats->channels; ch++) {
+        stats->min[ch] = HUGE_VALF;
+        stats->max[ch] = -HUGE_VALF;
+    }
+    stats->count = 0;
+}
+
+
+/**
+  * @brief  ͳƵۼֵ, ѷĽ
+  * @param  stats:      ͳƽṹַ
+  * @retval None
+  */
+void reset_filter_stats(FilterStatsTypeDef *stats) {
+    filter_stats_clear(stats);
+    memset(stats->env, 0, (size_t)stats->channels * 7 * sizeof(float));
+    stats->blocks = 0;
+}
+
+
+/**
+  * @brief  ͷͳڴ
+  * @note   ͷǰ attach_filter_*_stats(..., NULL) ˲ȡ.
+  * @param  stats:      ͳƽṹַ
+  * @retval None
+  */
+void free_filter_stats(FilterStatsTypeDef *stats) {
+    free(stats->mem);
+    memset(stats, 0, sizeof(*stats));
+}
+
+
+/**
+  * @brief  ͳƹҵ˲, ֮ apply_filter_bank* ˲ͬʱۼͳ
+  * @param  bank:       ˲ṹַ
+  * @param  stats:      ͳƽṹַ, Ϊ NULL ʱȡ
+  * @retval 0: ɹ; -1: ͨһ
+  */
+int attach_filter_bank_stats(FilterBankTypeDef *bank, FilterStatsTypeDef *stats) {
+    if(stats != NULL && stats->channels != bank->channels) {
+        return -1;
+    }
+    bank->stats = stats;
+    return 0;
+}
+
+
+/**
+  * @brief  ͳƹҵ˲, ͳƵһ
+  * @param  chain:      ˲ṹַ
+  * @param  stats:      ͳƽṹַ, Ϊ NULL ʱȡ
+  * @retval 0: ɹ; -1: ͨһ
+  */
+int attach_filter_chain_stats(FilterChainTypeDef *chain, FilterStatsTypeDef *stats) {
+    if(stats != NULL && stats->channels != chain->channels) {
+        return -1;
+    }
+    chain->stats = stats;
+    return 0;
+}
+
+
+/**
+  * @brief  һ: ۼֵ, ۼֵ, ûص
+  */
+static void filter_stats_publish(FilterStatsTypeDef *stats) {
+    const float inv = 1.0f / (float)stats->count;
+    float lo, hi;
+    int ch;
+
+    for(ch = 0; ch < stats->channels; ch++) {
+        lo = stats->min[ch];
+        hi = stats->max[ch];
+        stats->mean[ch] = stats->sum[ch] * inv;
+        stats->rms[ch] = sqrtf(stats->sum_sq[ch] * inv);
+        stats->lo[ch] = lo;
+        stats->hi[ch] = hi;
+        stats->peak[ch] = fabsf(lo) > fabsf(hi) ? fabsf(lo) : fabsf(hi);
+        stats->envelope[ch] = stats->env[ch];
+    }
+    filter_stats_clear(stats);
+    stats->blocks++;
+    if(stats->on_block != NULL) {
+        stats->on_block(stats, stats->ctx);
+    }
+}
+
+
+/**
+  * @brief  ӵǰλ, Խ߽໹ܴĲ
+  * @param  stats:      ͳƽṹַ, Ϊ NULL
+  * @param  len:        ʣ
+  * @retval β (stats Ϊ NULL ʱΪ len)
+  */
+int filter_stats_segment(const FilterStatsTypeDef *stats, int len) {
+    if(stats != NULL && len > stats->block - stats->count) {
+        return stats->block - stats->count;
+    }
+    return len;
+}
+
+
+/**
+  * @brief  ں˴ n ƽλ, һʱ
+  * @param  stats:      ͳƽṹַ, Ϊ NULL
+  * @param  n:          β ( filter_stats_segment ķֵ)
+  * @retval None
+  */
+void filter_stats_advance(FilterStatsTypeDef *stats, int n) {
+    if(stats == NULL) {
+        return;
+    }
+    stats->count += n;
+    if(stats->count == stats->block) {
+        filter_stats_publish(stats);
+    }
+}
+
+
+/**
+  * @brief  ͳƵ filter_run_planar: ڿ߽紦з, ÿһ鷢һν
+  * @note   stats Ϊ NULL ʱͬ filter_run_planar. ںͨ obj е stats ָۼͳ.
+  * @retval None
+  */
+void filter_stats_run_planar(FilterStatsTypeDef *stats, FilterLaneKernel fn, int width, void *obj, int channels,
+                             const float *input, int in_ch_stride, float *output, int out_ch_stride, int len) {
+    int n0, seg;
+
+    for(n0 = 0; n0 < len; n0 += seg) {
+        seg = filter_stats_segment(stats, len - n0);
+        filter_run_planar(fn, width, obj, channels, input + n0, in_ch_stride, output + n0, out_ch_stride, seg);
+        filter_stats_advance(stats, seg);
+    }
+}
+
+
+/**
+  * @brief  ͳƵ filter_run_frames, ͬ filter_run_frames
+  * @retval None
+  */
+void filter_stats_run_frames(FilterStatsTypeDef *stats, FilterLaneKernel fn, void *obj, int channels,
+                             const float *frames, int frame_stride, float *output, FilterLayoutType out_layout, int out_stride, int len) {
+    int n0, seg;
+
+    for(n0 = 0; n0 < len; n0 += seg) {
+        seg = filter_stats_segment(stats, len - n0);
+        filter_run_frames(fn, obj, channels, frames + (size_t)n0 * frame_stride, frame_stride,
+                          output + (out_layout == FILTER_LAYOUT_INTERLEAVED ? (size_t)n0 * out_stride : (size_t)n0),
+                          out_layout, out_stride, seg);
+        filter_stats_advance(stats, seg);
+    }
+}
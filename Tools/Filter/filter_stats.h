@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file           : filter_stats.h
+  * @brief          : ˲ͳ. ˲˲֮, ںдÿͬʱ
+  *                   ۼӺ, ƽ, С/ֵԼ, ÿһ鷢һξֵ, ,
+  *                   ֵȽ, Ҫٱһ.
+  * @attention      : ں˰ʱ CPU ָѡ,  filter_dispatch.h
+
+  ******************************************************************************
+  */
+
+
+// filter_stats.h
+#ifndef FILTER_STATS_H
+#define FILTER_STATS_H
+
+#include "filter_dispatch.h"
+#include "filter_chain.h"
+
+// ˲ͳƽṹ, ÿ channels 
+typedef struct filter_stats {
+    int channels;                           // ͨ
+    int block;                              // 鳤 (), ÿһ鷢һν
+    int count;                              // ǰۼӵĲ
+    float env_coeff;                        // һƽϵ 1 - exp(-1 / (fs * tau))
+    float *sum, *sum_sq;                    // ǰĺ, ƽ
+    float *min, *max;                       // ǰСֵ, ֵ
+    float *env;                             // ״̬ env += k * (|y| - env), 鱣
+    float *mean, *rms, *peak;               // : һľֵ, , ֵ max(|y|)
+    float *lo, *hi;                         // : һСֵ, ֵ
+    float *envelope;                        // : һʱİ
+    unsigned long blocks;                   // ѷĿ
+    void (*on_block)(const struct filter_stats *stats, void *ctx);  // ÿʱĻص, Ϊ NULL
+    void *ctx;                              // ص
+    float *mem;                             // 鹲õڴ
+}FilterStatsTypeDef;
+
+
+int init_filter_stats(FilterStatsTypeDef *stats, int channels, int block, float fs, float env_tau);
+void reset_filter_stats(FilterStatsTypeDef *stats);
+void free_filter_stats(FilterStatsTypeDef *stats);
+int attach_filter_bank_stats(FilterBankTypeDef *bank, FilterStatsTypeDef *stats);
+int attach_filter_chain_stats(FilterChainTypeDef *chain, FilterStatsTypeDef *stats);
+int filter_stats_segment(const FilterStatsTypeDef *stats, int len);
+void filter_stats_advance(FilterStatsTypeDef *stats, int n);
+void filter_stats_run_planar(FilterStatsTypeDef *stats, FilterLaneKernel fn, int width, void *obj, int channels,
+                             const float *input, int in_ch_stride, float *output, int out_ch_stride, int len);
+void filter_stats_run_frames(FilterStatsTypeDef *stats, FilterLaneKernel fn, void *obj, int channels,
+                             const float *frames, int frame_stride, float *output, FilterLayoutType out_layout, int out_stride, int len);
+
+#endif
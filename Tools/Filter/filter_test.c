@@ -0,0 +1,664 @@
+/**
+  ******************************************************************************
+  * @file           : filter_test.c
+  * @brief          : Զ (ctest). ָָںοʵԱ:
+                        ˲ / ں˲ (ͨ, ֯֡, ֯/ͨ, 16 λ)  apply_filter
+                        apply_filter_block / apply_filter_block_tdf2  apply_filter
+                        ƽ / ֵ / CIC ȡֱӼ
+                        filter_freqz (, λ, Ⱥӳ) ˫ֱӼ
+                        Welch ˫ DFT, ľֱӼ
+  * @attention      :
+                      ÷: filter_test [isa]
+                        isa         scalar / sse4 / avx2 / avx512, ʡʱβԵǰ CPU ֵָ֧;
+                                    ǰ CPU ָָ֧ʱ ( 0)
+                      ͨͳȶֿ鳤ȵ, , β״̬.
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_bank.h"
+#include "filter_chain.h"
+#include "filter_dispatch.h"
+#include "filter_freqz.h"
+#include "filter_half.h"
+#include "filter_running.h"
+#include "filter_spectrum.h"
+#include "filter_stats.h"
+#include "filter_tone.h"
+
+#define TEST_PI         3.14159265358979323846
+#define TEST_FS         2000.0f
+#define TEST_CH         37      //  16 ֿͨ + 5 ͨβ
+#define TEST_LEN        300     //  64 ֿ֡
+#define TEST_STRIDE     40      // ֯֡, ÿ֡ 3 ˲ĸֶ
+#define TEST_SPLIT      113     // δ, õ״̬
+#define TEST_TOL        1e-3    // ڲοȵ (㿿λԲ, ˳ͬ float Լ 1e-4)
+
+static int test_failures;
+static const char *test_isa = "";
+
+#define TEST_CHECK(cond) do { \
+        if(!(cond)) { \
+            printf("[%s] %s:%d: check fail: %s\n", test_isa, __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while(0)
+
+static unsigned int test_seed;
+
+// [-1, 1) ȷֲα
+static float test_rand(void) {
+    test_seed = test_seed * 1664525u + 1013904223u;
+    return (float)(test_seed >> 8) / 8388608.0f - 1.0f;
+}
+
+// ͨŵĲź: ͨƵʲͬ + 50 Hz Ƶ + 
+static void test_signal(float *x, int channels, int len) {
+    int ch, n;
+
+    test_seed = 12345u;
+    for(ch = 0; ch < channels; ch++) {
+        for(n = 0; n < len; n++) {
+            x[(size_t)ch * len + n] = (float)(sin(2.0 * TEST_PI * (5.0 + 7.0 * ch) * n / TEST_FS)
+                                              + 0.5 * sin(2.0 * TEST_PI * 50.0 * n / TEST_FS)) + 0.2f * test_rand();
+        }
+    }
+}
+
+// ͨ -> ֯֡ (֡ stride, ֶ NaN, Ӧȡ)
+static void test_interleave(const float *x, float *frames, int channels, int len, int stride) {
+    int ch, n;
+
+    for(n = 0; n < len; n++) {
+        for(ch = 0; ch < stride; ch++) {
+            frames[(size_t)n * stride + ch] = ch < channels ? x[(size_t)ch * len + n] : NAN;
+        }
+    }
+}
+
+/**
+  * @brief  Ƚο:  tol * max(1, max|ref|)
+  * @param  got / got_ch / got_n:   ,  ch ͨ n Ϊ got[ch * got_ch + n * got_n]
+  * @param  ref:                    ο, ͨ,  ch ͨ n Ϊ ref[ch * len + n]
+  * @retval 1: һ; 0: һ
+  */
+static int test_close(const char *what, const float *got, size_t got_ch, size_t got_n,
+                      const float *ref, int channels, int len, double tol) {
+    double scale = 1.0, err = 0.0, e;
+    int ch, n, bad_ch = 0, bad_n = 0;
+
+    for(ch = 0; ch < channels; ch++) {
+        for(n = 0; n < len; n++) {
+            e = fabs(ref[(size_t)ch * len + n]);
+            scale = e > scale ? e : scale;
+        }
+    }
+    for(ch = 0; ch < channels; ch++) {
+        for(n = 0; n < len; n++) {
+            e = fabs((double)got[ch * got_ch + n * got_n] - ref[(size_t)ch * len + n]);
+            // NaN compares false, count it as an error
+            if(!(e <= err)) {
+                err = e == e ? e : INFINITY;
+                bad_ch = ch;
+                bad_n = n;
+            }
+        }
+    }
+    if(err > tol * scale) {
+        printf("[%s] %s: max error %g at ch %d n %d (scale %g)\n", test_isa, what, err, bad_ch, bad_n, scale);
+        return 0;
+    }
+    return 1;
+}
+
+// ÿͨĵ n0 ~ n0 + n - 1 㸴Ƴɰͨŵ n ݿ (δʱʹ)
+static void test_slice(const float *x, int n0, int n, float *dst) {
+    int ch;
+
+    for(ch = 0; ch < TEST_CH; ch++) {
+        memcpy(dst + (size_t)ch * n, x + (size_t)ch * TEST_LEN + n0, (size_t)n * sizeof(float));
+    }
+}
+
+// test_slice 
+static void test_unslice(const float *src, int n0, int n, float *y) {
+    int ch;
+
+    for(ch = 0; ch < TEST_CH; ch++) {
+        memcpy(y + (size_t)ch * TEST_LEN + n0, src + (size_t)ch * n, (size_t)n * sizeof(float));
+    }
+}
+
+// ͨĲ˲: , Ƶͨ仯
+static void test_channel_filter(FilterTypeDef *f, int ch) {
+    switch(ch % 5) {
+        case 0:  init_filter(f, NOTCH, TEST_FS, 50.0f + ch, 0.0f, 0.0f); break;
+        case 1:  init_filter(f, LOWPASS, TEST_FS, 0.0f, 40.0f + 5.0f * ch, 0.0f); break;
+        case 2:  init_filter(f, HIGHPASS, TEST_FS, 0.0f, 0.0f, 1.0f + ch); break;
+        case 3:  init_filter(f, BANDPASS, TEST_FS, 0.0f, 20.0f + ch, 200.0f + 3.0f * ch); break;
+        default: init_filter(f, BANDSTOP, TEST_FS, 0.0f, 40.0f + ch, 60.0f + ch); break;
+    }
+}
+
+// ο: ÿͨ apply_filter (˲ṹĸ)
+static void test_ref_bank(const float *x, float *ref, int len) {
+    FilterTypeDef f;
+    int ch, n;
+
+    for(ch = 0; ch < TEST_CH; ch++) {
+        test_channel_filter(&f, ch);
+        for(n = 0; n < len; n++) {
+            ref[(size_t)ch * len + n] = apply_filter(x[(size_t)ch * len + n], &f);
+        }
+    }
+}
+
+
+/**
+  * @brief  apply_filter_block / apply_filter_block_tdf2  apply_filter
+  */
+static void test_block(const float *x, float *ref, float *y) {
+    FilterTypeDef f;
+    int ch;
+
+    test_ref_bank(x, ref, TEST_LEN);
+    for(ch = 0; ch < TEST_CH; ch++) {
+        const float *xc = x + (size_t)ch * TEST_LEN;
+        float *yc = y + (size_t)ch * TEST_LEN;
+        test_channel_filter(&f, ch);
+        apply_filter_block(&f, xc, yc, TEST_SPLIT);
+        apply_filter_block(&f, xc + TEST_SPLIT, yc + TEST_SPLIT, TEST_LEN - TEST_SPLIT);
+    }
+    TEST_CHECK(test_close("apply_filter_block", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+    for(ch = 0; ch < TEST_CH; ch++) {
+        const float *xc = x + (size_t)ch * TEST_LEN;
+        float *yc = y + (size_t)ch * TEST_LEN;
+        test_channel_filter(&f, ch);
+        apply_filter_block_tdf2(&f, xc, yc, TEST_SPLIT);
+        // the block forms hand over to each other through the x/y delay line
+        apply_filter_block(&f, xc + TEST_SPLIT, yc + TEST_SPLIT, 1);
+        apply_filter_block_tdf2(&f, xc + TEST_SPLIT + 1, yc + TEST_SPLIT + 1, TEST_LEN - TEST_SPLIT - 1);
+    }
+    TEST_CHECK(test_close("apply_filter_block_tdf2", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+}
+
+
+/**
+  * @brief  ˲: ͨ, ֯֡, 16 λ· apply_filter
+  */
+static void test_bank(const float *x, const float *frames, float *ref, float *y) {
+    static const FilterSampleType fmts[2] = { FILTER_SAMPLE_F16, FILTER_SAMPLE_BF16 };
+    static uint16_t xh[TEST_CH * TEST_LEN], fh[TEST_LEN * TEST_STRIDE], yh[TEST_LEN * TEST_STRIDE];
+    static float xr[TEST_CH * TEST_LEN];
+    FilterBankTypeDef bank;
+    FilterTypeDef f;
+    double ulp;
+    int ch, n, i;
+
+    TEST_CHECK(init_filter_bank(&bank, TEST_CH, LOWPASS, TEST_FS, 0.0f, 100.0f, 0.0f) == 0);
+    if(bank.mem == NULL) {
+        return;
+    }
+    for(ch = 0; ch < TEST_CH; ch++) {
+        test_channel_filter(&f, ch);
+        set_filter_bank_channel(&bank, ch, &f);
+    }
+    test_ref_bank(x, ref, TEST_LEN);
+
+    // planar, two calls
+    reset_filter_bank(&bank);
+    test_slice(x, 0, TEST_SPLIT, xr);
+    apply_filter_bank(&bank, xr, xr, TEST_SPLIT);
+    test_unslice(xr, 0, TEST_SPLIT, y);
+    test_slice(x, TEST_SPLIT, TEST_LEN - TEST_SPLIT, xr);
+    apply_filter_bank(&bank, xr, xr, TEST_LEN - TEST_SPLIT);
+    test_unslice(xr, TEST_SPLIT, TEST_LEN - TEST_SPLIT, y);
+    TEST_CHECK(test_close("apply_filter_bank", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+
+    // interleaved frames -> interleaved output, two calls
+    reset_filter_bank(&bank);
+    apply_filter_bank_frames(&bank, frames, TEST_STRIDE, y, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_SPLIT);
+    apply_filter_bank_frames(&bank, frames + (size_t)TEST_SPLIT * TEST_STRIDE, TEST_STRIDE,
+                             y + (size_t)TEST_SPLIT * TEST_STRIDE, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_LEN - TEST_SPLIT);
+    TEST_CHECK(test_close("apply_filter_bank_frames interleaved", y, 1, TEST_STRIDE, ref, TEST_CH, TEST_LEN, TEST_TOL));
+
+    // interleaved frames -> planar output
+    reset_filter_bank(&bank);
+    apply_filter_bank_frames(&bank, frames, TEST_STRIDE, y, FILTER_LAYOUT_PLANAR, TEST_LEN, TEST_LEN);
+    TEST_CHECK(test_close("apply_filter_bank_frames planar", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+
+    // 16 bit samples: the reference filters the rounded input, outputs may differ by one rounding step
+    for(i = 0; i < 2; i++) {
+        ulp = fmts[i] == FILTER_SAMPLE_F16 ? 1.0 / 1024.0 : 1.0 / 128.0;
+        for(n = 0; n < TEST_CH * TEST_LEN; n++) {
+            xh[n] = filter_f32_to_half(fmts[i], x[n]);
+            xr[n] = filter_half_to_f32(fmts[i], xh[n]);
+        }
+        test_ref_bank(xr, ref, TEST_LEN);
+
+        reset_filter_bank(&bank);
+        apply_filter_bank_half(&bank, fmts[i], xh, xh, TEST_LEN);
+        for(n = 0; n < TEST_CH * TEST_LEN; n++) {
+            y[n] = filter_half_to_f32(fmts[i], xh[n]);
+        }
+        TEST_CHECK(test_close("apply_filter_bank_half", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, ulp + TEST_TOL));
+
+        for(n = 0; n < TEST_LEN; n++) {
+            for(ch = 0; ch < TEST_STRIDE; ch++) {
+                fh[(size_t)n * TEST_STRIDE + ch] = ch < TEST_CH ? filter_f32_to_half(fmts[i], xr[(size_t)ch * TEST_LEN + n]) : 0;
+            }
+        }
+        reset_filter_bank(&bank);
+        apply_filter_bank_frames_half(&bank, fmts[i], fh, TEST_STRIDE, yh, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_SPLIT);
+        apply_filter_bank_frames_half(&bank, fmts[i], fh + (size_t)TEST_SPLIT * TEST_STRIDE, TEST_STRIDE,
+                                      yh + (size_t)TEST_SPLIT * TEST_STRIDE, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_LEN - TEST_SPLIT);
+        for(n = 0; n < TEST_LEN * TEST_STRIDE; n++) {
+            y[n] = filter_half_to_f32(fmts[i], yh[n]);
+        }
+        TEST_CHECK(test_close("apply_filter_bank_frames_half interleaved", y, 1, TEST_STRIDE, ref, TEST_CH, TEST_LEN, ulp + TEST_TOL));
+
+        reset_filter_bank(&bank);
+        apply_filter_bank_frames_half(&bank, fmts[i], fh, TEST_STRIDE, yh, FILTER_LAYOUT_PLANAR, TEST_LEN, TEST_LEN);
+        for(n = 0; n < TEST_CH * TEST_LEN; n++) {
+            y[n] = filter_half_to_f32(fmts[i], yh[n]);
+        }
+        TEST_CHECK(test_close("apply_filter_bank_frames_half planar", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, ulp + TEST_TOL));
+    }
+    free_filter_bank(&bank);
+}
+
+
+/**
+  * @brief  ں˲: ͨ, ֯֡ (ԭ,  filter_dma ͬ), ͨ, ͳƸ· apply_filter
+  */
+static void test_chain(const float *x, const float *frames, float *ref, float *y) {
+    static const FilterChainStageDef stages[4] = {
+        { NOTCH,    50.0f, 0.0f,   0.0f },
+        { HIGHPASS, 0.0f,  0.0f,   1.0f },
+        { LOWPASS,  0.0f,  100.0f, 0.0f },
+        { BANDSTOP, 0.0f,  140.0f, 160.0f },
+    };
+    static float buf[TEST_LEN * TEST_STRIDE];
+    FilterChainTypeDef chain;
+    FilterStatsTypeDef stats;
+    FilterTypeDef f[4];
+    float v;
+    int ch, n, s;
+
+    TEST_CHECK(init_filter_chain(&chain, TEST_CH, TEST_FS, stages, 4) == 0);
+    if(chain.mem == NULL) {
+        return;
+    }
+    // every third channel gets its own second stage
+    for(ch = 0; ch < TEST_CH; ch += 3) {
+        test_channel_filter(&f[0], ch);
+        set_filter_chain_stage(&chain, ch, 1, &f[0]);
+    }
+    for(ch = 0; ch < TEST_CH; ch++) {
+        for(s = 0; s < 4; s++) {
+            init_filter(&f[s], stages[s].class, TEST_FS, stages[s].notch_cut, stages[s].low_cut, stages[s].high_cut);
+        }
+        if(ch % 3 == 0) {
+            test_channel_filter(&f[1], ch);
+        }
+        for(n = 0; n < TEST_LEN; n++) {
+            v = x[(size_t)ch * TEST_LEN + n];
+            for(s = 0; s < 4; s++) {
+                v = apply_filter(v, &f[s]);
+            }
+            ref[(size_t)ch * TEST_LEN + n] = v;
+        }
+    }
+
+    reset_filter_chain(&chain);
+    test_slice(x, 0, TEST_SPLIT, buf);
+    apply_filter_chain(&chain, buf, buf, TEST_SPLIT);
+    test_unslice(buf, 0, TEST_SPLIT, y);
+    test_slice(x, TEST_SPLIT, TEST_LEN - TEST_SPLIT, buf);
+    apply_filter_chain(&chain, buf, buf, TEST_LEN - TEST_SPLIT);
+    test_unslice(buf, TEST_SPLIT, TEST_LEN - TEST_SPLIT, y);
+    TEST_CHECK(test_close("apply_filter_chain", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+
+    // in place on the frames, two calls, like filter_dma_process_half
+    memcpy(buf, frames, sizeof(buf));
+    reset_filter_chain(&chain);
+    apply_filter_chain_frames(&chain, buf, TEST_STRIDE, buf, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_SPLIT);
+    apply_filter_chain_frames(&chain, buf + (size_t)TEST_SPLIT * TEST_STRIDE, TEST_STRIDE,
+                              buf + (size_t)TEST_SPLIT * TEST_STRIDE, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_LEN - TEST_SPLIT);
+    TEST_CHECK(test_close("apply_filter_chain_frames interleaved", buf, 1, TEST_STRIDE, ref, TEST_CH, TEST_LEN, TEST_TOL));
+
+    reset_filter_chain(&chain);
+    apply_filter_chain_frames(&chain, frames, TEST_STRIDE, y, FILTER_LAYOUT_PLANAR, TEST_LEN, TEST_LEN);
+    TEST_CHECK(test_close("apply_filter_chain_frames planar", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+
+    // the kernels take a separate branch when statistics are attached
+    TEST_CHECK(init_filter_stats(&stats, TEST_CH, 64, TEST_FS, 0.01f) == 0);
+    TEST_CHECK(attach_filter_chain_stats(&chain, &stats) == 0);
+    reset_filter_chain(&chain);
+    apply_filter_chain(&chain, x, y, TEST_LEN);
+    TEST_CHECK(test_close("apply_filter_chain with stats", y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+    TEST_CHECK(stats.blocks == TEST_LEN / 64);
+    chain.stats = NULL;
+    free_filter_stats(&stats);
+    free_filter_chain(&chain);
+}
+
+
+/**
+  * @brief  : ûƵƵʱͨľֱӼ
+  */
+static void test_tone(const float *x) {
+    static float rms[TEST_CH];
+    ToneMonitorTypeDef mon;
+    double e;
+    int ch, n, bins;
+
+    for(ch = 0; ch < TEST_CH; ch++) {
+        for(e = 0.0, n = 0; n < TEST_LEN; n++) {
+            e += (double)x[(size_t)ch * TEST_LEN + n] * x[(size_t)ch * TEST_LEN + n];
+        }
+        rms[ch] = (float)sqrt(e / TEST_LEN);
+    }
+    for(bins = 0; bins <= 2; bins += 2) {
+        TEST_CHECK(init_tone_monitor(&mon, TEST_CH, NULL, 0, TEST_LEN) == 0);
+        mon.fs = TEST_FS;
+        for(n = 0; n < bins; n++) {
+            add_tone_monitor_bin(&mon, 50.0f * (n + 1));
+        }
+        apply_tone_monitor(&mon, x, TEST_LEN);
+        TEST_CHECK(mon.windows == 1);
+        TEST_CHECK(test_close(bins == 0 ? "tone monitor rms, no bins" : "tone monitor rms", mon.rms, 1, 1,
+                              rms, TEST_CH, 1, TEST_TOL));
+        free_tone_monitor(&mon);
+    }
+}
+
+
+// ο:  ch ͨ n ʱ̵Ļƽ / ֵ, Ϊ min(n + 1, window) 
+static void test_ref_running(RunningFilterClassType class, const float *x, float *ref, int window) {
+    double win[64], t, sum;
+    int ch, n, k, m, i, j;
+
+    for(ch = 0; ch < TEST_CH; ch++) {
+        for(n = 0; n < TEST_LEN; n++) {
+            m = n + 1 < window ? n + 1 : window;
+            for(k = 0, sum = 0.0; k < m; k++) {
+                win[k] = x[(size_t)ch * TEST_LEN + n - k];
+                sum += win[k];
+            }
+            if(class == MOVING_AVERAGE) {
+                ref[(size_t)ch * TEST_LEN + n] = (float)(sum / m);
+                continue;
+            }
+            for(i = 1; i < m; i++) {
+                for(j = i, t = win[i]; j > 0 && win[j - 1] > t; j--) {
+                    win[j] = win[j - 1];
+                }
+                win[j] = t;
+            }
+            ref[(size_t)ch * TEST_LEN + n] = (float)(m & 1 ? win[m / 2] : 0.5 * (win[m / 2 - 1] + win[m / 2]));
+        }
+    }
+}
+
+/**
+  * @brief  ƽ, ֵ (ż), CIC ȡֱӼ
+  */
+static void test_running(const float *x, const float *frames, float *ref, float *y) {
+    static const struct { RunningFilterClassType class; int window; const char *name; } cases[3] = {
+        { MOVING_AVERAGE, 7, "moving average" },
+        { MOVING_MEDIAN,  7, "moving median, odd window" },
+        { MOVING_MEDIAN,  8, "moving median, even window" },
+    };
+    static float xi[TEST_CH * TEST_LEN], fi[TEST_LEN * TEST_STRIDE];
+    RunningFilterTypeDef rf;
+    const int R = 4, N = 3;
+    double acc;
+    int c, ch, n, k, got;
+
+    for(c = 0; c < 3; c++) {
+        TEST_CHECK(init_running_filter(&rf, cases[c].class, TEST_CH, cases[c].window, 0) == 0);
+        test_ref_running(cases[c].class, x, ref, cases[c].window);
+
+        TEST_CHECK(apply_running_filter(&rf, x, y, TEST_LEN) == TEST_LEN);
+        TEST_CHECK(test_close(cases[c].name, y, TEST_LEN, 1, ref, TEST_CH, TEST_LEN, TEST_TOL));
+
+        reset_running_filter(&rf);
+        got = apply_running_filter_frames(&rf, frames, TEST_STRIDE, y, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_SPLIT);
+        got += apply_running_filter_frames(&rf, frames + (size_t)TEST_SPLIT * TEST_STRIDE, TEST_STRIDE,
+                                           y + (size_t)TEST_SPLIT * TEST_STRIDE, FILTER_LAYOUT_INTERLEAVED, TEST_STRIDE, TEST_LEN - TEST_SPLIT);
+        TEST_CHECK(got == TEST_LEN);
+        TEST_CHECK(test_close(cases[c].name, y, 1, TEST_STRIDE, ref, TEST_CH, TEST_LEN, TEST_TOL));
+        free_running_filter(&rf);
+    }
+
+    // CIC: N boxcars of length R at the full rate, every R-th output, gain R^N; the input is rounded to integers
+    for(n = 0; n < TEST_CH * TEST_LEN; n++) {
+        xi[n] = (float)lrintf(1000.0f * x[n]);
+    }
+    test_interleave(xi, fi, TEST_CH, TEST_LEN, TEST_STRIDE);
+    for(ch = 0; ch < TEST_CH; ch++) {
+        float *r = ref + (size_t)ch * TEST_LEN;
+        memcpy(r, xi + (size_t)ch * TEST_LEN, TEST_LEN * sizeof(float));
+        for(c = 0; c < N; c++) {
+            for(n = TEST_LEN - 1; n >= 0; n--) {
+                for(acc = 0.0, k = 0; k < R && k <= n; k++) {
+                    acc += r[n - k];
+                }
+                r[n] = (float)acc;
+            }
+        }
+        for(n = 0; n < TEST_LEN / R; n++) {
+            r[n] = (float)(r[n * R + R - 1] / pow(R, N));
+        }
+    }
+    TEST_CHECK(init_running_filter(&rf, CIC_DECIMATOR, TEST_CH, R, N) == 0);
+    got = apply_running_filter(&rf, xi, y, TEST_LEN);
+    TEST_CHECK(got == TEST_LEN / R);
+    for(ch = 0; ch < TEST_CH; ch++) {
+        memmove(ref + (size_t)ch * got, ref + (size_t)ch * TEST_LEN, (size_t)got * sizeof(float));
+        memmove(y + (size_t)ch * got, y + (size_t)ch * TEST_LEN, (size_t)got * sizeof(float));
+    }
+    TEST_CHECK(test_close("cic", y, (size_t)got, 1, ref, TEST_CH, got, 1e-6));
+
+    // frames, split where the decimation phase is not zero
+    reset_running_filter(&rf);
+    got = apply_running_filter_frames(&rf, fi, TEST_STRIDE, y, FILTER_LAYOUT_PLANAR, TEST_LEN, TEST_SPLIT);
+    got += apply_running_filter_frames(&rf, fi + (size_t)TEST_SPLIT * TEST_STRIDE, TEST_STRIDE,
+                                       y + got, FILTER_LAYOUT_PLANAR, TEST_LEN, TEST_LEN - TEST_SPLIT);
+    TEST_CHECK(got == TEST_LEN / R);
+    for(ch = 0; ch < TEST_CH; ch++) {
+        memmove(y + (size_t)ch * got, y + (size_t)ch * TEST_LEN, (size_t)got * sizeof(float));
+    }
+    TEST_CHECK(test_close("cic frames", y, (size_t)got, 1, ref, TEST_CH, got, 1e-6));
+    free_running_filter(&rf);
+}
+
+
+/**
+  * @brief  filter_freqz ˫ֱӼ H(e^jw) = prod B / A, ȺӳΪ -d(arg H)/dw ֮
+  */
+static void test_freqz(void) {
+    enum { NF = 301 };
+    static float freqs[NF], mag[NF], phase[NF], gd[NF];
+    FilterTypeDef stages[4];
+    double w, re, im, br, bi, ar, ai, dbr, dar, d, g, m, p, err_m = 0.0, err_p = 0.0, err_g = 0.0;
+    int i, s, skip;
+
+    init_filter(&stages[0], NOTCH, TEST_FS, 50.0f, 0.0f, 0.0f);
+    init_filter(&stages[1], HIGHPASS, TEST_FS, 0.0f, 0.0f, 1.0f);
+    init_filter(&stages[2], LOWPASS, TEST_FS, 0.0f, 100.0f, 0.0f);
+    init_filter(&stages[3], BANDSTOP, TEST_FS, 0.0f, 140.0f, 160.0f);
+    for(i = 0; i < NF; i++) {
+        freqs[i] = 0.5f * TEST_FS * i / (NF - 1);
+    }
+    TEST_CHECK(filter_freqz(stages, 4, freqs, NF, mag, phase, gd) == 0);
+    for(i = 0; i < NF; i++) {
+        w = 2.0 * TEST_PI * freqs[i] / TEST_FS;
+        re = 1.0;
+        im = 0.0;
+        g = 0.0;
+        skip = 0;
+        for(s = 0; s < 4; s++) {
+            const float *b = stages[s].b, *a = stages[s].a;
+            // B = b0 + b1 z^-1 + b2 z^-2, z^-k = cos(kw) - j sin(kw)
+            br = b[0] + b[1] * cos(w) + b[2] * cos(2.0 * w);
+            bi = -b[1] * sin(w) - b[2] * sin(2.0 * w);
+            ar = a[0] + a[1] * cos(w) + a[2] * cos(2.0 * w);
+            ai = -a[1] * sin(w) - a[2] * sin(2.0 * w);
+            // Re((b1 z^-1 + 2 b2 z^-2) / B), same for A
+            dbr = b[1] * cos(w) + 2.0 * b[2] * cos(2.0 * w);
+            dar = a[1] * cos(w) + 2.0 * a[2] * cos(2.0 * w);
+            d = br * br + bi * bi;
+            skip |= d < 1e-6;
+            g += d > 0.0 ? (dbr * br + (-b[1] * sin(w) - 2.0 * b[2] * sin(2.0 * w)) * bi) / d : 0.0;
+            g -= (dar * ar + (-a[1] * sin(w) - 2.0 * a[2] * sin(2.0 * w)) * ai) / (ar * ar + ai * ai);
+            // H *= B / A
+            p = (br * ar + bi * ai) / (ar * ar + ai * ai);
+            m = (bi * ar - br * ai) / (ar * ar + ai * ai);
+            d = re * p - im * m;
+            im = re * m + im * p;
+            re = d;
+        }
+        // zeros of the notch / band stop: magnitude is -inf and phase is undefined
+        if(skip || re * re + im * im < 1e-8) {
+            continue;
+        }
+        m = fabs(pow(10.0, mag[i] / 20.0) - sqrt(re * re + im * im));
+        p = fabs(remainder(phase[i] - atan2(im, re), 2.0 * TEST_PI));
+        d = fabs(gd[i] - g) / (1.0 + fabs(g));
+        err_m = m > err_m ? m : err_m;
+        err_p = p > err_p ? p : err_p;
+        err_g = d > err_g ? d : err_g;
+    }
+    if(err_m > 1e-4 || err_p > 1e-3 || err_g > 1e-3) {
+        printf("[%s] freqz: max error |H| %g, phase %g, group delay %g\n", test_isa, err_m, err_p, err_g);
+    }
+    TEST_CHECK(err_m <= 1e-4);
+    TEST_CHECK(err_p <= 1e-3);
+    TEST_CHECK(err_g <= 1e-3);
+}
+
+
+/**
+  * @brief  Welch ˫ DFT: ȥֵ,  Hann , ܶ, average ƽ
+  */
+static void test_welch(const float *x, const float *frames) {
+    enum { NFFT = 64, OVERLAP = 24, AVG = 3, HOP = NFFT - OVERLAP, SPAN = NFFT + HOP * (AVG - 1) };
+    static float ref[TEST_CH * (NFFT / 2 + 1)];
+    FilterSpectrumTypeDef spec;
+    double win[NFFT], seg[NFFT], sum_sq = 0.0, mean, re, im, err, scale;
+    int ch, k, n, t, path;
+
+    for(n = 0; n < NFFT; n++) {
+        win[n] = 0.5 - 0.5 * cos(2.0 * TEST_PI * n / NFFT);
+        sum_sq += win[n] * win[n];
+    }
+    for(ch = 0; ch < TEST_CH; ch++) {
+        for(k = 0; k <= NFFT / 2; k++) {
+            ref[(size_t)ch * (NFFT / 2 + 1) + k] = 0.0f;
+        }
+        for(t = 0; t < AVG; t++) {
+            for(mean = 0.0, n = 0; n < NFFT; n++) {
+                seg[n] = x[(size_t)ch * TEST_LEN + t * HOP + n];
+                mean += seg[n] / NFFT;
+            }
+            for(k = 0; k <= NFFT / 2; k++) {
+                for(re = 0.0, im = 0.0, n = 0; n < NFFT; n++) {
+                    re += win[n] * (seg[n] - mean) * cos(2.0 * TEST_PI * k * n / NFFT);
+                    im -= win[n] * (seg[n] - mean) * sin(2.0 * TEST_PI * k * n / NFFT);
+                }
+                ref[(size_t)ch * (NFFT / 2 + 1) + k] += (float)((k == 0 || k == NFFT / 2 ? 1.0 : 2.0)
+                                                               * (re * re + im * im) / (TEST_FS * sum_sq) / AVG);
+            }
+        }
+    }
+    for(path = 0; path < 2; path++) {
+        TEST_CHECK(init_filter_spectrum(&spec, TEST_CH, TEST_FS, NFFT, OVERLAP, FILTER_WINDOW_HANN, AVG) == 0);
+        if(spec.mem == NULL) {
+            return;
+        }
+        if(path == 0) {
+            // planar input of the first SPAN samples, in blocks that cross the segment boundaries
+            static float blk[TEST_CH * 29];
+            for(n = 0; n < SPAN; n += t) {
+                t = SPAN - n < 29 ? SPAN - n : 29;
+                for(ch = 0; ch < TEST_CH; ch++) {
+                    memcpy(blk + (size_t)ch * t, x + (size_t)ch * TEST_LEN + n, (size_t)t * sizeof(float));
+                }
+                apply_filter_spectrum(&spec, blk, t);
+            }
+        }
+        else {
+            apply_filter_spectrum_frames(&spec, frames, TEST_STRIDE, 50);
+            apply_filter_spectrum_frames(&spec, frames + (size_t)50 * TEST_STRIDE, TEST_STRIDE, SPAN - 50);
+        }
+        TEST_CHECK(spec.psds == 1);
+        for(ch = 0, err = 0.0, scale = 0.0; ch < TEST_CH; ch++) {
+            for(k = 0; k <= NFFT / 2; k++) {
+                const double r = ref[(size_t)ch * (NFFT / 2 + 1) + k];
+                const double d = fabs(spec.psd[(size_t)k * TEST_CH + ch] - r);
+                err = d > err ? d : err;
+                scale = r > scale ? r : scale;
+            }
+        }
+        if(err > 1e-4 * scale) {
+            printf("[%s] welch %s: max error %g (peak %g)\n", test_isa, path == 0 ? "planar" : "frames", err, scale);
+        }
+        TEST_CHECK(err <= 1e-4 * scale);
+        free_filter_spectrum(&spec);
+    }
+}
+
+
+/**
+  * @brief  һָںв
+  */
+static void test_isa_run(FilterIsaType isa) {
+    static float x[TEST_CH * TEST_LEN], frames[TEST_LEN * TEST_STRIDE];
+    static float ref[TEST_CH * TEST_LEN], y[TEST_LEN * TEST_STRIDE];
+    const int before = test_failures;
+
+    test_isa = filter_isa_name(isa);
+    if(filter_select_isa(isa) != 0) {
+        printf("[%s] not supported by this cpu, skipped\n", test_isa);
+        return;
+    }
+    test_signal(x, TEST_CH, TEST_LEN);
+    test_interleave(x, frames, TEST_CH, TEST_LEN, TEST_STRIDE);
+    test_block(x, ref, y);
+    test_bank(x, frames, ref, y);
+    test_chain(x, frames, ref, y);
+    test_tone(x);
+    test_running(x, frames, ref, y);
+    test_freqz();
+    test_welch(x, frames);
+    printf("[%s] %s\n", test_isa, test_failures == before ? "ok" : "FAILED");
+}
+
+int main(int argc, char **argv) {
+
+    int isa;
+
+    if(argc > 2) {
+        fprintf(stderr, "usage: %s [scalar|sse4|avx2|avx512]\n", argv[0]);
+        return 1;
+    }
+    for(isa = 0; isa < FILTER_ISA_COUNT; isa++) {
+        if(argc == 1 || strcmp(argv[1], filter_isa_name((FilterIsaType)isa)) == 0) {
+            test_isa_run((FilterIsaType)isa);
+            if(argc > 1) {
+                break;
+            }
+        }
+    }
+    if(argc > 1 && isa == FILTER_ISA_COUNT) {
+        fprintf(stderr, "usage: %s [scalar|sse4|avx2|avx512]\n", argv[0]);
+        return 1;
+    }
+    return test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+/**
+  ******************************************************************************
+  * @file           : filter_tone.c
+  * @brief          : 鹦ļ.
+                      Goertzel : s[n] = x[n] + 2cos(w) * s[n-1] - s[n-2]
+                      ڽʱ:   |X|^2 = s[n-1]^2 + s[n-2]^2 - 2cos(w) * s[n-1] * s[n-2]
+                      ҷ:     A = 2 * |X| / N
+  * @attention      :
+                      ʹʾ (ο):
+
+                        FilterTypeDef notch;        // ݲ˲
+                        ToneMonitorTypeDef mon;     // 嵥ṹ
+
+                        void publish(const ToneMonitorTypeDef *mon, void *ctx) {
+                            //  mon->amplitude / tone_monitor_ratio_db ͵
+                        }
+
+                        int main(void) {
+
+                            init_filter(&notch, NOTCH, 2000.0f, 50.0f, 0.0f, 0.0f);
+                            init_tone_monitor(&mon, 64, &notch, 3, 2000); // 50, 100, 150 Hz, ÿһ
+                            mon.on_window = publish;
+
+                            while(1) {
+
+                                apply_filter_chain(&chain, xn, yn, 256);
+                                apply_tone_monitor(&mon, yn, 256); // ݲ֮Ĳ
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_tone.h"
+#include "filter_dispatch.h"
+#include "filter_instr.h"
+
+#define TONE_MONITOR_PI     3.14159265358979323846
+
+
+/**
+  * @brief  ʼ
+  * @note   ƵΪ˲Ƶʵ 1 ~ harmonics г ( fs/2 г):
+  *         NOTCH ƵΪ notch_cut, BANDSTOP / BANDPASS Ϊ sqrt(low_cut * high_cut).
+  *         notch Ϊ NULL ʱƵ, ƵĬΪ 2000 Hz, ޸ mon->fs  add_tone_monitor_bin .
+  * @param  mon:        ṹַ
+  * @param  channels:   ͨ
+  * @param  notch:      ݲ () ˲, ṩƵʺͲƵ
+  * @param  harmonics:  г
+  * @param  window:      (), ΪƵڵʱй©С
+  * @retval 0: ɹ; -1: ڴʧ
+  */
+int init_tone_monitor(ToneMonitorTypeDef *mon, int channels, const FilterTypeDef *notch, int harmonics, int window) {
+
+    float center = 0.0f;
+    size_t n;
+    int h;
+
+    memset(mon, 0, sizeof(*mon));
+    if(channels <= 0 || window <= 0) {
+        return -1;
+    }
+    n = (size_t)channels;
+    mon->mem = (float *)calloc(n * (3 * TONE_MONITOR_MAX_BINS + 2), sizeof(float));
+    if(mon->mem == NULL) {
+        return -1;
+    }
+    mon->channels = channels;
+    mon->window = window;
+    mon->fs = 2000.0f;
+    mon->s1 = mon->mem;
+    mon->s2 = mon->s1 + n * TONE_MONITOR_MAX_BINS;
+    mon->amplitude = mon->s2 + n * TONE_MONITOR_MAX_BINS;
+    mon->energy = mon->amplitude + n * TONE_MONITOR_MAX_BINS;
+    mon->rms = mon->energy + n;
+
+    if(notch == NULL) {
+        return 0;
+    }
+    mon->fs = notch->fs;
+    if(notch->class == NOTCH) {
+        center = notch->notch_cut;
+    }
+    else if(notch->class == BANDSTOP || notch->class == BANDPASS) {
+        center = sqrtf(notch->low_cut * notch->high_cut);
+    }
+    if(center <= 0.0f) {
+        free_tone_monitor(mon);
+        return -1;
+    }
+    for(h = 1; h <= harmonics && center * h < 0.5f * mon->fs; h++) {
+        if(add_tone_monitor_bin(mon, center * h) != 0) {
+            break;
+        }
+    }
+    return 0;
+}
+
+
+/**
+  * @brief  һƵ (ͬʱ 50 Hz  60 Hz)
+  * @param  mon:        ṹַ
+  * @param  freq:       Ƶ (Hz)
+  * @retval Ƶ; -1: Ƶ
+  */
+int add_tone_monitor_bin(ToneMonitorTypeDef *mon, float freq) {
+    if(mon->bins >= TONE_MONITOR_MAX_BINS) {
+        return -1;
+    }
+    mon->freq[mon->bins] = freq;
+    mon->coeff[mon->bins] = (float)(2.0 * cos(2.0 * TONE_MONITOR_PI * freq / mon->fs));
+    return mon->bins++;
+}
+
+
+/**
+  * @brief  ͷŵڴ
+  * @param  mon:        ṹַ
+  * @retval None
+  */
+void free_tone_monitor(ToneMonitorTypeDef *mon) {
+    free(mon->mem);
+    memset(mon, 0, sizeof(*mon));
+}
+
+
+/**
+  * @brief  һ: , ״̬, ûص
+  */
+static void tone_monitor_publish(ToneMonitorTypeDef *mon) {
+    const int C = mon->channels;
+    const float scale = 2.0f / (float)mon->window;
+    float s1, s2, p;
+    int b, ch;
+
+    for(b = 0; b < mon->bins; b++) {
+        for(ch = 0; ch < C; ch++) {
+            s1 = mon->s1[b * C + ch];
+            s2 = mon->s2[b * C + ch];
+            p = s1 * s1 + s2 * s2 - mon->coeff[b] * s1 * s2;
+            mon->amplitude[b * C + ch] = scale * sqrtf(p > 0.0f ? p : 0.0f);
+        }
+    }
+    for(ch = 0; ch < C; ch++) {
+        mon->rms[ch] = sqrtf(mon->energy[ch] / (float)mon->window);
+    }
+    memset(mon->s1, 0, (size_t)C * TONE_MONITOR_MAX_BINS * 2 * sizeof(float));
+    memset(mon->energy, 0, (size_t)C * sizeof(float));
+    mon->count = 0;
+    mon->windows++;
+    if(mon->on_window != NULL) {
+        mon->on_window(mon, mon->ctx);
+    }
+}
+
+
+/**
+  * @brief  ⴦ (ͨŵ)
+  * @note    ch ͨ n ʱ̵ĲΪ input[ch * len + n]; ԿԽڱ߽.
+  * @param  mon:        ṹַ
+  * @param  input:       (channels * len), ͨݲ֮
+  * @param  len:        ÿͨĲ
+  * @retval None
+  */
+void apply_tone_monitor(ToneMonitorTypeDef *mon, const float *input, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    int n0, seg;
+
+    FILTER_INSTR_BEGIN();
+    for(n0 = 0; n0 < len; n0 += seg) {
+        seg = len - n0;
+        if(seg > mon->window - mon->count) {
+            seg = mon->window - mon->count;
+        }
+        filter_run_planar(k->goertzel, k->width, mon, mon->channels, input + n0, len, NULL, 0, seg);
+        mon->count += seg;
+        if(mon->count == mon->window) {
+            tone_monitor_publish(mon);
+        }
+    }
+    FILTER_INSTR_END(FILTER_SITE_TONE, mon, (long)mon->channels * len, NULL, 0, 0, 0);
+}
+
+
+/**
+  * @brief  ⴦ (֯֡)
+  * @param  mon:            ṹַ
+  * @param  frames:         ֡,  ch ͨ n ʱ̵ĲΪ frames[n * frame_stride + ch]
+  * @param  frame_stride:   ֡ļ (float )
+  * @param  len:            ֡
+  * @retval None
+  */
+void apply_tone_monitor_frames(ToneMonitorTypeDef *mon, const float *frames, int frame_stride, int len) {
+    const FilterKernelTable *k = filter_kernels();
+    int n0, seg;
+
+    FILTER_INSTR_BEGIN();
+    for(n0 = 0; n0 < len; n0 += seg) {
+        seg = len - n0;
+        if(seg > mon->window - mon->count) {
+            seg = mon->window - mon->count;
+        }
+        filter_run_frames(k->goertzel, mon, mon->channels, frames + (size_t)n0 * frame_stride, frame_stride,
+                          NULL, FILTER_LAYOUT_INTERLEAVED, 0, seg);
+        mon->count += seg;
+        if(mon->count == mon->window) {
+            tone_monitor_publish(mon);
+        }
+    }
+    FILTER_INSTR_END(FILTER_SITE_TONE, mon, (long)mon->channels * len, NULL, 0, 0, 0);
+}
+
+
+/**
+  * @brief  ռܹͨʵı
+  * @param  mon:        ṹַ
+  * @param  bin:        Ƶ
+  * @param  ch:         ͨ
+  * @retval 10 * log10( / ܹ) (dB), һɵĴ
+  */
+float tone_monitor_ratio_db(const ToneMonitorTypeDef *mon, int bin, int ch) {
+    const float a = mon->amplitude[bin * mon->channels + ch];
+    const float r = mon->rms[ch];
+    // sine power is A^2 / 2
+    return 10.0f * log10f((0.5f * a * a + 1e-30f) / (r * r + 1e-30f));
+}
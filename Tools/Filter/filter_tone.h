@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  * @file           : filter_tone.h
+  * @brief          : . ÿͨ Goertzel 㷨Ƶ (50/60 Hz) г
+  *                   , ÿÿƵֻһγ˼ (O(1)), ͨ SIMD м,
+  *                   Զÿÿͨһ FFT. ڼݲ֮ĹƵ.
+  * @attention      : ں˰ʱ CPU ָѡ,  filter_dispatch.h
+
+  ******************************************************************************
+  */
+
+
+// filter_tone.h
+#ifndef FILTER_TONE_H
+#define FILTER_TONE_H
+
+#include "filter.h"
+
+#define TONE_MONITOR_MAX_BINS       16      // Ƶ
+
+// ṹ
+typedef struct tone_monitor {
+    int channels;                           // ͨ
+    int bins;                               // Ƶ
+    int window;                             //  (), ÿһڷһν
+    int count;                              // ǰѴĲ
+    float fs;                               // Ƶ
+    float freq[TONE_MONITOR_MAX_BINS];      // ƵƵ (Hz)
+    float coeff[TONE_MONITOR_MAX_BINS];     // Goertzel ϵ 2 * cos(w)
+    float *s1, *s2;                         // Goertzel ״̬,  b Ƶ ch ͨΪ s1[b * channels + ch]
+    float *energy;                          // ǰڸͨƽ
+    float *amplitude;                       // : һڸƵҷ, ͬ s1
+    float *rms;                             // : һڸͨľ
+    unsigned long windows;                  // ɵĴ
+    void (*on_window)(const struct tone_monitor *mon, void *ctx);  // ÿڽʱĻص, Ϊ NULL
+    void *ctx;                              // ص
+    float *mem;                             // 鹲õڴ
+}ToneMonitorTypeDef;
+
+
+int init_tone_monitor(ToneMonitorTypeDef *mon, int channels, const FilterTypeDef *notch, int harmonics, int window);
+int add_tone_monitor_bin(ToneMonitorTypeDef *mon, float freq);
+void free_tone_monitor(ToneMonitorTypeDef *mon);
+void apply_tone_monitor(ToneMonitorTypeDef *mon, const float *input, int len);
+void apply_tone_monitor_frames(ToneMonitorTypeDef *mon, const float *frames, int frame_stride, int len);
+float tone_monitor_ratio_db(const ToneMonitorTypeDef *mon, int bin, int ch);
+
+#endif
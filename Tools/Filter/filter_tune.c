@@ -0,0 +1,434 @@
+/**
+  ******************************************************************************
+  * @file           : filter_tune.c
+  * @brief          : ˲ںԶŹļ.
+                      ļÿһ¼ ( tab ָ), ֻ׷Ӳд, ͬһһΪ׼:
+                      cpu_model   channels   len   kernel   isa   block_len   ns_per_sample
+  * @attention      :
+                      ʹʾ (ο):
+
+                        FilterBankTypeDef bank_nt; // ˲ṹ
+                        FilterPlanTypeDef plan;    // ִз
+
+                        int main(void) {
+
+                            init_filter_bank(&bank_nt, 64, NOTCH, 2000.0f, 50.0f, 0.0f, 0.0f); // ˲ʼ
+                            filter_autotune(&plan, 64, 256, NULL); // ״ʱԲдļ, ֱ֮Ӷȡ
+
+                            while(1) {
+
+                                apply_filter_plan(&plan, &bank_nt, xn, yn, 256); // ˲
+
+                            }
+
+                        }
+
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "filter_tune.h"
+#include "filter_stats.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(FILTER_HAVE_X86_KERNELS)
+#include <cpuid.h>
+#endif
+
+#define FILTER_TUNE_PROFILE     "filter_tune.profile"   // Ĭļ
+#define FILTER_TUNE_MEM_SLOTS   16                      // ڻķ
+#define FILTER_TUNE_MIN_SAMPLES 65536                   // ÿβٴĲ (ͨϼ)
+#define FILTER_TUNE_REPEAT      3                       // ÿѡԴ, ȡСֵ
+
+static const int filter_tune_block_lens[] = { 64, 256, 1024, 4096 };
+#define FILTER_TUNE_BLOCK_COUNT (int)(sizeof(filter_tune_block_lens) / sizeof(filter_tune_block_lens[0]))
+
+static const char *const filter_plan_kernel_names[FILTER_PLAN_KERNEL_COUNT] = {
+    "per_sample", "block", "block_tdf2", "bank", "chain"
+};
+
+// ڻ
+static struct {
+    int channels;
+    int len;
+    FilterPlanTypeDef plan;
+} filter_tune_mem[FILTER_TUNE_MEM_SLOTS];
+static int filter_tune_mem_count = 0;
+
+// ڻ, ֻڲҺд뻺ʱ (΢׼ڼ䲻)
+#if defined(_MSC_VER)
+static volatile long filter_tune_lock = 0;
+#define FILTER_TUNE_LOCK()      while(InterlockedExchange(&filter_tune_lock, 1) != 0) {}
+#define FILTER_TUNE_UNLOCK()    InterlockedExchange(&filter_tune_lock, 0)
+#else
+static volatile char filter_tune_lock = 0;
+#define FILTER_TUNE_LOCK()      while(__atomic_test_and_set(&filter_tune_lock, __ATOMIC_ACQUIRE)) {}
+#define FILTER_TUNE_UNLOCK()    __atomic_clear(&filter_tune_lock, __ATOMIC_RELEASE)
+#endif
+
+
+/**
+  * @brief  ȡں
+  * @param  kernel:     ں
+  * @retval ںַ
+  */
+const char *filter_plan_kernel_name(FilterPlanKernelType kernel) {
+    if(kernel < 0 || kernel >= FILTER_PLAN_KERNEL_COUNT) {
+        return "unknown";
+    }
+    return filter_plan_kernel_names[kernel];
+}
+
+
+/**
+  * @brief  ȡ CPU ͺַ, Ϊļļ
+  * @note   x86 ƽ̨ȡ CPUID Ʒַ, ƽ̨ "generic"
+  * @retval CPU ͺַ
+  */
+const char *filter_cpu_model(void) {
+    static char model[49];
+#if defined(FILTER_HAVE_X86_KERNELS)
+    unsigned int regs[12];
+    char *p;
+    int i;
+
+    if(model[0] != '\0') {
+        return model;
+    }
+    if(__get_cpuid_max(0x80000000u, NULL) >= 0x80000004u) {
+        for(i = 0; i < 3; i++) {
+            __get_cpuid(0x80000002u + i, &regs[i * 4], &regs[i * 4 + 1], &regs[i * 4 + 2], &regs[i * 4 + 3]);
+        }
+        memcpy(model, regs, 48);
+        model[48] = '\0';
+        // trim and keep the key on one tab separated field
+        for(p = model; *p == ' '; p++) {
+        }
+        memmove(model, p, strlen(p) + 1);
+        for(i = (int)strlen(model) - 1; i >= 0 && model[i] == ' '; i--) {
+            model[i] = '\0';
+        }
+        for(p = model; *p != '\0'; p++) {
+            if(*p == '\t' || *p == '\n') {
+                *p = ' ';
+            }
+        }
+    }
+#endif
+    if(model[0] == '\0') {
+        strcpy(model, "generic");
+    }
+    return model;
+}
+
+
+/**
+  * @brief  ʱ ()
+  */
+static double filter_tune_now_ns(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+
+/**
+  * @brief  õͨں˴˲һͨ
+  * @note   ͨϵӳȿ FilterTypeDef, д.
+  */
+static void filter_plan_run_channel(FilterPlanKernelType kernel, FilterBankTypeDef *bank, int ch,
+                                    const float *input, float *output, int len) {
+    FilterTypeDef f;
+    int n;
+
+    f.b[0] = bank->b0[ch];
+    f.b[1] = bank->b1[ch];
+    f.b[2] = bank->b2[ch];
+    f.a[0] = 1.0f;
+    f.a[1] = bank->a1[ch];
+    f.a[2] = bank->a2[ch];
+    f.x[0] = f.x[1] = bank->x1[ch];
+    f.x[2] = bank->x2[ch];
+    f.y[0] = f.y[1] = bank->y1[ch];
+    f.y[2] = bank->y2[ch];
+    if(kernel == FILTER_PLAN_PER_SAMPLE) {
+        for(n = 0; n < len; n++) {
+            output[n] = apply_filter(input[n], &f);
+        }
+    }
+    else if(kernel == FILTER_PLAN_BLOCK) {
+        apply_filter_block(&f, input, output, len);
+    }
+    else {
+        apply_filter_block_tdf2(&f, input, output, len);
+    }
+    bank->x1[ch] = f.x[1];
+    bank->x2[ch] = f.x[2];
+    bank->y1[ch] = f.y[1];
+    bank->y2[ch] = f.y[2];
+}
+
+
+/**
+  * @brief  ˲װɵں˲, ϵӳֱʹ˲
+  * @note    hist[0] Ϊ x[n-1], x[n-2], hist[1] Ϊ y[n-1], y[n-2], ˲ӳһһӦ.
+  */
+static void filter_plan_chain_view(FilterChainTypeDef *chain, FilterBankTypeDef *bank) {
+    memset(chain, 0, sizeof(*chain));
+    chain->channels = bank->channels;
+    chain->stages = 1;
+    chain->coef[0][0] = bank->b0;
+    chain->coef[0][1] = bank->b1;
+    chain->coef[0][2] = bank->b2;
+    chain->coef[0][3] = bank->a1;
+    chain->coef[0][4] = bank->a2;
+    chain->hist[0][0] = bank->x1;
+    chain->hist[0][1] = bank->x2;
+    chain->hist[1][0] = bank->y1;
+    chain->hist[1][1] = bank->y2;
+}
+
+
+/**
+  * @brief  ִз˲
+  * @note    apply_filter_bank ͬ (ͨ), ÿں˵ô plan->block_len .
+  * @param  plan:       ִз (filter_autotune Ľ)
+  * @param  bank:       ˲ṹַ
+  * @param  input:       (channels * len)
+  * @param  output:      (channels * len)
+  * @param  len:        ÿͨĲ
+  * @retval None
+  */
+void apply_filter_plan(const FilterPlanTypeDef *plan, FilterBankTypeDef *bank, const float *input, float *output, int len) {
+
+    const FilterKernelTable *k = NULL;
+    FilterChainTypeDef chain;
+    int n0, bl, ch;
+
+    if(plan->kernel == FILTER_PLAN_BANK || plan->kernel == FILTER_PLAN_CHAIN) {
+        k = filter_kernels_for(plan->isa);
+        if(k == NULL) {
+            k = filter_kernels();
+        }
+    }
+    if(plan->kernel == FILTER_PLAN_CHAIN) {
+        filter_plan_chain_view(&chain, bank);
+    }
+    for(n0 = 0; n0 < len; n0 += bl) {
+        bl = len - n0;
+        if(plan->block_len > 0 && bl > plan->block_len) {
+            bl = plan->block_len;
+        }
+        if(plan->kernel == FILTER_PLAN_CHAIN) {
+            filter_stats_run_planar(bank->stats, k->chain, k->width, &chain, bank->channels,
+                                    input + n0, len, output + n0, len, bl);
+        }
+        else if(k != NULL) {
+            apply_filter_bank_with(bank, k, input + n0, len, output + n0, len, bl);
+        }
+        else {
+            for(ch = 0; ch < bank->channels; ch++) {
+                filter_plan_run_channel(plan->kernel, bank, ch, input + (size_t)ch * len + n0,
+                                        output + (size_t)ch * len + n0, bl);
+            }
+        }
+    }
+}
+
+
+/**
+  * @brief  ļвҷ
+  * @retval 1: ҵ; 0: ûҵ
+  */
+static int filter_tune_load(const char *path, const char *cpu, int channels, int len, FilterPlanTypeDef *plan) {
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    char *cpu_end;
+    int found = 0;
+    int ch, ln, kernel, isa, block_len;
+    float ns;
+
+    if(fp == NULL) {
+        return 0;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        cpu_end = strchr(line, '\t');
+        if(cpu_end == NULL) {
+            continue;
+        }
+        *cpu_end = '\0';
+        if(strcmp(line, cpu) != 0) {
+            continue;
+        }
+        if(sscanf(cpu_end + 1, "%d\t%d\t%d\t%d\t%d\t%f", &ch, &ln, &kernel, &isa, &block_len, &ns) != 6) {
+            continue;
+        }
+        if(ch != channels || ln != len || kernel < 0 || kernel >= FILTER_PLAN_KERNEL_COUNT || block_len <= 0) {
+            continue;
+        }
+        // the profile may be shared between hosts, never pick an instruction set this CPU lacks
+        if((kernel == FILTER_PLAN_BANK || kernel == FILTER_PLAN_CHAIN) && !filter_cpu_supports((FilterIsaType)isa)) {
+            continue;
+        }
+        plan->kernel = (FilterPlanKernelType)kernel;
+        plan->isa = (FilterIsaType)isa;
+        plan->block_len = block_len;
+        plan->ns_per_sample = ns;
+        found = 1;
+    }
+    fclose(fp);
+    return found;
+}
+
+
+/**
+  * @brief  ׷һļ
+  */
+static void filter_tune_save(const char *path, const char *cpu, int channels, int len, const FilterPlanTypeDef *plan) {
+    FILE *fp = fopen(path, "a");
+    if(fp == NULL) {
+        return;
+    }
+    fprintf(fp, "%s\t%d\t%d\t%d\t%d\t%d\t%.4f\n", cpu, channels, len, (int)plan->kernel, (int)plan->isa,
+            plan->block_len, plan->ns_per_sample);
+    fclose(fp);
+}
+
+
+/**
+  * @brief  һѡ,  / ͨ / 
+  */
+static float filter_tune_measure(const FilterPlanTypeDef *plan, FilterBankTypeDef *bank,
+                                 const float *input, float *output, int len, int iters) {
+    double best = 0.0, t0, t;
+    int r, i;
+
+    for(r = 0; r < FILTER_TUNE_REPEAT; r++) {
+        t0 = filter_tune_now_ns();
+        for(i = 0; i < iters; i++) {
+            apply_filter_plan(plan, bank, input, output, len);
+        }
+        t = filter_tune_now_ns() - t0;
+        if(r == 0 || t < best) {
+            best = t;
+        }
+    }
+    return (float)(best / ((double)iters * bank->channels * len));
+}
+
+
+/**
+  * @brief  ˲ںԶź
+  * @note   ˳: ڻ -> ļ (Ϊ CPU ͺ, ͨ, ݿ鳤) -> ΢׼.
+  *         ΢׼ʹúϳݺݲ˲, ѡں˵ļ˲޹.
+  *         ڻ, ڶ߳е; ͬһڶ߳ͬʱ״εʱԲһ.
+  * @param  plan:           ִз
+  * @param  channels:       ͨ
+  * @param  len:            ÿε apply_filter_plan ʱÿͨĲ
+  * @param  profile_path:   ļ·, NULL ʱʹû FILTER_TUNE_PROFILE Ĭ·
+  * @retval 0: ɹ; -1: ڴʧ (plan Ϊ FILTER_PLAN_BLOCK)
+  */
+int filter_autotune(FilterPlanTypeDef *plan, int channels, int len, const char *profile_path) {
+
+    const char *cpu = filter_cpu_model();
+    FilterBankTypeDef bank;
+    FilterPlanTypeDef cand;
+    float *input, *output;
+    size_t i, samples;
+    int kernel, isa, b, iters, simd, cached = 0;
+    unsigned int seed = 1;
+
+    plan->kernel = FILTER_PLAN_BLOCK;
+    plan->isa = FILTER_ISA_SCALAR;
+    plan->block_len = len;
+    plan->ns_per_sample = 0.0f;
+    if(channels <= 0 || len <= 0) {
+        return -1;
+    }
+    FILTER_TUNE_LOCK();
+    for(b = 0; b < filter_tune_mem_count; b++) {
+        if(filter_tune_mem[b].channels == channels && filter_tune_mem[b].len == len) {
+            *plan = filter_tune_mem[b].plan;
+            cached = 1;
+            break;
+        }
+    }
+    FILTER_TUNE_UNLOCK();
+    if(cached) {
+        return 0;
+    }
+    if(profile_path == NULL) {
+        profile_path = getenv("FILTER_TUNE_PROFILE");
+    }
+    if(profile_path == NULL) {
+        profile_path = FILTER_TUNE_PROFILE;
+    }
+
+    if(!filter_tune_load(profile_path, cpu, channels, len, plan)) {
+        samples = (size_t)channels * (size_t)len;
+        input = (float *)malloc(samples * sizeof(float));
+        output = (float *)malloc(samples * sizeof(float));
+        if(input == NULL || output == NULL || init_filter_bank(&bank, channels, NOTCH, 2000.0f, 50.0f, 0.0f, 0.0f) != 0) {
+            free(input);
+            free(output);
+            return -1;
+        }
+        for(i = 0; i < samples; i++) {
+            seed = seed * 1103515245u + 12345u;
+            input[i] = (float)((seed >> 16) & 0x7fff) - 16384.0f;
+        }
+        // ݿ鱾Ѿٲʱֻһ
+        iters = samples >= FILTER_TUNE_MIN_SAMPLES ? 1 : (int)(FILTER_TUNE_MIN_SAMPLES / samples) + 1;
+        plan->ns_per_sample = -1.0f;
+        for(kernel = 0; kernel < FILTER_PLAN_KERNEL_COUNT; kernel++) {
+            simd = kernel == FILTER_PLAN_BANK || kernel == FILTER_PLAN_CHAIN;
+            for(isa = 0; isa < (simd ? FILTER_ISA_COUNT : 1); isa++) {
+                if(simd && !filter_cpu_supports((FilterIsaType)isa)) {
+                    continue;
+                }
+                for(b = 0; b <= FILTER_TUNE_BLOCK_COUNT; b++) {
+                    cand.kernel = (FilterPlanKernelType)kernel;
+                    cand.isa = (FilterIsaType)isa;
+                    // the last candidate processes the whole buffer in one call
+                    cand.block_len = (b < FILTER_TUNE_BLOCK_COUNT) ? filter_tune_block_lens[b] : len;
+                    if(b < FILTER_TUNE_BLOCK_COUNT && cand.block_len >= len) {
+                        continue;
+                    }
+                    reset_filter_bank(&bank);
+                    cand.ns_per_sample = filter_tune_measure(&cand, &bank, input, output, len, iters);
+                    if(plan->ns_per_sample < 0.0f || cand.ns_per_sample < plan->ns_per_sample) {
+                        *plan = cand;
+                    }
+                }
+            }
+        }
+        free_filter_bank(&bank);
+        free(input);
+        free(output);
+        filter_tune_save(profile_path, cpu, channels, len, plan);
+    }
+
+    FILTER_TUNE_LOCK();
+    if(filter_tune_mem_count < FILTER_TUNE_MEM_SLOTS) {
+        filter_tune_mem[filter_tune_mem_count].channels = channels;
+        filter_tune_mem[filter_tune_mem_count].len = len;
+        filter_tune_mem[filter_tune_mem_count].plan = *plan;
+        filter_tune_mem_count++;
+    }
+    FILTER_TUNE_UNLOCK();
+    return 0;
+}
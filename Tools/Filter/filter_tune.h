@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file           : filter_tune.h
+  * @brief          : ˲ںԶ. Ըͨÿδݿ鳤, ״ʹʱ
+  *                   Ըѡں (, 鴦, TDF-II 鴦, ָ SIMD ˲ں˲) Ϳ鳤
+  *                   ΢׼, ѡִз,  CPU ͺŻ浽ļ.
+  * @attention      : ļ·:  profile_path >  FILTER_TUNE_PROFILE > "filter_tune.profile"
+
+  ******************************************************************************
+  */
+
+
+// filter_tune.h
+#ifndef FILTER_TUNE_H
+#define FILTER_TUNE_H
+
+#include "filter_dispatch.h"
+
+// ѡںöٱ
+typedef enum {
+    FILTER_PLAN_PER_SAMPLE = 0, // ÿͨ apply_filter
+    FILTER_PLAN_BLOCK,          // ÿͨ apply_filter_block (ֱ I )
+    FILTER_PLAN_BLOCK_TDF2,     // ÿͨ apply_filter_block_tdf2 (תֱ II )
+    FILTER_PLAN_BANK,           // SIMD ˲ں, ָ isa
+    FILTER_PLAN_CHAIN,          // SIMD ں˲ں (, ֱʹ˲ϵӳ), ָ isa
+    FILTER_PLAN_KERNEL_COUNT
+} FilterPlanKernelType;
+
+// ִзṹ
+typedef struct filter_plan {
+    FilterPlanKernelType kernel;    // ں
+    FilterIsaType isa;              // ָ ( FILTER_PLAN_BANK / FILTER_PLAN_CHAIN ʹ)
+    int block_len;                  // ÿں˵ôĲ
+    float ns_per_sample;            // õĺʱ ( / ͨ / )
+}FilterPlanTypeDef;
+
+
+int filter_autotune(FilterPlanTypeDef *plan, int channels, int len, const char *profile_path);
+void apply_filter_plan(const FilterPlanTypeDef *plan, FilterBankTypeDef *bank, const float *input, float *output, int len);
+const char *filter_cpu_model(void);
+const char *filter_plan_kernel_name(FilterPlanKernelType kernel);
+
+#endif
@@ -1,22 +1,28 @@
-#include "serial_communicator.h"
+#include "serial_format.h"
 
 int main() {
 
     // 打开串口
-    Useserial();
+    if (Useserial() != 0) {
+        return 1;
+    }
 
-    // 通过 WriteFile 发送数据
+    // 异步发送: 消息进入发送队列, 由写线程合并写出
+    SerialWriter *writer = OpenSerialWriter(comHandle, NULL);
+    if (writer == NULL) {
+        CloseSerial(comHandle);
+        return 1;
+    }
     const char* msg = "Hello, this is a test message!\n";
-    SendMessageToSerial(msg);
+    SendMessageToSerialAsync(writer, msg);
 
-    // 发送变量
+    // 发送变量: 直接格式化到发送队列, 输出 "value=10\r\n"
     int value = 10;
-    char message[2048];
-    sprintf(message, "value=%d\r\n", value);
-    SendMessageToSerial(message);
+    SerialSendInt(writer, "value", value);
 
-    // 关闭串口
+    // 写出全部消息后关闭串口
+    CloseSerialWriter(writer);
     CloseSerial(comHandle);
 
     return 0;
-}
\ No newline at end of file
+}
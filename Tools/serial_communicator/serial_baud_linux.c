@@ -0,0 +1,40 @@
+// serial_baud_linux.c
+
+/*
+ * Linux 任意波特率：termios2 + BOTHER，直接设置 c_ispeed / c_ospeed，
+ * 不受 Bxxx 常量表限制（如 250000、3686400）。
+ * <asm/termbits.h> 与 glibc 的 <termios.h> 定义冲突，因此单独放在这个文件中。
+ */
+
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+
+int SerialSetCustomBaud(int fd, int baud) {
+
+    struct termios2 tio;
+    long diff;
+
+    if (baud <= 0 || ioctl(fd, TCGETS2, &tio) != 0) {
+        return -1;
+    }
+    tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tio.c_ispeed = (speed_t)baud;
+    tio.c_ospeed = (speed_t)baud;
+    if (ioctl(fd, TCSETS2, &tio) != 0) {
+        return -1;
+    }
+
+    // 驱动可能就近取整, 读回确认; 与请求的波特率相差超过 2% (UART 的容差) 视为不支持
+    if (ioctl(fd, TCGETS2, &tio) != 0) {
+        return -1;
+    }
+    diff = (long)tio.c_ospeed - (long)baud;
+    if (diff < 0) {
+        diff = -diff;
+    }
+    if (diff * 50 > (long)baud) {
+        return -1;
+    }
+    return 0;
+}
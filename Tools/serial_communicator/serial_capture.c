@@ -0,0 +1,427 @@
+// serial_capture.c
+
+/*
+ * 串口数据的记录和回放（POSIX）：
+ * 记录：收到的每段数据连同收到的时刻（CLOCK_MONOTONIC）和通道号追加到记录文件，
+ * 用于离线复现现场数据、对滤波和解析流程做性能分析。
+ * serial_reader.h / serial_ports.h 的配置中给出 capture 即可记录收到的全部原始字节（分割之前）。
+ *
+ * 记录文件按段存放，文件名为 "<prefix>.000000.cap"、"<prefix>.000001.cap" ...，
+ * 每个段文件用 posix_fallocate 预先分配 segment_size 字节并用 mmap 映射，写入只是一次 memcpy，不需要系统调用；
+ * 磁盘空间不足在换段时报告（计入 errors），不会在写入时触发 SIGBUS；
+ * 写满后截掉未用的部分，换下一个段文件。
+ * 同一 prefix 已有记录时 OpenSerialCapture 失败，除非配置中给出 overwrite（删除旧的段文件）。
+ *
+ * 段文件格式（小端，8 字节对齐）：
+ *     段头 32 字节：magic "SCAP"，版本，已写入的字节数 used，打开时的 CLOCK_REALTIME 和 CLOCK_MONOTONIC（ns）
+ *     记录：时刻（ns，8 字节），长度（4 字节），通道号（2 字节），保留（2 字节），数据，填充到 8 字节
+ * used 在每条记录写完后更新，进程异常退出时段文件中 used 之前的记录都是完整的。
+ *
+ * 回放：SerialReplay 按记录的时间间隔把数据写到串口（或 pty），speed 为 1 时按原速，
+ * 2 为两倍速，0 为尽快写出。命令行工具见 serial_capture_tool.c。
+ *
+ * SerialCapture 不是线程安全的，多个线程接收时各用一个 SerialCapture（prefix 不同）。
+ *
+ * 示例：
+ * #include "serial_capture.h"
+ * #include "serial_ports.h"
+ *
+ * SerialCapture *capture = OpenSerialCapture("/tmp/run1", NULL);
+ * SerialPortConfig config = { 0 };
+ *
+ * config.name = "/dev/ttyUSB0";
+ * config.capture = capture;                    // 通道号为串口编号
+ * SerialPortsAdd(ports, &config);
+ * ...
+ * CloseSerialPorts(ports);
+ * CloseSerialCapture(capture);
+ *
+ * // 之后按原速回放到 pty, 接收端打开 pty 的另一端即可
+ * SerialReplay("/tmp/run1", master, 1.0, -1);
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "serial_capture.h"
+
+#define SERIAL_CAPTURE_MAGIC        0x50414353u     // "SCAP"
+#define SERIAL_CAPTURE_VERSION      1
+#define SERIAL_CAPTURE_ALIGN(n)     (((n) + 7) & ~(size_t)7)
+#define SERIAL_CAPTURE_MIN_SEGMENT  (1u << 20)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t used;              // 已写入的字节数 (含段头)
+    uint64_t realtime;          // 打开记录时的 CLOCK_REALTIME (ns), 对照墙上时间
+    uint64_t monotonic;         // 同一时刻的 CLOCK_MONOTONIC (ns)
+} SerialCaptureHeader;
+
+typedef struct {
+    uint64_t timestamp;
+    uint32_t len;
+    uint16_t channel;
+    uint16_t reserved;
+} SerialCaptureEntry;
+
+struct SerialCapture {
+    char *prefix;
+    char *path;             // 当前段文件名
+    size_t path_size;
+    size_t segment_size;
+    unsigned index;         // 当前段号
+    int fd;
+    char *map;
+    size_t used;
+    uint64_t realtime;
+    uint64_t monotonic;
+    int overwrite;
+    int failing;            // 换段失败, 之后每次写入重试, 只在第一次失败时打印
+    SerialCaptureStats stats;
+};
+
+struct SerialCaptureReader {
+    char *prefix;
+    char *path;
+    size_t path_size;
+    unsigned index;
+    char *map;
+    size_t map_size;
+    size_t used;
+    size_t pos;
+};
+
+static uint64_t SerialCaptureClock(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static char *SerialCapturePath(const char *prefix, unsigned index, char *path, size_t size) {
+    snprintf(path, size, "%s.%06u.cap", prefix, index);
+    return path;
+}
+
+static int SerialCaptureOpenSegment(SerialCapture *c) {
+
+    SerialCaptureHeader *h;
+    int err;
+
+    SerialCapturePath(c->prefix, c->index, c->path, c->path_size);
+    // 不覆盖时用 O_EXCL, 之前留下的同名段文件不会被截断
+    c->fd = open(c->path, O_RDWR | O_CREAT | (c->overwrite ? O_TRUNC : O_EXCL) | O_CLOEXEC, 0644);
+    if (c->fd < 0) {
+        if (!c->failing) {
+            printf("open %s fail: %s\r\n", c->path, strerror(errno));
+        }
+        c->failing = 1;
+        return -1;
+    }
+    // 预先分配磁盘空间: 稀疏文件在磁盘满时会在 memcpy 写入未分配的页面时触发 SIGBUS
+    err = posix_fallocate(c->fd, 0, (off_t)c->segment_size);
+    if (err != 0) {
+        if (!c->failing) {
+            printf("fallocate %s fail: %s\r\n", c->path, strerror(err));
+        }
+        c->failing = 1;
+        close(c->fd);
+        c->fd = -1;
+        unlink(c->path);
+        return -1;
+    }
+    c->map = (char *)mmap(NULL, c->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, 0);
+    if (c->map == MAP_FAILED) {
+        if (!c->failing) {
+            printf("mmap %s fail: %s\r\n", c->path, strerror(errno));
+        }
+        c->failing = 1;
+        c->map = NULL;
+        close(c->fd);
+        c->fd = -1;
+        unlink(c->path);
+        return -1;
+    }
+    h = (SerialCaptureHeader *)c->map;
+    h->magic = SERIAL_CAPTURE_MAGIC;
+    h->version = SERIAL_CAPTURE_VERSION;
+    h->realtime = c->realtime;
+    h->monotonic = c->monotonic;
+    c->used = sizeof(SerialCaptureHeader);
+    h->used = c->used;
+    c->failing = 0;
+    c->stats.segments++;
+    return 0;
+}
+
+// 截掉段文件未用的部分
+static void SerialCaptureCloseSegment(SerialCapture *c) {
+    if (c->map != NULL) {
+        munmap(c->map, c->segment_size);
+        c->map = NULL;
+    }
+    if (c->fd >= 0) {
+        if (ftruncate(c->fd, (off_t)c->used) != 0) {
+            printf("ftruncate %s fail: %s\r\n", c->path, strerror(errno));
+        }
+        close(c->fd);
+        c->fd = -1;
+    }
+}
+
+SerialCapture *OpenSerialCapture(const char *prefix, const SerialCaptureConfig *config) {
+
+    SerialCapture *c;
+    unsigned i;
+
+    c = (SerialCapture *)calloc(1, sizeof(SerialCapture));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->fd = -1;
+    c->overwrite = config != NULL && config->overwrite;
+    c->segment_size = config != NULL && config->segment_size != 0 ? config->segment_size : (size_t)64 << 20;
+    c->segment_size = c->segment_size < SERIAL_CAPTURE_MIN_SEGMENT ? SERIAL_CAPTURE_MIN_SEGMENT : c->segment_size & ~(size_t)7;
+    c->path_size = strlen(prefix) + 16;
+    c->prefix = strdup(prefix);
+    c->path = (char *)malloc(c->path_size);
+    if (c->prefix == NULL || c->path == NULL) {
+        CloseSerialCapture(c);
+        return NULL;
+    }
+
+    // 已有记录时默认拒绝打开, 以免写错 prefix 覆盖之前的记录; overwrite 时删除旧的段文件 (否则会被回放接在新记录之后)
+    if (access(SerialCapturePath(prefix, 0, c->path, c->path_size), F_OK) == 0) {
+        if (!c->overwrite) {
+            printf("capture %s already exists\r\n", c->path);
+            CloseSerialCapture(c);
+            return NULL;
+        }
+        for (i = 0; unlink(SerialCapturePath(prefix, i, c->path, c->path_size)) == 0; i++) {
+        }
+    }
+
+    c->realtime = SerialCaptureClock(CLOCK_REALTIME);
+    c->monotonic = SerialCaptureClock(CLOCK_MONOTONIC);
+    if (SerialCaptureOpenSegment(c) != 0) {
+        CloseSerialCapture(c);
+        return NULL;
+    }
+    return c;
+}
+
+void CloseSerialCapture(SerialCapture *capture) {
+    if (capture == NULL) {
+        return;
+    }
+    SerialCaptureCloseSegment(capture);
+    free(capture->prefix);
+    free(capture->path);
+    free(capture);
+}
+
+// 以当前时刻追加一段数据, 段文件放不下时拆成多条记录; 成功返回 0
+int SerialCaptureWrite(SerialCapture *capture, int channel, const void *data, size_t len) {
+
+    SerialCapture *c = capture;
+    const uint64_t now = SerialCaptureClock(CLOCK_MONOTONIC);
+    const char *src = (const char *)data;
+    SerialCaptureEntry *e;
+    size_t n;
+
+    while (len > 0) {
+        // 至少能放下记录头和 8 字节数据, 否则换段; 上次换段失败 (如磁盘已满) 时重试同一段号, 段号保持连续
+        if (c->map == NULL || c->used + sizeof(SerialCaptureEntry) + 8 > c->segment_size) {
+            if (c->map != NULL) {
+                SerialCaptureCloseSegment(c);
+                c->index++;
+            }
+            if (SerialCaptureOpenSegment(c) != 0) {
+                c->stats.errors++;
+                return -1;
+            }
+        }
+        n = c->segment_size - c->used - sizeof(SerialCaptureEntry);
+        n = len < n ? len : n;
+        e = (SerialCaptureEntry *)(c->map + c->used);
+        e->timestamp = now;
+        e->len = (uint32_t)n;
+        e->channel = (uint16_t)channel;
+        e->reserved = 0;
+        memcpy(e + 1, src, n);
+        c->used += SERIAL_CAPTURE_ALIGN(sizeof(SerialCaptureEntry) + n);
+        // 记录完整写入后才计入 used
+        __atomic_store_n(&((SerialCaptureHeader *)c->map)->used, (uint64_t)c->used, __ATOMIC_RELEASE);
+        c->stats.records++;
+        c->stats.bytes += (unsigned long long)n;
+        src += n;
+        len -= n;
+    }
+    return 0;
+}
+
+void SerialCaptureGetStats(const SerialCapture *capture, SerialCaptureStats *stats) {
+    *stats = capture->stats;
+}
+
+static void SerialCaptureUnmap(SerialCaptureReader *r) {
+    if (r->map != NULL) {
+        munmap(r->map, r->map_size);
+        r->map = NULL;
+    }
+}
+
+static int SerialCaptureMap(SerialCaptureReader *r) {
+
+    const SerialCaptureHeader *h;
+    struct stat st;
+    int fd;
+
+    fd = open(SerialCapturePath(r->prefix, r->index, r->path, r->path_size), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SerialCaptureHeader)) {
+        close(fd);
+        return -1;
+    }
+    r->map_size = (size_t)st.st_size;
+    r->map = (char *)mmap(NULL, r->map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r->map == MAP_FAILED) {
+        r->map = NULL;
+        return -1;
+    }
+    h = (const SerialCaptureHeader *)r->map;
+    if (h->magic != SERIAL_CAPTURE_MAGIC || h->version != SERIAL_CAPTURE_VERSION) {
+        printf("%s: not a capture file\r\n", r->path);
+        SerialCaptureUnmap(r);
+        return -1;
+    }
+    r->used = h->used < r->map_size ? (size_t)h->used : r->map_size;
+    r->pos = sizeof(SerialCaptureHeader);
+    return 0;
+}
+
+SerialCaptureReader *OpenSerialCaptureReader(const char *prefix) {
+
+    SerialCaptureReader *r;
+
+    r = (SerialCaptureReader *)calloc(1, sizeof(SerialCaptureReader));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->path_size = strlen(prefix) + 16;
+    r->prefix = strdup(prefix);
+    r->path = (char *)malloc(r->path_size);
+    if (r->prefix == NULL || r->path == NULL || SerialCaptureMap(r) != 0) {
+        if (r->path != NULL) {
+            printf("open capture %s fail\r\n", r->path);
+        }
+        CloseSerialCaptureReader(r);
+        return NULL;
+    }
+    return r;
+}
+
+void CloseSerialCaptureReader(SerialCaptureReader *reader) {
+    if (reader == NULL) {
+        return;
+    }
+    SerialCaptureUnmap(reader);
+    free(reader->prefix);
+    free(reader->path);
+    free(reader);
+}
+
+// 读出下一条记录, 返回 1; 所有段文件都已读完返回 0
+int SerialCaptureNext(SerialCaptureReader *reader, SerialCaptureRecord *record) {
+
+    SerialCaptureReader *r = reader;
+    const SerialCaptureEntry *e;
+
+    while (r->map != NULL) {
+        e = (const SerialCaptureEntry *)(r->map + r->pos);
+        if (r->pos + sizeof(SerialCaptureEntry) <= r->used && e->len <= r->used - r->pos - sizeof(SerialCaptureEntry)) {
+            record->timestamp = e->timestamp;
+            record->channel = e->channel;
+            record->data = (const char *)(e + 1);
+            record->len = e->len;
+            r->pos += SERIAL_CAPTURE_ALIGN(sizeof(SerialCaptureEntry) + e->len);
+            return 1;
+        }
+        // 本段读完, 下一个段文件不存在时结束
+        SerialCaptureUnmap(r);
+        r->index++;
+        SerialCaptureMap(r);
+    }
+    return 0;
+}
+
+static void SerialReplaySleep(uint64_t t) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(t / 1000000000ull);
+    ts.tv_nsec = (long)(t % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// 回放记录到 comHandle: speed 为时间倍率 (1 原速, 0 尽快), channel 为 -1 时回放所有通道
+// 返回写出的字节数, 出错返回 -1
+long long SerialReplay(const char *prefix, SerialHandle comHandle, double speed, int channel) {
+
+    SerialCaptureReader *reader;
+    SerialCaptureRecord rec;
+    uint64_t start = 0, last = 0, elapsed = 0;
+    long long total = 0;
+    size_t off;
+    long n;
+
+    reader = OpenSerialCaptureReader(prefix);
+    if (reader == NULL) {
+        return -1;
+    }
+    while (total >= 0 && SerialCaptureNext(reader, &rec) > 0) {
+        if (channel >= 0 && rec.channel != channel) {
+            continue;
+        }
+        if (speed > 0) {
+            if (start == 0) {
+                start = SerialCaptureClock(CLOCK_MONOTONIC);
+                last = rec.timestamp;
+            }
+            // 只累加向前的间隔: 时间倒退 (如不同次记录拼接在一起) 时不等待, 不会因无符号相减而等待很久
+            if (rec.timestamp > last) {
+                elapsed += rec.timestamp - last;
+            }
+            last = rec.timestamp;
+            SerialReplaySleep(start + (uint64_t)((double)elapsed / speed));
+        }
+        for (off = 0; off < rec.len; off += (size_t)n) {
+            n = SerialWrite(comHandle, rec.data + off, rec.len - off);
+            if (n < 0) {
+                total = -1;
+                break;
+            }
+            if (n == 0) {
+                SerialWaitWritable(comHandle, -1);
+            }
+        }
+        if (total >= 0) {
+            total += (long long)rec.len;
+        }
+    }
+    CloseSerialCaptureReader(reader);
+    return total;
+}
@@ -0,0 +1,44 @@
+// serial_capture.h
+#ifndef SERIAL_CAPTURE_H
+#define SERIAL_CAPTURE_H
+
+#include "serial_communicator.h"
+
+// 记录文件的配置, 为 0 的字段使用默认值
+typedef struct {
+    size_t segment_size;    // 每个段文件的字节数, 写满后换下一个文件 (默认 64 MB, 不小于 1 MB)
+    int overwrite;          // 同一 prefix 已有记录时删除旧记录; 为 0 时打开失败
+} SerialCaptureConfig;
+
+// 统计
+typedef struct {
+    unsigned long long records;     // 已写入的记录数
+    unsigned long long bytes;       // 已写入的数据字节数 (不含记录头)
+    unsigned segments;              // 已使用的段文件数
+    unsigned long long errors;      // 换段失败 (如磁盘空间不足) 而丢弃的写入次数
+} SerialCaptureStats;
+
+// 读出的一条记录, data 指向映射的段文件, 在下一次 SerialCaptureNext 之前有效
+typedef struct {
+    unsigned long long timestamp;   // 收到数据的时刻 (CLOCK_MONOTONIC, ns)
+    int channel;                    // 写入时给出的通道号 (如 SerialPorts 的串口编号)
+    const char *data;
+    size_t len;
+} SerialCaptureRecord;
+
+typedef struct SerialCapture SerialCapture;
+typedef struct SerialCaptureReader SerialCaptureReader;
+
+SerialCapture *OpenSerialCapture(const char *prefix, const SerialCaptureConfig *config);
+void CloseSerialCapture(SerialCapture *capture);
+int SerialCaptureWrite(SerialCapture *capture, int channel, const void *data, size_t len);
+void SerialCaptureGetStats(const SerialCapture *capture, SerialCaptureStats *stats);
+
+SerialCaptureReader *OpenSerialCaptureReader(const char *prefix);
+void CloseSerialCaptureReader(SerialCaptureReader *reader);
+int SerialCaptureNext(SerialCaptureReader *reader, SerialCaptureRecord *record);
+
+long long SerialReplay(const char *prefix, SerialHandle comHandle, double speed, int channel);
+
+
+#endif /* Serial Capture */
@@ -0,0 +1,298 @@
+// serial_capture_test.c
+
+/*
+ * serial_capture 的自动测试（ctest），记录文件写在临时目录，openpty 创建的伪终端对代替真实串口：
+ *     写入多个通道、跨越多个段文件的记录，读回的通道号、数据和时刻与写入时一致
+ *     同一 prefix 已有记录时不给 overwrite 打开失败，给出时旧记录被删除
+ *     SerialReplay 按通道回放到串口，对端收到的字节与记录相同；按原速回放时保持记录的时间间隔
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "serial_capture.h"
+#include "serial_test.h"
+
+#define TEST_RECORDS    3000
+#define TEST_MAX_LEN    1000
+#define TEST_REPLAYED   300     // 回放的记录数
+
+static char test_dir[] = "/tmp/serial_capture_test.XXXXXX";
+static char test_prefix[256];
+
+static double TestNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// 第 i 条记录: 通道 i % 3, 长度 1 ~ TEST_MAX_LEN, 内容由 i 决定
+static size_t TestRecord(int i, char *buf) {
+
+    const size_t len = 1 + (size_t)(i * 7919) % TEST_MAX_LEN;
+    size_t k;
+
+    for (k = 0; k < len; k++) {
+        buf[k] = (char)(i + k * 31);
+    }
+    return len;
+}
+
+static void TestWriteRead(void) {
+
+    SerialCaptureConfig config;
+    SerialCaptureStats stats;
+    SerialCaptureRecord rec;
+    SerialCaptureReader *reader;
+    SerialCapture *capture;
+    char buf[TEST_MAX_LEN];
+    unsigned long long last = 0;
+    size_t len, off = 0, bytes = 0;
+    int i;
+
+    memset(&config, 0, sizeof(config));
+    config.segment_size = 1 << 20;
+    capture = OpenSerialCapture(test_prefix, &config);
+    SERIAL_CHECK(capture != NULL);
+    if (capture == NULL) {
+        return;
+    }
+    for (i = 0; i < TEST_RECORDS; i++) {
+        len = TestRecord(i, buf);
+        SERIAL_CHECK(SerialCaptureWrite(capture, i % 3, buf, len) == 0);
+        bytes += len;
+    }
+    SerialCaptureGetStats(capture, &stats);
+    CloseSerialCapture(capture);
+    // 跨段的记录被拆成两条
+    SERIAL_CHECK(stats.records >= TEST_RECORDS && stats.bytes == bytes && stats.errors == 0);
+    SERIAL_CHECK(stats.segments >= 2);
+
+    reader = OpenSerialCaptureReader(test_prefix);
+    SERIAL_CHECK(reader != NULL);
+    if (reader == NULL) {
+        return;
+    }
+    // 拆开的记录通道号相同, 数据接续
+    i = 0;
+    len = TestRecord(i, buf);
+    while (SerialCaptureNext(reader, &rec) > 0) {
+        if (i == TEST_RECORDS || rec.channel != i % 3 || rec.len > len - off
+            || memcmp(rec.data, buf + off, rec.len) != 0 || rec.timestamp < last) {
+            printf("record %d fail\r\n", i);
+            serial_test_failures++;
+            break;
+        }
+        last = rec.timestamp;
+        off += rec.len;
+        if (off == len) {
+            off = 0;
+            len = TestRecord(++i, buf);
+        }
+    }
+    SERIAL_CHECK(i == TEST_RECORDS);
+    CloseSerialCaptureReader(reader);
+}
+
+static void TestOverwrite(void) {
+
+    SerialCaptureConfig config;
+    SerialCaptureRecord rec;
+    SerialCaptureReader *reader;
+    SerialCapture *capture;
+
+    // 已有记录, 不覆盖
+    SERIAL_CHECK(OpenSerialCapture(test_prefix, NULL) == NULL);
+
+    memset(&config, 0, sizeof(config));
+    config.overwrite = 1;
+    capture = OpenSerialCapture(test_prefix, &config);
+    SERIAL_CHECK(capture != NULL);
+    if (capture == NULL) {
+        return;
+    }
+    SerialCaptureWrite(capture, 5, "new", 3);
+    CloseSerialCapture(capture);
+
+    // 只剩新记录, 旧的段文件都已删除
+    reader = OpenSerialCaptureReader(test_prefix);
+    SERIAL_CHECK(reader != NULL);
+    if (reader == NULL) {
+        return;
+    }
+    SERIAL_CHECK(SerialCaptureNext(reader, &rec) > 0 && rec.channel == 5 && rec.len == 3);
+    SERIAL_CHECK(SerialCaptureNext(reader, &rec) <= 0);
+    CloseSerialCaptureReader(reader);
+}
+
+// 读 pty 主端的线程
+typedef struct {
+    int fd;
+    volatile int stop;
+    char data[1 << 20];
+    size_t len;
+} TestSink;
+
+static void *TestSinkThread(void *arg) {
+
+    TestSink *sink = (TestSink *)arg;
+    struct pollfd pfd;
+    ssize_t n;
+
+    pfd.fd = sink->fd;
+    pfd.events = POLLIN;
+    for (;;) {
+        if (poll(&pfd, 1, 20) <= 0) {
+            if (sink->stop) {
+                break;
+            }
+            continue;
+        }
+        n = read(sink->fd, sink->data + sink->len, sizeof(sink->data) - sink->len);
+        if (n <= 0) {
+            break;
+        }
+        sink->len += (size_t)n;
+    }
+    return NULL;
+}
+
+// 回放 channel 到伪终端从端, 返回主端收到的字节数, 失败返回 -1
+static long long TestReplay(TestSink *sink, double speed, int channel, double *seconds) {
+
+    SerialHandle fd;
+    pthread_t thread;
+    char name[256];
+    long long n;
+    int slave;
+    double start;
+
+    if (openpty(&sink->fd, &slave, name, NULL, NULL) != 0) {
+        printf("openpty fail\r\n");
+        return -1;
+    }
+    close(slave);
+    fd = OpenSerial(name, CBR_115200, 8, NOPARITY, ONESTOPBIT);
+    if (fd == SERIAL_INVALID_HANDLE) {
+        close(sink->fd);
+        return -1;
+    }
+    sink->len = 0;
+    sink->stop = 0;
+    if (pthread_create(&thread, NULL, TestSinkThread, sink) != 0) {
+        CloseSerialQuiet(fd);
+        close(sink->fd);
+        return -1;
+    }
+    start = TestNow();
+    n = SerialReplay(test_prefix, fd, speed, channel);
+    *seconds = TestNow() - start;
+    sink->stop = 1;
+    pthread_join(thread, NULL);
+    CloseSerialQuiet(fd);
+    close(sink->fd);
+    return n;
+}
+
+static void TestReplays(void) {
+
+    static TestSink sink;
+    SerialCaptureConfig config;
+    SerialCapture *capture;
+    char buf[TEST_MAX_LEN], *expect;
+    size_t len, off = 0;
+    double seconds, fast;
+    int i;
+
+    // 通道 1 的数据
+    expect = (char *)malloc((size_t)TEST_REPLAYED * TEST_MAX_LEN);
+    if (expect == NULL) {
+        serial_test_failures++;
+        return;
+    }
+    memset(&config, 0, sizeof(config));
+    config.overwrite = 1;
+    capture = OpenSerialCapture(test_prefix, &config);
+    SERIAL_CHECK(capture != NULL);
+    if (capture == NULL) {
+        free(expect);
+        return;
+    }
+    for (i = 0; i < TEST_REPLAYED; i++) {
+        len = TestRecord(i, buf);
+        SerialCaptureWrite(capture, i % 3, buf, len);
+        if (i % 3 == 1) {
+            memcpy(expect + off, buf, len);
+            off += len;
+        }
+    }
+    CloseSerialCapture(capture);
+
+    SERIAL_CHECK(TestReplay(&sink, 0, 1, &seconds) == (long long)off);
+    SERIAL_CHECK(sink.len == off && memcmp(sink.data, expect, off) == 0);
+
+    // 所有通道
+    off = 0;
+    for (i = 0; i < TEST_REPLAYED; i++) {
+        off += TestRecord(i, buf);
+    }
+    SERIAL_CHECK(TestReplay(&sink, 0, -1, &seconds) == (long long)off);
+    SERIAL_CHECK(sink.len == off);
+    free(expect);
+
+    // 按原速: 三条记录间隔约 50 ms, 回放约 100 ms; 四倍速约 25 ms
+    capture = OpenSerialCapture(test_prefix, &config);
+    SERIAL_CHECK(capture != NULL);
+    if (capture == NULL) {
+        return;
+    }
+    for (i = 0; i < 3; i++) {
+        if (i > 0) {
+            usleep(50000);
+        }
+        SerialCaptureWrite(capture, 0, "tick\n", 5);
+    }
+    CloseSerialCapture(capture);
+    SERIAL_CHECK(TestReplay(&sink, 1, -1, &seconds) == 15);
+    SERIAL_CHECK(seconds >= 0.095);
+    SERIAL_CHECK(TestReplay(&sink, 4, -1, &fast) == 15);
+    SERIAL_CHECK(fast >= 0.02 && fast < seconds);
+    SERIAL_CHECK(sink.len == 15);
+}
+
+// 删除临时目录中的段文件
+static void TestCleanup(void) {
+
+    char path[300];
+    unsigned i;
+
+    for (i = 0; i < 100; i++) {
+        snprintf(path, sizeof(path), "%s.%06u.cap", test_prefix, i);
+        unlink(path);
+    }
+    rmdir(test_dir);
+}
+
+int main(void) {
+
+    if (mkdtemp(test_dir) == NULL) {
+        printf("mkdtemp fail\r\n");
+        return 1;
+    }
+    snprintf(test_prefix, sizeof(test_prefix), "%s/run", test_dir);
+    TestWriteRead();
+    TestOverwrite();
+    TestReplays();
+    TestCleanup();
+    return SERIAL_TEST_RESULT;
+}
@@ -0,0 +1,253 @@
+// serial_capture_tool.c
+
+/*
+ * 串口数据记录和回放工具（Linux），记录文件格式见 serial_capture.c。
+ *
+ * 用法:
+ *     serial_capture_tool record [-f] <prefix> <seconds> <port[@baud]> [port[@baud] ...]
+ *         接收各串口的数据写入 <prefix>.NNNNNN.cap，seconds 为 0 时直到 Ctrl+C；
+ *         通道号为串口在命令行中的顺序（从 0 开始）；同一 prefix 已有记录时需要 -f 才会覆盖
+ *     serial_capture_tool replay <prefix> [speed=1] [channel=-1] [port=pty] [baud=115200]
+ *         按记录的时间间隔写出，speed 为时间倍率（0 为尽快写出），channel 为 -1 时回放所有通道；
+ *         port 为 pty 时创建虚拟串口并打印对端路径，等待接收端打开后开始回放，接收端关闭后退出
+ *     serial_capture_tool info <prefix>
+ *         打印各通道的记录数、字节数和时长（时间倒退的间隔不计入）
+ *
+ * 示例：
+ * ./serial_capture_tool record /tmp/run1 60 /dev/ttyUSB0@921600 /dev/ttyUSB1
+ * ./serial_capture_tool replay /tmp/run1 10 0
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include "serial_communicator.h"
+#include "serial_capture.h"
+#include "serial_ports.h"
+
+#define TOOL_MAX_PORTS      16
+#define TOOL_MAX_CHANNELS   65536
+
+static volatile sig_atomic_t tool_stop;
+
+static void ToolSignal(int sig) {
+    (void)sig;
+    tool_stop = 1;
+}
+
+static double ToolNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int ToolRecord(const char *prefix, int overwrite, double seconds, int count, char **specs) {
+
+    SerialCaptureConfig capture_config;
+    SerialPortConfig config;
+    SerialCaptureStats stats;
+    SerialCapture *capture;
+    SerialPorts *ports;
+    char names[TOOL_MAX_PORTS][256];
+    char *at;
+    double end;
+    int i;
+
+    if (count > TOOL_MAX_PORTS) {
+        printf("too many serial ports\r\n");
+        return 1;
+    }
+    memset(&capture_config, 0, sizeof(capture_config));
+    capture_config.overwrite = overwrite;
+    capture = OpenSerialCapture(prefix, &capture_config);
+    if (capture == NULL) {
+        return 1;
+    }
+    ports = OpenSerialPorts(count);
+    if (ports == NULL) {
+        CloseSerialCapture(capture);
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        memset(&config, 0, sizeof(config));
+        snprintf(names[i], sizeof(names[i]), "%s", specs[i]);
+        at = strchr(names[i], '@');
+        if (at != NULL) {
+            *at = '\0';
+            config.baud = atoi(at + 1);
+        }
+        config.name = names[i];
+        config.delimiter = SERIAL_SPLIT_NONE;
+        config.capture = capture;
+        if (SerialPortsAdd(ports, &config) != i) {
+            CloseSerialPorts(ports);
+            CloseSerialCapture(capture);
+            return 1;
+        }
+        printf("channel %d: %s\n", i, names[i]);
+    }
+
+    signal(SIGINT, ToolSignal);
+    signal(SIGTERM, ToolSignal);
+    end = ToolNow() + seconds;
+    while (!tool_stop && (seconds <= 0 || ToolNow() < end)) {
+        SerialPortsPoll(ports, 100);
+    }
+
+    CloseSerialPorts(ports);
+    SerialCaptureGetStats(capture, &stats);
+    CloseSerialCapture(capture);
+    printf("%llu records, %llu bytes, %u segments, %llu errors\n", stats.records, stats.bytes, stats.segments, stats.errors);
+    return stats.errors == 0 ? 0 : 1;
+}
+
+// 等待 pty 对端打开 (open == 1) 或关闭 (open == 0), 对端没有打开时主设备上报 POLLHUP
+static int ToolWaitPeer(SerialHandle master, int open) {
+
+    struct pollfd pfd;
+    char buf[256];
+
+    while (!tool_stop) {
+        pfd.fd = master;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 50) < 0) {
+            continue;
+        }
+        if (((pfd.revents & POLLHUP) == 0) == open) {
+            return 0;
+        }
+        // 丢弃对端写回的数据
+        if (pfd.revents & POLLIN) {
+            if (read(master, buf, sizeof(buf)) < 0) {
+                return -1;
+            }
+        }
+        else if (pfd.revents & POLLHUP) {
+            usleep(50000);
+        }
+    }
+    return -1;
+}
+
+static int ToolReplay(const char *prefix, double speed, int channel, const char *port, int baud) {
+
+    SerialHandle handle;
+    char name[256];
+    double start;
+    long long n;
+    int pty = strcmp(port, "pty") == 0;
+
+    if (pty) {
+        if (OpenVirtualSerial(&handle, name, sizeof(name)) != 0) {
+            return 1;
+        }
+        printf("replay to %s\n", name);
+        fflush(stdout);
+        signal(SIGINT, ToolSignal);
+        signal(SIGTERM, ToolSignal);
+        if (ToolWaitPeer(handle, 1) != 0) {
+            close(handle);
+            return 1;
+        }
+        // 接收端通常在打开后设置串口参数并清空缓冲区
+        usleep(100000);
+    }
+    else {
+        handle = OpenSerial(port, baud, 8, NOPARITY, ONESTOPBIT);
+        if (handle == SERIAL_INVALID_HANDLE) {
+            return 1;
+        }
+    }
+
+    start = ToolNow();
+    n = SerialReplay(prefix, handle, speed, channel);
+    if (n >= 0) {
+        printf("%lld bytes in %.3f s\n", n, ToolNow() - start);
+    }
+
+    if (pty) {
+        ToolWaitPeer(handle, 0);
+        close(handle);
+    }
+    else {
+        tcdrain(handle);
+        CloseSerial(handle);
+    }
+    return n >= 0 ? 0 : 1;
+}
+
+static int ToolInfo(const char *prefix) {
+
+    SerialCaptureReader *reader;
+    SerialCaptureRecord rec;
+    unsigned long long *records, *bytes;
+    unsigned long long last = 0, elapsed = 0, total = 0;
+    int i;
+
+    reader = OpenSerialCaptureReader(prefix);
+    if (reader == NULL) {
+        return 1;
+    }
+    records = (unsigned long long *)calloc(2 * TOOL_MAX_CHANNELS, sizeof(unsigned long long));
+    if (records == NULL) {
+        CloseSerialCaptureReader(reader);
+        return 1;
+    }
+    bytes = records + TOOL_MAX_CHANNELS;
+    while (SerialCaptureNext(reader, &rec) > 0) {
+        if (total++ > 0 && rec.timestamp > last) {
+            elapsed += rec.timestamp - last;
+        }
+        last = rec.timestamp;
+        records[rec.channel]++;
+        bytes[rec.channel] += rec.len;
+    }
+    CloseSerialCaptureReader(reader);
+
+    for (i = 0; i < TOOL_MAX_CHANNELS; i++) {
+        if (records[i] != 0) {
+            printf("channel %d: %llu records, %llu bytes\n", i, records[i], bytes[i]);
+        }
+    }
+    printf("%llu records in %.3f s\n", total, (double)elapsed * 1e-9);
+    free(records);
+    return 0;
+}
+
+static void ToolUsage(void) {
+    printf("usage: serial_capture_tool record [-f] <prefix> <seconds> <port[@baud]> [port[@baud] ...]\n"
+           "       serial_capture_tool replay <prefix> [speed=1] [channel=-1] [port=pty] [baud=115200]\n"
+           "       serial_capture_tool info <prefix>\n");
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc >= 6 && strcmp(argv[1], "record") == 0 && strcmp(argv[2], "-f") == 0) {
+        return ToolRecord(argv[3], 1, atof(argv[4]), argc - 5, argv + 5);
+    }
+    if (argc >= 5 && strcmp(argv[1], "record") == 0) {
+        return ToolRecord(argv[2], 0, atof(argv[3]), argc - 4, argv + 4);
+    }
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        return ToolReplay(argv[2],
+                          argc > 3 ? atof(argv[3]) : 1.0,
+                          argc > 4 ? atoi(argv[4]) : -1,
+                          argc > 5 ? argv[5] : "pty",
+                          argc > 6 ? atoi(argv[6]) : CBR_115200);
+    }
+    if (argc >= 3 && strcmp(argv[1], "info") == 0) {
+        return ToolInfo(argv[2]);
+    }
+    ToolUsage();
+    return 1;
+}
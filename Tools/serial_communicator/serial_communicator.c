@@ -6,6 +6,8 @@
  * 使用串口通信的示例代码：
  * 这个文件封装了打开串口、发送数据和关闭串口的基本功能。
  * 使用之前，请确保已经安装并配置了虚拟串口驱动（VSPD）。
+ * Linux 等 POSIX 系统上使用 termios 实现同一组接口，串口名为设备路径（如 "/dev/ttyUSB0"），
+ * 可以用环境变量 SERIAL_PORT 覆盖 Useserial 的默认串口。
  *
  * VSPD（Virtual Serial Port Driver）是一个用于创建虚拟串口对的软件，可以模拟物理串口设备。
  * 如果你要通过串口通信，需要先启动并配置虚拟串口对（比如 "COM1" 和 "COM2"），
@@ -16,6 +18,9 @@
  * 2. 使用本代码打开串口（如 COM2），发送数据到串口。
  * 3. 关闭串口。
  *
+ * POSIX 上不需要 VSPD：OpenVirtualSerial 用伪终端（pty）创建一对本地串口，
+ * 返回本端句柄和对端的设备路径，对端路径可以直接传给 OpenSerial 或 SERIAL_PORT。
+ *
  * 示例：
  * // Example main.c
  * #include "serial_communicator.h"
@@ -41,21 +46,59 @@
  * }
  */
 
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <string.h>
 #include "serial_communicator.h"
 
-HANDLE comHandle;
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#endif
+
+SerialHandle comHandle = SERIAL_INVALID_HANDLE;
 
 int Useserial(void) {
+    const char *port = getenv("SERIAL_PORT");
     // 打开串口 串口2 波特率115200 停止位8 无校验 停止位1
-    comHandle = OpenSerial("COM2", CBR_115200, 8, NOPARITY, ONESTOPBIT);
-    if (INVALID_HANDLE_VALUE == comHandle) {
+    comHandle = OpenSerial(port != NULL ? port : SERIAL_DEFAULT_PORT, CBR_115200, 8, NOPARITY, ONESTOPBIT);
+    if (SERIAL_INVALID_HANDLE == comHandle) {
         printf("Open serial port failed.\n");
         return -1;
     }
     printf("Serial port opened successfully.\n");
+    return 0;
+}
+
+// 写完整条消息, 处理部分写入; 写超时 (不再可写) 时放弃剩余部分
+void SendMessageToSerial(const char* message) {
+    size_t len = strlen(message);
+    long n;
+
+    while (len > 0) {
+        n = SerialWrite(comHandle, message, len);
+        if (n < 0) {
+            return;
+        }
+        if (n == 0 && SerialWaitWritable(comHandle, -1) <= 0) {
+            printf("write timeout\r\n");
+            return;
+        }
+        message += n;
+        len -= (size_t)n;
+    }
 }
 
-HANDLE OpenSerial(const char *com, int baud, int byteSize, int parity, int stopBits) {
+#ifdef _WIN32
+
+SerialHandle OpenSerial(const char *com, int baud, int byteSize, int parity, int stopBits) {
 
     DCB dcb;
     BOOL b = FALSE;
@@ -94,16 +137,208 @@ HANDLE OpenSerial(const char *com, int baud, int byteSize, int parity, int stopB
     return comHandle;
 }
 
-void CloseSerial(HANDLE comHandle) {
-    CloseHandle(comHandle);
+void CloseSerial(SerialHandle comHandle) {
+    CloseSerialQuiet(comHandle);
     printf("Serial port closed.\n");
 }
 
-void SendMessageToSerial(const char* message) {
-    DWORD bytesWritten;
-    BOOL b = WriteFile(comHandle, message, strlen(message), &bytesWritten, NULL);
+// 不打印提示, 供 SerialPorts 和测试程序等一次开关多个串口时使用
+void CloseSerialQuiet(SerialHandle comHandle) {
+    CloseHandle(comHandle);
+}
+
+long SerialWrite(SerialHandle comHandle, const void *data, size_t len) {
+    DWORD bytesWritten = 0;
+    BOOL b = WriteFile(comHandle, data, (DWORD)len, &bytesWritten, NULL);
     if (!b) {
         printf("WriteFile fail\r\n");
+        return -1;
+    }
+    return (long)bytesWritten;
+}
+
+int SerialWaitWritable(SerialHandle comHandle, int timeout_ms) {
+    // 同步句柄, WriteFile 本身会等待; WriteFile 写出 0 字节说明写超时已到, 再等待也不会变为可写
+    (void)comHandle;
+    (void)timeout_ms;
+    return 0;
+}
+
+#else /* POSIX termios */
+
+// 标准波特率 -> Bxxx, 不在表中的波特率走 SerialSetCustomBaud
+static speed_t SerialSpeed(int baud) {
+    static const struct { int baud; speed_t speed; } table[] = {
+        { 50, B50 }, { 75, B75 }, { 110, B110 }, { 134, B134 }, { 150, B150 }, { 200, B200 },
+        { 300, B300 }, { 600, B600 }, { 1200, B1200 }, { 1800, B1800 }, { 2400, B2400 },
+        { 4800, B4800 }, { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 },
+        { 57600, B57600 }, { 115200, B115200 }, { 230400, B230400 },
+#ifdef B460800
+        { 460800, B460800 },
+#endif
+#ifdef B500000
+        { 500000, B500000 }, { 576000, B576000 }, { 921600, B921600 }, { 1000000, B1000000 },
+        { 1152000, B1152000 }, { 1500000, B1500000 }, { 2000000, B2000000 },
+#endif
+#ifdef B4000000
+        { 2500000, B2500000 }, { 3000000, B3000000 }, { 3500000, B3500000 }, { 4000000, B4000000 },
+#endif
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        if (table[i].baud == baud) {
+            return table[i].speed;
+        }
+    }
+    return B0;
+}
+
+SerialHandle OpenSerial(const char *com, int baud, int byteSize, int parity, int stopBits) {
+
+    struct termios tio;
+    speed_t speed = SerialSpeed(baud);
+    int fd;
+
+    // 阻塞 I/O, 不成为控制终端 (对应 CreateFile 的 Non Overlapped)
+    fd = open(com, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) {
+        printf("open %s fail: %s\r\n", com, strerror(errno));
+        return SERIAL_INVALID_HANDLE;
+    }
+
+    // 独占 (对应 CreateFile 的 No Sharing), 伪终端等不支持时忽略
+    ioctl(fd, TIOCEXCL);
+
+    if (tcgetattr(fd, &tio) != 0) {
+        printf("tcgetattr fail: %s\r\n", strerror(errno));
+        close(fd);
+        return SERIAL_INVALID_HANDLE;
+    }
+
+    // 原始模式: 不做行缓冲, 回显, 换行转换和流控, 逐字节透传
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB | CRTSCTS);
+#ifdef CMSPAR
+    tio.c_cflag &= ~CMSPAR;
+#endif
+    tio.c_cflag |= byteSize == 5 ? CS5 : byteSize == 6 ? CS6 : byteSize == 7 ? CS7 : CS8;
+    switch (parity) {
+        case ODDPARITY:  tio.c_cflag |= PARENB | PARODD; break;
+        case EVENPARITY: tio.c_cflag |= PARENB; break;
+#ifdef CMSPAR
+        case MARKPARITY:  tio.c_cflag |= PARENB | PARODD | CMSPAR; break;
+        case SPACEPARITY: tio.c_cflag |= PARENB | CMSPAR; break;
+#endif
+        default: break;
     }
+    if (parity != NOPARITY) {
+        tio.c_iflag |= INPCK;
+    }
+    // ONE5STOPBITS 只对 5 位数据有意义, termios 中同样由 CSTOPB 表示
+    if (stopBits != ONESTOPBIT) {
+        tio.c_cflag |= CSTOPB;
+    }
+    // read 至少返回 1 个字节, 不超时
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed != B0 ? speed : B38400);
+    cfsetospeed(&tio, speed != B0 ? speed : B38400);
+
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        printf("tcsetattr fail: %s\r\n", strerror(errno));
+        close(fd);
+        return SERIAL_INVALID_HANDLE;
+    }
+
+    // 非标准波特率
+    if (speed == B0 && SerialSetCustomBaud(fd, baud) != 0) {
+        printf("baud %d not supported\r\n", baud);
+        close(fd);
+        return SERIAL_INVALID_HANDLE;
+    }
+
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+void CloseSerial(SerialHandle comHandle) {
+    CloseSerialQuiet(comHandle);
+    printf("Serial port closed.\n");
+}
+
+// 不打印提示, 供 SerialPorts 和测试程序等一次开关多个串口时使用
+void CloseSerialQuiet(SerialHandle comHandle) {
+    close(comHandle);
+}
+
+long SerialWrite(SerialHandle comHandle, const void *data, size_t len) {
+    ssize_t n;
+
+    do {
+        n = write(comHandle, data, len);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        // 非阻塞句柄写满, 由调用方等待可写
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        printf("write fail: %s\r\n", strerror(errno));
+        return -1;
+    }
+    return (long)n;
+}
+
+int SerialWaitWritable(SerialHandle comHandle, int timeout_ms) {
+    struct pollfd pfd;
+    int n;
+
+    pfd.fd = comHandle;
+    pfd.events = POLLOUT;
+    do {
+        n = poll(&pfd, 1, timeout_ms);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+// 创建一对伪终端作为本地虚拟串口 (代替 VSPD): *local 为本端 (主设备), 对端设备路径写入 name
+int OpenVirtualSerial(SerialHandle *local, char *name, int len) {
+
+    struct termios tio;
+    const char *peer;
+    int fd;
+
+    fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        printf("posix_openpt fail: %s\r\n", strerror(errno));
+        return -1;
+    }
+    if (grantpt(fd) != 0 || unlockpt(fd) != 0 || (peer = ptsname(fd)) == NULL || (int)strlen(peer) >= len) {
+        printf("pty setup fail\r\n");
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    // 对端打开之前也保持原始模式, 避免回显和换行转换
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    strcpy(name, peer);
+    *local = fd;
+    return 0;
+}
+
+#if !defined(__linux__)
+// 其他 POSIX 系统只支持 Bxxx 中的波特率
+int SerialSetCustomBaud(int fd, int baud) {
+    (void)fd;
+    (void)baud;
+    return -1;
 }
+#endif
 
+#endif
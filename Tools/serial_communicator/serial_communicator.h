@@ -2,15 +2,66 @@
 #ifndef SERIAL_COMMUNICATOR_H
 #define SERIAL_COMMUNICATOR_H
 
+#include <stddef.h>
 #include <stdio.h>
+
+#ifdef _WIN32
+
 #include <windows.h>
 
-extern HANDLE comHandle;
+typedef HANDLE SerialHandle;
+#define SERIAL_INVALID_HANDLE   INVALID_HANDLE_VALUE
+#define SERIAL_DEFAULT_PORT     "COM2"
+
+#else
+
+typedef int SerialHandle;
+#define SERIAL_INVALID_HANDLE   (-1)
+#define SERIAL_DEFAULT_PORT     "/dev/ttyS1"
+
+// 与 windows.h 相同的取值, 调用方代码在两个平台上保持一致
+#define CBR_110         110
+#define CBR_300         300
+#define CBR_600         600
+#define CBR_1200        1200
+#define CBR_2400        2400
+#define CBR_4800        4800
+#define CBR_9600        9600
+#define CBR_14400       14400
+#define CBR_19200       19200
+#define CBR_38400       38400
+#define CBR_57600       57600
+#define CBR_115200      115200
+#define CBR_128000      128000
+#define CBR_256000      256000
+
+#define NOPARITY        0
+#define ODDPARITY       1
+#define EVENPARITY      2
+#define MARKPARITY      3
+#define SPACEPARITY     4
+
+#define ONESTOPBIT      0
+#define ONE5STOPBITS    1
+#define TWOSTOPBITS     2
+
+#endif
+
+// Useserial 打开的默认串口; 同时使用多个串口见 serial_ports.h
+extern SerialHandle comHandle;
 
 int Useserial(void);
-HANDLE OpenSerial(const char *com, int baud, int byteSize, int parity, int stopBits);
-void CloseSerial(HANDLE comHandle);
+SerialHandle OpenSerial(const char *com, int baud, int byteSize, int parity, int stopBits);
+void CloseSerial(SerialHandle comHandle);
+void CloseSerialQuiet(SerialHandle comHandle);
 void SendMessageToSerial(const char* message);
+long SerialWrite(SerialHandle comHandle, const void *data, size_t len);
+int SerialWaitWritable(SerialHandle comHandle, int timeout_ms);
+
+#ifndef _WIN32
+int OpenVirtualSerial(SerialHandle *local, char *name, int len);
+int SerialSetCustomBaud(int fd, int baud);
+#endif
 
 
-#endif /* Serial Communicator */
\ No newline at end of file
+#endif /* Serial Communicator */
@@ -0,0 +1,476 @@
+// serial_format.c
+
+/*
+ * 遥测数据格式化：
+ * 按类型把数值直接写入发送队列的槽（见 serial_writer.c），代替 sprintf + 临时缓冲区 + SendMessageToSerial。
+ * 整数每次转换两位（查表）；浮点数输出能精确还原同一个 float 的最短十进制表示（Ryu 算法），
+ * 不查询 locale，小数点固定为 '.'，接收端用 strtof 即可得到原值。
+ *
+ * 输出格式与 main.c 相同，每条记录一行 "key=value\r\n"，数组为 "key=v0,v1,...\r\n"。
+ * 一个 SerialBatch 中的记录依次写入同一个槽，槽写满后自动提交并预留下一个槽，
+ * 写线程再把相邻的槽合并成一次写入。单行超过一个槽时，数组拆成多行（key 相同）。
+ * 浮点数在 1e-4 <= |v| < 1e9 时用定点表示（如 "0.001", "123.5"），否则用科学计数法（如 "1e+09"）。
+ *
+ * 示例：
+ * #include "serial_format.h"
+ *
+ * SerialWriter *writer = OpenSerialWriter(comHandle, NULL);
+ * SerialBatch batch;
+ *
+ * SerialSendInt(writer, "value", 10);              // "value=10\r\n"
+ *
+ * SerialBatchBegin(&batch, writer);
+ * SerialBatchFloat(&batch, "rms", rms);
+ * SerialBatchFloats(&batch, "ch", output, 16);     // "ch=0.125,-3.5,...\r\n"
+ * SerialBatchEnd(&batch);
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include "serial_format.h"
+
+static const char SerialDigits2[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static int SerialDigitCount(unsigned long long v) {
+    int n = 1;
+
+    for (;;) {
+        if (v < 10ull) return n;
+        if (v < 100ull) return n + 1;
+        if (v < 1000ull) return n + 2;
+        if (v < 10000ull) return n + 3;
+        v /= 10000ull;
+        n += 4;
+    }
+}
+
+// 写入 v 的 n 位十进制数字 (n 为 v 的位数)
+static void SerialWriteDigits(char *p, unsigned long long v, int n) {
+    p += n;
+    while (v >= 100ull) {
+        const unsigned d = (unsigned)(v % 100ull) * 2;
+        v /= 100ull;
+        *--p = SerialDigits2[d + 1];
+        *--p = SerialDigits2[d];
+    }
+    if (v >= 10ull) {
+        *--p = SerialDigits2[v * 2 + 1];
+        *--p = SerialDigits2[v * 2];
+    }
+    else {
+        *--p = (char)('0' + v);
+    }
+}
+
+char *SerialFormatUint(char *p, unsigned long long value) {
+    const int n = SerialDigitCount(value);
+
+    SerialWriteDigits(p, value, n);
+    return p + n;
+}
+
+char *SerialFormatInt(char *p, long long value) {
+    if (value < 0) {
+        *p++ = '-';
+        return SerialFormatUint(p, 0ull - (unsigned long long)value);
+    }
+    return SerialFormatUint(p, (unsigned long long)value);
+}
+
+/* ---------------- 最短浮点数表示 (Ryu, float) ---------------- */
+
+#define FLOAT_MANTISSA_BITS         23
+#define FLOAT_BIAS                  127
+#define FLOAT_POW5_INV_BITCOUNT     59
+#define FLOAT_POW5_BITCOUNT         61
+
+// floor(2^(pow5bits(i) - 1 + 59) / 5^i) + 1
+static const uint64_t SerialPow5InvSplit[31] = {
+    0x0800000000000001ull, 0x0666666666666667ull, 0x051eb851eb851eb9ull,
+    0x04189374bc6a7efaull, 0x068db8bac710cb2aull, 0x053e2d6238da3c22ull,
+    0x0431bde82d7b634eull, 0x06b5fca6af2bd216ull, 0x055e63b88c230e78ull,
+    0x044b82fa09b5a52dull, 0x06df37f675ef6eaeull, 0x057f5ff85e592558ull,
+    0x0465e6604b7a8447ull, 0x0709709a125da071ull, 0x05a126e1a84ae6c1ull,
+    0x0480ebe7b9d58567ull, 0x0734aca5f6226f0bull, 0x05c3bd5191b525a3ull,
+    0x049c97747490eae9ull, 0x0760f253edb4ab0eull, 0x05e72843249088d8ull,
+    0x04b8ed0283a6d3e0ull, 0x078e480405d7b966ull, 0x060b6cd004ac9452ull,
+    0x04d5f0a66a23a9dbull, 0x07bcb43d769f762bull, 0x063090312bb2c4efull,
+    0x04f3a68dbc8f03f3ull, 0x07ec3daf94180651ull, 0x065697bfa9acd1daull,
+    0x051212ffbaf0a7e2ull
+};
+
+// 5^i 的最高 61 位
+static const uint64_t SerialPow5Split[48] = {
+    0x1000000000000000ull, 0x1400000000000000ull, 0x1900000000000000ull,
+    0x1f40000000000000ull, 0x1388000000000000ull, 0x186a000000000000ull,
+    0x1e84800000000000ull, 0x1312d00000000000ull, 0x17d7840000000000ull,
+    0x1dcd650000000000ull, 0x12a05f2000000000ull, 0x174876e800000000ull,
+    0x1d1a94a200000000ull, 0x12309ce540000000ull, 0x16bcc41e90000000ull,
+    0x1c6bf52634000000ull, 0x11c37937e0800000ull, 0x16345785d8a00000ull,
+    0x1bc16d674ec80000ull, 0x1158e460913d0000ull, 0x15af1d78b58c4000ull,
+    0x1b1ae4d6e2ef5000ull, 0x10f0cf064dd59200ull, 0x152d02c7e14af680ull,
+    0x1a784379d99db420ull, 0x108b2a2c28029094ull, 0x14adf4b7320334b9ull,
+    0x19d971e4fe8401e7ull, 0x1027e72f1f128130ull, 0x1431e0fae6d7217cull,
+    0x193e5939a08ce9dbull, 0x1f8def8808b02452ull, 0x13b8b5b5056e16b3ull,
+    0x18a6e32246c99c60ull, 0x1ed09bead87c0378ull, 0x13426172c74d822bull,
+    0x1812f9cf7920e2b6ull, 0x1e17b84357691b64ull, 0x12ced32a16a1b11eull,
+    0x178287f49c4a1d66ull, 0x1d6329f1c35ca4bfull, 0x125dfa371a19e6f7ull,
+    0x16f578c4e0a060b5ull, 0x1cb2d6f618c878e3ull, 0x11efc659cf7d4b8dull,
+    0x166bb7f0435c9e71ull, 0x1c06a5ec5433c60dull, 0x118427b3b4a05bc8ull
+};
+
+static uint32_t SerialPow5Bits(int32_t e) {
+    return (uint32_t)(((uint32_t)e * 1217359u) >> 19) + 1;
+}
+
+static uint32_t SerialLog10Pow2(int32_t e) {
+    return ((uint32_t)e * 78913u) >> 18;
+}
+
+static uint32_t SerialLog10Pow5(int32_t e) {
+    return ((uint32_t)e * 732923u) >> 20;
+}
+
+static int SerialMultipleOfPow5(uint32_t v, uint32_t p) {
+    uint32_t count = 0;
+
+    while (v % 5 == 0) {
+        v /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static uint32_t SerialMulShift(uint32_t m, uint64_t factor, int32_t shift) {
+    const uint64_t lo = (uint64_t)m * (uint32_t)factor;
+    const uint64_t hi = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((lo >> 32) + hi) >> (shift - 32));
+}
+
+// 有限非零 float -> output * 10^exponent, output 为最短的能还原原值的整数
+static uint32_t SerialShortest(uint32_t ieeeMantissa, uint32_t ieeeExponent, int32_t *exponent) {
+
+    int32_t e2, e10, removed = 0;
+    uint32_t m2, mv, mp, mm, mmShift, vr, vp, vm, q;
+    int acceptBounds, vmIsTrailingZeros = 0, vrIsTrailingZeros = 0;
+    uint32_t lastRemovedDigit = 0, output;
+
+    if (ieeeExponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieeeMantissa;
+    }
+    else {
+        e2 = (int32_t)ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+    }
+    acceptBounds = (m2 & 1) == 0;
+
+    // 区间 [mm, mp] 内的十进制数都会舍入到该 float (以 1/4 ulp 为单位)
+    mv = 4 * m2;
+    mp = 4 * m2 + 2;
+    mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+    mm = 4 * m2 - 1 - mmShift;
+
+    if (e2 >= 0) {
+        const int32_t k = FLOAT_POW5_INV_BITCOUNT + (int32_t)SerialPow5Bits((int32_t)(q = SerialLog10Pow2(e2))) - 1;
+        const int32_t i = -e2 + (int32_t)q + k;
+        e10 = (int32_t)q;
+        vr = SerialMulShift(mv, SerialPow5InvSplit[q], i);
+        vp = SerialMulShift(mp, SerialPow5InvSplit[q], i);
+        vm = SerialMulShift(mm, SerialPow5InvSplit[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            const int32_t l = FLOAT_POW5_INV_BITCOUNT + (int32_t)SerialPow5Bits((int32_t)(q - 1)) - 1;
+            lastRemovedDigit = SerialMulShift(mv, SerialPow5InvSplit[q - 1], -e2 + (int32_t)q - 1 + l) % 10;
+        }
+        if (q <= 9) {
+            // mv, mp, mm 中至多一个是 5 的倍数
+            if (mv % 5 == 0) {
+                vrIsTrailingZeros = SerialMultipleOfPow5(mv, q);
+            }
+            else if (acceptBounds) {
+                vmIsTrailingZeros = SerialMultipleOfPow5(mm, q);
+            }
+            else {
+                vp -= (uint32_t)SerialMultipleOfPow5(mp, q);
+            }
+        }
+    }
+    else {
+        const int32_t i = -e2 - (int32_t)(q = SerialLog10Pow5(-e2));
+        int32_t j = (int32_t)q - ((int32_t)SerialPow5Bits(i) - FLOAT_POW5_BITCOUNT);
+        e10 = (int32_t)q + e2;
+        vr = SerialMulShift(mv, SerialPow5Split[i], j);
+        vp = SerialMulShift(mp, SerialPow5Split[i], j);
+        vm = SerialMulShift(mm, SerialPow5Split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - ((int32_t)SerialPow5Bits(i + 1) - FLOAT_POW5_BITCOUNT);
+            lastRemovedDigit = SerialMulShift(mv, SerialPow5Split[i + 1], j) % 10;
+        }
+        if (q <= 1) {
+            // mv = 4 * m2 至少有两个低位 0
+            vrIsTrailingZeros = 1;
+            if (acceptBounds) {
+                vmIsTrailingZeros = mmShift == 1;
+            }
+            else {
+                --vp;
+            }
+        }
+        else if (q < 31) {
+            vrIsTrailingZeros = (mv & ((1u << (q - 1)) - 1)) == 0;
+        }
+    }
+
+    // 在 [vm, vp] 中去掉尽可能多的低位
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+        // 恰好 ...50..0 时向偶数舍入
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+            lastRemovedDigit = 4;
+        }
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    }
+    else {
+        while (vp / 10 > vm / 10) {
+            lastRemovedDigit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        output = vr + (vr == vm || lastRemovedDigit >= 5);
+    }
+
+    *exponent = e10 + removed;
+    return output;
+}
+
+char *SerialFormatFloat(char *p, float value) {
+
+    uint32_t bits, mantissa, exponent, output;
+    int32_t e10, sci;
+    int n, i;
+    char digits[10];
+
+    memcpy(&bits, &value, sizeof(bits));
+    mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    exponent = (bits >> FLOAT_MANTISSA_BITS) & 0xffu;
+
+    if (exponent == 0xffu) {
+        if (mantissa != 0) {
+            memcpy(p, "nan", 3);
+            return p + 3;
+        }
+        if (bits >> 31) {
+            *p++ = '-';
+        }
+        memcpy(p, "inf", 3);
+        return p + 3;
+    }
+    if (bits >> 31) {
+        *p++ = '-';
+    }
+    if (exponent == 0 && mantissa == 0) {
+        *p++ = '0';
+        return p;
+    }
+
+    output = SerialShortest(mantissa, exponent, &e10);
+    n = SerialDigitCount(output);
+    SerialWriteDigits(digits, output, n);
+    sci = e10 + n - 1;
+
+    if (sci >= 0 && sci < 9) {
+        // ddd[.ddd] 或 ddd000
+        if (n <= sci + 1) {
+            memcpy(p, digits, (size_t)n);
+            memset(p + n, '0', (size_t)(sci + 1 - n));
+            return p + sci + 1;
+        }
+        memcpy(p, digits, (size_t)(sci + 1));
+        p[sci + 1] = '.';
+        memcpy(p + sci + 2, digits + sci + 1, (size_t)(n - sci - 1));
+        return p + n + 1;
+    }
+    if (sci < 0 && sci >= -4) {
+        // 0.000ddd
+        *p++ = '0';
+        *p++ = '.';
+        for (i = sci + 1; i < 0; i++) {
+            *p++ = '0';
+        }
+        memcpy(p, digits, (size_t)n);
+        return p + n;
+    }
+
+    // d[.ddd]e+XX
+    *p++ = digits[0];
+    if (n > 1) {
+        *p++ = '.';
+        memcpy(p, digits + 1, (size_t)(n - 1));
+        p += n - 1;
+    }
+    *p++ = 'e';
+    *p++ = sci < 0 ? '-' : '+';
+    sci = sci < 0 ? -sci : sci;
+    if (sci >= 100) {
+        *p++ = (char)('0' + sci / 100);
+        sci %= 100;
+    }
+    *p++ = SerialDigits2[sci * 2];
+    *p++ = SerialDigits2[sci * 2 + 1];
+    return p;
+}
+
+/* ---------------- 批量记录 ---------------- */
+
+// 保证当前槽还有 need 字节, 否则提交当前槽并预留新槽
+static int SerialBatchReserve(SerialBatch *batch, size_t need) {
+
+    size_t cap;
+
+    if (batch->slot != NULL && (size_t)(batch->end - batch->p) >= need) {
+        return 0;
+    }
+    if (batch->slot != NULL) {
+        SerialWriterCommit(batch->writer, batch->slot, (size_t)(batch->p - batch->slot));
+        batch->slot = NULL;
+    }
+    batch->slot = SerialWriterReserve(batch->writer, &cap);
+    if (batch->slot == NULL) {
+        batch->dropped++;
+        return -1;
+    }
+    batch->p = batch->slot;
+    batch->end = batch->slot + cap;
+    // 单行放不进一个空槽, 只可能是 key 过长
+    return cap >= need ? 0 : -1;
+}
+
+static void SerialBatchKey(SerialBatch *batch, const char *key, size_t keylen) {
+    memcpy(batch->p, key, keylen);
+    batch->p[keylen] = '=';
+    batch->p += keylen + 1;
+}
+
+static void SerialBatchEol(SerialBatch *batch) {
+    batch->p[0] = '\r';
+    batch->p[1] = '\n';
+    batch->p += 2;
+}
+
+void SerialBatchBegin(SerialBatch *batch, SerialWriter *writer) {
+    batch->writer = writer;
+    batch->slot = NULL;
+    batch->p = NULL;
+    batch->end = NULL;
+    batch->dropped = 0;
+}
+
+int SerialBatchInt(SerialBatch *batch, const char *key, long long value) {
+
+    const size_t keylen = strlen(key);
+
+    if (SerialBatchReserve(batch, keylen + 1 + SERIAL_INT_CHARS + 2) != 0) {
+        return -1;
+    }
+    SerialBatchKey(batch, key, keylen);
+    batch->p = SerialFormatInt(batch->p, value);
+    SerialBatchEol(batch);
+    return 0;
+}
+
+int SerialBatchFloat(SerialBatch *batch, const char *key, float value) {
+
+    const size_t keylen = strlen(key);
+
+    if (SerialBatchReserve(batch, keylen + 1 + SERIAL_FLOAT_CHARS + 2) != 0) {
+        return -1;
+    }
+    SerialBatchKey(batch, key, keylen);
+    batch->p = SerialFormatFloat(batch->p, value);
+    SerialBatchEol(batch);
+    return 0;
+}
+
+int SerialBatchFloats(SerialBatch *batch, const char *key, const float *samples, int count) {
+
+    const size_t keylen = strlen(key);
+    int i = 0;
+
+    while (i < count) {
+        if (SerialBatchReserve(batch, keylen + 1 + SERIAL_FLOAT_CHARS + 2) != 0) {
+            return -1;
+        }
+        SerialBatchKey(batch, key, keylen);
+        for (;;) {
+            batch->p = SerialFormatFloat(batch->p, samples[i++]);
+            // 下一个值连同 ',' 和行尾放不下时换行
+            if (i == count || (size_t)(batch->end - batch->p) < 1 + SERIAL_FLOAT_CHARS + 2) {
+                break;
+            }
+            *batch->p++ = ',';
+        }
+        SerialBatchEol(batch);
+    }
+    return 0;
+}
+
+// 提交最后一个槽, 有记录被丢弃时返回 -1
+int SerialBatchEnd(SerialBatch *batch) {
+    if (batch->slot != NULL) {
+        SerialWriterCommit(batch->writer, batch->slot, (size_t)(batch->p - batch->slot));
+        batch->slot = NULL;
+    }
+    return batch->dropped ? -1 : 0;
+}
+
+int SerialSendInt(SerialWriter *writer, const char *key, long long value) {
+    SerialBatch batch;
+
+    SerialBatchBegin(&batch, writer);
+    return (SerialBatchInt(&batch, key, value) | SerialBatchEnd(&batch)) ? -1 : 0;
+}
+
+int SerialSendFloat(SerialWriter *writer, const char *key, float value) {
+    SerialBatch batch;
+
+    SerialBatchBegin(&batch, writer);
+    return (SerialBatchFloat(&batch, key, value) | SerialBatchEnd(&batch)) ? -1 : 0;
+}
+
+int SerialSendFloats(SerialWriter *writer, const char *key, const float *samples, int count) {
+    SerialBatch batch;
+
+    SerialBatchBegin(&batch, writer);
+    return (SerialBatchFloats(&batch, key, samples, count) | SerialBatchEnd(&batch)) ? -1 : 0;
+}
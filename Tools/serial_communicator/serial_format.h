@@ -0,0 +1,34 @@
+// serial_format.h
+#ifndef SERIAL_FORMAT_H
+#define SERIAL_FORMAT_H
+
+#include "serial_writer.h"
+
+#define SERIAL_INT_CHARS        20      // SerialFormatInt 最多写入的字节数 ("-9223372036854775808")
+#define SERIAL_FLOAT_CHARS      15      // SerialFormatFloat 最多写入的字节数 ("-1.17549435e-38")
+
+// 一批遥测记录, 每条记录一行 "key=value\r\n", 直接写入发送队列的槽
+typedef struct {
+    SerialWriter *writer;
+    char *slot;             // 当前预留的槽, NULL 表示尚未预留
+    char *p;                // 写入位置
+    char *end;              // 槽的末尾
+    int dropped;            // 因队列满被丢弃的槽数
+} SerialBatch;
+
+char *SerialFormatUint(char *p, unsigned long long value);
+char *SerialFormatInt(char *p, long long value);
+char *SerialFormatFloat(char *p, float value);
+
+void SerialBatchBegin(SerialBatch *batch, SerialWriter *writer);
+int SerialBatchInt(SerialBatch *batch, const char *key, long long value);
+int SerialBatchFloat(SerialBatch *batch, const char *key, float value);
+int SerialBatchFloats(SerialBatch *batch, const char *key, const float *samples, int count);
+int SerialBatchEnd(SerialBatch *batch);
+
+int SerialSendInt(SerialWriter *writer, const char *key, long long value);
+int SerialSendFloat(SerialWriter *writer, const char *key, float value);
+int SerialSendFloats(SerialWriter *writer, const char *key, const float *samples, int count);
+
+
+#endif /* Serial Format */
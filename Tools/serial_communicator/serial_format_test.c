@@ -0,0 +1,215 @@
+// serial_format_test.c
+
+/*
+ * serial_format 的自动测试（ctest），只在内存中格式化，不需要串口：
+ *     整数：0、各位数边界、LLONG_MIN / LLONG_MAX / ULLONG_MAX，与 snprintf 的结果比较
+ *     浮点数：特殊值、非规格化数、边界值和大量伪随机位模式，strtof 读回必须得到同一个 float，
+ *             有效数字位数与能还原原值的最少位数相同（最短表示）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include "serial_format.h"
+#include "serial_test.h"
+
+#define TEST_RANDOM_FLOATS  1000000
+
+static void TestInt(long long value) {
+
+    char buf[SERIAL_INT_CHARS + 1], ref[32];
+    char *end = SerialFormatInt(buf, value);
+
+    SERIAL_CHECK(end - buf <= SERIAL_INT_CHARS);
+    *end = '\0';
+    snprintf(ref, sizeof(ref), "%lld", value);
+    if (strcmp(buf, ref) != 0) {
+        printf("int %s: got %s\r\n", ref, buf);
+        serial_test_failures++;
+    }
+}
+
+static void TestUint(unsigned long long value) {
+
+    char buf[SERIAL_INT_CHARS + 1], ref[32];
+
+    *SerialFormatUint(buf, value) = '\0';
+    snprintf(ref, sizeof(ref), "%llu", value);
+    if (strcmp(buf, ref) != 0) {
+        printf("uint %s: got %s\r\n", ref, buf);
+        serial_test_failures++;
+    }
+}
+
+static void TestInts(void) {
+
+    unsigned long long p = 1;
+    int i;
+
+    TestInt(0);
+    TestInt(LLONG_MAX);
+    TestInt(LLONG_MIN);
+    TestInt(LLONG_MIN + 1);
+    TestUint(0);
+    TestUint(ULLONG_MAX);
+    // 10^k - 1, 10^k, 10^k + 1 及其负数
+    for (i = 0; i < 19; i++) {
+        TestInt((long long)p - 1);
+        TestInt((long long)p);
+        TestInt((long long)p + 1);
+        TestInt(-(long long)p);
+        TestInt(1 - (long long)p);
+        TestUint(p * 10 - 1);
+        p *= 10;
+    }
+    TestUint(p);
+    TestUint(p - 1);
+}
+
+// 能还原 value 的最少有效数字位数
+// 2 的幂下方的间隔只有上方的一半, 最近的 k 位小数不能还原时相邻的 k 位小数可能可以, 所以三个都试
+static int TestShortestDigits(float value) {
+
+    char ref[32];
+    long long m;
+    int k, e, d;
+
+    for (k = 1; k < 9; k++) {
+        snprintf(ref, sizeof(ref), "%.*e", k - 1, fabs((double)value));
+        m = ref[0] - '0';
+        for (d = 2; d <= k; d++) {
+            m = m * 10 + (ref[d] - '0');
+        }
+        e = atoi(strchr(ref, 'e') + 1) - (k - 1);
+        for (d = -1; d <= 1; d++) {
+            snprintf(ref, sizeof(ref), "%llde%d", m + d, e);
+            if (strtof(ref, NULL) == fabsf(value)) {
+                return k;
+            }
+        }
+    }
+    return k;
+}
+
+// 字符串中的有效数字位数 (不含前导零、尾部零和指数部分)
+static int TestDigits(const char *s) {
+
+    int first = -1, last = -1, i = 0;
+
+    for (; *s != '\0' && *s != 'e'; s++) {
+        if (*s >= '0' && *s <= '9') {
+            if (*s != '0') {
+                if (first < 0) {
+                    first = i;
+                }
+                last = i;
+            }
+            i++;
+        }
+    }
+    return first < 0 ? 0 : last - first + 1;
+}
+
+static void TestFloat(float value) {
+
+    char buf[SERIAL_FLOAT_CHARS + 1];
+    char *end = SerialFormatFloat(buf, value);
+    float back;
+
+    SERIAL_CHECK(end - buf <= SERIAL_FLOAT_CHARS);
+    *end = '\0';
+    back = strtof(buf, NULL);
+    if (isnan(value)) {
+        SERIAL_CHECK(isnan(back));
+        return;
+    }
+    if (memcmp(&back, &value, sizeof(value)) != 0) {
+        printf("float %.9g: got %s\r\n", (double)value, buf);
+        serial_test_failures++;
+        return;
+    }
+    if (value != 0 && !isinf(value) && TestDigits(buf) != TestShortestDigits(value)) {
+        printf("float %.9g: %s is not shortest\r\n", (double)value, buf);
+        serial_test_failures++;
+    }
+}
+
+static float TestBits(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void TestFloatText(float value, const char *text) {
+
+    char buf[SERIAL_FLOAT_CHARS + 1];
+
+    *SerialFormatFloat(buf, value) = '\0';
+    if (strcmp(buf, text) != 0) {
+        printf("float %.9g: got %s, expected %s\r\n", (double)value, buf, text);
+        serial_test_failures++;
+    }
+}
+
+static void TestFloats(void) {
+
+    uint32_t state = 12345;
+    float p = 1;
+    int i;
+
+    // 固定写法
+    TestFloatText(0.0f, "0");
+    TestFloatText(-0.0f, "-0");
+    TestFloatText(INFINITY, "inf");
+    TestFloatText(-INFINITY, "-inf");
+    TestFloatText(NAN, "nan");
+    TestFloatText(0.001f, "0.001");
+    TestFloatText(123.5f, "123.5");
+    TestFloatText(-3.5f, "-3.5");
+    TestFloatText(1e8f, "100000000");
+    TestFloatText(1e9f, "1e+09");
+    TestFloatText(1e-4f, "0.0001");
+    TestFloatText(1e-5f, "1e-05");
+    TestFloatText(FLT_MAX, "3.4028235e+38");
+    TestFloatText(-FLT_MIN, "-1.1754944e-38");
+    TestFloatText(TestBits(1), "1e-45");
+
+    // 边界值
+    TestFloat(FLT_MIN);
+    TestFloat(FLT_MAX);
+    TestFloat(FLT_EPSILON);
+    TestFloat(TestBits(1));
+    TestFloat(TestBits(0x007fffffu));
+    TestFloat(1.0f / 3.0f);
+    TestFloat(0.1f);
+    TestFloat(16777216.0f);
+    TestFloat(16777217.0f);
+    for (i = 0; i < 38; i++) {
+        TestFloat(p);
+        TestFloat(1.0f / p);
+        TestFloat(nextafterf(p, 0));
+        TestFloat(nextafterf(p, INFINITY));
+        p *= 10;
+    }
+    // 每个指数的最小、最大尾数
+    for (i = 0; i < 255; i++) {
+        TestFloat(TestBits((uint32_t)i << 23));
+        TestFloat(TestBits(((uint32_t)i << 23) | 0x007fffffu));
+    }
+    // 伪随机位模式 (含负数和非规格化数)
+    for (i = 0; i < TEST_RANDOM_FLOATS; i++) {
+        state = state * 1664525u + 1013904223u;
+        TestFloat(TestBits(state));
+    }
+}
+
+int main(void) {
+
+    TestInts();
+    TestFloats();
+    return SERIAL_TEST_RESULT;
+}
@@ -0,0 +1,522 @@
+// serial_frame.c
+
+/*
+ * 二进制帧协议：
+ * 文本格式 "value=%d\r\n" 每个采样要 10 字节以上，接收端还要解析。二进制帧每个采样 2 或 4 字节，
+ * 用 COBS 编码去掉数据中的 0x00，0x00 只作为帧分隔符，接收端丢失或收到错误字节后在下一个 0x00 处重新同步。
+ *
+ * 帧结构（COBS 编码前，小端）：
+ *     类型 (1) | 序号 (2) | 数据 (n) | CRC-16 (2) 或 CRC-32 (4)
+ * 类型最高位为 SERIAL_FRAME_CRC32 时使用 CRC-32，CRC 覆盖类型、序号和数据。
+ * 序号每帧加 1，接收端按序号统计丢帧数。
+ *
+ * 采样帧（SERIAL_FRAME_SAMPLES）的数据：
+ *     通道数 (1) | 格式 (1) | 采样帧数 (2) | 比例系数 (float, 4) | 采样，按采样帧交织 [帧][通道]
+ * 格式为 SERIAL_SAMPLE_F32、SERIAL_SAMPLE_I16 或 SERIAL_SAMPLE_I32，整数格式的实际值 = 整数 * 比例系数。
+ * SERIAL_SAMPLE_PACKED 量化方式与 SERIAL_SAMPLE_I32 相同，采样数据换成 serial_pack.c 的压缩块，
+ * 每帧独立压缩，丢帧不影响后续帧的解码。
+ *
+ * 编码时先把原始帧写在输出缓冲区靠后的位置，再原地 COBS 编码到缓冲区开头，不需要额外的缓冲区。
+ *
+ * 示例：
+ * #include "serial_frame.h"
+ *
+ * // 发送端: 16 通道, int16, 1 LSB = 0.001
+ * SerialFrameEncoder enc;
+ * SerialFrameEncoderInit(&enc, 16, SERIAL_SAMPLE_I16, 0.001f, 0);
+ * SerialSendSamples(writer, &enc, output, 8);          // 8 个采样帧, 交织存放
+ *
+ * // 接收端
+ * static void on_frame(const SerialFrame *frame, void *ctx) {
+ *     float samples[1024];
+ *     int channels, frames = SerialFrameSamples(frame, samples, 1024, &channels);
+ *     ...
+ * }
+ * SerialFrameDecoder dec;
+ * SerialFrameDecoderInit(&dec, 4096, on_frame, NULL);
+ * SerialFrameDecode(&dec, rx, rx_len);                 // 任意切分的接收数据
+ * SerialFrameDecoderFree(&dec);
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "serial_frame.h"
+#include "serial_pack.h"
+
+#define SERIAL_COBS_OVERHEAD(len)   ((len) / 254 + 2)
+
+static uint32_t SerialCrc32Table[8][256];
+static uint16_t SerialCrc16Table[8][256];
+#ifdef _WIN32
+static INIT_ONCE SerialCrcOnce = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t SerialCrcOnce = PTHREAD_ONCE_INIT;
+#endif
+
+static void SerialCrcInit(void) {
+    uint32_t c;
+    uint16_t h;
+    int i, k;
+
+    for (i = 0; i < 256; i++) {
+        c = (uint32_t)i;
+        for (k = 0; k < 8; k++) {
+            c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+        }
+        SerialCrc32Table[0][i] = c;
+
+        h = (uint16_t)(i << 8);
+        for (k = 0; k < 8; k++) {
+            h = (uint16_t)((h << 1) ^ ((h & 0x8000u) ? 0x1021u : 0u));
+        }
+        SerialCrc16Table[0][i] = h;
+    }
+    // slicing-by-8: 表 k 为后面跟 k 个 0 字节时的余数
+    for (k = 1; k < 8; k++) {
+        for (i = 0; i < 256; i++) {
+            c = SerialCrc32Table[k - 1][i];
+            SerialCrc32Table[k][i] = (c >> 8) ^ SerialCrc32Table[0][c & 0xffu];
+            h = SerialCrc16Table[k - 1][i];
+            SerialCrc16Table[k][i] = (uint16_t)((h << 8) ^ SerialCrc16Table[0][h >> 8]);
+        }
+    }
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK SerialCrcInitOnce(PINIT_ONCE once, PVOID param, PVOID *context) {
+    (void)once;
+    (void)param;
+    (void)context;
+    SerialCrcInit();
+    return TRUE;
+}
+#endif
+
+// 第一次使用时建表, 多线程同时调用时只建一次
+static void SerialCrcReady(void) {
+#ifdef _WIN32
+    InitOnceExecuteOnce(&SerialCrcOnce, SerialCrcInitOnce, NULL, NULL);
+#else
+    pthread_once(&SerialCrcOnce, SerialCrcInit);
+#endif
+}
+
+static uint32_t SerialLoad32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void SerialStore16(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void SerialStore32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, "123456789" -> 0x29B1
+uint16_t SerialCrc16(const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint16_t crc = 0xFFFFu;
+
+    SerialCrcReady();
+    while (len >= 8) {
+        crc = SerialCrc16Table[7][p[0] ^ (crc >> 8)] ^ SerialCrc16Table[6][p[1] ^ (crc & 0xffu)]
+            ^ SerialCrc16Table[5][p[2]] ^ SerialCrc16Table[4][p[3]]
+            ^ SerialCrc16Table[3][p[4]] ^ SerialCrc16Table[2][p[5]]
+            ^ SerialCrc16Table[1][p[6]] ^ SerialCrc16Table[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (uint16_t)((crc << 8) ^ SerialCrc16Table[0][((crc >> 8) ^ *p++) & 0xffu]);
+    }
+    return crc;
+}
+
+// CRC-32 (IEEE 802.3): "123456789" -> 0xCBF43926
+uint32_t SerialCrc32(const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFu, a, b;
+
+    SerialCrcReady();
+    while (len >= 8) {
+        a = SerialLoad32(p) ^ crc;
+        b = SerialLoad32(p + 4);
+        crc = SerialCrc32Table[7][a & 0xffu] ^ SerialCrc32Table[6][(a >> 8) & 0xffu]
+            ^ SerialCrc32Table[5][(a >> 16) & 0xffu] ^ SerialCrc32Table[4][a >> 24]
+            ^ SerialCrc32Table[3][b & 0xffu] ^ SerialCrc32Table[2][(b >> 8) & 0xffu]
+            ^ SerialCrc32Table[1][(b >> 16) & 0xffu] ^ SerialCrc32Table[0][b >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ SerialCrc32Table[0][(crc ^ *p++) & 0xffu];
+    }
+    return ~crc;
+}
+
+// COBS 编码, 不含分隔符; dst 可以与 src 重叠, 只要 dst + SERIAL_COBS_OVERHEAD(len) <= src
+size_t SerialCobsEncode(uint8_t *dst, const uint8_t *src, size_t len) {
+
+    const uint8_t *end = src + len;
+    const uint8_t *zero;
+    uint8_t *out = dst;
+    size_t run, n;
+
+    for (;;) {
+        run = (size_t)(end - src) < 254 ? (size_t)(end - src) : 254;
+        zero = (const uint8_t *)memchr(src, 0, run);
+        n = zero != NULL ? (size_t)(zero - src) : run;
+        *out++ = (uint8_t)(n + 1);
+        memmove(out, src, n);
+        out += n;
+        src += n;
+        if (zero != NULL) {
+            // 0x00 由下一个码字隐含, 数据以 0x00 结尾时还要输出一个空块
+            src++;
+        }
+        else if (n < 254 || src == end) {
+            break;
+        }
+    }
+    return (size_t)(out - dst);
+}
+
+// COBS 解码 (不含分隔符), 可以原地解码 (dst == src), 格式错误返回 -1
+long SerialCobsDecode(uint8_t *dst, const uint8_t *src, size_t len) {
+
+    const uint8_t *end = src + len;
+    uint8_t *out = dst;
+    size_t n;
+    unsigned code;
+
+    while (src < end) {
+        code = *src++;
+        n = code - 1u;
+        if (code == 0 || n > (size_t)(end - src)) {
+            return -1;
+        }
+        memmove(out, src, n);
+        out += n;
+        src += n;
+        if (code != 0xFF && src < end) {
+            *out++ = 0;
+        }
+    }
+    return (long)(out - dst);
+}
+
+// 原始帧 raw (已在 out + SERIAL_COBS_OVERHEAD 处写好类型, 序号和数据) 追加 CRC 后原地编码
+static long SerialFrameFinish(uint8_t *out, uint8_t *raw, size_t len) {
+    size_t n;
+
+    if (raw[0] & SERIAL_FRAME_CRC32) {
+        SerialStore32(raw + len, SerialCrc32(raw, len));
+        len += 4;
+    }
+    else {
+        SerialStore16(raw + len, SerialCrc16(raw, len));
+        len += 2;
+    }
+    n = SerialCobsEncode(out, raw, len);
+    out[n] = 0;
+    return (long)n + 1;
+}
+
+// 编码一帧, 返回写入 out 的字节数 (含分隔符), 空间不足返回 -1
+long SerialFrameEncode(uint8_t *out, size_t cap, int type, unsigned seq, const void *payload, size_t len) {
+
+    const size_t raw_len = SERIAL_FRAME_HEADER + len + 4;
+    uint8_t *raw = out + SERIAL_COBS_OVERHEAD(raw_len);
+
+    if (cap < SERIAL_FRAME_BOUND(len)) {
+        return -1;
+    }
+    raw[0] = (uint8_t)type;
+    SerialStore16(raw + 1, seq);
+    memcpy(raw + SERIAL_FRAME_HEADER, payload, len);
+    return SerialFrameFinish(out, raw, SERIAL_FRAME_HEADER + len);
+}
+
+void SerialFrameEncoderInit(SerialFrameEncoder *enc, int channels, int format, float scale, int crc32) {
+    enc->seq = 0;
+    enc->crc32 = crc32;
+    enc->channels = channels;
+    enc->format = format;
+    enc->scale = scale > 0.0f ? scale : 1.0f;
+}
+
+static int SerialSampleBytes(int format) {
+    return format == SERIAL_SAMPLE_I16 ? 2 : 4;
+}
+
+// 编码 frames 个采样帧 (samples 按 [帧][通道] 交织), 返回写入 out 的字节数, 空间不足返回 -1
+long SerialFrameEncodeSamples(SerialFrameEncoder *enc, uint8_t *out, size_t cap, const float *samples, int frames) {
+
+    const size_t count = (size_t)frames * (size_t)enc->channels;
+    const float inv = 1.0f / enc->scale;
+    size_t len = SERIAL_SAMPLE_HEADER + count * (size_t)SerialSampleBytes(enc->format);
+    size_t raw_len = SERIAL_FRAME_HEADER + len + 4;
+    uint8_t *raw, *p;
+    uint32_t bits;
+    long packed = 0;
+    float v;
+    size_t i;
+
+    if (enc->format == SERIAL_SAMPLE_PACKED) {
+        // 压缩后的长度事先未知, 按 cap 预留 COBS 开销, 压缩时按剩余空间检查
+        raw_len = cap > SERIAL_COBS_OVERHEAD(cap) + 1 ? cap - SERIAL_COBS_OVERHEAD(cap) - 1 : 0;
+        len = raw_len > SERIAL_FRAME_HEADER + SERIAL_SAMPLE_HEADER + 4 ? raw_len - SERIAL_FRAME_HEADER - 4 : 0;
+        raw = out + SERIAL_COBS_OVERHEAD(cap);
+    }
+    else {
+        raw = out + SERIAL_COBS_OVERHEAD(raw_len);
+    }
+    p = raw + SERIAL_FRAME_HEADER + SERIAL_SAMPLE_HEADER;
+
+    if (cap < SERIAL_FRAME_BOUND(len) || len == 0 || frames <= 0 || frames > 0xffff) {
+        return -1;
+    }
+    if (enc->format == SERIAL_SAMPLE_PACKED) {
+        packed = SerialPackSamples(p, len - SERIAL_SAMPLE_HEADER, samples, enc->channels, frames, enc->scale);
+        if (packed < 0) {
+            return -1;
+        }
+        len = SERIAL_SAMPLE_HEADER + (size_t)packed;
+    }
+    raw[0] = (uint8_t)(SERIAL_FRAME_SAMPLES | (enc->crc32 ? SERIAL_FRAME_CRC32 : 0));
+    SerialStore16(raw + 1, enc->seq);
+    raw[3] = (uint8_t)enc->channels;
+    raw[4] = (uint8_t)enc->format;
+    SerialStore16(raw + 5, (uint32_t)frames);
+    memcpy(&bits, &enc->scale, sizeof(bits));
+    SerialStore32(raw + 7, bits);
+
+    switch (enc->format) {
+        case SERIAL_SAMPLE_I16:
+            for (i = 0; i < count; i++) {
+                v = samples[i] * inv;
+                v = v < -32768.0f ? -32768.0f : v > 32767.0f ? 32767.0f : v;
+                SerialStore16(p + 2 * i, (uint32_t)(int32_t)(v + (v >= 0.0f ? 0.5f : -0.5f)));
+            }
+            break;
+        case SERIAL_SAMPLE_I32:
+            for (i = 0; i < count; i++) {
+                v = samples[i] * inv;
+                v = v < -2147483648.0f ? -2147483648.0f : v > 2147483520.0f ? 2147483520.0f : v;
+                SerialStore32(p + 4 * i, (uint32_t)(int32_t)(v + (v >= 0.0f ? 0.5f : -0.5f)));
+            }
+            break;
+        case SERIAL_SAMPLE_PACKED:
+            break;
+        default:
+            for (i = 0; i < count; i++) {
+                memcpy(&bits, &samples[i], sizeof(bits));
+                SerialStore32(p + 4 * i, bits);
+            }
+            break;
+    }
+    enc->seq = (enc->seq + 1) & 0xffffu;
+    return SerialFrameFinish(out, raw, SERIAL_FRAME_HEADER + len);
+}
+
+// 直接编码到发送队列的槽, 一个槽放不下时拆成多帧; 有帧被丢弃时返回 -1
+int SerialSendSamples(SerialWriter *writer, SerialFrameEncoder *enc, const float *samples, int frames) {
+
+    const size_t bytes = (size_t)enc->channels * (size_t)SerialSampleBytes(enc->format);
+    size_t cap, fit;
+    char *slot;
+    long n;
+    int chunk, hint = 0xffff;
+
+    while (frames > 0) {
+        slot = SerialWriterReserve(writer, &cap);
+        if (slot == NULL) {
+            return -1;
+        }
+        // SERIAL_FRAME_BOUND(len) <= cap, 按 cap 估计 COBS 开销
+        fit = cap > SERIAL_FRAME_HEADER + SERIAL_SAMPLE_HEADER + 4 + cap / 254 + 3
+            ? (cap - SERIAL_FRAME_HEADER - SERIAL_SAMPLE_HEADER - 4 - cap / 254 - 3) / bytes : 0;
+        chunk = fit < (size_t)frames ? (int)fit : frames;
+        if (enc->format == SERIAL_SAMPLE_PACKED) {
+            // 压缩后的长度取决于数据, 从上一个槽放下的帧数的 2 倍开始尝试, 放不下时减半
+            chunk = frames < hint ? frames : hint;
+            while ((n = SerialFrameEncodeSamples(enc, (uint8_t *)slot, cap, samples, chunk)) < 0 && chunk > 1) {
+                chunk /= 2;
+            }
+            hint = chunk < 0x7fff ? chunk * 2 : 0xffff;
+        }
+        else {
+            n = chunk > 0 ? SerialFrameEncodeSamples(enc, (uint8_t *)slot, cap, samples, chunk) : -1;
+        }
+        SerialWriterCommit(writer, slot, n > 0 ? (size_t)n : 0);
+        if (n < 0) {
+            return -1;
+        }
+        samples += (size_t)chunk * (size_t)enc->channels;
+        frames -= chunk;
+    }
+    return 0;
+}
+
+int SerialFrameDecoderInit(SerialFrameDecoder *dec, size_t max_frame,
+                           void (*on_frame)(const SerialFrame *frame, void *ctx), void *ctx) {
+    memset(dec, 0, sizeof(*dec));
+    dec->cap = SERIAL_FRAME_BOUND(max_frame);
+    dec->buf = (uint8_t *)malloc(dec->cap);
+    dec->on_frame = on_frame;
+    dec->ctx = ctx;
+    return dec->buf != NULL ? 0 : -1;
+}
+
+void SerialFrameDecoderFree(SerialFrameDecoder *dec) {
+    free(dec->buf);
+    dec->buf = NULL;
+}
+
+// 把 src[0..len) 的 COBS 数据解码到 dec->buf (src 可以就是 dec->buf), 校验后分发
+static int SerialFrameDispatch(SerialFrameDecoder *dec, const uint8_t *src, size_t len) {
+
+    SerialFrame frame;
+    uint8_t *buf = dec->buf;
+    long n = SerialCobsDecode(buf, src, len);
+    size_t crc_len;
+
+    if (n < 0) {
+        dec->crc_errors++;
+        return 0;
+    }
+    crc_len = n > 0 && (buf[0] & SERIAL_FRAME_CRC32) ? 4 : 2;
+    if ((size_t)n < SERIAL_FRAME_HEADER + crc_len) {
+        dec->crc_errors++;
+        return 0;
+    }
+    n -= (long)crc_len;
+    if (crc_len == 4 ? SerialCrc32(buf, (size_t)n) != SerialLoad32(buf + n)
+                     : SerialCrc16(buf, (size_t)n) != (uint16_t)(buf[n] | buf[n + 1] << 8)) {
+        dec->crc_errors++;
+        return 0;
+    }
+
+    frame.type = buf[0] & ~SERIAL_FRAME_CRC32;
+    frame.seq = (unsigned)(buf[1] | buf[2] << 8);
+    frame.payload = buf + SERIAL_FRAME_HEADER;
+    frame.len = (size_t)n - SERIAL_FRAME_HEADER;
+    if (dec->synced) {
+        dec->lost += (frame.seq - dec->next_seq) & 0xffffu;
+    }
+    dec->synced = 1;
+    dec->next_seq = (frame.seq + 1) & 0xffffu;
+    dec->frames++;
+    if (dec->on_frame != NULL) {
+        dec->on_frame(&frame, dec->ctx);
+    }
+    return 1;
+}
+
+// 输入任意切分的接收数据, 返回本次分发的有效帧数
+int SerialFrameDecode(SerialFrameDecoder *dec, const void *data, size_t len) {
+
+    const uint8_t *p = (const uint8_t *)data;
+    const uint8_t *end = p + len;
+    const uint8_t *zero;
+    size_t n;
+    int frames = 0;
+
+    while (p < end) {
+        zero = (const uint8_t *)memchr(p, 0, (size_t)(end - p));
+        n = (size_t)((zero != NULL ? zero : end) - p);
+
+        if (!dec->discard && dec->len + n > dec->cap) {
+            dec->discard = 1;
+            dec->overruns++;
+        }
+        if (zero == NULL) {
+            if (!dec->discard) {
+                memcpy(dec->buf + dec->len, p, n);
+                dec->len += n;
+            }
+            break;
+        }
+
+        if (!dec->discard && dec->len == 0 && n > 0) {
+            // 整帧都在本次输入中, 直接从输入解码
+            frames += SerialFrameDispatch(dec, p, n);
+        }
+        else if (!dec->discard && dec->len + n > 0) {
+            memcpy(dec->buf + dec->len, p, n);
+            frames += SerialFrameDispatch(dec, dec->buf, dec->len + n);
+        }
+        dec->len = 0;
+        dec->discard = 0;
+        p = zero + 1;
+    }
+    return frames;
+}
+
+// 采样帧 -> float, 返回采样帧数, 格式错误或 max_values 不足返回 -1
+int SerialFrameSamples(const SerialFrame *frame, float *samples, int max_values, int *channels) {
+
+    const uint8_t *p = frame->payload;
+    const uint8_t *data = p + SERIAL_SAMPLE_HEADER;
+    size_t count, i;
+    uint32_t bits;
+    float scale;
+    int ch, frames, bytes;
+
+    if (frame->type != SERIAL_FRAME_SAMPLES || frame->len < SERIAL_SAMPLE_HEADER) {
+        return -1;
+    }
+    ch = p[0];
+    frames = p[2] | p[3] << 8;
+    bytes = SerialSampleBytes(p[1]);
+    count = (size_t)ch * (size_t)frames;
+    bits = SerialLoad32(p + 4);
+    memcpy(&scale, &bits, sizeof(scale));
+    if (p[1] > SERIAL_SAMPLE_PACKED || count > (size_t)max_values) {
+        return -1;
+    }
+    if (p[1] == SERIAL_SAMPLE_PACKED) {
+        if (count == 0 || SerialUnpackSamples(samples, data, frame->len - SERIAL_SAMPLE_HEADER, ch, frames, scale)
+                          != (long)(frame->len - SERIAL_SAMPLE_HEADER)) {
+            return -1;
+        }
+    }
+    else if (frame->len != SERIAL_SAMPLE_HEADER + count * (size_t)bytes) {
+        return -1;
+    }
+
+    switch (p[1]) {
+        case SERIAL_SAMPLE_I16:
+            for (i = 0; i < count; i++) {
+                samples[i] = (float)(int16_t)(data[2 * i] | data[2 * i + 1] << 8) * scale;
+            }
+            break;
+        case SERIAL_SAMPLE_I32:
+            for (i = 0; i < count; i++) {
+                samples[i] = (float)(int32_t)SerialLoad32(data + 4 * i) * scale;
+            }
+            break;
+        case SERIAL_SAMPLE_PACKED:
+            break;
+        default:
+            for (i = 0; i < count; i++) {
+                bits = SerialLoad32(data + 4 * i);
+                memcpy(&samples[i], &bits, sizeof(bits));
+            }
+            break;
+    }
+    if (channels != NULL) {
+        *channels = ch;
+    }
+    return frames;
+}
@@ -0,0 +1,76 @@
+// serial_frame.h
+#ifndef SERIAL_FRAME_H
+#define SERIAL_FRAME_H
+
+#include <stdint.h>
+#include "serial_writer.h"
+
+// 帧类型, 类型字节最高位表示校验方式
+#define SERIAL_FRAME_DATA       0x00    // 任意数据
+#define SERIAL_FRAME_SAMPLES    0x01    // 多通道采样, 见 SerialFrameEncodeSamples
+#define SERIAL_FRAME_CRC32      0x80    // CRC-32 (IEEE), 否则 CRC-16 (CCITT-FALSE)
+
+#define SERIAL_FRAME_HEADER     3       // 类型 + 序号
+#define SERIAL_SAMPLE_HEADER    8       // 通道数 + 格式 + 采样帧数 + 比例系数
+
+// 采样格式
+#define SERIAL_SAMPLE_F32       0       // float
+#define SERIAL_SAMPLE_I16       1       // int16, 值 = 整数 * scale
+#define SERIAL_SAMPLE_I32       2       // int32, 值 = 整数 * scale
+#define SERIAL_SAMPLE_PACKED    3       // 按 scale 量化后预测 + 位打包压缩, 见 serial_pack.c
+
+// 编码后的最大字节数 (含分隔符 0x00)
+#define SERIAL_FRAME_BOUND(len) ((len) + SERIAL_FRAME_HEADER + 4 + ((len) + SERIAL_FRAME_HEADER + 4) / 254 + 3)
+
+// 解码后的帧, payload 指向解码器内部缓冲区, 只在回调期间有效
+typedef struct {
+    int type;               // SERIAL_FRAME_DATA / SERIAL_FRAME_SAMPLES (不含校验位)
+    unsigned seq;           // 序号 (0 ~ 65535)
+    const uint8_t *payload;
+    size_t len;
+} SerialFrame;
+
+// 采样帧编码器
+typedef struct {
+    unsigned seq;           // 下一帧的序号
+    int crc32;              // 1: CRC-32, 0: CRC-16
+    int channels;           // 通道数 (1 ~ 255)
+    int format;             // SERIAL_SAMPLE_*
+    float scale;            // 整数格式的比例系数
+} SerialFrameEncoder;
+
+// 流式解码器
+typedef struct {
+    uint8_t *buf;           // 未解码的帧数据
+    size_t cap;
+    size_t len;
+    int discard;            // 帧超长, 丢弃到下一个分隔符
+    int synced;             // 已收到过有效帧
+    unsigned next_seq;      // 期望的下一个序号
+    unsigned long long frames;          // 有效帧数
+    unsigned long long crc_errors;      // 校验失败或 COBS 格式错误的帧数
+    unsigned long long lost;            // 按序号推算的丢帧数
+    unsigned long long overruns;        // 超过 cap 被丢弃的帧数
+    void (*on_frame)(const SerialFrame *frame, void *ctx);
+    void *ctx;
+} SerialFrameDecoder;
+
+
+uint16_t SerialCrc16(const void *data, size_t len);
+uint32_t SerialCrc32(const void *data, size_t len);
+size_t SerialCobsEncode(uint8_t *dst, const uint8_t *src, size_t len);
+long SerialCobsDecode(uint8_t *dst, const uint8_t *src, size_t len);
+
+long SerialFrameEncode(uint8_t *out, size_t cap, int type, unsigned seq, const void *payload, size_t len);
+void SerialFrameEncoderInit(SerialFrameEncoder *enc, int channels, int format, float scale, int crc32);
+long SerialFrameEncodeSamples(SerialFrameEncoder *enc, uint8_t *out, size_t cap, const float *samples, int frames);
+int SerialSendSamples(SerialWriter *writer, SerialFrameEncoder *enc, const float *samples, int frames);
+
+int SerialFrameDecoderInit(SerialFrameDecoder *dec, size_t max_frame,
+                           void (*on_frame)(const SerialFrame *frame, void *ctx), void *ctx);
+void SerialFrameDecoderFree(SerialFrameDecoder *dec);
+int SerialFrameDecode(SerialFrameDecoder *dec, const void *data, size_t len);
+int SerialFrameSamples(const SerialFrame *frame, float *samples, int max_values, int *channels);
+
+
+#endif /* Serial Frame */
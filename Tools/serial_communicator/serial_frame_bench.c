@@ -0,0 +1,226 @@
+// serial_frame_bench.c
+
+/*
+ * 二进制帧与文本格式的对比测试（只在内存中编解码，不需要串口）：
+ * 每种格式报告每个采样的线上字节数、编码 / 解码耗时，以及在 115200 和 921600 波特率下
+ * 每秒能传输的采样数（每字节按 10 位计：1 起始位 + 8 数据位 + 1 停止位）。
+ *
+ * 用法: serial_frame_bench [channels=16] [frames=8]
+ *     channels  通道数
+ *     frames    每个数据包的采样帧数（文本格式为每行的采样数 / channels）
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "serial_format.h"
+#include "serial_frame.h"
+#include "serial_pack.h"
+#include "serial_parse.h"
+
+#define BENCH_SAMPLES   (1 << 21)   // 每种格式编码的采样总数
+#define BENCH_REPEAT    5
+
+static double BenchSeconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double)t.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+typedef struct {
+    const char *name;
+    int format;             // SERIAL_SAMPLE_*, -1 为文本 (strtof 解码), -2 为文本 (serial_parse 解码)
+    int crc32;
+} BenchCase;
+
+static float *bench_out;
+static size_t bench_pos;
+
+static void BenchOnFrame(const SerialFrame *frame, void *ctx) {
+    int n = SerialFrameSamples(frame, bench_out + bench_pos, BENCH_SAMPLES, NULL);
+    (void)ctx;
+    if (n > 0) {
+        bench_pos += (size_t)n * (size_t)frame->payload[0];
+    }
+}
+
+// 文本: "ch=v0,v1,...\r\n", 每行 frames * channels 个采样
+static size_t BenchTextEncode(uint8_t *out, const float *samples, size_t count, int per_line) {
+    char *p = (char *)out;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (i % (size_t)per_line == 0) {
+            memcpy(p, "ch=", 3);
+            p += 3;
+        }
+        p = SerialFormatFloat(p, samples[i]);
+        if ((i + 1) % (size_t)per_line == 0 || i + 1 == count) {
+            *p++ = '\r';
+            *p++ = '\n';
+        }
+        else {
+            *p++ = ',';
+        }
+    }
+    return (size_t)(p - (char *)out);
+}
+
+static size_t BenchTextDecode(const uint8_t *in, size_t len, float *samples) {
+    const char *p = (const char *)in;
+    const char *end = p + len;
+    char *next;
+    size_t n = 0;
+
+    while (p < end) {
+        p = memchr(p, '=', (size_t)(end - p));
+        if (p == NULL) {
+            break;
+        }
+        p++;
+        for (;;) {
+            samples[n++] = strtof(p, &next);
+            p = next;
+            if (*p != ',') {
+                break;
+            }
+            p++;
+        }
+        p += 2;
+    }
+    return n;
+}
+
+// 文本, 用 SerialParseLines 解码, 批满时取出数值后继续
+static size_t BenchTextParse(const uint8_t *in, size_t len, float *samples) {
+    static SerialValue values[4096];
+    SerialValueBatch batch = { values, 4096, 0 };
+    SerialParser parser;
+    size_t used = 0, n = 0;
+    int i;
+
+    SerialParserInit(&parser);
+    while (used < len) {
+        used += SerialParseLines(&parser, (const char *)in + used, len - used, &batch);
+        if (batch.count == 0) {
+            break;
+        }
+        for (i = 0; i < batch.count; i++) {
+            samples[n++] = values[i].type == SERIAL_VALUE_FLOAT ? (float)values[i].value.f : (float)values[i].value.i;
+        }
+        batch.count = 0;
+    }
+    return n;
+}
+
+int main(int argc, char **argv) {
+
+    const BenchCase cases[] = {
+        { "text (shortest float)", -1, 0 },
+        { "text + serial_parse", -2, 0 },
+        { "frame f32 + crc16", SERIAL_SAMPLE_F32, 0 },
+        { "frame f32 + crc32", SERIAL_SAMPLE_F32, 1 },
+        { "frame i16 + crc16", SERIAL_SAMPLE_I16, 0 },
+        { "frame i32 + crc32", SERIAL_SAMPLE_I32, 1 },
+        { "frame packed + crc16", SERIAL_SAMPLE_PACKED, 0 },
+    };
+    const int channels = argc > 1 ? atoi(argv[1]) : 16;
+    const int frames = argc > 2 ? atoi(argv[2]) : 8;
+    const size_t per_packet = (size_t)channels * (size_t)frames;
+    const size_t count = BENCH_SAMPLES / per_packet * per_packet;
+    float *samples, *decoded;
+    uint8_t *wire;
+    size_t wire_cap, wire_len = 0, n, i;
+    double t0, enc_s, dec_s, bytes_per_sample, err;
+    int c, r;
+
+    if (channels < 1 || channels > 255 || frames < 1 || count == 0) {
+        fprintf(stderr, "usage: %s [channels 1..255] [frames]\n", argv[0]);
+        return 1;
+    }
+
+    samples = (float *)malloc(count * sizeof(float));
+    decoded = (float *)malloc(count * sizeof(float));
+    wire_cap = count * 16 + count / per_packet * SERIAL_FRAME_BOUND(SERIAL_SAMPLE_HEADER);
+    wire = (uint8_t *)malloc(wire_cap);
+    if (samples == NULL || decoded == NULL || wire == NULL) {
+        return 1;
+    }
+    bench_out = decoded;
+
+    // 滤波后的多通道正弦 + 噪声, 幅度约 +-10
+    srand(1);
+    for (i = 0; i < count; i++) {
+        const size_t ch = i % (size_t)channels, t = i / (size_t)channels;
+        samples[i] = 8.0f * sinf(0.01f * (float)t * (float)(ch + 1)) + 0.01f * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    printf("%d channels, %d sample frames per packet, %zu samples\n", channels, frames, count);
+    printf("%-24s %10s %10s %10s %12s %12s %10s\n", "format", "B/sample", "enc ns/s", "dec ns/s",
+           "@115200 S/s", "@921600 S/s", "max err");
+
+    for (c = 0; c < (int)(sizeof(cases) / sizeof(cases[0])); c++) {
+        SerialFrameEncoder enc;
+        SerialFrameDecoder dec;
+
+        enc_s = dec_s = 1e30;
+        for (r = 0; r < BENCH_REPEAT; r++) {
+            t0 = BenchSeconds();
+            if (cases[c].format < 0) {
+                wire_len = BenchTextEncode(wire, samples, count, (int)per_packet);
+            }
+            else {
+                SerialFrameEncoderInit(&enc, channels, cases[c].format, cases[c].format == SERIAL_SAMPLE_I32 ? 1e-6f : 1e-3f, cases[c].crc32);
+                for (wire_len = 0, n = 0; n < count; n += per_packet) {
+                    wire_len += (size_t)SerialFrameEncodeSamples(&enc, wire + wire_len, wire_cap - wire_len, samples + n, frames);
+                }
+            }
+            t0 = BenchSeconds() - t0;
+            enc_s = t0 < enc_s ? t0 : enc_s;
+
+            t0 = BenchSeconds();
+            if (cases[c].format == -1) {
+                bench_pos = BenchTextDecode(wire, wire_len, decoded);
+            }
+            else if (cases[c].format == -2) {
+                bench_pos = BenchTextParse(wire, wire_len, decoded);
+            }
+            else {
+                bench_pos = 0;
+                SerialFrameDecoderInit(&dec, SERIAL_SAMPLE_HEADER + SerialPackBound(channels, frames), BenchOnFrame, NULL);
+                SerialFrameDecode(&dec, wire, wire_len);
+                SerialFrameDecoderFree(&dec);
+            }
+            t0 = BenchSeconds() - t0;
+            dec_s = t0 < dec_s ? t0 : dec_s;
+        }
+
+        for (err = 0.0, i = 0; i < count && bench_pos == count; i++) {
+            const double d = fabs((double)decoded[i] - (double)samples[i]);
+            err = d > err ? d : err;
+        }
+        bytes_per_sample = (double)wire_len / (double)count;
+        printf("%-24s %10.2f %10.1f %10.1f %12.0f %12.0f %10.2g%s\n", cases[c].name, bytes_per_sample,
+               enc_s / (double)count * 1e9, dec_s / (double)count * 1e9,
+               115200.0 / 10.0 / bytes_per_sample, 921600.0 / 10.0 / bytes_per_sample, err,
+               bench_pos == count ? "" : "  DECODE MISMATCH");
+    }
+
+    free(samples);
+    free(decoded);
+    free(wire);
+    return 0;
+}
@@ -0,0 +1,314 @@
+// serial_frame_test.c
+
+/*
+ * serial_frame 的自动测试（ctest），只在内存中编解码，不需要串口：
+ *     CRC-16 / CRC-32 的标准校验值，以及与逐位计算结果的比较（各种长度和起始对齐）
+ *     COBS 编解码往返（254 字节分块边界、全 0、无 0、原地解码）和格式错误的输入
+ *     帧编解码往返（任意切分的输入），翻转每一位、插入分隔符、截断和超长帧时
+ *     错误帧被丢弃并计数，下一帧照常解码，丢帧数按序号统计
+ *     采样帧 F32 / I16 / I32 往返
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "serial_frame.h"
+#include "serial_test.h"
+
+#define TEST_MAX_PAYLOAD    600
+#define TEST_FRAMES         32
+
+static uint32_t test_state = 12345;
+
+static uint32_t TestRandom(void) {
+    test_state = test_state * 1664525u + 1013904223u;
+    return test_state >> 8;
+}
+
+// 逐位计算的参考值
+static uint16_t TestCrc16(const uint8_t *p, size_t len) {
+
+    uint16_t crc = 0xFFFFu;
+    int k;
+
+    while (len--) {
+        crc ^= (uint16_t)(*p++ << 8);
+        for (k = 0; k < 8; k++) {
+            crc = crc & 0x8000u ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t TestCrc32(const uint8_t *p, size_t len) {
+
+    uint32_t crc = 0xFFFFFFFFu;
+    int k;
+
+    while (len--) {
+        crc ^= *p++;
+        for (k = 0; k < 8; k++) {
+            crc = crc & 1u ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+static void TestCrc(void) {
+
+    uint8_t data[80];
+    size_t len, off;
+
+    SERIAL_CHECK(SerialCrc16("123456789", 9) == 0x29B1);
+    SERIAL_CHECK(SerialCrc32("123456789", 9) == 0xCBF43926u);
+    SERIAL_CHECK(SerialCrc16(data, 0) == 0xFFFFu);
+    SERIAL_CHECK(SerialCrc32(data, 0) == 0);
+
+    for (len = 0; len < sizeof(data); len++) {
+        data[len] = (uint8_t)TestRandom();
+    }
+    for (off = 0; off < 8; off++) {
+        for (len = 0; len + off <= 64; len++) {
+            SERIAL_CHECK(SerialCrc16(data + off, len) == TestCrc16(data + off, len));
+            SERIAL_CHECK(SerialCrc32(data + off, len) == TestCrc32(data + off, len));
+        }
+    }
+}
+
+// 编码后不含 0x00, 长度不超过 len + len / 254 + 1, 解码 (原地) 得到原数据
+static void TestCobsRoundTrip(const uint8_t *src, size_t len) {
+
+    static uint8_t enc[TEST_MAX_PAYLOAD * 2];
+    size_t n = SerialCobsEncode(enc, src, len);
+
+    SERIAL_CHECK(n <= len + len / 254 + 1);
+    SERIAL_CHECK(memchr(enc, 0, n) == NULL);
+    if (SerialCobsDecode(enc, enc, n) != (long)len || memcmp(enc, src, len) != 0) {
+        printf("cobs round trip fail, len %u\r\n", (unsigned)len);
+        serial_test_failures++;
+    }
+}
+
+static void TestCobs(void) {
+
+    static const uint8_t code_zero[] = { 0x03, 0x11, 0x00, 0x22 };
+    static const uint8_t code_long[] = { 0x05, 0x11, 0x22 };
+    static const uint8_t code_tail[] = { 0x02, 0x11, 0x04, 0x22 };
+    uint8_t src[TEST_MAX_PAYLOAD], out[16];
+    size_t len, i;
+
+    for (len = 0; len < TEST_MAX_PAYLOAD; len++) {
+        // 全 0
+        memset(src, 0, len);
+        TestCobsRoundTrip(src, len);
+        // 无 0 (覆盖 253 / 254 / 255 / 508 等分块边界)
+        for (i = 0; i < len; i++) {
+            src[i] = (uint8_t)(i % 255 + 1);
+        }
+        TestCobsRoundTrip(src, len);
+        // 随机, 约 1/8 为 0
+        for (i = 0; i < len; i++) {
+            src[i] = TestRandom() % 8 == 0 ? 0 : (uint8_t)(TestRandom() | 1);
+        }
+        TestCobsRoundTrip(src, len);
+    }
+
+    // 码字为 0, 码字超出剩余长度
+    SERIAL_CHECK(SerialCobsDecode(out, code_zero, sizeof(code_zero)) == -1);
+    SERIAL_CHECK(SerialCobsDecode(out, code_long, sizeof(code_long)) == -1);
+    SERIAL_CHECK(SerialCobsDecode(out, code_tail, sizeof(code_tail)) == -1);
+    SERIAL_CHECK(SerialCobsDecode(out, code_tail, 0) == 0);
+}
+
+// 收到的帧
+typedef struct {
+    int frames;
+    unsigned seq[TEST_FRAMES * 2];
+    size_t len[TEST_FRAMES * 2];
+    uint8_t payload[TEST_FRAMES * 2][TEST_MAX_PAYLOAD];
+} TestReceived;
+
+static void TestOnFrame(const SerialFrame *frame, void *ctx) {
+
+    TestReceived *rx = (TestReceived *)ctx;
+
+    if (rx->frames < TEST_FRAMES * 2 && frame->len <= TEST_MAX_PAYLOAD) {
+        rx->seq[rx->frames] = frame->seq;
+        rx->len[rx->frames] = frame->len;
+        memcpy(rx->payload[rx->frames], frame->payload, frame->len);
+    }
+    rx->frames++;
+}
+
+// TEST_FRAMES 帧, 长度 0 ~ 299, 以任意大小切分输入, 全部按序收到
+static void TestFrameStream(int crc32) {
+
+    static uint8_t payload[TEST_FRAMES][TEST_MAX_PAYLOAD];
+    static uint8_t stream[TEST_FRAMES * SERIAL_FRAME_BOUND(TEST_MAX_PAYLOAD)];
+    static TestReceived rx;
+    const int type = SERIAL_FRAME_DATA | (crc32 ? SERIAL_FRAME_CRC32 : 0);
+    SerialFrameDecoder dec;
+    size_t len[TEST_FRAMES], pos = 0, chunk, i;
+    long n;
+    int f;
+
+    for (f = 0; f < TEST_FRAMES; f++) {
+        len[f] = TestRandom() % 300;
+        for (i = 0; i < len[f]; i++) {
+            payload[f][i] = (uint8_t)TestRandom();
+        }
+        n = SerialFrameEncode(stream + pos, sizeof(stream) - pos, type, 65530u + (unsigned)f, payload[f], len[f]);
+        SERIAL_CHECK(n > 0 && (size_t)n <= SERIAL_FRAME_BOUND(len[f]));
+        pos += (size_t)n;
+    }
+
+    memset(&rx, 0, sizeof(rx));
+    SERIAL_CHECK(SerialFrameDecoderInit(&dec, TEST_MAX_PAYLOAD, TestOnFrame, &rx) == 0);
+    for (i = 0; i < pos; i += chunk) {
+        chunk = 1 + TestRandom() % 64;
+        chunk = chunk < pos - i ? chunk : pos - i;
+        SerialFrameDecode(&dec, stream + i, chunk);
+    }
+    SERIAL_CHECK(rx.frames == TEST_FRAMES);
+    SERIAL_CHECK(dec.frames == TEST_FRAMES && dec.crc_errors == 0 && dec.lost == 0 && dec.overruns == 0);
+    for (f = 0; f < TEST_FRAMES && f < rx.frames; f++) {
+        SERIAL_CHECK(rx.seq[f] == ((65530u + (unsigned)f) & 0xffffu));
+        SERIAL_CHECK(rx.len[f] == len[f] && memcmp(rx.payload[f], payload[f], len[f]) == 0);
+    }
+    SerialFrameDecoderFree(&dec);
+}
+
+// 第二帧损坏: 不被分发, 计入 crc_errors, 第三帧照常收到并把第二帧计为丢失
+static void TestCorrupted(int crc32) {
+
+    static TestReceived rx;
+    const int type = SERIAL_FRAME_DATA | (crc32 ? SERIAL_FRAME_CRC32 : 0);
+    uint8_t payload[40], frame[3][SERIAL_FRAME_BOUND(40)], bad[SERIAL_FRAME_BOUND(40) + 1];
+    SerialFrameDecoder dec;
+    long len[3];
+    int f, i, bit, dispatched;
+
+    for (i = 0; i < (int)sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7 % 5);  // 含 0
+    }
+    for (f = 0; f < 3; f++) {
+        len[f] = SerialFrameEncode(frame[f], sizeof(frame[f]), type, (unsigned)f, payload, sizeof(payload));
+    }
+    SERIAL_CHECK(SerialFrameDecoderInit(&dec, sizeof(payload), TestOnFrame, &rx) == 0);
+
+    // 翻转第二帧 (不含分隔符) 的每一位
+    for (i = 0; i < len[1] - 1; i++) {
+        for (bit = 0; bit < 8; bit++) {
+            memset(&rx, 0, sizeof(rx));
+            dec.synced = 0;
+            dec.crc_errors = dec.lost = 0;
+            memcpy(bad, frame[1], (size_t)len[1]);
+            bad[i] ^= (uint8_t)(1u << bit);
+            SerialFrameDecode(&dec, frame[0], (size_t)len[0]);
+            SerialFrameDecode(&dec, bad, (size_t)len[1]);
+            dispatched = rx.frames;
+            SerialFrameDecode(&dec, frame[2], (size_t)len[2]);
+            if (dispatched != 1 || rx.frames != 2 || dec.crc_errors == 0 || dec.lost != 1
+                || rx.seq[1] != 2 || memcmp(rx.payload[1], payload, sizeof(payload)) != 0) {
+                printf("bit %d of byte %d not detected (crc32 %d)\r\n", bit, i, crc32);
+                serial_test_failures++;
+            }
+        }
+    }
+
+    // 帧中间插入分隔符: 两段都不是有效帧
+    memset(&rx, 0, sizeof(rx));
+    dec.crc_errors = 0;
+    memcpy(bad, frame[1], 10);
+    bad[10] = 0;
+    memcpy(bad + 11, frame[1] + 10, (size_t)len[1] - 10);
+    SerialFrameDecode(&dec, bad, (size_t)len[1] + 1);
+    SerialFrameDecode(&dec, frame[2], (size_t)len[2]);
+    SERIAL_CHECK(rx.frames == 1 && rx.seq[0] == 2 && dec.crc_errors == 2);
+
+    // 截断 (丢失最后几个字节): 不是有效帧
+    memset(&rx, 0, sizeof(rx));
+    dec.crc_errors = 0;
+    memcpy(bad, frame[1], (size_t)len[1]);
+    bad[len[1] - 4] = 0;
+    SerialFrameDecode(&dec, bad, (size_t)len[1] - 3);
+    SerialFrameDecode(&dec, frame[2], (size_t)len[2]);
+    SERIAL_CHECK(rx.frames == 1 && rx.seq[0] == 2 && dec.crc_errors == 1);
+
+    // 只有帧头, 空帧 (连续分隔符) 被忽略
+    memset(&rx, 0, sizeof(rx));
+    dec.crc_errors = 0;
+    SerialFrameDecode(&dec, "\x02\x01\x00\x00\x00", 5);
+    SERIAL_CHECK(rx.frames == 0 && dec.crc_errors == 1);
+    SerialFrameDecoderFree(&dec);
+
+    // 超过 max_frame 的帧被丢弃到下一个分隔符
+    memset(&rx, 0, sizeof(rx));
+    SERIAL_CHECK(SerialFrameDecoderInit(&dec, sizeof(payload) / 2, TestOnFrame, &rx) == 0);
+    SerialFrameDecode(&dec, frame[0], (size_t)len[0]);
+    SERIAL_CHECK(rx.frames == 0 && dec.overruns == 1);
+    len[0] = SerialFrameEncode(frame[0], sizeof(frame[0]), type, 7, payload, sizeof(payload) / 2);
+    SerialFrameDecode(&dec, frame[0], (size_t)len[0]);
+    SERIAL_CHECK(rx.frames == 1 && rx.seq[0] == 7);
+    SerialFrameDecoderFree(&dec);
+}
+
+static float test_samples[16 * 8];
+static float test_decoded[16 * 8];
+static int test_decoded_frames;
+
+static void TestOnSamples(const SerialFrame *frame, void *ctx) {
+    int channels;
+    (void)ctx;
+    test_decoded_frames = SerialFrameSamples(frame, test_decoded, 16 * 8, &channels);
+    if (channels != 16) {
+        test_decoded_frames = -1;
+    }
+}
+
+static void TestSamples(void) {
+
+    static const int formats[3] = { SERIAL_SAMPLE_F32, SERIAL_SAMPLE_I16, SERIAL_SAMPLE_I32 };
+    uint8_t out[SERIAL_FRAME_BOUND(SERIAL_SAMPLE_HEADER + 16 * 8 * 4)];
+    SerialFrameEncoder enc;
+    SerialFrameDecoder dec;
+    float err;
+    long n;
+    int f, i;
+
+    for (i = 0; i < 16 * 8; i++) {
+        test_samples[i] = (float)((int)(TestRandom() % 20001) - 10000) * 0.001f;
+    }
+    for (f = 0; f < 3; f++) {
+        SerialFrameEncoderInit(&enc, 16, formats[f], 0.001f, f == 1);
+        SERIAL_CHECK(SerialFrameDecoderInit(&dec, SERIAL_SAMPLE_HEADER + 16 * 8 * 4, TestOnSamples, NULL) == 0);
+        n = SerialFrameEncodeSamples(&enc, out, sizeof(out), test_samples, 8);
+        SERIAL_CHECK(n > 0);
+        test_decoded_frames = 0;
+        SerialFrameDecode(&dec, out, (size_t)n);
+        SERIAL_CHECK(test_decoded_frames == 8);
+        // F32 精确还原, 整数格式误差不超过半个 LSB
+        for (i = 0; i < 16 * 8; i++) {
+            err = fabsf(test_decoded[i] - test_samples[i]);
+            SERIAL_CHECK(formats[f] == SERIAL_SAMPLE_F32 ? err == 0 : err <= 0.0005f + 1e-6f);
+        }
+        SERIAL_CHECK(enc.seq == 1);
+        SerialFrameDecoderFree(&dec);
+    }
+    // 空间不足
+    SERIAL_CHECK(SerialFrameEncodeSamples(&enc, out, 16, test_samples, 8) == -1);
+}
+
+int main(void) {
+
+    TestCrc();
+    TestCobs();
+    TestFrameStream(0);
+    TestFrameStream(1);
+    TestCorrupted(0);
+    TestCorrupted(1);
+    TestSamples();
+    return SERIAL_TEST_RESULT;
+}
@@ -0,0 +1,521 @@
+// serial_loopback_bench.c
+
+/*
+ * 串口回环测试（POSIX）：测量各发送方式的吞吐量和往返延迟。
+ * 默认用 pty 对：本端用 OpenSerial 打开从端，另一个线程在主端把收到的数据原样写回（相当于对端设备回显）。
+ * 也可以用真实串口：给出 port 和 peer 时在 peer 上回显（两个串口用交叉线相连），
+ * 只给出 port 时认为 TX 和 RX 已经短接。
+ *
+ * 每条消息是一行 "发送时刻(ns),序号,填充...\n"，收到回显后用当前时刻减去发送时刻得到往返延迟。
+ * 发送方式：
+ *     direct   SendMessageToSerial（comHandle，同步写）
+ *     writer   SerialWriterSend（serial_writer.h，后台写线程）
+ *     ports    SerialPortsSend（serial_ports.h，epoll 事件循环）
+ *     uring    SerialPortsSend（serial_ports.h，io_uring 事件循环）
+ * direct 和 writer 由 serial_reader.h 在另一个线程接收，ports 和 uring 在同一个事件循环中收发。
+ *
+ * 每种方式输出一行 JSON（字段见 BenchPrint），延迟直方图按 2 的幂分段、每段 16 格（误差约 6%）。
+ *
+ * 用法: serial_loopback_bench [path=all] [size=64] [rate=0] [seconds=2] [port=pty] [peer] [baud=115200]
+ *     path     all / direct / writer / ports / uring
+ *     size     每条消息的字节数（含 '\n'，48..4096）
+ *     rate     每秒发送的消息数，0 为尽快发送
+ *     seconds  每种方式的发送时长
+ *     port     串口设备路径，pty 为使用 pty 对
+ *     peer     回显端串口设备路径
+ *     baud     真实串口的波特率
+ *
+ * 示例：
+ * ./serial_loopback_bench all 64 10000 5
+ * ./serial_loopback_bench writer 256 0 2 /dev/ttyUSB0 /dev/ttyUSB1 921600
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "serial_communicator.h"
+#include "serial_writer.h"
+#include "serial_format.h"
+#include "serial_reader.h"
+#include "serial_ports.h"
+
+#define BENCH_MIN_SIZE      48      // 两个 20 位十进制数, 两个 ',' 和 '\n'
+#define BENCH_MAX_SIZE      4096
+#define BENCH_HIST_SUB      16      // 每个 2 的幂分段的格数
+#define BENCH_DRAIN_NS      2000000000ULL   // 停止发送后等待回显的最长时间
+
+enum { BENCH_DIRECT, BENCH_WRITER, BENCH_PORTS, BENCH_URING, BENCH_PATHS };
+
+static const char *const bench_paths[BENCH_PATHS] = { "direct", "writer", "ports", "uring" };
+
+// 往返延迟直方图 (ns)
+typedef struct {
+    unsigned long long counts[64 * BENCH_HIST_SUB];
+    unsigned long long n;
+    unsigned long long min;
+    unsigned long long max;
+} BenchHistogram;
+
+typedef struct {
+    int path;
+    size_t size;
+    double rate;
+    double seconds;
+    const char *device;
+    SerialHandle handle;
+    unsigned long long start;       // 本轮开始时刻, 更早的回显来自上一轮
+    unsigned long long sent;
+    unsigned long long received;
+    unsigned long long last;        // 最后一次收到回显的时刻
+    int stop;                       // __atomic, 由主线程设置
+    int ready;                      // 接收线程已就绪 (1) 或打开失败 (-1), 由 lock / cond 保护
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    BenchHistogram hist;
+} BenchRun;
+
+typedef struct {
+    SerialHandle fd;
+    int stop;                       // __atomic, 由主线程设置
+} BenchEcho;
+
+static unsigned long long BenchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static void BenchSleepUntil(unsigned long long t) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(t / 1000000000ULL);
+    ts.tv_nsec = (long)(t % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static int BenchBucket(unsigned long long v) {
+    int e;
+
+    if (v < BENCH_HIST_SUB) {
+        return (int)v;
+    }
+    e = 63 - __builtin_clzll(v);
+    return (e - 3) * BENCH_HIST_SUB + (int)((v >> (e - 4)) & (BENCH_HIST_SUB - 1));
+}
+
+// 格的上界 (含)
+static unsigned long long BenchBucketUpper(int idx) {
+    const int e = idx / BENCH_HIST_SUB + 3;
+
+    if (idx < BENCH_HIST_SUB) {
+        return (unsigned long long)idx;
+    }
+    return ((unsigned long long)(BENCH_HIST_SUB + idx % BENCH_HIST_SUB + 1) << (e - 4)) - 1;
+}
+
+static void BenchRecord(BenchHistogram *h, unsigned long long v) {
+    h->counts[BenchBucket(v)]++;
+    if (h->n == 0 || v < h->min) {
+        h->min = v;
+    }
+    if (v > h->max) {
+        h->max = v;
+    }
+    h->n++;
+}
+
+static unsigned long long BenchPercentile(const BenchHistogram *h, double q) {
+    const unsigned long long rank = (unsigned long long)(q * (double)h->n);
+    unsigned long long seen = 0, upper;
+    int i;
+
+    for (i = 0; i < 64 * BENCH_HIST_SUB; i++) {
+        seen += h->counts[i];
+        if (seen > rank) {
+            upper = BenchBucketUpper(i);
+            return upper < h->max ? upper : h->max;
+        }
+    }
+    return h->max;
+}
+
+// "发送时刻,序号,xxx...\n" 共 size 字节, 后跟 '\0' 供 SendMessageToSerial 使用
+static size_t BenchMessage(char *msg, size_t size, unsigned long long ts, unsigned long long seq) {
+    char *p = SerialFormatUint(msg, ts);
+
+    *p++ = ',';
+    p = SerialFormatUint(p, seq);
+    *p++ = ',';
+    memset(p, 'x', size - 1 - (size_t)(p - msg));
+    msg[size - 1] = '\n';
+    msg[size] = '\0';
+    return size;
+}
+
+static int BenchParse(const SerialView *view, unsigned long long *ts, unsigned long long *seq) {
+    const char *p = view->data, *end = view->data + view->len;
+    unsigned long long v[2] = { 0, 0 };
+    int i;
+
+    for (i = 0; i < 2; i++, p++) {
+        if (p >= end || *p < '0' || *p > '9') {
+            return -1;
+        }
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            v[i] = v[i] * 10 + (unsigned long long)(*p - '0');
+        }
+        if (p >= end || *p != ',') {
+            return -1;
+        }
+    }
+    *ts = v[0];
+    *seq = v[1];
+    return 0;
+}
+
+static void BenchOnEcho(const SerialView *view, void *ctx) {
+
+    BenchRun *run = (BenchRun *)ctx;
+    unsigned long long ts, seq, now = BenchNow();
+
+    // 上一轮残留的回显或被截断的行
+    if (BenchParse(view, &ts, &seq) != 0 || ts < run->start || ts > now || view->len + 1 != run->size) {
+        return;
+    }
+    BenchRecord(&run->hist, now - ts);
+    __atomic_store_n(&run->last, now, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&run->received, 1, __ATOMIC_RELEASE);
+}
+
+static void BenchOnPortEcho(int port, const SerialView *view, void *ctx) {
+    (void)port;
+    BenchOnEcho(view, ctx);
+}
+
+// 对端: 把收到的数据原样写回
+static void *BenchEchoThread(void *arg) {
+
+    BenchEcho *echo = (BenchEcho *)arg;
+    struct pollfd pfd;
+    char buf[65536];
+    long n, w, off;
+
+    pfd.fd = echo->fd;
+    pfd.events = POLLIN;
+    while (!__atomic_load_n(&echo->stop, __ATOMIC_ACQUIRE)) {
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        n = read(echo->fd, buf, sizeof(buf));
+        for (off = 0; n > 0 && off < n && !__atomic_load_n(&echo->stop, __ATOMIC_ACQUIRE); off += w) {
+            w = SerialWrite(echo->fd, buf + off, (size_t)(n - off));
+            if (w < 0) {
+                return NULL;
+            }
+            if (w == 0) {
+                SerialWaitWritable(echo->fd, 50);
+            }
+        }
+    }
+    return NULL;
+}
+
+// 关闭对端: pty 主设备直接 close, 真实串口用 CloseSerial
+static void BenchCloseEcho(BenchEcho *echo, int use_pty) {
+    if (echo->fd == SERIAL_INVALID_HANDLE) {
+        return;
+    }
+    if (use_pty) {
+        close(echo->fd);
+    }
+    else {
+        CloseSerialQuiet(echo->fd);
+    }
+    echo->fd = SERIAL_INVALID_HANDLE;
+}
+
+static void BenchSetReady(BenchRun *run, int ready) {
+    pthread_mutex_lock(&run->lock);
+    run->ready = ready;
+    pthread_cond_signal(&run->cond);
+    pthread_mutex_unlock(&run->lock);
+}
+
+static void *BenchReaderThread(void *arg) {
+
+    BenchRun *run = (BenchRun *)arg;
+    SerialReaderConfig config;
+    SerialReader *reader;
+
+    memset(&config, 0, sizeof(config));
+    config.delimiter = SERIAL_SPLIT_LINE;
+    config.on_record = BenchOnEcho;
+    config.ctx = run;
+    reader = OpenSerialReader(run->handle, &config);
+    // 第一次 SerialReaderPoll 把句柄加入 epoll, 之后才通知发送端开始
+    if (reader == NULL || SerialReaderPoll(reader, 0) < 0) {
+        CloseSerialReader(reader);
+        BenchSetReady(run, -1);
+        return NULL;
+    }
+    BenchSetReady(run, 1);
+    while (!__atomic_load_n(&run->stop, __ATOMIC_ACQUIRE)) {
+        if (SerialReaderPoll(reader, 50) < 0) {
+            break;
+        }
+    }
+    CloseSerialReader(reader);
+    return NULL;
+}
+
+// 按 rate 计算第 seq 条消息的发送时刻, 尽快发送时为 0
+static unsigned long long BenchDue(const BenchRun *run, unsigned long long seq) {
+    return run->rate > 0 ? run->start + (unsigned long long)((double)seq * 1e9 / run->rate) : 0;
+}
+
+// direct / writer: 本线程发送, 另一个线程接收
+static int BenchRunThreads(BenchRun *run) {
+
+    SerialWriterConfig config;
+    SerialWriter *writer = NULL;
+    pthread_t reader;
+    char msg[BENCH_MAX_SIZE + 1];
+    unsigned long long due, end, now;
+
+    if (run->path == BENCH_WRITER) {
+        memset(&config, 0, sizeof(config));
+        config.slot_size = (int)run->size;
+        config.policy = SERIAL_BLOCK;
+        writer = OpenSerialWriter(run->handle, &config);
+        if (writer == NULL) {
+            return -1;
+        }
+    }
+    comHandle = run->handle;
+    run->ready = 0;
+    if (pthread_create(&reader, NULL, BenchReaderThread, run) != 0) {
+        CloseSerialWriter(writer);
+        return -1;
+    }
+    // 等待接收线程把句柄设为非阻塞并加入 epoll
+    pthread_mutex_lock(&run->lock);
+    while (run->ready == 0) {
+        pthread_cond_wait(&run->cond, &run->lock);
+    }
+    pthread_mutex_unlock(&run->lock);
+    if (run->ready < 0) {
+        pthread_join(reader, NULL);
+        CloseSerialWriter(writer);
+        return -1;
+    }
+
+    run->start = BenchNow();
+    end = run->start + (unsigned long long)(run->seconds * 1e9);
+    while ((now = BenchNow()) < end) {
+        due = BenchDue(run, run->sent);
+        if (due > now) {
+            BenchSleepUntil(due);
+        }
+        BenchMessage(msg, run->size, BenchNow(), run->sent);
+        if (writer != NULL) {
+            SerialWriterSend(writer, msg, run->size);
+        }
+        else {
+            SendMessageToSerial(msg);
+        }
+        run->sent++;
+    }
+    if (writer != NULL) {
+        SerialWriterFlush(writer);
+    }
+
+    end = BenchNow() + BENCH_DRAIN_NS;
+    while (__atomic_load_n(&run->received, __ATOMIC_ACQUIRE) < run->sent && BenchNow() < end) {
+        usleep(1000);
+    }
+    __atomic_store_n(&run->stop, 1, __ATOMIC_RELEASE);
+    pthread_join(reader, NULL);
+    CloseSerialWriter(writer);
+    return 0;
+}
+
+// ports / uring: 同一个事件循环中收发
+static int BenchRunPorts(BenchRun *run) {
+
+    SerialPortConfig config;
+    SerialPortStats stats;
+    SerialPorts *ports;
+    char msg[BENCH_MAX_SIZE + 1];
+    unsigned long long due, end, now;
+    int id, timeout;
+
+    ports = OpenSerialPortsBackend(1, run->path == BENCH_URING ? SERIAL_BACKEND_URING : SERIAL_BACKEND_EPOLL);
+    if (ports == NULL) {
+        return -1;
+    }
+    memset(&config, 0, sizeof(config));
+    config.handle = run->handle;
+    config.delimiter = SERIAL_SPLIT_LINE;
+    config.on_record = BenchOnPortEcho;
+    config.ctx = run;
+    id = SerialPortsAdd(ports, &config);
+    if (id < 0) {
+        CloseSerialPorts(ports);
+        return -1;
+    }
+
+    run->start = BenchNow();
+    end = run->start + (unsigned long long)(run->seconds * 1e9);
+    while ((now = BenchNow()) < end) {
+        // 发送到期的消息; 尽快发送时保持发送缓冲区半满
+        while ((due = BenchDue(run, run->sent)) <= now && SerialPortsGetStats(ports, id, &stats) == 0 &&
+               stats.tx_pending < 32768) {
+            BenchMessage(msg, run->size, BenchNow(), run->sent);
+            if (SerialPortsSend(ports, id, msg, run->size) != 0) {
+                break;
+            }
+            run->sent++;
+        }
+        // 等待下一条到期时同时接收; 毫秒精度, 晚到的消息在下一轮补发, 不影响延迟的计算
+        timeout = due > now ? (int)((due - now + 999999) / 1000000) : 0;
+        if (SerialPortsPoll(ports, timeout < 10 ? timeout : 10) < 0) {
+            break;
+        }
+    }
+
+    end = BenchNow() + BENCH_DRAIN_NS;
+    while (run->received < run->sent && BenchNow() < end) {
+        if (SerialPortsPoll(ports, 10) < 0) {
+            break;
+        }
+    }
+    CloseSerialPorts(ports);
+    return 0;
+}
+
+static void BenchPrint(const BenchRun *run) {
+
+    const BenchHistogram *h = &run->hist;
+    const double sec = run->last > run->start ? (double)(run->last - run->start) * 1e-9 : run->seconds;
+    int i, first = 1;
+
+    printf("{\"path\":\"%s\",\"device\":\"%s\",\"size\":%zu,\"rate\":%.0f,\"seconds\":%.3f,"
+           "\"sent\":%llu,\"received\":%llu,\"lost\":%llu,\"mb_per_s\":%.3f,\"msgs_per_s\":%.1f,"
+           "\"rtt_us\":{\"min\":%.1f,\"p50\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f},\"histogram_us\":[",
+           bench_paths[run->path], run->device, run->size, run->rate, sec, run->sent, run->received,
+           run->sent - run->received, (double)(run->received * run->size) / sec * 1e-6, (double)run->received / sec,
+           (double)h->min * 1e-3, (double)BenchPercentile(h, 0.5) * 1e-3, (double)BenchPercentile(h, 0.99) * 1e-3,
+           (double)BenchPercentile(h, 0.999) * 1e-3, (double)h->max * 1e-3);
+    // 非空的格: [上界, 个数]
+    for (i = 0; i < 64 * BENCH_HIST_SUB; i++) {
+        if (h->counts[i] != 0) {
+            printf("%s[%.3f,%llu]", first ? "" : ",", (double)BenchBucketUpper(i) * 1e-3, h->counts[i]);
+            first = 0;
+        }
+    }
+    printf("]}\n");
+    fflush(stdout);
+}
+
+static void BenchUsage(FILE *out, const char *name) {
+    fprintf(out, "usage: %s [all|direct|writer|ports|uring] [size %d..%d] [rate] [seconds] [port|pty] [peer] [baud]\n",
+            name, BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+}
+
+int main(int argc, char **argv) {
+
+    static BenchRun run;
+    BenchEcho echo = { SERIAL_INVALID_HANDLE, 0 };
+    const char *path = argc > 1 ? argv[1] : "all";
+    const char *port = argc > 5 ? argv[5] : "pty";
+    const char *peer = argc > 6 ? argv[6] : NULL;
+    const int baud = argc > 7 ? atoi(argv[7]) : CBR_115200;
+    const int use_pty = strcmp(port, "pty") == 0;
+    pthread_t echo_thread;
+    char name[64];
+    SerialHandle handle;
+    int p, ran = 0;
+
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        BenchUsage(stdout, argv[0]);
+        return 0;
+    }
+    memset(&run, 0, sizeof(run));
+    pthread_mutex_init(&run.lock, NULL);
+    pthread_cond_init(&run.cond, NULL);
+    run.size = argc > 2 ? (size_t)atoi(argv[2]) : 64;
+    run.rate = argc > 3 ? atof(argv[3]) : 0;
+    run.seconds = argc > 4 ? atof(argv[4]) : 2.0;
+    if (run.size < BENCH_MIN_SIZE || run.size > BENCH_MAX_SIZE || run.rate < 0 || run.seconds <= 0) {
+        BenchUsage(stderr, argv[0]);
+        return 1;
+    }
+
+    if (use_pty) {
+        if (OpenVirtualSerial(&echo.fd, name, sizeof(name)) != 0) {
+            return 1;
+        }
+        port = name;
+    }
+    else if (peer != NULL) {
+        echo.fd = OpenSerial(peer, baud, 8, NOPARITY, ONESTOPBIT);
+        if (echo.fd == SERIAL_INVALID_HANDLE) {
+            return 1;
+        }
+    }
+    handle = OpenSerial(port, baud, 8, NOPARITY, ONESTOPBIT);
+    if (handle == SERIAL_INVALID_HANDLE) {
+        BenchCloseEcho(&echo, use_pty);
+        return 1;
+    }
+    if (echo.fd != SERIAL_INVALID_HANDLE) {
+        fcntl(echo.fd, F_SETFL, fcntl(echo.fd, F_GETFL) | O_NONBLOCK);
+        if (pthread_create(&echo_thread, NULL, BenchEchoThread, &echo) != 0) {
+            printf("echo thread create fail\r\n");
+            BenchCloseEcho(&echo, use_pty);
+            CloseSerialQuiet(handle);
+            return 1;
+        }
+    }
+
+    for (p = 0; p < BENCH_PATHS; p++) {
+        if (strcmp(path, "all") != 0 && strcmp(path, bench_paths[p]) != 0) {
+            continue;
+        }
+        run.path = p;
+        run.device = use_pty ? "pty" : port;
+        run.handle = handle;
+        run.sent = run.received = run.last = 0;
+        __atomic_store_n(&run.stop, 0, __ATOMIC_RELEASE);
+        memset(&run.hist, 0, sizeof(run.hist));
+        if ((p == BENCH_PORTS || p == BENCH_URING ? BenchRunPorts(&run) : BenchRunThreads(&run)) == 0) {
+            BenchPrint(&run);
+        }
+        else {
+            fprintf(stderr, "%s: not available\n", bench_paths[p]);
+        }
+        ran++;
+    }
+    if (ran == 0) {
+        fprintf(stderr, "unknown path %s\n", path);
+        BenchUsage(stderr, argv[0]);
+    }
+
+    if (echo.fd != SERIAL_INVALID_HANDLE) {
+        __atomic_store_n(&echo.stop, 1, __ATOMIC_RELEASE);
+        pthread_join(echo_thread, NULL);
+        BenchCloseEcho(&echo, use_pty);
+    }
+    CloseSerialQuiet(handle);
+    return ran > 0 ? 0 : 1;
+}
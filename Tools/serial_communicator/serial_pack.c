@@ -0,0 +1,313 @@
+// serial_pack.c
+
+/*
+ * 采样块压缩：
+ * 滤波后的相邻采样高度相关，传差值比传原值少很多位。每个块（一个采样帧包）独立压缩，
+ * 不依赖前一个块，丢一个包只影响这个包。
+ *
+ * 采样先按 scale 量化为 int32（与 SERIAL_SAMPLE_I32 相同），每个通道在块内选择残差最小的预测阶数：
+ *     0 阶: r = x[t]
+ *     1 阶: r = x[t] - x[t-1]
+ *     2 阶: r = x[t] - 2 x[t-1] + x[t-2]      （线性预测）
+ * 残差做 zigzag 变换（0, -1, 1, -2 ... -> 0, 1, 2, 3 ...）后，
+ * 按该通道残差的最大位数定宽位打包；有个别大残差时改用 varint（每字节 7 位）。
+ *
+ * 块格式：
+ *     每通道 1 字节: 阶数 << 6 | 位宽 (0 ~ 34, 63 表示 varint)
+ *     按通道依次: 第一个采样的 zigzag varint, 之后 frames - 1 个残差（第二个采样最多用 1 阶）
+ * 位流低位在前，块末尾补齐到字节。
+ * 统计和量化按 [帧][通道] 顺序遍历，内层循环在通道上连续，编译器可以向量化。
+ */
+
+#include <string.h>
+#include "serial_pack.h"
+
+#define SERIAL_PACK_VARINT      63
+#define SERIAL_PACK_MAX_CH      255
+
+// 位写入器, 低位在前
+typedef struct {
+    uint8_t *p;
+    uint8_t *end;
+    uint64_t acc;
+    int bits;
+    int overflow;
+} SerialBitWriter;
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    uint64_t acc;
+    int bits;
+    size_t over;            // 读过末尾的字节数
+} SerialBitReader;
+
+static int32_t SerialQuantize(float x, float inv) {
+    float v = x * inv;
+
+    v = v < -2147483648.0f ? -2147483648.0f : v > 2147483520.0f ? 2147483520.0f : v;
+    return (int32_t)(v + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+static uint64_t SerialZigzag(int64_t r) {
+    return ((uint64_t)r << 1) ^ (uint64_t)(r >> 63);
+}
+
+static int64_t SerialUnzigzag(uint64_t z) {
+    return (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+}
+
+static int SerialBitLength(uint64_t v) {
+#if defined(__GNUC__)
+    return v != 0 ? 64 - __builtin_clzll(v) : 0;
+#else
+    int n = 0;
+
+    while (v != 0) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static int SerialVarintBits(uint64_t z) {
+    return (SerialBitLength(z) + 6) / 7 * 8 + (z == 0) * 8;
+}
+
+// 写入 w (<= 32) 位
+static void SerialBitPut(SerialBitWriter *bw, uint64_t v, int w) {
+    bw->acc |= (v & ((1ull << w) - 1)) << bw->bits;
+    bw->bits += w;
+    if (bw->bits >= 32) {
+        if (bw->end - bw->p < 4) {
+            bw->overflow = 1;
+            bw->bits -= 32;
+            bw->acc >>= 32;
+            return;
+        }
+        bw->p[0] = (uint8_t)bw->acc;
+        bw->p[1] = (uint8_t)(bw->acc >> 8);
+        bw->p[2] = (uint8_t)(bw->acc >> 16);
+        bw->p[3] = (uint8_t)(bw->acc >> 24);
+        bw->p += 4;
+        bw->acc >>= 32;
+        bw->bits -= 32;
+    }
+}
+
+static void SerialBitPutWide(SerialBitWriter *bw, uint64_t v, int w) {
+    if (w > 32) {
+        SerialBitPut(bw, v, 32);
+        SerialBitPut(bw, v >> 32, w - 32);
+    }
+    else if (w > 0) {
+        SerialBitPut(bw, v, w);
+    }
+}
+
+static void SerialBitPutVarint(SerialBitWriter *bw, uint64_t z) {
+    while (z >= 0x80u) {
+        SerialBitPut(bw, (z & 0x7fu) | 0x80u, 8);
+        z >>= 7;
+    }
+    SerialBitPut(bw, z, 8);
+}
+
+static long SerialBitFinish(SerialBitWriter *bw, uint8_t *start) {
+    while (bw->bits > 0) {
+        if (bw->p == bw->end) {
+            return -1;
+        }
+        *bw->p++ = (uint8_t)bw->acc;
+        bw->acc >>= 8;
+        bw->bits -= 8;
+    }
+    return bw->overflow ? -1 : (long)(bw->p - start);
+}
+
+// 读取 w (<= 32) 位, 超出末尾的部分按 0 读
+static uint64_t SerialBitGet(SerialBitReader *br, int w) {
+    uint64_t v;
+
+    while (br->bits < 32) {
+        if (br->p < br->end) {
+            br->acc |= (uint64_t)*br->p++ << br->bits;
+        }
+        else {
+            br->over++;
+        }
+        br->bits += 8;
+    }
+    v = br->acc & ((1ull << w) - 1);
+    br->acc >>= w;
+    br->bits -= w;
+    return v;
+}
+
+static uint64_t SerialBitGetWide(SerialBitReader *br, int w) {
+    uint64_t lo;
+
+    if (w > 32) {
+        lo = SerialBitGet(br, 32);
+        return lo | SerialBitGet(br, w - 32) << 32;
+    }
+    return w > 0 ? SerialBitGet(br, w) : 0;
+}
+
+static uint64_t SerialBitGetVarint(SerialBitReader *br) {
+    uint64_t z = 0, b;
+    int shift = 0;
+
+    do {
+        b = SerialBitGet(br, 8);
+        z |= (b & 0x7fu) << shift;
+        shift += 7;
+    } while ((b & 0x80u) && shift < 64);
+    return z;
+}
+
+// 最坏情况的压缩后字节数
+size_t SerialPackBound(int channels, int frames) {
+    return (size_t)channels * (1 + 10) + ((size_t)channels * (size_t)frames * 34 + 7) / 8 + 4;
+}
+
+// 压缩 frames 个采样帧 (samples 按 [帧][通道] 交织), 返回写入 out 的字节数, 空间不足返回 -1
+long SerialPackSamples(uint8_t *out, size_t cap, const float *samples, int channels, int frames, float scale) {
+
+    const float inv = 1.0f / scale;
+    uint64_t any[3][SERIAL_PACK_MAX_CH];
+    int32_t p1[SERIAL_PACK_MAX_CH], p2[SERIAL_PACK_MAX_CH];
+    SerialBitWriter bw;
+    uint64_t vbits;
+    int64_t r;
+    int32_t q, q1, q2;
+    int t, c, o, order, width, w;
+
+    if (channels < 1 || channels > SERIAL_PACK_MAX_CH || frames < 1 || cap < (size_t)channels) {
+        return -1;
+    }
+
+    // 统计各阶残差的位宽 (zigzag 后按位或)
+    memset(any, 0, sizeof(any));
+    for (c = 0; c < channels; c++) {
+        p1[c] = SerialQuantize(samples[c], inv);
+    }
+    if (frames > 1) {
+        for (c = 0; c < channels; c++) {
+            q = SerialQuantize(samples[channels + c], inv);
+            any[0][c] |= SerialZigzag(q);
+            any[1][c] |= any[2][c] |= SerialZigzag((int64_t)q - p1[c]);
+            p2[c] = p1[c];
+            p1[c] = q;
+        }
+    }
+    for (t = 2; t < frames; t++) {
+        const float *x = samples + (size_t)t * (size_t)channels;
+        for (c = 0; c < channels; c++) {
+            const int64_t d = (int64_t)(q = SerialQuantize(x[c], inv)) - p1[c];
+            any[0][c] |= SerialZigzag(q);
+            any[1][c] |= SerialZigzag(d);
+            any[2][c] |= SerialZigzag(d - ((int64_t)p1[c] - p2[c]));
+            p2[c] = p1[c];
+            p1[c] = q;
+        }
+    }
+
+    bw.p = out + channels;
+    bw.end = out + cap;
+    bw.acc = 0;
+    bw.bits = 0;
+    bw.overflow = 0;
+
+    for (c = 0; c < channels; c++) {
+        // 位宽相同时选低阶
+        order = 0;
+        width = SerialBitLength(any[0][c]);
+        for (o = 1; o < 3; o++) {
+            w = SerialBitLength(any[o][c]);
+            if (w < width) {
+                width = w;
+                order = o;
+            }
+        }
+
+        // 个别大残差把位宽撑大时改用 varint
+        vbits = 0;
+        if (width > 8 && frames > 1) {
+            q1 = SerialQuantize(samples[c], inv);
+            q2 = q1;
+            for (t = 1; t < frames; t++) {
+                q = SerialQuantize(samples[(size_t)t * (size_t)channels + c], inv);
+                r = order == 0 ? q : order == 1 || t == 1 ? (int64_t)q - q1 : (int64_t)q - 2 * (int64_t)q1 + q2;
+                vbits += (uint64_t)SerialVarintBits(SerialZigzag(r));
+                q2 = q1;
+                q1 = q;
+            }
+            if (vbits < (uint64_t)width * (uint64_t)(frames - 1)) {
+                width = SERIAL_PACK_VARINT;
+            }
+        }
+        out[c] = (uint8_t)(order << 6 | width);
+
+        q1 = SerialQuantize(samples[c], inv);
+        q2 = q1;
+        SerialBitPutVarint(&bw, SerialZigzag(q1));
+        for (t = 1; t < frames; t++) {
+            q = SerialQuantize(samples[(size_t)t * (size_t)channels + c], inv);
+            r = order == 0 ? q : order == 1 || t == 1 ? (int64_t)q - q1 : (int64_t)q - 2 * (int64_t)q1 + q2;
+            if (width == SERIAL_PACK_VARINT) {
+                SerialBitPutVarint(&bw, SerialZigzag(r));
+            }
+            else {
+                SerialBitPutWide(&bw, SerialZigzag(r), width);
+            }
+            q2 = q1;
+            q1 = q;
+        }
+        if (bw.overflow) {
+            return -1;
+        }
+    }
+    return SerialBitFinish(&bw, out);
+}
+
+// 解压到 samples ([帧][通道] 交织), 返回读取的字节数, 格式错误或数据不足返回 -1
+long SerialUnpackSamples(float *samples, const uint8_t *in, size_t len, int channels, int frames, float scale) {
+
+    SerialBitReader br;
+    size_t used;
+    uint32_t q, q1, q2, r;
+    int t, c, order, width;
+
+    if (channels < 1 || frames < 1 || len < (size_t)channels) {
+        return -1;
+    }
+    br.p = in + channels;
+    br.end = in + len;
+    br.acc = 0;
+    br.bits = 0;
+    br.over = 0;
+
+    for (c = 0; c < channels; c++) {
+        order = in[c] >> 6;
+        width = in[c] & 0x3f;
+        if (order > 2 || (width > 34 && width != SERIAL_PACK_VARINT)) {
+            return -1;
+        }
+        // 原值都在 int32 范围内, 按 32 位回绕运算重建, 错误数据也不会溢出
+        q1 = (uint32_t)SerialUnzigzag(SerialBitGetVarint(&br));
+        q2 = q1;
+        samples[c] = (float)(int32_t)q1 * scale;
+        for (t = 1; t < frames; t++) {
+            r = (uint32_t)SerialUnzigzag(width == SERIAL_PACK_VARINT ? SerialBitGetVarint(&br) : SerialBitGetWide(&br, width));
+            q = order == 0 ? r : order == 1 || t == 1 ? q1 + r : 2 * q1 - q2 + r;
+            samples[(size_t)t * (size_t)channels + c] = (float)(int32_t)q * scale;
+            q2 = q1;
+            q1 = q;
+        }
+    }
+    // 读取位置超过末尾说明数据被截断
+    used = (size_t)(br.p - in) + br.over - (size_t)(br.bits / 8);
+    return used <= len ? (long)used : -1;
+}
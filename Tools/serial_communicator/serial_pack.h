@@ -0,0 +1,13 @@
+// serial_pack.h
+#ifndef SERIAL_PACK_H
+#define SERIAL_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+size_t SerialPackBound(int channels, int frames);
+long SerialPackSamples(uint8_t *out, size_t cap, const float *samples, int channels, int frames, float scale);
+long SerialUnpackSamples(float *samples, const uint8_t *in, size_t len, int channels, int frames, float scale);
+
+
+#endif /* Serial Pack */
@@ -0,0 +1,152 @@
+// serial_pack_test.c
+
+/*
+ * serial_pack 的自动测试（ctest），只在内存中压缩，不需要串口：
+ *     位宽 0 ~ 32 的定宽打包、varint、0 / 1 / 2 阶预测各至少出现一次，解压后与量化值相同
+ *     单帧、255 通道、int32 边界值和任意 scale 的往返
+ *     压缩后不超过 SerialPackBound，空间不足、截断和格式错误的输入返回 -1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "serial_pack.h"
+#include "serial_test.h"
+
+#define TEST_WIDTHS     33                  // 位宽 0 ~ 32 各一个通道
+#define TEST_CHANNELS   (TEST_WIDTHS + 3)   // 另有 varint, 1 阶, 2 阶各一个通道
+#define TEST_FRAMES     64
+
+static uint32_t test_state = 12345;
+
+static uint32_t TestRandom(void) {
+    test_state = test_state * 1664525u + 1013904223u;
+    return test_state;
+}
+
+// 解压结果与原值相差不超过半个 LSB (量化误差) 和 float 本身的精度
+static int TestClose(float got, float want, float scale) {
+    return fabsf(got - want) <= 0.5f * scale + fabsf(want) * 1.2e-7f;
+}
+
+// 压缩 + 解压, 返回压缩后的字节数, 失败返回 -1
+static long TestRoundTrip(const float *samples, int channels, int frames, float scale, uint8_t *out) {
+
+    const size_t bound = SerialPackBound(channels, frames);
+    float *back = (float *)malloc((size_t)channels * (size_t)frames * sizeof(float));
+    long n, m;
+    size_t i;
+
+    n = SerialPackSamples(out, bound, samples, channels, frames, scale);
+    SERIAL_CHECK(n > 0 && (size_t)n <= bound);
+    if (n <= 0 || back == NULL) {
+        free(back);
+        return -1;
+    }
+    m = SerialUnpackSamples(back, out, (size_t)n, channels, frames, scale);
+    SERIAL_CHECK(m == n);
+    for (i = 0; i < (size_t)channels * (size_t)frames; i++) {
+        if (!TestClose(back[i], samples[i], scale)) {
+            printf("sample %u (channel %d): got %.9g, expected %.9g\r\n",
+                   (unsigned)i, (int)(i % (size_t)channels), (double)back[i], (double)samples[i]);
+            serial_test_failures++;
+            break;
+        }
+    }
+    // 截断 1 字节
+    SERIAL_CHECK(SerialUnpackSamples(back, out, (size_t)n - 1, channels, frames, scale) == -1);
+    free(back);
+    return n;
+}
+
+static void TestWidths(void) {
+
+    static float samples[TEST_FRAMES][TEST_CHANNELS];
+    static uint8_t out[8192];
+    unsigned long long widths = 0;
+    int orders = 0, varint = 0;
+    long long lo, hi, step;
+    int t, c, w;
+
+    for (w = 0; w < TEST_WIDTHS; w++) {
+        // zigzag 后位宽为 w 的整数: [-2^(w-1), 2^(w-1) - 1], 第 1, 2 帧取两端, 0 阶残差位宽正好是 w
+        // 超过 24 位时只取 float 能精确表示的值 (step 的整数倍), 否则舍入后可能变成 2^(w-1)
+        step = w > 24 ? 1ll << (w - 24) : 1;
+        lo = w == 0 ? 0 : -(1ll << (w - 1));
+        hi = w == 0 ? 0 : (1ll << (w - 1)) - step;
+        for (t = 0; t < TEST_FRAMES; t++) {
+            samples[t][w] = (float)(t == 1 ? lo : t == 2 ? hi : lo + (long long)(TestRandom() % (unsigned long long)((hi - lo) / step + 1)) * step);
+        }
+    }
+    for (t = 0; t < TEST_FRAMES; t++) {
+        // 平稳信号中偶尔一个大值: varint
+        samples[t][TEST_WIDTHS] = (float)(t == 40 ? 1 << 20 : (int)(TestRandom() % 5) - 2);
+        // 斜坡: 1 阶
+        samples[t][TEST_WIDTHS + 1] = (float)(1000 - 37 * t);
+        // 抛物线: 2 阶
+        samples[t][TEST_WIDTHS + 2] = (float)(3 * t * t + 1000);
+    }
+
+    if (TestRoundTrip(&samples[0][0], TEST_CHANNELS, TEST_FRAMES, 1.0f, out) < 0) {
+        return;
+    }
+    for (c = 0; c < TEST_CHANNELS; c++) {
+        w = out[c] & 0x3f;
+        if (w == 63) {
+            varint = 1;
+        }
+        else {
+            widths |= 1ull << w;
+        }
+        orders |= 1 << (out[c] >> 6);
+    }
+    SERIAL_CHECK(widths == (1ull << TEST_WIDTHS) - 1);
+    SERIAL_CHECK(varint);
+    SERIAL_CHECK(orders == 7);
+
+    // 格式错误的通道头: 阶数 3, 位宽 35
+    out[0] = 3 << 6;
+    SERIAL_CHECK(SerialUnpackSamples(&samples[0][0], out, sizeof(out), TEST_CHANNELS, TEST_FRAMES, 1.0f) == -1);
+    out[0] = 35;
+    SERIAL_CHECK(SerialUnpackSamples(&samples[0][0], out, sizeof(out), TEST_CHANNELS, TEST_FRAMES, 1.0f) == -1);
+}
+
+static void TestShapes(void) {
+
+    static float samples[TEST_FRAMES * 255];
+    static uint8_t out[65536];
+    int i;
+
+    // 单帧
+    samples[0] = 1.25f;
+    samples[1] = -7.5f;
+    TestRoundTrip(samples, 2, 1, 0.25f, out);
+
+    // 255 通道, 正弦, scale 0.001
+    for (i = 0; i < TEST_FRAMES * 255; i++) {
+        samples[i] = 3.0f * sinf((float)(i / 255) * 0.05f + (float)(i % 255));
+    }
+    TestRoundTrip(samples, 255, TEST_FRAMES, 0.001f, out);
+
+    // int32 边界, 超出范围的值被限幅
+    for (i = 0; i < TEST_FRAMES; i++) {
+        samples[i] = i % 2 ? 2147483520.0f : -2147483648.0f;
+    }
+    TestRoundTrip(samples, 1, TEST_FRAMES, 1.0f, out);
+
+    // 参数和空间
+    SERIAL_CHECK(SerialPackSamples(out, sizeof(out), samples, 0, 1, 1.0f) == -1);
+    SERIAL_CHECK(SerialPackSamples(out, sizeof(out), samples, 256, 1, 1.0f) == -1);
+    SERIAL_CHECK(SerialPackSamples(out, sizeof(out), samples, 1, 0, 1.0f) == -1);
+    SERIAL_CHECK(SerialPackSamples(out, 8, samples, 1, TEST_FRAMES, 1.0f) == -1);
+    SERIAL_CHECK(SerialUnpackSamples(samples, out, 0, 1, 1, 1.0f) == -1);
+}
+
+int main(void) {
+
+    TestWidths();
+    TestShapes();
+    return SERIAL_TEST_RESULT;
+}
@@ -0,0 +1,397 @@
+// serial_parse.c
+
+/*
+ * 文本遥测解析（接收端，serial_format.c 的逆过程）：
+ * 每行 "key=value\r\n" 或 "key=v0,v1,...\r\n"，每个数值解析成一个 SerialValue，写入调用方预先分配的批中，
+ * 解析过程不分配内存、不复制行。
+ *
+ *   - 结构字符 '\n'、'='、',' 用 SSE2 每次比较 16 字节得到位掩码（没有 SSE2 时按 8 字节一组用位运算比较），
+ *     一遍扫描同时找到行尾和字段边界，逐位取出，不再逐字节判断。
+ *   - 数值转换不查询 locale、不要求以 '\0' 结尾：整数直接累加；浮点数在有效数字不超过 2^53
+ *     且十进制指数在 +-22 以内时用一次精确的乘除得到正确舍入的结果（serial_format.c 输出的定点数都在此范围），
+ *     其余情况（如 "1.17549435e-38"）复制到临时缓冲区交给 strtod。
+ *   - key 映射为编号（散列表，最多 SERIAL_PARSE_KEYS 个），记录中只存编号。
+ *
+ * SerialParseLines 解析缓冲区中所有完整的行，返回已解析的字节数，剩余的不完整行留给下一次；
+ * 与 serial_reader.h 的行模式一起使用时，在 on_record 中对每行调用 SerialParseLine。
+ * 批满时两个函数都在行的边界停下（SerialParseLine 返回 -1），处理完批中的数据后重新调用即可。
+ * 格式错误的行整行跳过，计入 errors。
+ *
+ * 示例：
+ * #include "serial_parse.h"
+ *
+ * static SerialParser parser;
+ * static SerialValue values[4096];
+ * static SerialValueBatch batch = { values, 4096, 0 };
+ *
+ * static void on_line(const SerialView *view, void *ctx) {
+ *     if (SerialParseLine(&parser, view->data, view->len, &batch) < 0) {
+ *         consume(&batch);         // 处理 batch.values[0 .. batch.count), 然后 batch.count = 0
+ *         SerialParseLine(&parser, view->data, view->len, &batch);
+ *     }
+ * }
+ *
+ * SerialParserInit(&parser);
+ * int ch = SerialParserKey(&parser, "ch");     // 预先注册, 编号固定
+ * ...
+ * // 整数形式的浮点数 (如 SerialFormatFloat 输出的 "7") 解析为 SERIAL_VALUE_INT
+ * if (values[i].key == ch) {
+ *     output[values[i].index] = values[i].type == SERIAL_VALUE_FLOAT ? (float)values[i].value.f : (float)values[i].value.i;
+ * }
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "serial_parse.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SERIAL_PARSE_SSE2
+#elif (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_WIN32)
+#define SERIAL_PARSE_SWAR
+#endif
+
+#define SERIAL_PARSE_FULL       (-1)
+#define SERIAL_PARSE_ERROR      (-2)
+#define SERIAL_PARSE_UNKNOWN    (-3)
+
+/* ---------------- 结构字符扫描 ---------------- */
+
+typedef struct {
+    const char *base;       // 当前 16 字节块
+    const char *end;
+    unsigned mask;          // 块中还没取出的结构字符
+} SerialScan;
+
+#ifdef SERIAL_PARSE_SWAR
+// 8 字节中等于 '\n', '=', ',' 的字节 -> 8 位掩码
+static unsigned SerialSwarMask(uint64_t x) {
+    static const uint64_t patterns[3] = { 0x0a0a0a0a0a0a0a0aull, 0x3d3d3d3d3d3d3d3dull, 0x2c2c2c2c2c2c2c2cull };
+    const uint64_t low7 = 0x7f7f7f7f7f7f7f7full;
+    uint64_t hit = 0, y;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        y = x ^ patterns[i];
+        hit |= ~(((y & low7) + low7) | y | low7);
+    }
+    // 每字节的最高位收集到低 8 位
+    return (unsigned)((((hit >> 7) & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56);
+}
+#endif
+
+static unsigned SerialScanBlock(const char *p, const char *end) {
+    unsigned mask = 0;
+    int i;
+
+    if (end - p >= 16) {
+#if defined(SERIAL_PARSE_SSE2)
+        const __m128i b = _mm_loadu_si128((const __m128i *)p);
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8('\n')),
+                                                      _mm_cmpeq_epi8(b, _mm_set1_epi8('='))),
+                                         _mm_cmpeq_epi8(b, _mm_set1_epi8(',')));
+        return (unsigned)_mm_movemask_epi8(hit);
+#elif defined(SERIAL_PARSE_SWAR)
+        uint64_t w[2];
+
+        memcpy(w, p, sizeof(w));
+        return SerialSwarMask(w[0]) | SerialSwarMask(w[1]) << 8;
+#endif
+    }
+    for (i = 0; i < 16 && p + i < end; i++) {
+        mask |= (unsigned)(p[i] == '\n' || p[i] == '=' || p[i] == ',') << i;
+    }
+    return mask;
+}
+
+static int SerialLowestBit(unsigned v) {
+#if defined(__GNUC__)
+    return __builtin_ctz(v);
+#else
+    int n = 0;
+
+    while (!(v & 1u)) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static void SerialScanInit(SerialScan *s, const char *p, const char *end) {
+    s->base = p;
+    s->end = end;
+    s->mask = p < end ? SerialScanBlock(p, end) : 0;
+}
+
+// 下一个结构字符, 没有时返回 end
+static const char *SerialScanNext(SerialScan *s) {
+    int bit;
+
+    while (s->mask == 0) {
+        if (s->end - s->base <= 16) {
+            return s->end;
+        }
+        s->base += 16;
+        s->mask = SerialScanBlock(s->base, s->end);
+    }
+    bit = SerialLowestBit(s->mask);
+    s->mask &= s->mask - 1;
+    return s->base + bit;
+}
+
+/* ---------------- 数值转换 ---------------- */
+
+static const double SerialPow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 解析 [p, end) 开头的一个数 (类似 C++ from_chars): 返回数值之后的位置, 不是数值时返回 NULL
+const char *SerialParseNumber(const char *p, const char *end, SerialValue *value) {
+
+    const char *start = p;
+    uint64_t m = 0;
+    int neg = 0, digits = 0, sig = 0, inexact = 0, is_float = 0, e10 = 0, e = 0, eneg = 0, d;
+    char buf[64];
+    char *stop;
+    double f;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        p++;
+    }
+    // SerialFormatFloat 输出的非有限值
+    if (end - p >= 3 && (memcmp(p, "inf", 3) == 0 || memcmp(p, "nan", 3) == 0)) {
+        value->type = SERIAL_VALUE_FLOAT;
+        value->value.f = p[0] == 'n' ? NAN : neg ? -HUGE_VAL : HUGE_VAL;
+        return p + 3;
+    }
+
+    // 最多保留 19 位有效数字, 之后的整数位只计入指数
+    for (; p < end && (unsigned)(*p - '0') < 10u; p++, digits++) {
+        d = *p - '0';
+        if (sig < 19) {
+            m = m * 10 + (uint64_t)d;
+            sig += m != 0;
+        }
+        else {
+            e10++;
+            inexact |= d != 0;
+        }
+    }
+    if (p < end && *p == '.') {
+        is_float = 1;
+        for (p++; p < end && (unsigned)(*p - '0') < 10u; p++, digits++) {
+            d = *p - '0';
+            if (sig < 19) {
+                m = m * 10 + (uint64_t)d;
+                sig += m != 0;
+                e10--;
+            }
+            else {
+                inexact |= d != 0;
+            }
+        }
+    }
+    if (digits == 0) {
+        return NULL;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        is_float = 1;
+        p++;
+        if (p < end && (*p == '-' || *p == '+')) {
+            eneg = *p == '-';
+            p++;
+        }
+        if (p >= end || (unsigned)(*p - '0') >= 10u) {
+            return NULL;
+        }
+        for (; p < end && (unsigned)(*p - '0') < 10u; p++) {
+            if (e < 100000) {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        e10 += eneg ? -e : e;
+    }
+
+    if (!is_float && !inexact && e10 == 0 && m <= (neg ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX)) {
+        value->type = SERIAL_VALUE_INT;
+        value->value.i = neg && m != 0 ? -(long long)(m - 1) - 1 : (long long)m;
+        return p;
+    }
+
+    value->type = SERIAL_VALUE_FLOAT;
+    if (m == 0) {
+        f = 0.0;
+    }
+    else if (!inexact && m <= (1ull << 53) && e10 >= -22 && e10 <= 22) {
+        // 两个操作数都是精确的 double, 一次运算即正确舍入
+        f = e10 < 0 ? (double)m / SerialPow10[-e10] : (double)m * SerialPow10[e10];
+    }
+    else {
+        if ((size_t)(p - start) >= sizeof(buf)) {
+            return NULL;
+        }
+        memcpy(buf, start, (size_t)(p - start));
+        buf[p - start] = '\0';
+        value->value.f = strtod(buf, &stop);
+        return stop == buf + (p - start) ? p : NULL;
+    }
+    value->value.f = neg ? -f : f;
+    return p;
+}
+
+/* ---------------- key 和行 ---------------- */
+
+static int SerialParserLookup(SerialParser *parser, const char *key, size_t len, int add) {
+
+    const unsigned mask = SERIAL_PARSE_KEYS * 2 - 1;
+    uint32_t h = 2166136261u;
+    size_t i;
+    int id;
+
+    if (len == 0 || len > SERIAL_PARSE_KEY_CHARS) {
+        return SERIAL_PARSE_ERROR;
+    }
+    for (i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)key[i]) * 16777619u;
+    }
+    for (h &= mask; parser->slots[h] != 0; h = (h + 1) & mask) {
+        id = parser->slots[h] - 1;
+        if (parser->lengths[id] == len && memcmp(parser->names[id], key, len) == 0) {
+            return id;
+        }
+    }
+    if (!add || parser->keys == SERIAL_PARSE_KEYS) {
+        return SERIAL_PARSE_UNKNOWN;
+    }
+    id = parser->keys++;
+    memcpy(parser->names[id], key, len);
+    parser->names[id][len] = '\0';
+    parser->lengths[id] = (unsigned char)len;
+    parser->slots[h] = (unsigned char)(id + 1);
+    return id;
+}
+
+void SerialParserInit(SerialParser *parser) {
+    memset(parser, 0, sizeof(*parser));
+    parser->learn = 1;
+}
+
+// 注册 key, 返回编号, 失败 (过长或 key 表满) 返回 -1
+int SerialParserKey(SerialParser *parser, const char *key) {
+    const int id = SerialParserLookup(parser, key, strlen(key), 1);
+    return id >= 0 ? id : -1;
+}
+
+const char *SerialParserKeyName(const SerialParser *parser, int key) {
+    return key >= 0 && key < parser->keys ? parser->names[key] : NULL;
+}
+
+// 解析从 p 开始的一行, *eol 为行尾 ('\n' 或 s->end)
+// 返回加入 batch 的数值个数, 失败时不加入任何数值, 返回 SERIAL_PARSE_*
+static int SerialParseRecord(SerialParser *parser, SerialScan *s, const char *p, SerialValueBatch *batch,
+                             const char **eol) {
+
+    const int saved = batch->count;
+    const char *c = SerialScanNext(s), *tok, *stop;
+    SerialValue *v;
+    int status = 0, key = 0, index = 0;
+
+    if (c == s->end || *c != '=') {
+        // 空行不算错误
+        status = c == p || (c == p + 1 && *p == '\r') ? 0 : SERIAL_PARSE_ERROR;
+    }
+    else {
+        key = SerialParserLookup(parser, p, (size_t)(c - p), parser->learn);
+        status = key >= 0 ? 0 : key;
+        while (status == 0) {
+            tok = c + 1;
+            c = SerialScanNext(s);
+            stop = c;
+            if ((c == s->end || *c == '\n') && stop > tok && stop[-1] == '\r') {
+                stop--;
+            }
+            if (batch->count == batch->capacity) {
+                // 整行都放不进空批时只能跳过
+                status = saved > 0 ? SERIAL_PARSE_FULL : SERIAL_PARSE_ERROR;
+                break;
+            }
+            v = &batch->values[batch->count];
+            if (SerialParseNumber(tok, stop, v) != stop) {
+                status = SERIAL_PARSE_ERROR;
+                break;
+            }
+            v->key = (unsigned short)key;
+            v->index = (unsigned short)(index < 65535 ? index : 65535);
+            v->line = parser->lines;
+            batch->count++;
+            index++;
+            if (c == s->end || *c == '\n') {
+                break;
+            }
+            if (*c == '=') {
+                status = SERIAL_PARSE_ERROR;
+            }
+        }
+    }
+    while (c < s->end && *c != '\n') {
+        c = SerialScanNext(s);
+    }
+    *eol = c;
+    if (status != 0) {
+        batch->count = saved;
+        return status;
+    }
+    return batch->count - saved;
+}
+
+static void SerialParseCount(SerialParser *parser, int status) {
+    parser->lines++;
+    parser->errors += status == SERIAL_PARSE_ERROR;
+    parser->unknown += status == SERIAL_PARSE_UNKNOWN;
+}
+
+// 解析一行 (不含 '\n', 可以带 '\r'), 返回加入 batch 的数值个数; batch 放不下时返回 -1, 不加入任何数值
+int SerialParseLine(SerialParser *parser, const char *line, size_t len, SerialValueBatch *batch) {
+
+    SerialScan s;
+    const char *eol;
+    int n;
+
+    SerialScanInit(&s, line, line + len);
+    n = SerialParseRecord(parser, &s, line, batch, &eol);
+    if (n == SERIAL_PARSE_FULL) {
+        return -1;
+    }
+    SerialParseCount(parser, n);
+    return n > 0 ? n : 0;
+}
+
+// 解析 data 中所有完整的行, 返回已解析的字节数 (最后一个已解析行的 '\n' 之后); batch 满时提前停止
+size_t SerialParseLines(SerialParser *parser, const char *data, size_t len, SerialValueBatch *batch) {
+
+    const char *p = data, *end = data + len, *eol;
+    SerialScan s;
+    int before, n;
+
+    SerialScanInit(&s, data, end);
+    while (p < end) {
+        before = batch->count;
+        n = SerialParseRecord(parser, &s, p, batch, &eol);
+        if (eol == end) {
+            // 不完整的行留到下一次
+            batch->count = before;
+            break;
+        }
+        if (n == SERIAL_PARSE_FULL) {
+            break;
+        }
+        SerialParseCount(parser, n);
+        p = eol + 1;
+    }
+    return (size_t)(p - data);
+}
@@ -0,0 +1,52 @@
+// serial_parse.h
+#ifndef SERIAL_PARSE_H
+#define SERIAL_PARSE_H
+
+#include <stddef.h>
+
+#define SERIAL_PARSE_KEYS       64      // 最多区分的 key 个数
+#define SERIAL_PARSE_KEY_CHARS  31      // key 的最大长度
+
+// 数值类型
+#define SERIAL_VALUE_INT        0       // 没有小数点和指数的整数
+#define SERIAL_VALUE_FLOAT      1
+
+// 一个数值, "key=v0,v1,..." 中每个元素一个
+typedef struct {
+    unsigned short key;     // key 编号, 见 SerialParserKey
+    unsigned short index;   // 在数组中的位置, 单值为 0 (超过 65535 时为 65535)
+    unsigned char type;     // SERIAL_VALUE_*
+    unsigned line;          // 行号, 从 0 开始
+    union {
+        long long i;
+        double f;
+    } value;
+} SerialValue;
+
+// 调用方分配的一批数值, 解析时不分配内存
+typedef struct {
+    SerialValue *values;
+    int capacity;
+    int count;
+} SerialValueBatch;
+
+typedef struct {
+    int keys;
+    char names[SERIAL_PARSE_KEYS][SERIAL_PARSE_KEY_CHARS + 1];
+    unsigned char lengths[SERIAL_PARSE_KEYS];
+    unsigned char slots[SERIAL_PARSE_KEYS * 2];     // key 的散列表, 存编号 + 1
+    int learn;                  // 遇到新 key 时自动加入 (默认), 为 0 时跳过未注册 key 的行
+    unsigned lines;             // 已解析的行数
+    unsigned long long errors;  // 格式错误而跳过的行数
+    unsigned long long unknown; // 因 key 未注册或 key 表满而跳过的行数
+} SerialParser;
+
+void SerialParserInit(SerialParser *parser);
+int SerialParserKey(SerialParser *parser, const char *key);
+const char *SerialParserKeyName(const SerialParser *parser, int key);
+int SerialParseLine(SerialParser *parser, const char *line, size_t len, SerialValueBatch *batch);
+size_t SerialParseLines(SerialParser *parser, const char *data, size_t len, SerialValueBatch *batch);
+const char *SerialParseNumber(const char *p, const char *end, SerialValue *value);
+
+
+#endif /* Serial Parse */
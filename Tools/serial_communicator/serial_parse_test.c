@@ -0,0 +1,191 @@
+// serial_parse_test.c
+
+/*
+ * serial_parse 的自动测试（ctest），只在内存中解析，不需要串口：
+ *     SerialParseNumber 与 strtod / strtoll 逐位比较：SerialFormatFloat 的输出、
+ *     随机位数 / 小数点位置 / 指数的十进制串（快速路径和 strtod 路径都覆盖）、整数边界和格式错误的输入
+ *     SerialParseLine / SerialParseLines：数组、"\r\n"、不完整的行、格式错误和未注册 key 的计数、批满时在行边界停下
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include "serial_parse.h"
+#include "serial_format.h"
+#include "serial_test.h"
+
+#define TEST_RANDOM_NUMBERS     1000000
+
+static uint32_t test_state = 12345;
+
+static uint32_t TestRandom(void) {
+    test_state = test_state * 1664525u + 1013904223u;
+    return test_state >> 8;
+}
+
+// 解析 text 整串, 与 strtod (有小数点或指数, 或超出 int64) / strtoll (整数) 比较
+static void TestNumber(const char *text) {
+
+    const size_t len = strlen(text);
+    SerialValue v;
+    const char *stop = SerialParseNumber(text, text + len, &v);
+    double ref;
+    long long iref;
+    int is_int = strpbrk(text, ".eE") == NULL && strstr(text, "inf") == NULL && strstr(text, "nan") == NULL;
+
+    if (stop != text + len) {
+        printf("number %s: not parsed\r\n", text);
+        serial_test_failures++;
+        return;
+    }
+    // 超出 int64 的整数按浮点数解析
+    errno = 0;
+    iref = strtoll(text, NULL, 10);
+    if (is_int && errno == 0) {
+        if (v.type != SERIAL_VALUE_INT || v.value.i != iref) {
+            printf("number %s: got %lld, expected %lld\r\n", text, v.value.i, iref);
+            serial_test_failures++;
+        }
+        return;
+    }
+    ref = strtod(text, NULL);
+    if (v.type != SERIAL_VALUE_FLOAT
+        || (isnan(ref) ? !isnan(v.value.f) : memcmp(&v.value.f, &ref, sizeof(ref)) != 0)) {
+        printf("number %s: got %.17g, expected %.17g\r\n", text, v.value.f, ref);
+        serial_test_failures++;
+    }
+}
+
+static void TestNumbers(void) {
+
+    static const char *const fixed[] = {
+        "0", "-0", "+7", "1", "-1", "10", "0.5", "-0.0", "00012", "1.", "1.0", ".5", "-.25",
+        "9223372036854775807", "-9223372036854775808", "9223372036854775808", "-9223372036854775809",
+        "18446744073709551616", "123456789012345678901234567890",
+        "1e0", "1E+2", "1e-2", "2.5e22", "2.5e23", "9007199254740993", "9007199254740993.0",
+        "0.1", "0.3", "1.7976931348623157e308", "1e309", "-1e309", "4.9e-324", "2e-324", "1e-400",
+        "3.4028235e+38", "1.17549435e-38", "1e-45", "0.000123456", "123456789.5",
+        "inf", "-inf", "nan", "1e99999999", "0e5", "0.000000000000000000000000000001",
+    };
+    static const char *const invalid[] = { "", "-", "+", ".", "-.", "e5", "1e", "1e+", "1e-x", "abc", "--1" };
+    static const char tail[] = "1.5x";
+    char text[64], *p;
+    float x;
+    SerialValue v;
+    size_t i;
+    int n, k, point, e;
+
+    for (i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+        TestNumber(fixed[i]);
+    }
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        SERIAL_CHECK(SerialParseNumber(invalid[i], invalid[i] + strlen(invalid[i]), &v) == NULL);
+    }
+    // 数值之后的字符不属于数值
+    SERIAL_CHECK(SerialParseNumber(tail, tail + 4, &v) == tail + 3);
+
+    // SerialFormatFloat 的输出 (接收端的实际输入)
+    for (i = 0; i < TEST_RANDOM_NUMBERS; i++) {
+        n = (int)(TestRandom() << 8 | (TestRandom() & 0xff));
+        memcpy(&x, &n, sizeof(x));
+        *SerialFormatFloat(text, x) = '\0';
+        TestNumber(text);
+    }
+
+    // 随机十进制串: 1 ~ 25 位数字, 随机小数点, 一半带指数
+    for (i = 0; i < TEST_RANDOM_NUMBERS; i++) {
+        p = text;
+        if (TestRandom() & 1) {
+            *p++ = '-';
+        }
+        n = 1 + (int)(TestRandom() % 25);
+        point = (int)(TestRandom() % (unsigned)(n + 2)) - 1;
+        for (k = 0; k < n; k++) {
+            if (k == point) {
+                *p++ = '.';
+            }
+            *p++ = (char)('0' + TestRandom() % 10);
+        }
+        if (TestRandom() & 1) {
+            e = (int)(TestRandom() % 700) - 350;
+            p += snprintf(p, (size_t)(text + sizeof(text) - p), "e%d", e);
+        }
+        *p = '\0';
+        TestNumber(text);
+    }
+}
+
+static void TestLines(void) {
+
+    static const char data[] =
+        "value=10\r\n"
+        "ch=0.125,-3.5,7,1e-05\r\n"
+        "\r\n"
+        "bad line\r\n"
+        "value=1,x\n"
+        "value==1\n"
+        "a_key_longer_than_one_block=2.5\n"
+        "value=-9223372036854775808\n"
+        "partial=1";
+    SerialValue values[16];
+    SerialValueBatch batch = { values, 16, 0 };
+    SerialParser parser;
+    size_t used;
+    int value, ch, n;
+
+    SerialParserInit(&parser);
+    value = SerialParserKey(&parser, "value");
+    ch = SerialParserKey(&parser, "ch");
+    SERIAL_CHECK(value == 0 && ch == 1);
+    SERIAL_CHECK(SerialParserKey(&parser, "value") == 0);
+    SERIAL_CHECK(SerialParserKey(&parser, "") == -1);
+    SERIAL_CHECK(SerialParserKey(&parser, "0123456789012345678901234567890123") == -1);
+
+    used = SerialParseLines(&parser, data, sizeof(data) - 1, &batch);
+    SERIAL_CHECK(used == sizeof(data) - 1 - strlen("partial=1"));
+    SERIAL_CHECK(batch.count == 7);
+    SERIAL_CHECK(parser.lines == 8);
+    SERIAL_CHECK(parser.errors == 3);
+    if (batch.count == 7) {
+        SERIAL_CHECK(values[0].key == value && values[0].type == SERIAL_VALUE_INT && values[0].value.i == 10);
+        SERIAL_CHECK(values[1].key == ch && values[1].index == 0 && values[1].value.f == 0.125);
+        SERIAL_CHECK(values[2].index == 1 && values[2].value.f == -3.5);
+        SERIAL_CHECK(values[3].index == 2 && values[3].type == SERIAL_VALUE_INT && values[3].value.i == 7);
+        SERIAL_CHECK(values[4].index == 3 && values[4].value.f == strtod("1e-05", NULL));
+        SERIAL_CHECK(values[1].line == 1 && values[4].line == 1);
+        SERIAL_CHECK(strcmp(SerialParserKeyName(&parser, values[5].key), "a_key_longer_than_one_block") == 0);
+        SERIAL_CHECK(values[5].value.f == 2.5 && values[5].line == 6);
+        SERIAL_CHECK(values[6].value.i == LLONG_MIN);
+    }
+
+    // 不自动注册 key 时跳过未注册 key 的行
+    batch.count = 0;
+    parser.learn = 0;
+    SERIAL_CHECK(SerialParseLine(&parser, "other=1", 7, &batch) == 0 && parser.unknown == 1);
+    SERIAL_CHECK(SerialParseLine(&parser, "ch=1,2\r", 7, &batch) == 2 && batch.count == 2);
+
+    // 批满: 在行边界停下, 不加入这一行的任何数值
+    batch.capacity = 3;
+    SERIAL_CHECK(SerialParseLine(&parser, "ch=1,2", 6, &batch) == -1 && batch.count == 2);
+    batch.count = 0;
+    n = SerialParseLine(&parser, "ch=1,2", 6, &batch);
+    SERIAL_CHECK(n == 2);
+    batch.count = 2;
+    used = SerialParseLines(&parser, "value=1\nch=1,2\n", 15, &batch);
+    SERIAL_CHECK(used == 8 && batch.count == 3);
+    // 一行放不进空批时跳过, 计为错误
+    batch.count = 0;
+    batch.capacity = 1;
+    SERIAL_CHECK(SerialParseLine(&parser, "ch=1,2", 6, &batch) == 0 && batch.count == 0);
+}
+
+int main(void) {
+
+    TestNumbers();
+    TestLines();
+    return SERIAL_TEST_RESULT;
+}
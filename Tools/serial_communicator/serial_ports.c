@@ -0,0 +1,871 @@
+// serial_ports.c
+
+/*
+ * 多串口管理（Linux）：
+ * serial_communicator.c 的 comHandle 只能表示一个串口。这里每个串口用一个整数编号表示，
+ * 所有串口注册到同一个 epoll，由一个线程调用 SerialPortsPoll 处理全部串口的收发，
+ * 不需要每个串口一个阻塞线程。
+ *
+ * 接收使用 serial_reader.c：每个串口有自己的环形缓冲区，完整的行或帧以视图的形式交给 on_record。
+ * 发送先直接写串口，写不完的部分放进该串口的发送缓冲区，并监听 EPOLLOUT，可写时由事件循环续写；
+ * 发送缓冲区放不下整条消息时丢弃该消息，计入 tx_dropped。
+ *
+ * io_uring 后端（OpenSerialPortsBackend 选择 SERIAL_BACKEND_URING 或 SERIAL_BACKEND_AUTO）接口和行为相同，
+ * 区别在于系统调用：epoll 每次唤醒要 epoll_wait 加上每个串口的 read / write，
+ * io_uring 的读写请求常驻内核，SerialPortsPoll 只调用一次 io_uring_enter，同时提交新请求和收取完成事件。
+ *   - 接收：用 IORING_OP_READ_FIXED 直接读进该串口的环形缓冲区，每次完成后重新提交；
+ *     缓冲区没能注册时，内核支持的话（6.7 起）用多次读取请求（IORING_OP_READ_MULTISHOT），
+ *     数据进共享的内核选择缓冲区（provided buffer ring）后复制到环形缓冲区，否则用普通的 IORING_OP_READ。
+ *     多次读取省去了重新提交，但每次最多读一个选择缓冲区并多一次复制，
+ *     在 serial_ports_bench 中每 MB 的 CPU 时间是固定缓冲区读的约 4 倍，所以只作为退路。
+ *   - 发送：SerialPortsSend 只把数据放进发送缓冲区并填写 IORING_OP_WRITE_FIXED 请求，
+ *     在下一次 SerialPortsPoll 时与其他请求一起提交。
+ *   - 环形缓冲区和发送缓冲区注册为固定缓冲区（registered buffers），读写时内核不必每次映射用户页；
+ *     注册失败（如 RLIMIT_MEMLOCK 不够）时该串口退回上面的多次读取和普通的 WRITE。
+ *
+ * SerialPorts 不是线程安全的，所有函数都应在调用 SerialPortsPoll 的线程中使用，
+ * 回调中可以直接调用 SerialPortsSend 和 SerialPortsRemove。
+ * 原有的 Useserial / comHandle 不受影响，也可以把 comHandle 作为 handle 加入管理器。
+ *
+ * 示例：
+ * #include "serial_ports.h"
+ *
+ * static void on_line(int port, const SerialView *view, void *ctx) {
+ *     printf("port %d: %.*s\n", port, (int)view->len, view->data);
+ * }
+ *
+ * int main() {
+ *     char name[32];
+ *     SerialPortConfig config = { 0 };
+ *     SerialPorts *ports = OpenSerialPortsBackend(64, SERIAL_BACKEND_AUTO);
+ *     int i;
+ *
+ *     config.baud = CBR_115200;
+ *     config.delimiter = SERIAL_SPLIT_LINE;
+ *     config.on_record = on_line;
+ *     for (i = 0; i < 16; i++) {
+ *         sprintf(name, "/dev/ttyUSB%d", i);
+ *         config.name = name;
+ *         SerialPortsAdd(ports, &config);
+ *     }
+ *     SerialPortsSend(ports, 0, "start\r\n", 7);
+ *     while (SerialPortsPoll(ports, 1000) >= 0) {
+ *     }
+ *     CloseSerialPorts(ports);
+ *     return 0;
+ * }
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include "serial_ports.h"
+#ifdef SERIAL_HAVE_URING
+#include "serial_uring.h"
+#endif
+
+#define SERIAL_PORTS_EVENTS     64
+
+// io_uring 请求的 user_data: 代数 << 32 | 编号 << 2 | 操作
+#define SERIAL_OP_RX            1
+#define SERIAL_OP_TX            2
+#define SERIAL_OP_CANCEL        3
+#define SERIAL_URING_BUFS       64      // 多次读取共享的内核选择缓冲区个数 (2 的幂)
+#define SERIAL_URING_BUF_SIZE   16384
+
+typedef struct {
+    SerialPorts *owner;
+    int id;
+    unsigned generation;    // 与编号一起放进 epoll 事件, 识别已移除后被复用的编号
+    SerialPortConfig config;
+    SerialHandle handle;
+    int owned;              // 由管理器打开, 移除时关闭
+    SerialReader *reader;
+    char *tx;
+    size_t tx_off;
+    size_t tx_len;
+    int watch_out;          // 已监听 EPOLLOUT
+    int closed;
+    int removed;            // 在处理自己的事件时被移除 (io_uring: 或还有请求在内核中), 之后释放
+    int fixed;              // io_uring: 缓冲区已注册
+    int rx_armed;           // io_uring: 读请求在内核中
+    size_t tx_inflight;     // io_uring: 正在写的字节数
+    int inflight;           // io_uring: 内核中的请求数, 为 0 才能释放
+    SerialPortStats stats;
+} SerialPort;
+
+struct SerialPorts {
+    int backend;
+    int epoll;
+    int max_ports;
+    unsigned generation;
+    SerialPort *current;    // 正在处理事件的串口
+    SerialPort **ports;
+    unsigned long long syscalls;    // epoll 后端: epoll_wait, epoll_ctl, write 和已移除串口的 read
+#ifdef SERIAL_HAVE_URING
+    SerialUring uring;
+    int fixed;              // 固定缓冲区表已注册 (每个串口 2 项)
+    int multishot;          // 支持 IORING_OP_READ_MULTISHOT
+    int rearm;              // 有串口因提交队列满没能提交读写请求
+    struct io_uring_buf_ring *buf_ring;
+    char *buf_mem;
+    unsigned short buf_tail;
+#endif
+};
+
+static void SerialPortClosed(SerialPort *p);
+static void SerialPortFree(SerialPort *p);
+
+static uint64_t SerialPortTag(const SerialPort *p, int op) {
+    return (uint64_t)p->generation << 32 | (uint64_t)(uint32_t)p->id << 2 | (uint64_t)op;
+}
+
+static SerialPort *SerialPortsGet(const SerialPorts *ports, int port) {
+    if (port < 0 || port >= ports->max_ports || ports->ports[port] == NULL || ports->ports[port]->removed) {
+        return NULL;
+    }
+    return ports->ports[port];
+}
+
+static void SerialPortRecord(const SerialView *view, void *ctx) {
+    SerialPort *p = (SerialPort *)ctx;
+
+    if (!p->removed && p->config.on_record != NULL) {
+        p->config.on_record(p->id, view, p->config.ctx);
+    }
+}
+
+static void SerialPortRelease(SerialPort *p) {
+    SerialReaderStats rx;
+
+    if (p->reader != NULL) {
+        SerialReaderGetStats(p->reader, &rx);
+        p->owner->syscalls += p->owner->backend == SERIAL_BACKEND_EPOLL ? rx.reads : 0;
+    }
+    CloseSerialReader(p->reader);
+    if (p->owned) {
+        CloseSerialQuiet(p->handle);
+    }
+    free(p->tx);
+    free(p);
+}
+
+#ifdef SERIAL_HAVE_URING
+
+static struct io_uring_sqe *SerialPortsSqe(SerialPorts *ports) {
+    struct io_uring_sqe *sqe = SerialUringSqe(&ports->uring);
+
+    // 提交队列满时先提交已有的请求
+    if (sqe == NULL && SerialUringEnter(&ports->uring, 0, 0) >= 0) {
+        sqe = SerialUringSqe(&ports->uring);
+    }
+    return sqe;
+}
+
+static int SerialUringPortsInit(SerialPorts *ports) {
+
+    struct io_uring_rsrc_register rr;
+    struct io_uring_buf_reg reg;
+    unsigned entries = 64, i;
+    size_t ring_size = SERIAL_URING_BUFS * sizeof(struct io_uring_buf);
+
+    while (entries < 4u * (unsigned)ports->max_ports) {
+        entries <<= 1;
+    }
+    if (SerialUringInit(&ports->uring, entries) != 0) {
+        ports->uring.fd = -1;
+        return -1;
+    }
+
+    // 稀疏的固定缓冲区表, 加入串口时填入
+    memset(&rr, 0, sizeof(rr));
+    rr.nr = 2u * (unsigned)ports->max_ports;
+    rr.flags = IORING_RSRC_REGISTER_SPARSE;
+    ports->fixed = SerialUringRegister(&ports->uring, IORING_REGISTER_BUFFERS2, &rr, sizeof(rr)) == 0;
+
+    if (!SerialUringProbe(&ports->uring, IORING_OP_READ_MULTISHOT)) {
+        return 0;
+    }
+    ports->buf_ring = (struct io_uring_buf_ring *)mmap(NULL, ring_size, PROT_READ | PROT_WRITE,
+                                                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ports->buf_mem = (char *)malloc((size_t)SERIAL_URING_BUFS * SERIAL_URING_BUF_SIZE);
+    if (ports->buf_ring == MAP_FAILED || ports->buf_mem == NULL) {
+        ports->buf_ring = ports->buf_ring == MAP_FAILED ? NULL : ports->buf_ring;
+        return 0;
+    }
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ports->buf_ring;
+    reg.ring_entries = SERIAL_URING_BUFS;
+    reg.bgid = 0;
+    if (SerialUringRegister(&ports->uring, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        return 0;
+    }
+    for (i = 0; i < SERIAL_URING_BUFS; i++) {
+        ports->buf_ring->bufs[i].addr = (uint64_t)(uintptr_t)(ports->buf_mem + (size_t)i * SERIAL_URING_BUF_SIZE);
+        ports->buf_ring->bufs[i].len = SERIAL_URING_BUF_SIZE;
+        ports->buf_ring->bufs[i].bid = (unsigned short)i;
+    }
+    ports->buf_tail = SERIAL_URING_BUFS;
+    __atomic_store_n(&ports->buf_ring->tail, ports->buf_tail, __ATOMIC_RELEASE);
+    ports->multishot = 1;
+    return 0;
+}
+
+static void SerialUringPortsFree(SerialPorts *ports) {
+    if (ports->uring.fd >= 0) {
+        SerialUringFree(&ports->uring);
+    }
+    if (ports->buf_ring != NULL) {
+        munmap(ports->buf_ring, SERIAL_URING_BUFS * sizeof(struct io_uring_buf));
+    }
+    free(ports->buf_mem);
+}
+
+// 把用完的内核选择缓冲区放回缓冲区环
+static void SerialUringRecycle(SerialPorts *ports, unsigned bid) {
+    struct io_uring_buf *b = &ports->buf_ring->bufs[ports->buf_tail & (SERIAL_URING_BUFS - 1)];
+
+    b->addr = (uint64_t)(uintptr_t)(ports->buf_mem + (size_t)bid * SERIAL_URING_BUF_SIZE);
+    b->len = SERIAL_URING_BUF_SIZE;
+    b->bid = (unsigned short)bid;
+    ports->buf_tail++;
+    __atomic_store_n(&ports->buf_ring->tail, ports->buf_tail, __ATOMIC_RELEASE);
+}
+
+static void SerialUringRegisterPort(SerialPort *p) {
+
+    struct io_uring_rsrc_update2 up;
+    struct iovec iov[2];
+
+    if (!p->owner->fixed) {
+        return;
+    }
+    memset(iov, 0, sizeof(iov));
+    if (!p->fixed) {
+        iov[0].iov_base = SerialReaderMemory(p->reader, &iov[0].iov_len);
+        iov[1].iov_base = p->tx;
+        iov[1].iov_len = p->config.tx_size;
+    }
+    memset(&up, 0, sizeof(up));
+    up.offset = 2u * (unsigned)p->id;
+    up.data = (uint64_t)(uintptr_t)iov;
+    up.nr = 2;
+    // 注册和注销用同一个调用, iov 为空时清空该项
+    if (SerialUringRegister(&p->owner->uring, IORING_REGISTER_BUFFERS_UPDATE, &up, sizeof(up)) >= 0) {
+        p->fixed = !p->fixed;
+    }
+}
+
+static void SerialUringArmRx(SerialPort *p) {
+
+    struct io_uring_sqe *sqe;
+    size_t space;
+    char *buf;
+
+    sqe = SerialPortsSqe(p->owner);
+    if (sqe == NULL) {
+        p->owner->rearm = 1;
+        return;
+    }
+    sqe->fd = p->handle;
+    sqe->off = (uint64_t)-1;
+    sqe->user_data = SerialPortTag(p, SERIAL_OP_RX);
+    if (p->owner->multishot && !p->fixed) {
+        sqe->opcode = IORING_OP_READ_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+    }
+    else {
+        buf = SerialReaderBuffer(p->reader, &space);
+        sqe->opcode = p->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->addr = (uint64_t)(uintptr_t)buf;
+        sqe->len = (unsigned)(space < 0x7ffff000u ? space : 0x7ffff000u);
+        sqe->buf_index = (unsigned short)(2 * p->id);
+    }
+    p->rx_armed = 1;
+    p->inflight++;
+}
+
+static void SerialUringArmTx(SerialPort *p) {
+
+    struct io_uring_sqe *sqe = SerialPortsSqe(p->owner);
+
+    if (sqe == NULL) {
+        p->owner->rearm = 1;
+        return;
+    }
+    sqe->opcode = p->fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = p->handle;
+    sqe->off = (uint64_t)-1;
+    sqe->addr = (uint64_t)(uintptr_t)(p->tx + p->tx_off);
+    sqe->len = (unsigned)p->tx_len;
+    sqe->buf_index = (unsigned short)(2 * p->id + 1);
+    sqe->user_data = SerialPortTag(p, SERIAL_OP_TX);
+    p->tx_inflight = p->tx_len;
+    p->inflight++;
+}
+
+static void SerialUringCancel(SerialPort *p) {
+
+    struct io_uring_sqe *sqe;
+    int op;
+
+    for (op = SERIAL_OP_RX; op <= SERIAL_OP_TX; op++) {
+        if ((op == SERIAL_OP_RX ? p->rx_armed : p->tx_inflight > 0) && (sqe = SerialPortsSqe(p->owner)) != NULL) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = SerialPortTag(p, op);
+            sqe->user_data = SerialPortTag(p, SERIAL_OP_CANCEL);
+        }
+    }
+}
+
+// 处理一个完成事件, 返回分发的记录数
+static int SerialUringComplete(SerialPorts *ports, uint64_t tag, int res, unsigned flags) {
+
+    const int op = (int)(tag & 3u);
+    const int id = (int)((uint32_t)tag >> 2);
+    SerialPort *p = id < ports->max_ports ? ports->ports[id] : NULL;
+    const char *data;
+    size_t space, n, len;
+    char *buf;
+    int records = 0;
+
+    if (p == NULL || p->generation != (unsigned)(tag >> 32) || op == SERIAL_OP_CANCEL) {
+        if (flags & IORING_CQE_F_BUFFER) {
+            SerialUringRecycle(ports, flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+        return 0;
+    }
+    ports->current = p;
+    if (op == SERIAL_OP_RX) {
+        if (!(flags & IORING_CQE_F_MORE)) {
+            p->rx_armed = 0;
+            p->inflight--;
+        }
+        if (res > 0) {
+            p->stats.rx.reads++;
+            if (flags & IORING_CQE_F_BUFFER) {
+                // 内核选择缓冲区 -> 环形缓冲区, 放不下时分段
+                data = ports->buf_mem + (size_t)(flags >> IORING_CQE_BUFFER_SHIFT) * SERIAL_URING_BUF_SIZE;
+                for (len = (size_t)res; len > 0; len -= n, data += n) {
+                    buf = SerialReaderBuffer(p->reader, &space);
+                    n = len < space ? len : space;
+                    memcpy(buf, data, n);
+                    records += SerialReaderCommit(p->reader, n);
+                }
+            }
+            else {
+                records += SerialReaderCommit(p->reader, (size_t)res);
+            }
+        }
+        else if (res == 0 || (res != -EAGAIN && res != -EINTR && res != -ENOBUFS && res != -ECANCELED)) {
+            SerialPortClosed(p);
+        }
+        if (flags & IORING_CQE_F_BUFFER) {
+            SerialUringRecycle(ports, flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+        if (!p->rx_armed && !p->closed && !p->removed) {
+            SerialUringArmRx(p);
+        }
+    }
+    else {
+        p->inflight--;
+        p->tx_inflight = 0;
+        if (res > 0) {
+            p->stats.tx_writes++;
+            p->stats.tx_bytes += (unsigned long long)res;
+            p->tx_off += (size_t)res;
+            p->tx_len -= (size_t)res;
+        }
+        else if (res != -EAGAIN && res != -EINTR && res != -ECANCELED) {
+            SerialPortClosed(p);
+        }
+        if (p->tx_len == 0) {
+            p->tx_off = 0;
+        }
+        else if (!p->closed && !p->removed) {
+            SerialUringArmTx(p);
+        }
+    }
+    ports->current = NULL;
+    if (p->removed && p->inflight == 0) {
+        ports->ports[id] = NULL;
+        SerialPortFree(p);
+    }
+    return records;
+}
+
+static int SerialUringPoll(SerialPorts *ports, int timeout_ms) {
+
+    struct io_uring_cqe *cqe;
+    uint64_t tag;
+    unsigned flags;
+    int res, i, records = 0;
+
+    if (SerialUringEnter(&ports->uring, 1, timeout_ms) < 0) {
+        return -1;
+    }
+    while ((cqe = SerialUringPeek(&ports->uring)) != NULL) {
+        tag = cqe->user_data;
+        res = cqe->res;
+        flags = cqe->flags;
+        SerialUringAdvance(&ports->uring);
+        records += SerialUringComplete(ports, tag, res, flags);
+    }
+    if (ports->rearm) {
+        ports->rearm = 0;
+        for (i = 0; i < ports->max_ports; i++) {
+            SerialPort *p = SerialPortsGet(ports, i);
+            if (p != NULL && !p->closed && !p->rx_armed) {
+                SerialUringArmRx(p);
+            }
+            if (p != NULL && !p->closed && p->tx_len > 0 && p->tx_inflight == 0) {
+                SerialUringArmTx(p);
+            }
+        }
+    }
+    return records;
+}
+
+static unsigned long long SerialUringSyscalls(const SerialPorts *ports) {
+    return ports->uring.enters;
+}
+
+#else
+
+static int SerialUringPortsInit(SerialPorts *ports) {
+    (void)ports;
+    return -1;
+}
+
+#endif
+
+SerialPorts *OpenSerialPorts(int max_ports) {
+    return OpenSerialPortsBackend(max_ports, SERIAL_BACKEND_EPOLL);
+}
+
+SerialPorts *OpenSerialPortsBackend(int max_ports, int backend) {
+
+    SerialPorts *ports;
+
+    ports = (SerialPorts *)calloc(1, sizeof(SerialPorts));
+    if (ports == NULL) {
+        return NULL;
+    }
+    ports->epoll = -1;
+    ports->max_ports = max_ports > 0 ? max_ports : 64;
+    ports->ports = (SerialPort **)calloc((size_t)ports->max_ports, sizeof(SerialPort *));
+    if (ports->ports == NULL) {
+        free(ports);
+        return NULL;
+    }
+
+    if (backend != SERIAL_BACKEND_EPOLL && SerialUringPortsInit(ports) == 0) {
+        ports->backend = SERIAL_BACKEND_URING;
+        return ports;
+    }
+    if (backend == SERIAL_BACKEND_URING) {
+        printf("io_uring setup fail: %s\r\n", strerror(errno));
+        free(ports->ports);
+        free(ports);
+        return NULL;
+    }
+
+    ports->backend = SERIAL_BACKEND_EPOLL;
+    ports->epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (ports->epoll < 0) {
+        printf("epoll_create fail: %s\r\n", strerror(errno));
+        free(ports->ports);
+        free(ports);
+        return NULL;
+    }
+    return ports;
+}
+
+void CloseSerialPorts(SerialPorts *ports) {
+    int i;
+
+    if (ports == NULL) {
+        return;
+    }
+    for (i = 0; i < ports->max_ports; i++) {
+        SerialPortsRemove(ports, i);
+    }
+#ifdef SERIAL_HAVE_URING
+    if (ports->backend == SERIAL_BACKEND_URING) {
+        // 等待取消的请求完成后再释放缓冲区
+        for (i = 0; i < 100; i++) {
+            int j, busy = 0;
+            for (j = 0; j < ports->max_ports; j++) {
+                busy |= ports->ports[j] != NULL;
+            }
+            if (!busy) {
+                break;
+            }
+            SerialUringPoll(ports, 10);
+        }
+        SerialUringPortsFree(ports);
+        for (i = 0; i < ports->max_ports; i++) {
+            if (ports->ports[i] != NULL) {
+                SerialPortRelease(ports->ports[i]);
+            }
+        }
+    }
+#endif
+    if (ports->epoll >= 0) {
+        close(ports->epoll);
+    }
+    free(ports->ports);
+    free(ports);
+}
+
+static int SerialPortWatch(SerialPort *p, int out) {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (out ? EPOLLOUT : 0);
+    ev.data.u64 = SerialPortTag(p, 0);
+    p->watch_out = out;
+    p->owner->syscalls++;
+    return epoll_ctl(p->owner->epoll, EPOLL_CTL_MOD, p->handle, &ev);
+}
+
+static void SerialPortClosed(SerialPort *p) {
+    if (p->closed) {
+        return;
+    }
+    p->closed = 1;
+    p->stats.closed = 1;
+    if (p->owner->backend == SERIAL_BACKEND_EPOLL) {
+        p->owner->syscalls++;
+        epoll_ctl(p->owner->epoll, EPOLL_CTL_DEL, p->handle, NULL);
+    }
+#ifdef SERIAL_HAVE_URING
+    else {
+        SerialUringCancel(p);
+    }
+#endif
+    if (p->config.on_close != NULL) {
+        p->config.on_close(p->id, p->config.ctx);
+    }
+}
+
+static void SerialPortFree(SerialPort *p) {
+    if (p->owner->backend == SERIAL_BACKEND_EPOLL && !p->closed) {
+        epoll_ctl(p->owner->epoll, EPOLL_CTL_DEL, p->handle, NULL);
+    }
+#ifdef SERIAL_HAVE_URING
+    if (p->fixed) {
+        SerialUringRegisterPort(p);
+    }
+#endif
+    SerialPortRelease(p);
+}
+
+// 加入一个串口, 返回编号, 失败返回 -1
+int SerialPortsAdd(SerialPorts *ports, const SerialPortConfig *config) {
+
+    SerialReaderConfig rc;
+    struct epoll_event ev;
+    SerialPort *p;
+    int id;
+
+    for (id = 0; id < ports->max_ports && ports->ports[id] != NULL; id++) {
+    }
+    if (id == ports->max_ports) {
+        printf("too many serial ports\r\n");
+        return -1;
+    }
+    p = (SerialPort *)calloc(1, sizeof(SerialPort));
+    if (p == NULL) {
+        return -1;
+    }
+    p->owner = ports;
+    p->id = id;
+    p->generation = ++ports->generation;
+    p->config = *config;
+    if (p->config.baud <= 0) {
+        p->config.baud = CBR_115200;
+    }
+    if (p->config.byteSize <= 0) {
+        p->config.byteSize = 8;
+    }
+    if (p->config.tx_size == 0) {
+        p->config.tx_size = 65536;
+    }
+    p->tx = (char *)malloc(p->config.tx_size);
+    if (p->tx == NULL) {
+        free(p);
+        return -1;
+    }
+
+    if (config->name != NULL) {
+        p->handle = OpenSerial(config->name, p->config.baud, p->config.byteSize, p->config.parity, p->config.stopBits);
+        p->owned = 1;
+    }
+    else {
+        p->handle = config->handle;
+    }
+    if (p->handle == SERIAL_INVALID_HANDLE) {
+        free(p->tx);
+        free(p);
+        return -1;
+    }
+
+    memset(&rc, 0, sizeof(rc));
+    rc.ring_size = p->config.ring_size;
+    rc.delimiter = p->config.delimiter;
+    rc.on_record = SerialPortRecord;
+    rc.ctx = p;
+    rc.capture = p->config.capture;
+    rc.channel = id;
+    p->reader = OpenSerialReader(p->handle, &rc);
+    if (p->reader == NULL) {
+        printf("add serial port fail\r\n");
+        SerialPortRelease(p);
+        return -1;
+    }
+
+#ifdef SERIAL_HAVE_URING
+    if (ports->backend == SERIAL_BACKEND_URING) {
+        ports->ports[id] = p;
+        SerialUringRegisterPort(p);
+        SerialUringArmRx(p);
+        return id;
+    }
+#endif
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.u64 = SerialPortTag(p, 0);
+    ports->syscalls++;
+    if (epoll_ctl(ports->epoll, EPOLL_CTL_ADD, p->handle, &ev) != 0) {
+        printf("add serial port fail\r\n");
+        SerialPortRelease(p);
+        return -1;
+    }
+    ports->ports[id] = p;
+    return id;
+}
+
+// 移除串口, 由管理器打开的串口同时关闭; 未写出的数据被丢弃
+void SerialPortsRemove(SerialPorts *ports, int port) {
+
+    SerialPort *p = SerialPortsGet(ports, port);
+
+    if (p == NULL) {
+        return;
+    }
+#ifdef SERIAL_HAVE_URING
+    // 内核中还有读写请求时先取消, 完成后再释放缓冲区
+    if (p->inflight > 0) {
+        if (!p->closed) {
+            SerialUringCancel(p);
+        }
+        p->removed = 1;
+        return;
+    }
+#endif
+    if (p == ports->current) {
+        p->removed = 1;
+        return;
+    }
+    ports->ports[port] = NULL;
+    SerialPortFree(p);
+}
+
+// 写出发送缓冲区, 按是否还有剩余调整 EPOLLOUT
+static void SerialPortFlush(SerialPort *p) {
+
+    long n;
+
+    while (p->tx_len > 0) {
+        n = SerialWrite(p->handle, p->tx + p->tx_off, p->tx_len);
+        p->owner->syscalls++;
+        if (n < 0) {
+            SerialPortClosed(p);
+            return;
+        }
+        if (n == 0) {
+            break;
+        }
+        p->stats.tx_writes++;
+        p->stats.tx_bytes += (unsigned long long)n;
+        p->tx_off += (size_t)n;
+        p->tx_len -= (size_t)n;
+    }
+    if (p->tx_len == 0) {
+        p->tx_off = 0;
+    }
+    if ((p->tx_len > 0) != p->watch_out) {
+        SerialPortWatch(p, p->tx_len > 0);
+    }
+}
+
+// 发送一条消息: 先直接写, 剩余部分进发送缓冲区; 放不下时整条丢弃并返回 -1
+// io_uring 后端只放进发送缓冲区, 在下一次 SerialPortsPoll 时提交
+int SerialPortsSend(SerialPorts *ports, int port, const void *data, size_t len) {
+
+    SerialPort *p = SerialPortsGet(ports, port);
+    const char *src = (const char *)data;
+    size_t space;
+    long n;
+
+    if (p == NULL || p->closed) {
+        return -1;
+    }
+    // 写请求在内核中时缓冲区不能移动, 只能追加在末尾
+    space = p->tx_inflight > 0 ? p->config.tx_size - p->tx_off - p->tx_len : p->config.tx_size - p->tx_len;
+    if (len > space) {
+        p->stats.tx_dropped++;
+        return -1;
+    }
+    // 缓冲区为空时不经过复制, 直接写串口
+    while (ports->backend == SERIAL_BACKEND_EPOLL && p->tx_len == 0 && len > 0) {
+        n = SerialWrite(p->handle, src, len);
+        ports->syscalls++;
+        if (n < 0) {
+            SerialPortClosed(p);
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        p->stats.tx_writes++;
+        p->stats.tx_bytes += (unsigned long long)n;
+        src += n;
+        len -= (size_t)n;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    if (p->tx_off + p->tx_len + len > p->config.tx_size) {
+        memmove(p->tx, p->tx + p->tx_off, p->tx_len);
+        p->tx_off = 0;
+    }
+    memcpy(p->tx + p->tx_off + p->tx_len, src, len);
+    p->tx_len += len;
+#ifdef SERIAL_HAVE_URING
+    if (ports->backend == SERIAL_BACKEND_URING) {
+        if (p->tx_inflight == 0) {
+            SerialUringArmTx(p);
+        }
+        return 0;
+    }
+#endif
+    if (!p->watch_out) {
+        SerialPortWatch(p, 1);
+    }
+    return 0;
+}
+
+// 处理所有串口的事件, 最多等待 timeout_ms 毫秒 (-1 一直等待), 返回分发的记录数, 出错返回 -1
+int SerialPortsPoll(SerialPorts *ports, int timeout_ms) {
+
+    struct epoll_event ev[SERIAL_PORTS_EVENTS];
+    SerialPort *p;
+    int n, i, id, r, records = 0;
+
+#ifdef SERIAL_HAVE_URING
+    if (ports->backend == SERIAL_BACKEND_URING) {
+        return SerialUringPoll(ports, timeout_ms);
+    }
+#endif
+    n = epoll_wait(ports->epoll, ev, SERIAL_PORTS_EVENTS, timeout_ms);
+    ports->syscalls++;
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    for (i = 0; i < n; i++) {
+        id = (int)((uint32_t)ev[i].data.u64 >> 2);
+        p = SerialPortsGet(ports, id);
+        // 同一批事件中前面的回调可能已经移除了这个串口
+        if (p == NULL || p->generation != (unsigned)(ev[i].data.u64 >> 32) || p->closed) {
+            continue;
+        }
+        // 回调 (包括 on_close) 中移除当前串口时推迟到处理完再释放
+        ports->current = p;
+        if (ev[i].events & EPOLLOUT) {
+            SerialPortFlush(p);
+        }
+        if (!p->closed && (ev[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+            p->stats.rx.wakeups++;
+            r = SerialReaderRead(p->reader);
+            if (r < 0) {
+                SerialPortClosed(p);
+            }
+            else {
+                records += r;
+            }
+        }
+        ports->current = NULL;
+        if (p->removed) {
+            ports->ports[id] = NULL;
+            SerialPortFree(p);
+        }
+    }
+    return records;
+}
+
+SerialHandle SerialPortsHandle(const SerialPorts *ports, int port) {
+    SerialPort *p = SerialPortsGet(ports, port);
+    return p != NULL ? p->handle : SERIAL_INVALID_HANDLE;
+}
+
+int SerialPortsGetStats(const SerialPorts *ports, int port, SerialPortStats *stats) {
+
+    SerialPort *p = SerialPortsGet(ports, port);
+
+    if (p == NULL) {
+        return -1;
+    }
+    *stats = p->stats;
+    SerialReaderGetStats(p->reader, &stats->rx);
+    // io_uring 后端的读由内核完成, 按完成事件计数
+    stats->rx.wakeups = p->stats.rx.wakeups;
+    if (ports->backend == SERIAL_BACKEND_URING) {
+        stats->rx.reads = stats->rx.wakeups = p->stats.rx.reads;
+    }
+    stats->tx_pending = p->tx_len;
+    return 0;
+}
+
+const char *SerialPortsBackend(const SerialPorts *ports) {
+#ifdef SERIAL_HAVE_URING
+    if (ports->backend == SERIAL_BACKEND_URING) {
+        return ports->fixed ? "io_uring (fixed buffers)" : ports->multishot ? "io_uring (multishot)" : "io_uring";
+    }
+#else
+    (void)ports;
+#endif
+    return "epoll";
+}
+
+// 事件循环发出的系统调用次数 (不含打开和关闭串口)
+unsigned long long SerialPortsSyscalls(const SerialPorts *ports) {
+
+    SerialReaderStats rx;
+    unsigned long long n = ports->syscalls;
+    int i;
+
+#ifdef SERIAL_HAVE_URING
+    if (ports->backend == SERIAL_BACKEND_URING) {
+        return SerialUringSyscalls(ports);
+    }
+#endif
+    for (i = 0; i < ports->max_ports; i++) {
+        if (ports->ports[i] != NULL) {
+            SerialReaderGetStats(ports->ports[i]->reader, &rx);
+            n += rx.reads;
+        }
+    }
+    return n;
+}
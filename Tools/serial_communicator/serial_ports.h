@@ -0,0 +1,54 @@
+// serial_ports.h
+#ifndef SERIAL_PORTS_H
+#define SERIAL_PORTS_H
+
+#include "serial_reader.h"
+
+// 单个串口的配置, 为 0 的字段使用默认值
+typedef struct {
+    const char *name;       // 设备路径, 由管理器打开和关闭; 为 NULL 时使用 handle
+    SerialHandle handle;    // 已打开的串口 (如 comHandle), 移除时不关闭
+    int baud;               // 默认 CBR_115200
+    int byteSize;           // 默认 8
+    int parity;             // NOPARITY ...
+    int stopBits;           // ONESTOPBIT ...
+    size_t ring_size;       // 接收缓冲区, 见 SerialReaderConfig (默认 1 MB)
+    int delimiter;          // SERIAL_SPLIT_*
+    size_t tx_size;         // 发送缓冲区字节数 (默认 65536)
+    void (*on_record)(int port, const SerialView *view, void *ctx);
+    void (*on_close)(int port, void *ctx);  // 对端关闭或读写出错, 可以为 NULL
+    void *ctx;
+    SerialCapture *capture; // 不为 NULL 时把收到的数据写入记录文件, 通道号为串口编号 (见 serial_capture.h)
+} SerialPortConfig;
+
+// 单个串口的统计
+typedef struct {
+    SerialReaderStats rx;
+    unsigned long long tx_bytes;    // 已写出的字节数
+    unsigned long long tx_writes;   // write 调用次数
+    unsigned long long tx_dropped;  // 发送缓冲区满被丢弃的消息数
+    size_t tx_pending;              // 发送缓冲区中还没写出的字节数
+    int closed;
+} SerialPortStats;
+
+// 事件循环的实现方式, 见 serial_ports.c
+#define SERIAL_BACKEND_EPOLL    0
+#define SERIAL_BACKEND_URING    1       // 运行需要 5.11 及以上的内核; 编译需要 Linux 5.19 及以上的 linux/io_uring.h (CMakeLists.txt 检查)
+#define SERIAL_BACKEND_AUTO     2       // 优先 io_uring, 不可用时 epoll
+
+typedef struct SerialPorts SerialPorts;
+
+SerialPorts *OpenSerialPorts(int max_ports);
+SerialPorts *OpenSerialPortsBackend(int max_ports, int backend);
+void CloseSerialPorts(SerialPorts *ports);
+int SerialPortsAdd(SerialPorts *ports, const SerialPortConfig *config);
+void SerialPortsRemove(SerialPorts *ports, int port);
+int SerialPortsSend(SerialPorts *ports, int port, const void *data, size_t len);
+int SerialPortsPoll(SerialPorts *ports, int timeout_ms);
+SerialHandle SerialPortsHandle(const SerialPorts *ports, int port);
+int SerialPortsGetStats(const SerialPorts *ports, int port, SerialPortStats *stats);
+const char *SerialPortsBackend(const SerialPorts *ports);
+unsigned long long SerialPortsSyscalls(const SerialPorts *ports);
+
+
+#endif /* Serial Ports */
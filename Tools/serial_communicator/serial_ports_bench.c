@@ -0,0 +1,231 @@
+// serial_ports_bench.c
+
+/*
+ * 多串口事件循环的对比测试（Linux，用 pty 对代替真实串口，不需要硬件）：
+ * 对每种后端（epoll、io_uring）分两个阶段：
+ *   接收：另一个线程向所有 pty 主端写入文本行，事件循环从从端接收并按行分发；
+ *   发送：事件循环通过 SerialPortsSend 向所有从端发送，另一个线程从主端读出。
+ * 报告吞吐量（MB/s、行/s）、事件循环每秒的系统调用次数，以及事件循环线程的 CPU 占用和每 MB 的 CPU 时间。
+ *
+ * 用法: serial_ports_bench [ports=32] [line=64] [seconds=2]
+ *     ports    pty 对数
+ *     line     每行字节数（含 '\n'）
+ *     seconds  每个阶段的时长
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "serial_ports.h"
+
+#define BENCH_MAX_PORTS     256
+#define BENCH_CHUNK         4096    // 每次写入 / 发送的字节数 (整行)
+
+typedef struct {
+    int ports;
+    SerialHandle masters[BENCH_MAX_PORTS];
+    char chunk[BENCH_CHUNK];
+    size_t chunk_len;
+    volatile int stop;
+    unsigned long long drained;     // 发送阶段主端读出的字节数
+} BenchPeers;
+
+static unsigned long long bench_bytes;
+static unsigned long long bench_lines;
+
+static double BenchSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// 当前线程 (事件循环) 的用户态 + 内核态 CPU 秒数
+static double BenchThreadCpu(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+}
+
+static void BenchOnLine(int port, const SerialView *view, void *ctx) {
+    (void)port;
+    (void)ctx;
+    bench_bytes += view->len + 1;
+    bench_lines++;
+}
+
+// 接收阶段: 尽快向所有主端写入
+static void *BenchProducer(void *arg) {
+
+    BenchPeers *peers = (BenchPeers *)arg;
+    struct pollfd fds[BENCH_MAX_PORTS];
+    int i;
+
+    while (!peers->stop) {
+        for (i = 0; i < peers->ports; i++) {
+            fds[i].fd = peers->masters[i];
+            fds[i].events = POLLOUT;
+        }
+        if (poll(fds, (nfds_t)peers->ports, 10) <= 0) {
+            continue;
+        }
+        for (i = 0; i < peers->ports; i++) {
+            // 只写整块, 保证每行完整
+            if ((fds[i].revents & POLLOUT) && write(peers->masters[i], peers->chunk, peers->chunk_len) < 0 && errno != EAGAIN) {
+                return NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+// 发送阶段: 尽快从所有主端读出
+static void *BenchDrainer(void *arg) {
+
+    BenchPeers *peers = (BenchPeers *)arg;
+    struct pollfd fds[BENCH_MAX_PORTS];
+    char buf[65536];
+    long n;
+    int i;
+
+    while (!peers->stop) {
+        for (i = 0; i < peers->ports; i++) {
+            fds[i].fd = peers->masters[i];
+            fds[i].events = POLLIN;
+        }
+        if (poll(fds, (nfds_t)peers->ports, 10) <= 0) {
+            continue;
+        }
+        for (i = 0; i < peers->ports; i++) {
+            while ((fds[i].revents & POLLIN) && (n = read(peers->masters[i], buf, sizeof(buf))) > 0) {
+                __atomic_add_fetch(&peers->drained, (unsigned long long)n, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void BenchReport(const char *backend, const char *phase, double bytes, double lines, double syscalls,
+                        double cpu, double sec) {
+    const double mb = bytes / 1e6;
+
+    printf("%-26s %-6s %10.1f %12.0f %12.0f %8.1f %10.2f\n", backend, phase, mb / sec, lines / sec, syscalls / sec,
+           100.0 * cpu / sec, mb > 0 ? 1e3 * cpu / mb : 0.0);
+}
+
+static int BenchRun(BenchPeers *peers, int backend, int line, double seconds) {
+
+    char names[BENCH_MAX_PORTS][64];
+    SerialPortConfig config;
+    SerialPorts *ports;
+    pthread_t thread;
+    unsigned long long sys0;
+    double t0, cpu0, sec;
+    int ids[BENCH_MAX_PORTS];
+    SerialPortStats stats;
+    int i;
+
+    ports = OpenSerialPortsBackend(peers->ports, backend);
+    if (ports == NULL) {
+        return -1;
+    }
+    memset(&config, 0, sizeof(config));
+    config.delimiter = SERIAL_SPLIT_LINE;
+    config.ring_size = 1 << 18;
+    config.on_record = BenchOnLine;
+    for (i = 0; i < peers->ports; i++) {
+        if (OpenVirtualSerial(&peers->masters[i], names[i], sizeof(names[i])) != 0) {
+            return -1;
+        }
+        fcntl(peers->masters[i], F_SETFL, fcntl(peers->masters[i], F_GETFL) | O_NONBLOCK);
+        config.name = names[i];
+        ids[i] = SerialPortsAdd(ports, &config);
+        if (ids[i] < 0) {
+            return -1;
+        }
+    }
+
+    // 接收
+    bench_bytes = bench_lines = 0;
+    peers->stop = 0;
+    pthread_create(&thread, NULL, BenchProducer, peers);
+    sys0 = SerialPortsSyscalls(ports);
+    cpu0 = BenchThreadCpu();
+    t0 = BenchSeconds();
+    while (BenchSeconds() - t0 < seconds) {
+        SerialPortsPoll(ports, 10);
+    }
+    sec = BenchSeconds() - t0;
+    BenchReport(SerialPortsBackend(ports), "rx", (double)bench_bytes, (double)bench_lines,
+                (double)(SerialPortsSyscalls(ports) - sys0), BenchThreadCpu() - cpu0, sec);
+    peers->stop = 1;
+    pthread_join(thread, NULL);
+
+    // 发送: 把每个串口的发送缓冲区补到一半, epoll 后端直接写满 pty 后才进缓冲区
+    peers->stop = 0;
+    peers->drained = 0;
+    pthread_create(&thread, NULL, BenchDrainer, peers);
+    sys0 = SerialPortsSyscalls(ports);
+    cpu0 = BenchThreadCpu();
+    t0 = BenchSeconds();
+    while (BenchSeconds() - t0 < seconds) {
+        for (i = 0; i < peers->ports; i++) {
+            while (SerialPortsGetStats(ports, ids[i], &stats) == 0 && stats.tx_pending < 32768 &&
+                   SerialPortsSend(ports, ids[i], peers->chunk, peers->chunk_len) == 0) {
+            }
+        }
+        SerialPortsPoll(ports, 10);
+    }
+    sec = BenchSeconds() - t0;
+    BenchReport(SerialPortsBackend(ports), "tx", (double)peers->drained, (double)peers->drained / line,
+                (double)(SerialPortsSyscalls(ports) - sys0), BenchThreadCpu() - cpu0, sec);
+    peers->stop = 1;
+    pthread_join(thread, NULL);
+
+    CloseSerialPorts(ports);
+    for (i = 0; i < peers->ports; i++) {
+        close(peers->masters[i]);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+
+    const int backends[] = { SERIAL_BACKEND_EPOLL, SERIAL_BACKEND_URING };
+    static BenchPeers peers;
+    const int line = argc > 2 ? atoi(argv[2]) : 64;
+    const double seconds = argc > 3 ? atof(argv[3]) : 2.0;
+    size_t i;
+
+    peers.ports = argc > 1 ? atoi(argv[1]) : 32;
+    if (peers.ports < 1 || peers.ports > BENCH_MAX_PORTS || line < 2 || line > BENCH_CHUNK || seconds <= 0) {
+        fprintf(stderr, "usage: %s [ports 1..%d] [line 2..%d] [seconds]\n", argv[0], BENCH_MAX_PORTS, BENCH_CHUNK);
+        return 1;
+    }
+    for (peers.chunk_len = 0; peers.chunk_len + (size_t)line <= BENCH_CHUNK; peers.chunk_len += (size_t)line) {
+        for (i = 0; i + 1 < (size_t)line; i++) {
+            peers.chunk[peers.chunk_len + i] = (char)('a' + i % 26);
+        }
+        peers.chunk[peers.chunk_len + i] = '\n';
+    }
+
+    printf("%d pty pairs, %d bytes per line, %.1f s per phase\n", peers.ports, line, seconds);
+    printf("%-26s %-6s %10s %12s %12s %8s %10s\n", "backend", "phase", "MB/s", "lines/s", "syscalls/s",
+           "cpu %", "cpu ms/MB");
+    for (i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if (BenchRun(&peers, backends[i], line, seconds) != 0) {
+            printf("%s: not available\r\n", backends[i] == SERIAL_BACKEND_URING ? "io_uring" : "epoll");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,282 @@
+// serial_ports_test.c
+
+/*
+ * serial_ports 的自动测试（ctest），openpty 创建的伪终端对代替真实串口，epoll 和 io_uring 两种后端各跑一遍
+ * （内核或编译环境不支持 io_uring 时跳过）：
+ *     多个串口的记录按串口编号交给 on_record，每个串口的内容和顺序不变；SerialPortsSend 写到对应的串口
+ *     回调中移除同一批事件中的另一个串口和当前串口、加入新串口：被移除的串口不再分发记录，
+ *     新串口即使复用了编号也收不到旧串口的数据，由管理器打开的串口被关闭
+ *     对端关闭时调用 on_close，on_close 中可以移除该串口
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+#include "serial_ports.h"
+#include "serial_test.h"
+
+#define TEST_PORTS      4
+#define TEST_LINES      100
+#define TEST_MAX_PORTS  8
+
+typedef struct {
+    int port;
+    char text[32];
+} TestRecord;
+
+typedef struct {
+    SerialPorts *ports;
+    TestRecord records[TEST_PORTS * TEST_LINES * 2];
+    int count;
+    int closes;
+    int closed_port;
+    // 回调中的操作
+    int remove_in_record;   // 收到这个串口的记录时移除 remove_other 和自己, 再加入 add_name
+    int remove_other;
+    const char *add_name;
+    int added;
+} TestCtx;
+
+static void TestOnRecord(int port, const SerialView *view, void *ctx);
+static void TestOnClose(int port, void *ctx);
+
+static int TestAdd(TestCtx *t, const char *name) {
+
+    SerialPortConfig config;
+
+    memset(&config, 0, sizeof(config));
+    config.name = name;
+    config.delimiter = SERIAL_SPLIT_LINE;
+    config.on_record = TestOnRecord;
+    config.on_close = TestOnClose;
+    config.ctx = t;
+    return SerialPortsAdd(t->ports, &config);
+}
+
+static void TestOnRecord(int port, const SerialView *view, void *ctx) {
+
+    TestCtx *t = (TestCtx *)ctx;
+    TestRecord *r;
+
+    if (t->count < (int)(sizeof(t->records) / sizeof(t->records[0]))) {
+        r = &t->records[t->count++];
+        r->port = port;
+        snprintf(r->text, sizeof(r->text), "%.*s", (int)view->len, view->data);
+    }
+    if (port == t->remove_in_record) {
+        t->remove_in_record = -1;
+        SerialPortsRemove(t->ports, t->remove_other);
+        SerialPortsRemove(t->ports, port);
+        t->added = TestAdd(t, t->add_name);
+    }
+}
+
+static void TestOnClose(int port, void *ctx) {
+
+    TestCtx *t = (TestCtx *)ctx;
+
+    t->closes++;
+    t->closed_port = port;
+    SerialPortsRemove(t->ports, port);
+}
+
+// 调用 SerialPortsPoll 直到 cond 成立, 最多约 2 秒
+#define TEST_POLL_UNTIL(t, cond) do { \
+        int poll_i_; \
+        for (poll_i_ = 0; poll_i_ < 200 && !(cond); poll_i_++) { \
+            SerialPortsPoll((t)->ports, 10); \
+        } \
+    } while (0)
+
+static int TestOpenPty(int *master, char *name) {
+
+    int slave;
+
+    if (openpty(master, &slave, name, NULL, NULL) != 0) {
+        printf("openpty fail\r\n");
+        serial_test_failures++;
+        return -1;
+    }
+    close(slave);
+    return 0;
+}
+
+// 从主端读 len 字节, 超时返回已读字节数
+static size_t TestRead(int master, char *buf, size_t len, int timeout_ms) {
+
+    struct pollfd pfd;
+    size_t got = 0;
+    ssize_t n;
+
+    pfd.fd = master;
+    pfd.events = POLLIN;
+    while (got < len && poll(&pfd, 1, timeout_ms) > 0) {
+        n = read(master, buf + got, len - got);
+        if (n <= 0) {
+            break;
+        }
+        got += (size_t)n;
+    }
+    return got;
+}
+
+// 从端被关闭后主端 read 返回 -1 (EIO) 或挂断
+static int TestSlaveClosed(int master) {
+
+    struct pollfd pfd;
+    char c;
+
+    pfd.fd = master;
+    pfd.events = POLLIN;
+    return poll(&pfd, 1, 0) > 0 && ((pfd.revents & POLLHUP) || read(master, &c, 1) < 0);
+}
+
+static int TestCount(const TestCtx *t, int port, const char *text) {
+
+    int i, n = 0;
+
+    for (i = 0; i < t->count; i++) {
+        if ((port < 0 || t->records[i].port == port) && (text == NULL || strcmp(t->records[i].text, text) == 0)) {
+            n++;
+        }
+    }
+    return n;
+}
+
+static void TestBackend(int backend) {
+
+    static TestCtx t;
+    int master[TEST_PORTS + 1], id[TEST_PORTS + 1];
+    char name[TEST_PORTS + 1][256], line[64], got[64];
+    int i, k, n, ok;
+
+    memset(&t, 0, sizeof(t));
+    t.remove_in_record = -1;
+    t.ports = OpenSerialPortsBackend(TEST_MAX_PORTS, backend);
+    if (t.ports == NULL) {
+        if (backend == SERIAL_BACKEND_URING) {
+            printf("io_uring not available, skipped\r\n");
+            return;
+        }
+        serial_test_failures++;
+        return;
+    }
+    printf("backend: %s\r\n", SerialPortsBackend(t.ports));
+    for (i = 0; i <= TEST_PORTS; i++) {
+        if (TestOpenPty(&master[i], name[i]) != 0) {
+            CloseSerialPorts(t.ports);
+            return;
+        }
+    }
+    for (i = 0; i < TEST_PORTS; i++) {
+        id[i] = TestAdd(&t, name[i]);
+        SERIAL_CHECK(id[i] == i);
+    }
+
+    // 各串口交替收到多行, 按编号分发, 顺序不变
+    for (k = 0; k < TEST_LINES; k++) {
+        for (i = 0; i < TEST_PORTS; i++) {
+            n = snprintf(line, sizeof(line), "port%d line%d\n", i, k);
+            SERIAL_CHECK(write(master[i], line, (size_t)n) == n);
+        }
+    }
+    TEST_POLL_UNTIL(&t, t.count >= TEST_PORTS * TEST_LINES);
+    SERIAL_CHECK(t.count == TEST_PORTS * TEST_LINES);
+    for (i = 0; i < TEST_PORTS; i++) {
+        ok = TestCount(&t, id[i], NULL) == TEST_LINES;
+        for (k = 0, n = 0; ok && n < t.count; n++) {
+            if (t.records[n].port != id[i]) {
+                continue;
+            }
+            snprintf(line, sizeof(line), "port%d line%d", i, k++);
+            ok = strcmp(t.records[n].text, line) == 0;
+        }
+        SERIAL_CHECK(ok);
+    }
+
+    // 发送: io_uring 后端在下一次 SerialPortsPoll 时提交
+    for (i = 0; i < TEST_PORTS; i++) {
+        n = snprintf(line, sizeof(line), "reply%d\n", i);
+        SERIAL_CHECK(SerialPortsSend(t.ports, id[i], line, (size_t)n) == 0);
+    }
+    SerialPortsPoll(t.ports, 0);
+    for (i = 0; i < TEST_PORTS; i++) {
+        n = snprintf(line, sizeof(line), "reply%d\n", i);
+        SERIAL_CHECK(TestRead(master[i], got, (size_t)n, 1000) == (size_t)n && memcmp(got, line, (size_t)n) == 0);
+    }
+
+    // 串口 0 和 1 的数据在同一次 SerialPortsPoll 中到达, 串口 0 的回调移除 1 和 0 并加入新串口
+    t.count = 0;
+    t.remove_in_record = id[0];
+    t.remove_other = id[1];
+    t.add_name = name[TEST_PORTS];
+    t.added = -1;
+    SERIAL_CHECK(write(master[0], "first\n", 6) == 6);
+    SERIAL_CHECK(write(master[1], "gone\n", 5) == 5);
+    usleep(20000);
+    TEST_POLL_UNTIL(&t, t.added >= 0);
+    SERIAL_CHECK(t.added >= 0);
+    id[TEST_PORTS] = t.added;
+    SERIAL_CHECK(SerialPortsHandle(t.ports, id[TEST_PORTS]) != SERIAL_INVALID_HANDLE);
+    // 从端已被关闭, 之后写入主端的数据 (写入失败也可以) 没有串口接收
+    if (write(master[0], "late\n", 5) < 0) {
+        SERIAL_CHECK(TestSlaveClosed(master[0]));
+    }
+    SERIAL_CHECK(write(master[TEST_PORTS], "new\n", 4) == 4);
+    TEST_POLL_UNTIL(&t, TestCount(&t, -1, "new") > 0);
+    for (k = 0; k < 20; k++) {
+        SerialPortsPoll(t.ports, 5);
+    }
+    SERIAL_CHECK(TestCount(&t, id[TEST_PORTS], "new") == 1);
+    SERIAL_CHECK(TestCount(&t, -1, "gone") == 0);
+    SERIAL_CHECK(TestCount(&t, -1, "late") == 0);
+    SERIAL_CHECK(TestCount(&t, id[0], "first") == 1);
+    SERIAL_CHECK(t.count == 2);
+    SERIAL_CHECK(TestSlaveClosed(master[0]));
+    SERIAL_CHECK(TestSlaveClosed(master[1]));
+    if (id[TEST_PORTS] != id[0]) {
+        SERIAL_CHECK(SerialPortsHandle(t.ports, id[0]) == SERIAL_INVALID_HANDLE);
+    }
+    if (id[TEST_PORTS] != id[1]) {
+        SERIAL_CHECK(SerialPortsHandle(t.ports, id[1]) == SERIAL_INVALID_HANDLE);
+    }
+    SERIAL_CHECK(SerialPortsSend(t.ports, id[1] == id[TEST_PORTS] ? id[0] : id[1], "x", 1) == -1);
+
+    // 对端关闭: on_close 中移除
+    close(master[2]);
+    master[2] = -1;
+    TEST_POLL_UNTIL(&t, t.closes > 0);
+    SERIAL_CHECK(t.closes == 1 && t.closed_port == id[2]);
+    for (k = 0; k < 10; k++) {
+        SerialPortsPoll(t.ports, 5);
+    }
+    SERIAL_CHECK(SerialPortsHandle(t.ports, id[2]) == SERIAL_INVALID_HANDLE);
+
+    // 其余串口不受影响
+    t.count = 0;
+    SERIAL_CHECK(write(master[3], "still\n", 6) == 6);
+    TEST_POLL_UNTIL(&t, t.count > 0);
+    SERIAL_CHECK(TestCount(&t, id[3], "still") == 1);
+
+    CloseSerialPorts(t.ports);
+    SERIAL_CHECK(TestSlaveClosed(master[3]));
+    for (i = 0; i <= TEST_PORTS; i++) {
+        if (master[i] >= 0) {
+            close(master[i]);
+        }
+    }
+}
+
+int main(void) {
+
+    TestBackend(SERIAL_BACKEND_EPOLL);
+    TestBackend(SERIAL_BACKEND_URING);
+    return SERIAL_TEST_RESULT;
+}
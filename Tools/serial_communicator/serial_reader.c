@@ -0,0 +1,314 @@
+// serial_reader.c
+
+/*
+ * 串口接收（Linux）：
+ * 串口设为非阻塞，用边沿触发的 epoll 等待数据，数据直接读进一个大的环形缓冲区，
+ * 按分隔符切出完整的行或帧后，把指向缓冲区的视图交给回调，不做复制。
+ *
+ * 环形缓冲区把同一块内存（memfd）连续映射两次，读写位置跨过缓冲区末尾时地址仍然连续，
+ * 所以 read 可以一次填满全部空闲空间，跨越末尾的记录也能作为一段连续内存交给回调。
+ *
+ * 一次 read 尽量读满空闲空间：数据越密集，每次读到的越多，系统调用次数和唤醒次数越少。
+ * 边沿触发时必须读到 EAGAIN 为止：tty 的数据先进 flip 缓冲区再转入行规程，
+ * read 没有读满并不代表已经读空。
+ * 单条记录超过缓冲区大小时丢弃到下一个分隔符，计入 overruns。
+ *
+ * 示例：
+ * #include "serial_reader.h"
+ * #include "serial_frame.h"
+ *
+ * static void on_line(const SerialView *view, void *ctx) {
+ *     printf("%.*s\n", (int)view->len, view->data);
+ * }
+ *
+ * int main() {
+ *     SerialReaderConfig config = { 0 };
+ *     SerialReader *reader;
+ *
+ *     Useserial();
+ *     config.delimiter = SERIAL_SPLIT_LINE;
+ *     config.on_record = on_line;
+ *     reader = OpenSerialReader(comHandle, &config);
+ *     while (SerialReaderPoll(reader, 1000) >= 0) {
+ *     }
+ *     CloseSerialReader(reader);
+ *     CloseSerial(comHandle);
+ *     return 0;
+ * }
+ *
+ * 接收二进制帧时 delimiter 设为 SERIAL_SPLIT_FRAME，在回调中调用
+ * SerialFrameDecode(&dec, view->data, view->len + 1)，帧从环形缓冲区直接解码。
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include "serial_reader.h"
+
+struct SerialReader {
+    SerialHandle comHandle;
+    SerialReaderConfig config;
+    int epoll;
+    int flags;              // 打开前的文件状态标志, 关闭时恢复
+    char *ring;             // 2 * size 的映射, 后一半是前一半的镜像
+    size_t size;
+    size_t mask;
+    size_t head;            // 写入位置 (累计字节数)
+    size_t tail;            // 下一条记录的起点
+    size_t scan;            // 已查找过分隔符的位置
+    int discard;            // 记录超长, 丢弃到下一个分隔符
+    int closed;
+    SerialReaderStats stats;
+};
+
+// 把同一块共享内存连续映射两次
+static char *SerialRingMap(size_t size) {
+
+    char *base, *lo, *hi;
+    int fd;
+
+    fd = memfd_create("serial_ring", MFD_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+    base = (char *)mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    lo = (char *)mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    hi = (char *)mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);
+    if (lo != base || hi != base + size) {
+        munmap(base, 2 * size);
+        return NULL;
+    }
+    return base;
+}
+
+SerialReader *OpenSerialReader(SerialHandle comHandle, const SerialReaderConfig *config) {
+
+    SerialReader *r;
+    size_t size;
+
+    r = (SerialReader *)calloc(1, sizeof(SerialReader));
+    if (r == NULL) {
+        return NULL;
+    }
+    if (config != NULL) {
+        r->config = *config;
+    }
+    if (r->config.ring_size == 0) {
+        r->config.ring_size = 1 << 20;
+    }
+    size = (size_t)sysconf(_SC_PAGESIZE);
+    while (size < r->config.ring_size) {
+        size <<= 1;
+    }
+    r->config.ring_size = size;
+    r->size = size;
+    r->mask = size - 1;
+    r->comHandle = comHandle;
+    r->epoll = -1;
+
+    r->ring = SerialRingMap(size);
+    if (r->ring == NULL) {
+        printf("ring buffer mmap fail\r\n");
+        free(r);
+        return NULL;
+    }
+
+    r->flags = fcntl(comHandle, F_GETFL);
+    if (r->flags < 0 || fcntl(comHandle, F_SETFL, r->flags | O_NONBLOCK) != 0) {
+        printf("set nonblocking fail: %s\r\n", strerror(errno));
+        CloseSerialReader(r);
+        return NULL;
+    }
+    return r;
+}
+
+void CloseSerialReader(SerialReader *reader) {
+    if (reader == NULL) {
+        return;
+    }
+    if (reader->flags >= 0) {
+        fcntl(reader->comHandle, F_SETFL, reader->flags);
+    }
+    if (reader->epoll >= 0) {
+        close(reader->epoll);
+    }
+    munmap(reader->ring, 2 * reader->size);
+    free(reader);
+}
+
+// 分发 [tail, head) 中的完整记录, 返回分发的记录数
+static int SerialReaderSplit(SerialReader *r) {
+
+    const int delimiter = r->config.delimiter;
+    SerialView view;
+    const char *start, *p, *end, *hit;
+    int records = 0;
+
+    if (delimiter < 0) {
+        if (r->head != r->tail && r->config.on_record != NULL) {
+            view.data = r->ring + (r->tail & r->mask);
+            view.len = r->head - r->tail;
+            r->config.on_record(&view, r->config.ctx);
+            records++;
+        }
+        r->tail = r->scan = r->head;
+        r->stats.records += (unsigned long long)records;
+        return records;
+    }
+
+    // 以记录起点为基址, 到 head 的距离不超过 size, 落在两次映射内
+    start = r->ring + (r->tail & r->mask);
+    p = start + (r->scan - r->tail);
+    end = start + (r->head - r->tail);
+    while ((hit = (const char *)memchr(p, delimiter, (size_t)(end - p))) != NULL) {
+        view.data = start;
+        view.len = (size_t)(hit - start);
+        if (r->discard) {
+            r->discard = 0;
+        }
+        else {
+            if (delimiter == '\n' && view.len > 0 && view.data[view.len - 1] == '\r') {
+                view.len--;
+            }
+            if (r->config.on_record != NULL) {
+                r->config.on_record(&view, r->config.ctx);
+            }
+            records++;
+        }
+        r->tail += (size_t)(hit - start) + 1;
+        start = p = hit + 1;
+    }
+    r->scan = r->head;
+    r->stats.records += (unsigned long long)records;
+    return records;
+}
+
+// 空闲空间的起点和大小 (一段连续内存); 缓冲区被一条未结束的记录占满时丢弃该记录
+char *SerialReaderBuffer(SerialReader *reader, size_t *space) {
+
+    SerialReader *r = reader;
+
+    *space = r->size - (r->head - r->tail);
+    if (*space == 0) {
+        if (!r->discard) {
+            r->discard = 1;
+            r->stats.overruns++;
+        }
+        r->tail = r->scan = r->head;
+        *space = r->size;
+    }
+    return r->ring + (r->head & r->mask);
+}
+
+// 已向 SerialReaderBuffer 返回的空间写入 len 字节, 分发其中的完整记录, 返回分发的记录数
+int SerialReaderCommit(SerialReader *reader, size_t len) {
+    reader->stats.bytes += (unsigned long long)len;
+    if (reader->config.capture != NULL && len > 0) {
+        SerialCaptureWrite(reader->config.capture, reader->config.channel, reader->ring + (reader->head & reader->mask), len);
+    }
+    reader->head += len;
+    return SerialReaderSplit(reader);
+}
+
+// 环形缓冲区的整个映射 (含镜像), 用于向 io_uring 注册
+char *SerialReaderMemory(const SerialReader *reader, size_t *len) {
+    *len = 2 * reader->size;
+    return reader->ring;
+}
+
+// 读出当前可读的全部数据并分发, 返回分发的记录数, 对端关闭或出错返回 -1
+int SerialReaderRead(SerialReader *reader) {
+
+    SerialReader *r = reader;
+    size_t space;
+    ssize_t n;
+    int records = 0;
+
+    char *buf;
+
+    if (r->closed) {
+        return -1;
+    }
+    for (;;) {
+        buf = SerialReaderBuffer(r, &space);
+        n = read(r->comHandle, buf, space);
+        r->stats.reads++;
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            // 伪终端对端关闭时返回 EIO
+            r->closed = 1;
+            break;
+        }
+        if (n == 0) {
+            r->closed = 1;
+            break;
+        }
+        records += SerialReaderCommit(r, (size_t)n);
+    }
+    return records > 0 || !r->closed ? records : -1;
+}
+
+// 等待数据最多 timeout_ms 毫秒 (-1 一直等待), 返回分发的记录数, 超时返回 0, 对端关闭或出错返回 -1
+int SerialReaderPoll(SerialReader *reader, int timeout_ms) {
+
+    struct epoll_event ev;
+    int n;
+
+    if (reader->closed) {
+        return -1;
+    }
+    // 由 SerialPorts 等外部事件循环调用 SerialReaderRead 时不需要自己的 epoll
+    if (reader->epoll < 0) {
+        reader->epoll = epoll_create1(EPOLL_CLOEXEC);
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = reader;
+        if (reader->epoll < 0 || epoll_ctl(reader->epoll, EPOLL_CTL_ADD, reader->comHandle, &ev) != 0) {
+            printf("epoll setup fail: %s\r\n", strerror(errno));
+            if (reader->epoll >= 0) {
+                close(reader->epoll);
+                reader->epoll = -1;
+            }
+            return -1;
+        }
+    }
+    n = epoll_wait(reader->epoll, &ev, 1, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    reader->stats.wakeups++;
+    return SerialReaderRead(reader);
+}
+
+SerialHandle SerialReaderHandle(const SerialReader *reader) {
+    return reader->comHandle;
+}
+
+void SerialReaderGetStats(const SerialReader *reader, SerialReaderStats *stats) {
+    *stats = reader->stats;
+}
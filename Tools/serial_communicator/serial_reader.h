@@ -0,0 +1,54 @@
+// serial_reader.h
+#ifndef SERIAL_READER_H
+#define SERIAL_READER_H
+
+#include "serial_communicator.h"
+#include "serial_capture.h"
+
+// 分割方式
+#define SERIAL_SPLIT_LINE       '\n'    // 按行, 去掉行尾的 "\r\n" 或 "\n"
+#define SERIAL_SPLIT_FRAME      0       // 按 COBS 帧分隔符 0x00, 见 serial_frame.h
+#define SERIAL_SPLIT_NONE       (-1)    // 不分割, 每次读到的数据作为一段
+
+// 一条完整记录, data 指向环形缓冲区, 只在回调期间有效
+// data 之后紧跟分隔符 (行模式下可能是 "\r\n"), 帧模式下可以把 len + 1 字节直接交给 SerialFrameDecode
+typedef struct {
+    const char *data;
+    size_t len;
+} SerialView;
+
+// 配置, 为 0 的字段使用默认值
+typedef struct {
+    size_t ring_size;       // 环形缓冲区字节数, 向上取 2 的幂且不小于页大小 (默认 1 MB), 也是单条记录的最大长度
+    int delimiter;          // SERIAL_SPLIT_*, 或任意分隔字节
+    void (*on_record)(const SerialView *view, void *ctx);
+    void *ctx;
+    SerialCapture *capture; // 不为 NULL 时把读到的原始数据写入记录文件, 见 serial_capture.h
+    int channel;            // 写入记录文件的通道号
+} SerialReaderConfig;
+
+// 统计
+typedef struct {
+    unsigned long long bytes;       // 已读取的字节数
+    unsigned long long reads;       // read 调用次数 (含返回 EAGAIN 的)
+    unsigned long long records;     // 已分发的记录数
+    unsigned long long overruns;    // 超过 ring_size 被丢弃的记录数
+    unsigned long long wakeups;     // epoll 唤醒次数
+} SerialReaderStats;
+
+typedef struct SerialReader SerialReader;
+
+SerialReader *OpenSerialReader(SerialHandle comHandle, const SerialReaderConfig *config);
+void CloseSerialReader(SerialReader *reader);
+int SerialReaderRead(SerialReader *reader);
+int SerialReaderPoll(SerialReader *reader, int timeout_ms);
+SerialHandle SerialReaderHandle(const SerialReader *reader);
+void SerialReaderGetStats(const SerialReader *reader, SerialReaderStats *stats);
+
+// 由其他 I/O 方式 (如 io_uring) 直接读入环形缓冲区
+char *SerialReaderBuffer(SerialReader *reader, size_t *space);
+int SerialReaderCommit(SerialReader *reader, size_t len);
+char *SerialReaderMemory(const SerialReader *reader, size_t *len);
+
+
+#endif /* Serial Reader */
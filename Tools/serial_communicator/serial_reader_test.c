@@ -0,0 +1,224 @@
+// serial_reader_test.c
+
+/*
+ * serial_reader 的自动测试（ctest），openpty 创建的伪终端对代替真实串口：
+ *     按行分割（去掉 "\r\n"）、按帧分割、不分割，记录跨过环形缓冲区末尾时内容连续
+ *     超过缓冲区大小的记录丢弃到下一个分隔符，计入 overruns，之后的记录照常分发
+ *     （SerialReaderBuffer / SerialReaderCommit 直接写入，以及经伪终端 read 两种方式）
+ *     对端关闭后 SerialReaderPoll 返回 -1
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pty.h>
+#include <unistd.h>
+#include "serial_reader.h"
+#include "serial_test.h"
+
+#define TEST_RING   4096    // 向上取到页大小
+
+// 收到的记录, 每条之后加 '|'
+typedef struct {
+    char text[1 << 16];
+    size_t len;
+    int records;
+} TestRecords;
+
+static void TestOnRecord(const SerialView *view, void *ctx) {
+
+    TestRecords *rx = (TestRecords *)ctx;
+
+    if (rx->len + view->len + 1 <= sizeof(rx->text)) {
+        memcpy(rx->text + rx->len, view->data, view->len);
+        rx->len += view->len;
+        rx->text[rx->len++] = '|';
+    }
+    rx->records++;
+}
+
+static int TestText(const TestRecords *rx, const char *text) {
+    return rx->len == strlen(text) && memcmp(rx->text, text, rx->len) == 0;
+}
+
+// 直接写入环形缓冲区
+static size_t TestPut(SerialReader *reader, const char *data, size_t len) {
+
+    size_t space, n, total = 0;
+    char *buf;
+
+    while (total < len) {
+        buf = SerialReaderBuffer(reader, &space);
+        n = len - total < space ? len - total : space;
+        memcpy(buf, data + total, n);
+        SerialReaderCommit(reader, n);
+        total += n;
+    }
+    return total;
+}
+
+static SerialReader *TestOpen(int fd, int delimiter, TestRecords *rx) {
+
+    SerialReaderConfig config;
+
+    memset(&config, 0, sizeof(config));
+    config.ring_size = TEST_RING;
+    config.delimiter = delimiter;
+    config.on_record = TestOnRecord;
+    config.ctx = rx;
+    memset(rx, 0, sizeof(*rx));
+    return OpenSerialReader(fd, &config);
+}
+
+static void TestSplit(int fd) {
+
+    static TestRecords rx;
+    static char line[3 * TEST_RING];
+    SerialReaderStats stats;
+    SerialReader *reader;
+    size_t i, total = 0;
+    int n;
+
+    // 按行: "\r\n" 和 "\n" 都去掉, 空行也是一条记录
+    reader = TestOpen(fd, SERIAL_SPLIT_LINE, &rx);
+    SERIAL_CHECK(reader != NULL);
+    if (reader == NULL) {
+        return;
+    }
+    TestPut(reader, "a=1\r\nb=", 7);
+    SERIAL_CHECK(TestText(&rx, "a=1|"));
+    TestPut(reader, "2\n\r\n\nc", 6);
+    SERIAL_CHECK(TestText(&rx, "a=1|b=2|||"));
+
+    // 跨过缓冲区末尾的记录: 长度 1 ~ 199 的行, 累计数倍于缓冲区
+    rx.len = 0;
+    rx.records = 0;
+    TestPut(reader, "\n", 1);
+    for (n = 1; n < 200; n++) {
+        for (i = 0; i < (size_t)n; i++) {
+            line[i] = (char)('a' + (n + i) % 26);
+        }
+        line[n] = '\n';
+        TestPut(reader, line, (size_t)n + 1);
+        total += (size_t)n + 1;
+        if (rx.len < (size_t)n + 1 || memcmp(rx.text + rx.len - (size_t)n - 1, line, (size_t)n) != 0) {
+            printf("line %d fail\r\n", n);
+            serial_test_failures++;
+            break;
+        }
+        rx.len = 0;
+    }
+    SERIAL_CHECK(total > 4 * TEST_RING);
+    SERIAL_CHECK(rx.records == 200);
+
+    // 超长记录: 丢弃到下一个分隔符, 前后的记录不受影响
+    rx.len = 0;
+    memset(line, 'x', sizeof(line));
+    TestPut(reader, "before\n", 7);
+    TestPut(reader, line, sizeof(line));
+    TestPut(reader, "tail\nafter\n", 11);
+    SERIAL_CHECK(TestText(&rx, "before|after|"));
+    // 正好填满缓冲区的记录也被丢弃
+    rx.len = 0;
+    TestPut(reader, line, TEST_RING);
+    TestPut(reader, "\nnext\n", 6);
+    SERIAL_CHECK(TestText(&rx, "next|"));
+    SerialReaderGetStats(reader, &stats);
+    SERIAL_CHECK(stats.overruns == 2);
+    CloseSerialReader(reader);
+
+    // 按帧: 0x00 分隔
+    reader = TestOpen(fd, SERIAL_SPLIT_FRAME, &rx);
+    if (reader != NULL) {
+        TestPut(reader, "ab\0c\0\0d", 7);
+        SERIAL_CHECK(TestText(&rx, "ab|c||"));
+        CloseSerialReader(reader);
+    }
+
+    // 不分割: 每次写入的数据一段
+    reader = TestOpen(fd, SERIAL_SPLIT_NONE, &rx);
+    if (reader != NULL) {
+        TestPut(reader, "ab\n", 3);
+        TestPut(reader, "c", 1);
+        SERIAL_CHECK(TestText(&rx, "ab\n|c|"));
+        CloseSerialReader(reader);
+    }
+}
+
+// 经伪终端: 超长行被 read 填满缓冲区后丢弃
+static void TestPty(void) {
+
+    static TestRecords rx;
+    static char line[3 * TEST_RING];
+    SerialReaderStats stats;
+    SerialReader *reader;
+    SerialHandle fd;
+    char name[256];
+    size_t off, n;
+    int master, slave, i;
+
+    if (openpty(&master, &slave, name, NULL, NULL) != 0) {
+        printf("openpty fail\r\n");
+        serial_test_failures++;
+        return;
+    }
+    close(slave);
+    fd = OpenSerial(name, CBR_115200, 8, NOPARITY, ONESTOPBIT);
+    SERIAL_CHECK(fd != SERIAL_INVALID_HANDLE);
+    if (fd == SERIAL_INVALID_HANDLE) {
+        close(master);
+        return;
+    }
+    reader = TestOpen(fd, SERIAL_SPLIT_LINE, &rx);
+    SERIAL_CHECK(reader != NULL);
+    if (reader == NULL) {
+        CloseSerialQuiet(fd);
+        close(master);
+        return;
+    }
+
+    memset(line, 'y', sizeof(line));
+    memcpy(line, "first\r\n", 7);
+    memcpy(line + sizeof(line) - 12, "\nlast=1\r\n", 9);
+    n = sizeof(line) - 3;
+    // 分块写入, 每块之后读空, 不让伪终端缓冲区写满
+    for (off = 0; off < n; off += 512) {
+        SERIAL_CHECK(write(master, line + off, n - off < 512 ? n - off : 512) > 0);
+        SerialReaderGetStats(reader, &stats);
+        for (i = 0; i < 100 && stats.bytes < off + 512 && stats.bytes < n; i++) {
+            SerialReaderPoll(reader, 10);
+            SerialReaderGetStats(reader, &stats);
+        }
+    }
+    SERIAL_CHECK(TestText(&rx, "first|last=1|"));
+    SERIAL_CHECK(stats.overruns == 1);
+    SERIAL_CHECK(stats.bytes == n);
+    SERIAL_CHECK(stats.records == 2);
+
+    // 对端关闭
+    close(master);
+    for (i = 0; i < 100 && SerialReaderPoll(reader, 10) >= 0; i++) {
+    }
+    SERIAL_CHECK(SerialReaderPoll(reader, 0) == -1);
+    CloseSerialReader(reader);
+    CloseSerialQuiet(fd);
+}
+
+int main(void) {
+
+    int fds[2];
+
+    // 直接写入环形缓冲区时只需要一个可以设为非阻塞的描述符
+    if (pipe(fds) != 0) {
+        return 1;
+    }
+    TestSplit(fds[0]);
+    close(fds[0]);
+    close(fds[1]);
+    TestPty();
+    return SERIAL_TEST_RESULT;
+}
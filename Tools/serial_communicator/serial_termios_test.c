@@ -0,0 +1,167 @@
+// serial_termios_test.c
+
+/*
+ * POSIX termios 后端的自动测试（ctest），用 openpty 创建的伪终端对代替真实串口：
+ *     OpenSerial 打开从端，SendMessageToSerial 写出，在主端读回
+ *     OpenSerial 设置的原始模式、停止位和波特率（伪终端驱动固定为 8 位无校验，数据位和校验位无法在这里检查）
+ *     SerialSetCustomBaud 设置非标准波特率并读回确认
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#include "serial_communicator.h"
+#include "serial_test.h"
+
+// 从主端读 len 字节, 最多等待 1 秒
+static size_t TestRead(int fd, char *buf, size_t len) {
+
+    struct pollfd pfd;
+    size_t got = 0;
+    ssize_t n;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    while (got < len && poll(&pfd, 1, 1000) > 0) {
+        n = read(fd, buf + got, len - got);
+        if (n <= 0) {
+            break;
+        }
+        got += (size_t)n;
+    }
+    return got;
+}
+
+static void TestRoundTrip(int master, const char *name) {
+
+    const char *msg = "value=10\r\nline without \\r\\n translation\n";
+    char buf[128];
+    size_t len = strlen(msg);
+
+    comHandle = OpenSerial(name, CBR_115200, 8, NOPARITY, ONESTOPBIT);
+    SERIAL_CHECK(comHandle != SERIAL_INVALID_HANDLE);
+    if (comHandle == SERIAL_INVALID_HANDLE) {
+        return;
+    }
+    SendMessageToSerial(msg);
+    SERIAL_CHECK(TestRead(master, buf, len) == len);
+    SERIAL_CHECK(memcmp(buf, msg, len) == 0);
+
+    // 反方向: 原始模式下从端逐字节收到, 不等行尾
+    SERIAL_CHECK(write(master, "ab", 2) == 2);
+    SERIAL_CHECK(TestRead(comHandle, buf, 2) == 2);
+    SERIAL_CHECK(memcmp(buf, "ab", 2) == 0);
+    CloseSerialQuiet(comHandle);
+    comHandle = SERIAL_INVALID_HANDLE;
+}
+
+// 每次 OpenSerial 用一对新的伪终端: OpenSerial 设置了 TIOCEXCL, 非 root 用户不能再次打开同一从端
+static int TestPty(int *master, char *name) {
+
+    int slave;
+
+    if (openpty(master, &slave, name, NULL, NULL) != 0) {
+        printf("openpty fail\r\n");
+        return -1;
+    }
+    close(slave);
+    return 0;
+}
+
+static void TestRawMode(void) {
+
+    struct termios tio;
+    SerialHandle fd;
+    char name[256];
+    int master;
+
+    if (TestPty(&master, name) != 0) {
+        serial_test_failures++;
+        return;
+    }
+    fd = OpenSerial(name, CBR_9600, 7, EVENPARITY, TWOSTOPBITS);
+    SERIAL_CHECK(fd != SERIAL_INVALID_HANDLE);
+    if (fd != SERIAL_INVALID_HANDLE) {
+        SERIAL_CHECK(tcgetattr(fd, &tio) == 0);
+        SERIAL_CHECK((tio.c_lflag & (ICANON | ECHO | ECHONL | ISIG | IEXTEN)) == 0);
+        SERIAL_CHECK((tio.c_iflag & (IXON | ICRNL | INLCR | IGNCR | ISTRIP)) == 0);
+        SERIAL_CHECK((tio.c_oflag & OPOST) == 0);
+        SERIAL_CHECK((tio.c_cflag & (CLOCAL | CREAD)) == (CLOCAL | CREAD));
+        SERIAL_CHECK((tio.c_cflag & CSTOPB) != 0);
+        SERIAL_CHECK((tio.c_cflag & CRTSCTS) == 0);
+        SERIAL_CHECK((tio.c_iflag & INPCK) != 0);
+        SERIAL_CHECK(tio.c_cc[VMIN] == 1 && tio.c_cc[VTIME] == 0);
+        SERIAL_CHECK(cfgetospeed(&tio) == B9600);
+        CloseSerialQuiet(fd);
+    }
+    close(master);
+
+    if (TestPty(&master, name) != 0) {
+        serial_test_failures++;
+        return;
+    }
+    fd = OpenSerial(name, CBR_115200, 8, ODDPARITY, ONESTOPBIT);
+    SERIAL_CHECK(fd != SERIAL_INVALID_HANDLE);
+    if (fd != SERIAL_INVALID_HANDLE) {
+        SERIAL_CHECK(tcgetattr(fd, &tio) == 0);
+        SERIAL_CHECK((tio.c_cflag & CSTOPB) == 0);
+        SERIAL_CHECK((tio.c_iflag & INPCK) != 0);
+        SERIAL_CHECK(cfgetospeed(&tio) == B115200);
+        CloseSerialQuiet(fd);
+    }
+    close(master);
+}
+
+static void TestCustomBaud(void) {
+
+    SerialHandle fd;
+    char name[256];
+    int master, slave;
+
+    if (openpty(&master, &slave, name, NULL, NULL) != 0) {
+        printf("openpty fail\r\n");
+        serial_test_failures++;
+        return;
+    }
+    SERIAL_CHECK(SerialSetCustomBaud(slave, 250000) == 0);
+    SERIAL_CHECK(SerialSetCustomBaud(slave, 3686400) == 0);
+    SERIAL_CHECK(SerialSetCustomBaud(slave, 0) == -1);
+    SERIAL_CHECK(SerialSetCustomBaud(slave, -9600) == -1);
+    SERIAL_CHECK(SerialSetCustomBaud(-1, 250000) == -1);
+    close(slave);
+    close(master);
+
+    // 不在 Bxxx 表中的波特率由 OpenSerial 转给 SerialSetCustomBaud
+    if (TestPty(&master, name) != 0) {
+        serial_test_failures++;
+        return;
+    }
+    fd = OpenSerial(name, 250000, 8, NOPARITY, ONESTOPBIT);
+    SERIAL_CHECK(fd != SERIAL_INVALID_HANDLE);
+    if (fd != SERIAL_INVALID_HANDLE) {
+        CloseSerialQuiet(fd);
+    }
+    close(master);
+}
+
+int main(void) {
+
+    char name[256];
+    int master;
+
+    if (TestPty(&master, name) != 0) {
+        return 1;
+    }
+    TestRoundTrip(master, name);
+    close(master);
+    TestRawMode();
+    TestCustomBaud();
+    return SERIAL_TEST_RESULT;
+}
@@ -0,0 +1,24 @@
+// serial_test.h
+#ifndef SERIAL_TEST_H
+#define SERIAL_TEST_H
+
+/*
+ * 自动测试（ctest）共用的检查宏：条件不成立时打印位置并计数，
+ * main 返回 SERIAL_TEST_RESULT，有失败时 ctest 报告该测试失败。
+ */
+
+#include <stdio.h>
+
+static int serial_test_failures;
+
+#define SERIAL_CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: check fail: %s\r\n", __FILE__, __LINE__, #cond); \
+            serial_test_failures++; \
+        } \
+    } while (0)
+
+#define SERIAL_TEST_RESULT  (serial_test_failures == 0 ? 0 : 1)
+
+
+#endif /* Serial Test */
@@ -0,0 +1,213 @@
+// serial_uring.c
+
+/*
+ * io_uring 的最小封装（运行需要 5.11 及以上的内核，编译需要 5.19 及以上的 linux/io_uring.h），不依赖 liburing：
+ * 用 io_uring_setup / io_uring_enter / io_uring_register 系统调用和共享内存中的提交队列（SQ）、完成队列（CQ）。
+ *
+ * SerialUringSqe 只在共享内存中填写请求，不进入内核；SerialUringEnter 把积累的请求一次提交，
+ * 同时等待完成，多个串口的读写请求合并成一次系统调用。
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "serial_uring.h"
+
+#define SERIAL_URING_LOAD(p)        __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define SERIAL_URING_STORE(p, v)    __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+static int SerialUringSetup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+int SerialUringInit(SerialUring *uring, unsigned entries) {
+
+    struct io_uring_params p;
+    SerialUring *u = uring;
+    char *sq, *cq;
+
+    memset(u, 0, sizeof(*u));
+    memset(&p, 0, sizeof(p));
+    // 多次读取 (multishot) 一个请求产生多个完成事件, 完成队列取大一些
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = entries * 8;
+#ifdef IORING_SETUP_COOP_TASKRUN
+    p.flags |= IORING_SETUP_COOP_TASKRUN;
+#endif
+    u->fd = SerialUringSetup(entries, &p);
+    if (u->fd < 0 && errno == EINVAL) {
+        // 5.19 之前的内核没有 COOP_TASKRUN
+        memset(&p, 0, sizeof(p));
+        p.flags = IORING_SETUP_CQSIZE;
+        p.cq_entries = entries * 8;
+        u->fd = SerialUringSetup(entries, &p);
+    }
+    if (u->fd < 0) {
+        return -1;
+    }
+    u->features = p.features;
+
+    u->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (u->cq_ring_size > u->sq_ring_size) {
+            u->sq_ring_size = u->cq_ring_size;
+        }
+        u->cq_ring_size = u->sq_ring_size;
+    }
+    u->sq_ring = mmap(NULL, u->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQ_RING);
+    if (u->sq_ring == MAP_FAILED) {
+        u->sq_ring = NULL;
+        SerialUringFree(u);
+        return -1;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        u->cq_ring = u->sq_ring;
+    }
+    else {
+        u->cq_ring = mmap(NULL, u->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_CQ_RING);
+        if (u->cq_ring == MAP_FAILED) {
+            u->cq_ring = NULL;
+            SerialUringFree(u);
+            return -1;
+        }
+    }
+    u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = (struct io_uring_sqe *)mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        u->sqes = NULL;
+        SerialUringFree(u);
+        return -1;
+    }
+
+    sq = (char *)u->sq_ring;
+    cq = (char *)u->cq_ring;
+    u->sq_head = (unsigned *)(sq + p.sq_off.head);
+    u->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    u->sq_flags = (unsigned *)(sq + p.sq_off.flags);
+    u->sq_array = (unsigned *)(sq + p.sq_off.array);
+    u->sq_mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+    u->sq_entries = p.sq_entries;
+    u->sq_local = u->sq_submitted = *u->sq_tail;
+    u->cq_head = (unsigned *)(cq + p.cq_off.head);
+    u->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    u->cq_mask = *(unsigned *)(cq + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+void SerialUringFree(SerialUring *uring) {
+    if (uring->sqes != NULL) {
+        munmap(uring->sqes, uring->sqes_size);
+    }
+    if (uring->cq_ring != NULL && uring->cq_ring != uring->sq_ring) {
+        munmap(uring->cq_ring, uring->cq_ring_size);
+    }
+    if (uring->sq_ring != NULL) {
+        munmap(uring->sq_ring, uring->sq_ring_size);
+    }
+    if (uring->fd >= 0) {
+        close(uring->fd);
+    }
+    memset(uring, 0, sizeof(*uring));
+    uring->fd = -1;
+}
+
+// 取一个空闲的 SQE (已清零), 提交队列满时返回 NULL
+struct io_uring_sqe *SerialUringSqe(SerialUring *uring) {
+
+    struct io_uring_sqe *sqe;
+    unsigned idx;
+
+    if (uring->sq_local - SERIAL_URING_LOAD(uring->sq_head) >= uring->sq_entries) {
+        return NULL;
+    }
+    idx = uring->sq_local & uring->sq_mask;
+    uring->sq_array[idx] = idx;
+    uring->sq_local++;
+    sqe = &uring->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// 提交已填写的 SQE, 并等待至少 wait_nr 个完成事件 (最多 timeout_ms 毫秒, -1 一直等待)
+// 返回提交的 SQE 数, 出错返回 -1; 超时和被信号打断不算错误
+int SerialUringEnter(SerialUring *uring, unsigned wait_nr, int timeout_ms) {
+
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    unsigned to_submit, flags = 0;
+    void *argp = NULL;
+    size_t argsz = 0;
+    int n;
+
+    SERIAL_URING_STORE(uring->sq_tail, uring->sq_local);
+    to_submit = uring->sq_local - uring->sq_submitted;
+    if (wait_nr > 0 && SerialUringPeek(uring) != NULL) {
+        wait_nr = 0;
+    }
+    if (wait_nr > 0 || (SERIAL_URING_LOAD(uring->sq_flags) & IORING_SQ_CQ_OVERFLOW)) {
+        flags |= IORING_ENTER_GETEVENTS;
+    }
+    if (wait_nr > 0 && timeout_ms >= 0) {
+        memset(&arg, 0, sizeof(arg));
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+        arg.ts = (unsigned long long)(uintptr_t)&ts;
+        argp = &arg;
+        argsz = sizeof(arg);
+        flags |= IORING_ENTER_EXT_ARG;
+    }
+    if (to_submit == 0 && flags == 0) {
+        return 0;
+    }
+    n = (int)syscall(__NR_io_uring_enter, uring->fd, to_submit, wait_nr, flags, argp, argsz);
+    uring->enters++;
+    if (n < 0) {
+        return errno == ETIME || errno == EINTR || errno == EAGAIN || errno == EBUSY ? 0 : -1;
+    }
+    uring->sq_submitted += (unsigned)n;
+    return n;
+}
+
+// 下一个完成事件, 没有时返回 NULL; 处理完后调用 SerialUringAdvance
+struct io_uring_cqe *SerialUringPeek(SerialUring *uring) {
+    unsigned head = *uring->cq_head;
+
+    if (head == SERIAL_URING_LOAD(uring->cq_tail)) {
+        return NULL;
+    }
+    return &uring->cqes[head & uring->cq_mask];
+}
+
+void SerialUringAdvance(SerialUring *uring) {
+    SERIAL_URING_STORE(uring->cq_head, *uring->cq_head + 1);
+}
+
+int SerialUringRegister(SerialUring *uring, unsigned opcode, const void *arg, unsigned nr) {
+    uring->enters++;
+    return (int)syscall(__NR_io_uring_register, uring->fd, opcode, arg, nr);
+}
+
+// 内核是否支持操作 op
+int SerialUringProbe(SerialUring *uring, int op) {
+
+    struct {
+        struct io_uring_probe probe;
+        struct io_uring_probe_op ops[256];
+    } p;
+
+    memset(&p, 0, sizeof(p));
+    if (SerialUringRegister(uring, IORING_REGISTER_PROBE, &p, 256) != 0 || op > p.probe.last_op) {
+        return 0;
+    }
+    return (p.probe.ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+}
@@ -0,0 +1,48 @@
+// serial_uring.h
+#ifndef SERIAL_URING_H
+#define SERIAL_URING_H
+
+#include <stddef.h>
+#include <linux/io_uring.h>
+
+// 旧内核头文件中没有的定义 (内核 6.7)
+#ifndef IORING_OP_READ_MULTISHOT
+#define IORING_OP_READ_MULTISHOT    49
+#endif
+
+// 直接用系统调用操作的 io_uring, 只有 serial_ports.c 使用
+typedef struct {
+    int fd;
+    unsigned features;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_flags;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_local;      // 已填写的 SQE (未必已提交)
+    unsigned sq_submitted;  // 已交给内核的 SQE
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    void *cq_ring;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned long long enters;      // io_uring_enter 调用次数
+} SerialUring;
+
+int SerialUringInit(SerialUring *uring, unsigned entries);
+void SerialUringFree(SerialUring *uring);
+struct io_uring_sqe *SerialUringSqe(SerialUring *uring);
+int SerialUringEnter(SerialUring *uring, unsigned wait_nr, int timeout_ms);
+struct io_uring_cqe *SerialUringPeek(SerialUring *uring);
+void SerialUringAdvance(SerialUring *uring);
+int SerialUringRegister(SerialUring *uring, unsigned opcode, const void *arg, unsigned nr);
+int SerialUringProbe(SerialUring *uring, int op);
+
+
+#endif /* Serial Uring */
@@ -0,0 +1,636 @@
+// serial_writer.c
+
+/*
+ * 串口异步发送：
+ * SendMessageToSerial 每条消息同步写一次，调用方要等整条消息在串口上发完。
+ * 这里把消息放进无锁队列（有界 MPMC 环形队列，每个槽存一条消息）后立即返回，
+ * 由一个写线程把队列中积压的消息合并成一次大的写入，并处理部分写入、可写等待和失败重试。
+ * 串口越忙积压越多，合并后的写入越大，系统调用次数随之减少。
+ *
+ * 队列满时按 SerialWriterConfig.policy 处理：等待（SERIAL_BLOCK）、
+ * 丢弃最旧的消息（SERIAL_DROP_OLDEST）或丢弃当前消息（SERIAL_DROP_NEWEST）。
+ * 可以多个线程同时发送，同一线程发送的消息保持顺序。
+ *
+ * 也可以直接在队列槽中格式化，省去一次复制：
+ *     size_t cap;
+ *     char *p = SerialWriterReserve(writer, &cap);
+ *     if (p != NULL) {
+ *         SerialWriterCommit(writer, p, (size_t)snprintf(p, cap, "value=%d\r\n", value));
+ *     }
+ * Reserve 之后必须尽快 Commit，写线程会在该槽处等待。
+ *
+ * 示例：
+ * #include "serial_writer.h"
+ *
+ * int main() {
+ *     SerialWriterConfig config = { 0 };
+ *     SerialWriter *writer;
+ *
+ *     Useserial();
+ *     config.policy = SERIAL_DROP_OLDEST;
+ *     writer = OpenSerialWriter(comHandle, &config);
+ *
+ *     SendMessageToSerialAsync(writer, "Hello, this is a test message!\n");
+ *
+ *     // 等待全部写出后关闭
+ *     CloseSerialWriter(writer);
+ *     CloseSerial(comHandle);
+ *     return 0;
+ * }
+ */
+
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "serial_writer.h"
+
+#ifndef _WIN32
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+#define SERIAL_CACHE_LINE       64
+
+// 原子操作: GCC / Clang 用 __atomic 内建函数; MSVC 用 Interlocked* (都是完整屏障, 不区分内存序), 按宽度选择 32 / 64 位版本
+#if defined(__GNUC__)
+#define SERIAL_RELAXED              __ATOMIC_RELAXED
+#define SERIAL_ACQUIRE              __ATOMIC_ACQUIRE
+#define SERIAL_RELEASE              __ATOMIC_RELEASE
+#define SERIAL_SEQ_CST              __ATOMIC_SEQ_CST
+#define SERIAL_ATOMIC_LOAD(p, m)        __atomic_load_n(p, m)
+#define SERIAL_ATOMIC_STORE(p, v, m)    __atomic_store_n(p, v, m)
+#define SERIAL_ATOMIC_ADD(p, v, m)      ((void)__atomic_fetch_add(p, v, m))
+#define SERIAL_ATOMIC_XCHG(p, v, m)     __atomic_exchange_n(p, v, m)
+#define SERIAL_FENCE()                  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define SERIAL_RELAXED              0
+#define SERIAL_ACQUIRE              0
+#define SERIAL_RELEASE              0
+#define SERIAL_SEQ_CST              0
+#define SERIAL_WIDE(p)              (sizeof(*(p)) == 8)
+#define SERIAL_ATOMIC_LOAD(p, m)        (SERIAL_WIDE(p) \
+    ? (unsigned long long)InterlockedCompareExchange64((volatile LONG64 *)(p), 0, 0) \
+    : (unsigned long long)(unsigned long)InterlockedCompareExchange((volatile LONG *)(p), 0, 0))
+#define SERIAL_ATOMIC_STORE(p, v, m)    (SERIAL_WIDE(p) \
+    ? (void)InterlockedExchange64((volatile LONG64 *)(p), (LONG64)(v)) \
+    : (void)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+#define SERIAL_ATOMIC_ADD(p, v, m)      (SERIAL_WIDE(p) \
+    ? (void)InterlockedExchangeAdd64((volatile LONG64 *)(p), (LONG64)(v)) \
+    : (void)InterlockedExchangeAdd((volatile LONG *)(p), (LONG)(v)))
+#define SERIAL_ATOMIC_XCHG(p, v, m)     (SERIAL_WIDE(p) \
+    ? (unsigned long long)InterlockedExchange64((volatile LONG64 *)(p), (LONG64)(v)) \
+    : (unsigned long long)(unsigned long)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+#define SERIAL_FENCE()                  MemoryBarrier()
+#endif
+
+#define SERIAL_LOAD(p)          SERIAL_ATOMIC_LOAD(p, SERIAL_ACQUIRE)
+#define SERIAL_STORE(p, v)      SERIAL_ATOMIC_STORE(p, v, SERIAL_RELEASE)
+// 只有写线程修改的计数, 其他线程读取
+#define SERIAL_COUNT(p, v)      SERIAL_ATOMIC_STORE(p, SERIAL_ATOMIC_LOAD(p, SERIAL_RELAXED) + (v), SERIAL_RELAXED)
+
+// 线程: Windows 用 CRITICAL_SECTION / CONDITION_VARIABLE, 其他平台用 pthread
+#ifdef _WIN32
+typedef HANDLE SerialThread;
+typedef CRITICAL_SECTION SerialMutex;
+typedef CONDITION_VARIABLE SerialCond;
+#else
+typedef pthread_t SerialThread;
+typedef pthread_mutex_t SerialMutex;
+typedef pthread_cond_t SerialCond;
+#endif
+
+typedef struct {
+    size_t seq;             // 槽序号, 等于入队位置表示空闲, 等于入队位置 + 1 表示已提交
+    size_t len;
+    char data[];
+} SerialSlot;
+
+struct SerialWriter {
+    SerialHandle comHandle;
+    SerialWriterConfig config;
+    size_t mask;
+    size_t stride;
+    unsigned char *slots;
+    unsigned char *mem;
+    char *batch;
+    SerialThread thread;
+    SerialMutex lock;
+    SerialCond wake;    // 唤醒空闲的写线程
+    SerialCond space;   // 唤醒等待空间的发送方
+    SerialCond done;       // 唤醒 SerialWriterFlush
+
+    // 发送方和写线程各自修改的位置分开放在不同的缓存行
+    char pad0[SERIAL_CACHE_LINE];
+    size_t enqueue_pos;
+    char pad1[SERIAL_CACHE_LINE - sizeof(size_t)];
+    size_t dequeue_pos;
+    char pad2[SERIAL_CACHE_LINE - sizeof(size_t)];
+
+    int idle;               // 写线程即将等待 wake
+    int busy;               // 写线程持有未写完的消息
+    int blocked;            // 等待空间的发送方数
+    int flushing;           // 等待 done 的线程数
+    int stop;
+    SerialWriterStats stats;
+};
+
+static SerialSlot *SerialSlotAt(const SerialWriter *w, size_t pos) {
+    return (SerialSlot *)(w->slots + (pos & w->mask) * w->stride);
+}
+
+// 弱比较交换 (relaxed), 失败时 *expected 更新为当前值
+static int SerialCas(size_t *p, size_t *expected, size_t desired) {
+#if defined(__GNUC__)
+    return __atomic_compare_exchange_n(p, expected, desired, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#else
+    size_t old;
+
+#ifdef _WIN64
+    old = (size_t)InterlockedCompareExchange64((volatile LONG64 *)p, (LONG64)desired, (LONG64)*expected);
+#else
+    old = (size_t)(unsigned long)InterlockedCompareExchange((volatile LONG *)p, (LONG)desired, (LONG)*expected);
+#endif
+    if (old == *expected) {
+        return 1;
+    }
+    *expected = old;
+    return 0;
+#endif
+}
+
+#ifdef _WIN32
+
+static void SerialMutexInit(SerialMutex *m) {
+    InitializeCriticalSection(m);
+}
+
+static void SerialMutexDestroy(SerialMutex *m) {
+    DeleteCriticalSection(m);
+}
+
+static void SerialMutexLock(SerialMutex *m) {
+    EnterCriticalSection(m);
+}
+
+static void SerialMutexUnlock(SerialMutex *m) {
+    LeaveCriticalSection(m);
+}
+
+static void SerialCondInit(SerialCond *c) {
+    InitializeConditionVariable(c);
+}
+
+static void SerialCondDestroy(SerialCond *c) {
+    (void)c;
+}
+
+static void SerialCondSignal(SerialCond *c) {
+    WakeConditionVariable(c);
+}
+
+static void SerialCondBroadcast(SerialCond *c) {
+    WakeAllConditionVariable(c);
+}
+
+static void SerialYield(void) {
+    SwitchToThread();
+}
+
+static void SerialSleepMs(int ms) {
+    Sleep((DWORD)ms);
+}
+
+#else
+
+static void SerialMutexInit(SerialMutex *m) {
+    pthread_mutex_init(m, NULL);
+}
+
+static void SerialMutexDestroy(SerialMutex *m) {
+    pthread_mutex_destroy(m);
+}
+
+static void SerialMutexLock(SerialMutex *m) {
+    pthread_mutex_lock(m);
+}
+
+static void SerialMutexUnlock(SerialMutex *m) {
+    pthread_mutex_unlock(m);
+}
+
+static void SerialCondInit(SerialCond *c) {
+    pthread_cond_init(c, NULL);
+}
+
+static void SerialCondDestroy(SerialCond *c) {
+    pthread_cond_destroy(c);
+}
+
+static void SerialCondSignal(SerialCond *c) {
+    pthread_cond_signal(c);
+}
+
+static void SerialCondBroadcast(SerialCond *c) {
+    pthread_cond_broadcast(c);
+}
+
+static void SerialYield(void) {
+    sched_yield();
+}
+
+static void SerialSleepMs(int ms) {
+    struct timespec ts;
+
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+#endif
+
+// 持有 w->lock 时等待 cond, 最多 ms 毫秒
+static void SerialWriterWait(SerialWriter *w, SerialCond *cond, int ms) {
+#ifdef _WIN32
+    SleepConditionVariableCS(cond, &w->lock, (DWORD)ms);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += (long)ms * 1000000L;
+    ts.tv_sec += ts.tv_nsec / 1000000000L;
+    ts.tv_nsec %= 1000000000L;
+    pthread_cond_timedwait(cond, &w->lock, &ts);
+#endif
+}
+
+static void SerialWriterNotify(SerialWriter *w, int *waiters, SerialCond *cond) {
+    // 与等待方的 "登记 -> 栅栏 -> 复查" 配对, 不会丢失唤醒
+    SERIAL_FENCE();
+    if (SERIAL_ATOMIC_LOAD(waiters, SERIAL_RELAXED)) {
+        SerialMutexLock(&w->lock);
+        SerialCondBroadcast(cond);
+        SerialMutexUnlock(&w->lock);
+    }
+}
+
+// 取出最旧的已提交消息, 队列空或最旧的消息尚未提交时返回 NULL
+static SerialSlot *SerialDequeue(SerialWriter *w) {
+    size_t pos = SERIAL_ATOMIC_LOAD(&w->dequeue_pos, SERIAL_RELAXED);
+    SerialSlot *slot;
+    intptr_t dif;
+
+    for (;;) {
+        slot = SerialSlotAt(w, pos);
+        dif = (intptr_t)SERIAL_LOAD(&slot->seq) - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            if (SerialCas(&w->dequeue_pos, &pos, pos + 1)) {
+                return slot;
+            }
+        }
+        else if (dif < 0) {
+            return NULL;
+        }
+        else {
+            pos = SERIAL_ATOMIC_LOAD(&w->dequeue_pos, SERIAL_RELAXED);
+        }
+    }
+}
+
+// 归还槽, 下一轮入队位置为 pos + slots
+static void SerialRelease(SerialWriter *w, SerialSlot *slot) {
+    SERIAL_STORE(&slot->seq, SERIAL_ATOMIC_LOAD(&slot->seq, SERIAL_RELAXED) + w->mask);
+}
+
+static int SerialFull(SerialWriter *w) {
+    size_t pos = SERIAL_ATOMIC_LOAD(&w->enqueue_pos, SERIAL_RELAXED);
+    return (intptr_t)SERIAL_LOAD(&SerialSlotAt(w, pos)->seq) - (intptr_t)pos < 0;
+}
+
+static int SerialReady(SerialWriter *w) {
+    size_t pos = SERIAL_ATOMIC_LOAD(&w->dequeue_pos, SERIAL_RELAXED);
+    return (size_t)SERIAL_LOAD(&SerialSlotAt(w, pos)->seq) == pos + 1;
+}
+
+// 写出一批数据: 部分写入时续写, 不可写时等待, 失败时重试
+static void SerialWriterWrite(SerialWriter *w, const char *data, size_t len) {
+    int retries = w->config.retries;
+    long n;
+
+    while (len > 0) {
+        n = SerialWrite(w->comHandle, data, len);
+        SERIAL_COUNT(&w->stats.writes, 1);
+        if (n > 0) {
+            if ((size_t)n < len) {
+                SERIAL_COUNT(&w->stats.partial, 1);
+            }
+            SERIAL_COUNT(&w->stats.bytes, (unsigned long long)n);
+            data += n;
+            len -= (size_t)n;
+        }
+        else if (n == 0) {
+            SerialWaitWritable(w->comHandle, 100);
+        }
+        else if (retries-- > 0) {
+            SerialSleepMs(1);
+        }
+        else {
+            SERIAL_COUNT(&w->stats.errors, 1);
+            return;
+        }
+    }
+}
+
+static void SerialWriterThread(SerialWriter *w) {
+
+    const size_t limit = (size_t)w->config.batch_size - (size_t)w->config.slot_size;
+    SerialSlot *slot;
+    size_t fill;
+    unsigned long n;
+
+    for (;;) {
+        fill = 0;
+        n = 0;
+        SERIAL_ATOMIC_STORE(&w->busy, 1, SERIAL_SEQ_CST);
+
+        // 合并积压的消息, 复制后立即归还槽, 串口写入期间发送方可以继续入队
+        while (fill <= limit && (slot = SerialDequeue(w)) != NULL) {
+            memcpy(w->batch + fill, slot->data, slot->len);
+            fill += slot->len;
+            SerialRelease(w, slot);
+            n++;
+        }
+        if (n > 0) {
+            SerialWriterNotify(w, &w->blocked, &w->space);
+        }
+        if (fill > 0) {
+            SerialWriterWrite(w, w->batch, fill);
+        }
+        SERIAL_COUNT(&w->stats.messages, n);
+        SERIAL_ATOMIC_STORE(&w->busy, 0, SERIAL_SEQ_CST);
+
+        if (n > 0) {
+            SerialWriterNotify(w, &w->flushing, &w->done);
+            continue;
+        }
+        if (SERIAL_ATOMIC_LOAD(&w->stop, SERIAL_ACQUIRE)) {
+            break;
+        }
+
+        SerialMutexLock(&w->lock);
+        SERIAL_ATOMIC_STORE(&w->idle, 1, SERIAL_RELAXED);
+        SERIAL_FENCE();
+        if (!SerialReady(w) && !SERIAL_ATOMIC_LOAD(&w->stop, SERIAL_RELAXED)) {
+            SerialWriterWait(w, &w->wake, 100);
+        }
+        SERIAL_ATOMIC_STORE(&w->idle, 0, SERIAL_RELAXED);
+        SerialMutexUnlock(&w->lock);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI SerialWriterEntry(LPVOID arg) {
+    SerialWriterThread((SerialWriter *)arg);
+    return 0;
+}
+#else
+static void *SerialWriterEntry(void *arg) {
+    SerialWriterThread((SerialWriter *)arg);
+    return NULL;
+}
+#endif
+
+SerialWriter *OpenSerialWriter(SerialHandle comHandle, const SerialWriterConfig *config) {
+
+    SerialWriter *w;
+    size_t slots = 2, i;
+
+    w = (SerialWriter *)calloc(1, sizeof(SerialWriter));
+    if (w == NULL) {
+        return NULL;
+    }
+    if (config != NULL) {
+        w->config = *config;
+    }
+    if (w->config.slots <= 0) {
+        w->config.slots = 1024;
+    }
+    if (w->config.slot_size <= 0) {
+        w->config.slot_size = 256;
+    }
+    if (w->config.batch_size < w->config.slot_size) {
+        w->config.batch_size = w->config.slot_size > 65536 ? w->config.slot_size : 65536;
+    }
+    if (config == NULL || w->config.retries < 0) {
+        w->config.retries = 3;
+    }
+    while (slots < (size_t)w->config.slots) {
+        slots <<= 1;
+    }
+    w->config.slots = (int)slots;
+    w->comHandle = comHandle;
+    w->mask = slots - 1;
+    w->stride = (offsetof(SerialSlot, data) + (size_t)w->config.slot_size + SERIAL_CACHE_LINE - 1) & ~(size_t)(SERIAL_CACHE_LINE - 1);
+    w->mem = (unsigned char *)malloc(w->stride * slots + SERIAL_CACHE_LINE);
+    w->batch = (char *)malloc((size_t)w->config.batch_size);
+    if (w->mem == NULL || w->batch == NULL) {
+        free(w->mem);
+        free(w->batch);
+        free(w);
+        return NULL;
+    }
+    w->slots = w->mem + (SERIAL_CACHE_LINE - (uintptr_t)w->mem % SERIAL_CACHE_LINE) % SERIAL_CACHE_LINE;
+    for (i = 0; i < slots; i++) {
+        SerialSlotAt(w, i)->seq = i;
+    }
+
+    SerialMutexInit(&w->lock);
+    SerialCondInit(&w->wake);
+    SerialCondInit(&w->space);
+    SerialCondInit(&w->done);
+#ifdef _WIN32
+    w->thread = CreateThread(NULL, 0, SerialWriterEntry, w, 0, NULL);
+    if (w->thread == NULL) {
+#else
+    if (pthread_create(&w->thread, NULL, SerialWriterEntry, w) != 0) {
+#endif
+        printf("writer thread fail\r\n");
+        SerialMutexDestroy(&w->lock);
+        SerialCondDestroy(&w->wake);
+        SerialCondDestroy(&w->space);
+        SerialCondDestroy(&w->done);
+        free(w->mem);
+        free(w->batch);
+        free(w);
+        return NULL;
+    }
+    return w;
+}
+
+// 写出队列中的全部消息后停止写线程, 不关闭串口
+// 返回 0; 有槽被预留但一直没有提交时, 写线程无法越过它, 其后的消息没有写出, 打印并返回 -1
+int CloseSerialWriter(SerialWriter *writer) {
+
+    size_t unsent;
+
+    if (writer == NULL) {
+        return 0;
+    }
+    SERIAL_ATOMIC_STORE(&writer->stop, 1, SERIAL_RELEASE);
+    SerialMutexLock(&writer->lock);
+    SerialCondSignal(&writer->wake);
+    SerialMutexUnlock(&writer->lock);
+#ifdef _WIN32
+    WaitForSingleObject(writer->thread, INFINITE);
+    CloseHandle(writer->thread);
+#else
+    pthread_join(writer->thread, NULL);
+#endif
+    unsent = SERIAL_ATOMIC_LOAD(&writer->enqueue_pos, SERIAL_ACQUIRE) - SERIAL_ATOMIC_LOAD(&writer->dequeue_pos, SERIAL_RELAXED);
+    if (unsent > 0) {
+        printf("writer closed with %lu unsent messages: slot reserved but not committed\r\n", (unsigned long)unsent);
+    }
+
+    SerialMutexDestroy(&writer->lock);
+    SerialCondDestroy(&writer->wake);
+    SerialCondDestroy(&writer->space);
+    SerialCondDestroy(&writer->done);
+    free(writer->mem);
+    free(writer->batch);
+    free(writer);
+    return unsent > 0 ? -1 : 0;
+}
+
+// 预留一个槽, 返回可写入 *capacity 字节的缓冲区; 队列满且按策略放弃时返回 NULL
+char *SerialWriterReserve(SerialWriter *writer, size_t *capacity) {
+
+    SerialWriter *w = writer;
+    SerialSlot *slot;
+    size_t pos;
+    intptr_t dif;
+
+    for (;;) {
+        pos = SERIAL_ATOMIC_LOAD(&w->enqueue_pos, SERIAL_RELAXED);
+        for (;;) {
+            slot = SerialSlotAt(w, pos);
+            dif = (intptr_t)SERIAL_LOAD(&slot->seq) - (intptr_t)pos;
+            if (dif == 0) {
+                if (SerialCas(&w->enqueue_pos, &pos, pos + 1)) {
+                    if (capacity != NULL) {
+                        *capacity = (size_t)w->config.slot_size;
+                    }
+                    return slot->data;
+                }
+            }
+            else if (dif < 0) {
+                break;
+            }
+            else {
+                pos = SERIAL_ATOMIC_LOAD(&w->enqueue_pos, SERIAL_RELAXED);
+            }
+        }
+
+        // 队列满
+        if (w->config.policy == SERIAL_DROP_NEWEST) {
+            SERIAL_ATOMIC_ADD(&w->stats.dropped, 1, SERIAL_RELAXED);
+            return NULL;
+        }
+        if (w->config.policy == SERIAL_DROP_OLDEST) {
+            slot = SerialDequeue(w);
+            if (slot != NULL) {
+                SerialRelease(w, slot);
+                SERIAL_ATOMIC_ADD(&w->stats.dropped, 1, SERIAL_RELAXED);
+                SerialWriterNotify(w, &w->flushing, &w->done);
+            }
+            else {
+                // 最旧的槽已被预留但尚未提交
+                SerialYield();
+            }
+            continue;
+        }
+        SerialMutexLock(&w->lock);
+        SERIAL_ATOMIC_ADD(&w->blocked, 1, SERIAL_RELAXED);
+        SERIAL_FENCE();
+        if (SerialFull(w)) {
+            SerialWriterWait(w, &w->space, 10);
+        }
+        SERIAL_ATOMIC_ADD(&w->blocked, -1, SERIAL_RELAXED);
+        SerialMutexUnlock(&w->lock);
+    }
+}
+
+// 提交 SerialWriterReserve 返回的槽, len 不超过预留时返回的容量
+void SerialWriterCommit(SerialWriter *writer, char *slot, size_t len) {
+
+    SerialSlot *s = (SerialSlot *)(slot - offsetof(SerialSlot, data));
+
+    s->len = len < (size_t)writer->config.slot_size ? len : (size_t)writer->config.slot_size;
+    SERIAL_STORE(&s->seq, SERIAL_ATOMIC_LOAD(&s->seq, SERIAL_RELAXED) + 1);
+
+    // 写线程空闲时只由一个发送方唤醒, 写线程忙时不进入内核
+    SERIAL_FENCE();
+    if (SERIAL_ATOMIC_LOAD(&writer->idle, SERIAL_RELAXED) && SERIAL_ATOMIC_XCHG(&writer->idle, 0, SERIAL_RELAXED)) {
+        SerialMutexLock(&writer->lock);
+        SerialCondSignal(&writer->wake);
+        SerialMutexUnlock(&writer->lock);
+    }
+}
+
+// 入队一条消息, 成功返回 0; 超过 slot_size 或按策略丢弃时返回 -1
+int SerialWriterSend(SerialWriter *writer, const void *data, size_t len) {
+
+    char *slot;
+
+    if (len > (size_t)writer->config.slot_size) {
+        SERIAL_ATOMIC_ADD(&writer->stats.dropped, 1, SERIAL_RELAXED);
+        return -1;
+    }
+    slot = SerialWriterReserve(writer, NULL);
+    if (slot == NULL) {
+        return -1;
+    }
+    memcpy(slot, data, len);
+    SerialWriterCommit(writer, slot, len);
+    return 0;
+}
+
+int SendMessageToSerialAsync(SerialWriter *writer, const char* message) {
+    return SerialWriterSend(writer, message, strlen(message));
+}
+
+// 等待调用前入队的消息全部写出 (或被丢弃)
+void SerialWriterFlush(SerialWriter *writer) {
+
+    SerialWriter *w = writer;
+    const size_t target = SERIAL_ATOMIC_LOAD(&w->enqueue_pos, SERIAL_SEQ_CST);
+
+    for (;;) {
+        if ((intptr_t)(SERIAL_ATOMIC_LOAD(&w->dequeue_pos, SERIAL_SEQ_CST) - target) >= 0
+            && !SERIAL_ATOMIC_LOAD(&w->busy, SERIAL_SEQ_CST)) {
+            return;
+        }
+        SerialMutexLock(&w->lock);
+        SERIAL_ATOMIC_ADD(&w->flushing, 1, SERIAL_RELAXED);
+        SERIAL_FENCE();
+        if ((intptr_t)(SERIAL_ATOMIC_LOAD(&w->dequeue_pos, SERIAL_SEQ_CST) - target) < 0
+            || SERIAL_ATOMIC_LOAD(&w->busy, SERIAL_SEQ_CST)) {
+            SerialWriterWait(w, &w->done, 10);
+        }
+        SERIAL_ATOMIC_ADD(&w->flushing, -1, SERIAL_RELAXED);
+        SerialMutexUnlock(&w->lock);
+    }
+}
+
+void SerialWriterGetStats(const SerialWriter *writer, SerialWriterStats *stats) {
+    stats->messages = SERIAL_ATOMIC_LOAD(&writer->stats.messages, SERIAL_RELAXED);
+    stats->bytes = SERIAL_ATOMIC_LOAD(&writer->stats.bytes, SERIAL_RELAXED);
+    stats->writes = SERIAL_ATOMIC_LOAD(&writer->stats.writes, SERIAL_RELAXED);
+    stats->partial = SERIAL_ATOMIC_LOAD(&writer->stats.partial, SERIAL_RELAXED);
+    stats->dropped = SERIAL_ATOMIC_LOAD(&writer->stats.dropped, SERIAL_RELAXED);
+    stats->errors = SERIAL_ATOMIC_LOAD(&writer->stats.errors, SERIAL_RELAXED);
+}
@@ -0,0 +1,45 @@
+// serial_writer.h
+#ifndef SERIAL_WRITER_H
+#define SERIAL_WRITER_H
+
+#include "serial_communicator.h"
+
+// 队列满时的处理方式
+typedef enum {
+    SERIAL_BLOCK = 0,       // 等待写线程腾出空间
+    SERIAL_DROP_OLDEST,     // 丢弃队列中最旧的消息
+    SERIAL_DROP_NEWEST,     // 丢弃当前消息
+} SerialBackpressure;
+
+// 配置, 为 0 的字段使用默认值
+typedef struct {
+    int slots;              // 队列槽数, 向上取 2 的幂 (默认 1024)
+    int slot_size;          // 每条消息的最大字节数 (默认 256)
+    int batch_size;         // 写线程每次合并写出的最大字节数 (默认 65536, 不小于 slot_size)
+    int retries;            // 写失败时的重试次数, 之后丢弃该批数据 (0 不重试, 小于 0 或 config 为 NULL 时为 3)
+    SerialBackpressure policy;
+} SerialWriterConfig;
+
+// 统计
+typedef struct {
+    unsigned long long messages;    // 已写出的消息数
+    unsigned long long bytes;       // 已写出的字节数
+    unsigned long long writes;      // 写调用次数 (含部分写入后的续写)
+    unsigned long long partial;     // 部分写入次数
+    unsigned long long dropped;     // 因队列满或超长被丢弃的消息数
+    unsigned long long errors;      // 重试后仍失败而丢弃的批数
+} SerialWriterStats;
+
+typedef struct SerialWriter SerialWriter;
+
+SerialWriter *OpenSerialWriter(SerialHandle comHandle, const SerialWriterConfig *config);
+int CloseSerialWriter(SerialWriter *writer);
+int SendMessageToSerialAsync(SerialWriter *writer, const char* message);
+int SerialWriterSend(SerialWriter *writer, const void *data, size_t len);
+char *SerialWriterReserve(SerialWriter *writer, size_t *capacity);
+void SerialWriterCommit(SerialWriter *writer, char *slot, size_t len);
+void SerialWriterFlush(SerialWriter *writer);
+void SerialWriterGetStats(const SerialWriter *writer, SerialWriterStats *stats);
+
+
+#endif /* Serial Writer */
@@ -0,0 +1,396 @@
+// serial_writer_test.c
+
+/*
+ * serial_writer 的自动测试（ctest），openpty 创建的伪终端对代替真实串口：
+ *     SERIAL_BLOCK 下多个发送线程（SerialWriterSend 和 Reserve / Commit 两种方式）同时发送，
+ *     对端收到全部消息、每个线程的消息保持顺序，SerialWriterFlush 返回时全部已写出
+ *     伪终端写满、写线程停在第一条消息上时，SERIAL_DROP_OLDEST / SERIAL_DROP_NEWEST 的丢弃数和对端收到的消息都是确定的
+ *     CloseSerialWriter 写出剩余消息；有槽被预留但未提交时返回 -1，之前的消息照常写出
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "serial_writer.h"
+#include "serial_test.h"
+
+#define TEST_MSG_LEN        16      // "pPP nNNNNNNNNNN\n"
+#define TEST_PRODUCERS      4
+#define TEST_MESSAGES       20000   // 每个发送线程
+#define TEST_SLOTS          16      // 丢弃测试的队列槽数
+#define TEST_EXTRA          10      // 丢弃测试中超出队列容量的消息数
+
+static void TestMessage(char *buf, int producer, int n) {
+    snprintf(buf, TEST_MSG_LEN + 1, "p%02d n%010d\n", producer, n);
+}
+
+// 打开伪终端对, 从端用 OpenSerial 打开
+static SerialHandle TestOpen(int *master) {
+
+    SerialHandle fd;
+    char name[256];
+    int slave;
+
+    if (openpty(master, &slave, name, NULL, NULL) != 0) {
+        printf("openpty fail\r\n");
+        serial_test_failures++;
+        return SERIAL_INVALID_HANDLE;
+    }
+    close(slave);
+    fd = OpenSerial(name, CBR_115200, 8, NOPARITY, ONESTOPBIT);
+    SERIAL_CHECK(fd != SERIAL_INVALID_HANDLE);
+    if (fd == SERIAL_INVALID_HANDLE) {
+        close(*master);
+    }
+    return fd;
+}
+
+// 从主端读 len 字节, 超时返回已读字节数
+static size_t TestRead(int master, char *buf, size_t len, int timeout_ms) {
+
+    struct pollfd pfd;
+    size_t got = 0;
+    ssize_t n;
+
+    pfd.fd = master;
+    pfd.events = POLLIN;
+    while (got < len && poll(&pfd, 1, timeout_ms) > 0) {
+        n = read(master, buf + got, len - got);
+        if (n <= 0) {
+            break;
+        }
+        got += (size_t)n;
+    }
+    return got;
+}
+
+// 设为非阻塞并写满伪终端 (主端不读), 返回写入的字节数
+// 伪终端缓冲区由内核异步转移, 写满后稍等再写, 直到等待后也写不进为止
+static size_t TestFill(SerialHandle fd) {
+
+    static const char junk[4096] = { 0 };
+    size_t total = 0;
+    long n, round;
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    do {
+        round = 0;
+        while ((n = SerialWrite(fd, junk, sizeof(junk))) > 0) {
+            round += n;
+        }
+        total += (size_t)round;
+        usleep(20000);
+    } while (round > 0);
+    return total;
+}
+
+// 读掉 TestFill 写入的字节
+static int TestSkip(int master, size_t len) {
+
+    static char buf[4096];
+    size_t n;
+
+    while (len > 0) {
+        n = TestRead(master, buf, len < sizeof(buf) ? len : sizeof(buf), 2000);
+        if (n == 0) {
+            return -1;
+        }
+        len -= n;
+    }
+    return 0;
+}
+
+// 等待写线程取走一条消息并停在写入上
+static int TestWaitStuck(SerialWriter *writer) {
+
+    SerialWriterStats stats;
+    int i;
+
+    for (i = 0; i < 2000; i++) {
+        SerialWriterGetStats(writer, &stats);
+        if (stats.writes > 0) {
+            return stats.messages == 0 && stats.bytes == 0 ? 0 : -1;
+        }
+        usleep(1000);
+    }
+    return -1;
+}
+
+// 队列满时的丢弃: 写线程持有消息 0, 队列 TEST_SLOTS 槽, 再发送 TEST_SLOTS + TEST_EXTRA 条
+static void TestDrop(SerialBackpressure policy) {
+
+    static char got[(TEST_SLOTS + 1) * TEST_MSG_LEN];
+    char msg[TEST_MSG_LEN + 1], want[TEST_MSG_LEN + 1];
+    SerialWriterConfig config;
+    SerialWriterStats stats;
+    SerialWriter *writer;
+    SerialHandle fd;
+    size_t filled;
+    int master, i, k, failed = 0, first;
+
+    fd = TestOpen(&master);
+    if (fd == SERIAL_INVALID_HANDLE) {
+        return;
+    }
+    filled = TestFill(fd);
+
+    // 每批只取一条消息
+    memset(&config, 0, sizeof(config));
+    config.slots = TEST_SLOTS;
+    config.slot_size = 32;
+    config.batch_size = 32;
+    config.policy = policy;
+    writer = OpenSerialWriter(fd, &config);
+    SERIAL_CHECK(writer != NULL);
+    if (writer == NULL) {
+        CloseSerialQuiet(fd);
+        close(master);
+        return;
+    }
+    TestMessage(msg, 0, 0);
+    SERIAL_CHECK(SerialWriterSend(writer, msg, TEST_MSG_LEN) == 0);
+    if (TestWaitStuck(writer) != 0) {
+        printf("writer did not stall on a full pty\r\n");
+        serial_test_failures++;
+    }
+    for (i = 1; i <= TEST_SLOTS + TEST_EXTRA; i++) {
+        TestMessage(msg, 0, i);
+        if (SerialWriterSend(writer, msg, TEST_MSG_LEN) != 0) {
+            failed++;
+        }
+    }
+    SerialWriterGetStats(writer, &stats);
+    SERIAL_CHECK(stats.dropped == TEST_EXTRA);
+    SERIAL_CHECK(failed == (policy == SERIAL_DROP_NEWEST ? TEST_EXTRA : 0));
+
+    // 主端读出后写线程继续: 消息 0, 然后是最新 (DROP_OLDEST) 或最早 (DROP_NEWEST) 的 TEST_SLOTS 条
+    SERIAL_CHECK(TestSkip(master, filled) == 0);
+    SERIAL_CHECK(TestRead(master, got, sizeof(got), 2000) == sizeof(got));
+    first = policy == SERIAL_DROP_OLDEST ? 1 + TEST_EXTRA : 1;
+    for (k = 0; k <= TEST_SLOTS; k++) {
+        TestMessage(want, 0, k == 0 ? 0 : first + k - 1);
+        if (memcmp(got + k * TEST_MSG_LEN, want, TEST_MSG_LEN) != 0) {
+            printf("policy %d message %d: got %.*s", (int)policy, k, TEST_MSG_LEN, got + k * TEST_MSG_LEN);
+            serial_test_failures++;
+            break;
+        }
+    }
+    SerialWriterFlush(writer);
+    SerialWriterGetStats(writer, &stats);
+    SERIAL_CHECK(stats.messages == TEST_SLOTS + 1);
+    SERIAL_CHECK(TestRead(master, got, sizeof(got), 50) == 0);
+
+    SERIAL_CHECK(CloseSerialWriter(writer) == 0);
+    CloseSerialQuiet(fd);
+    close(master);
+}
+
+typedef struct {
+    SerialWriter *writer;
+    int producer;
+} TestProducer;
+
+static void *TestProducerThread(void *arg) {
+
+    TestProducer *p = (TestProducer *)arg;
+    char msg[TEST_MSG_LEN + 1], *slot;
+    size_t cap;
+    int i;
+
+    for (i = 0; i < TEST_MESSAGES; i++) {
+        // 奇数线程直接在槽中格式化
+        if (p->producer & 1) {
+            slot = SerialWriterReserve(p->writer, &cap);
+            if (slot == NULL || cap < TEST_MSG_LEN + 1) {
+                break;
+            }
+            TestMessage(slot, p->producer, i);
+            SerialWriterCommit(p->writer, slot, TEST_MSG_LEN);
+        }
+        else {
+            TestMessage(msg, p->producer, i);
+            if (SerialWriterSend(p->writer, msg, TEST_MSG_LEN) != 0) {
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+// 读主端的线程, 按行检查每个发送线程的序号
+typedef struct {
+    int fd;
+    int stop;               // __atomic
+    size_t bytes;
+    int next[TEST_PRODUCERS];
+    int errors;
+} TestSink;
+
+static void *TestSinkThread(void *arg) {
+
+    TestSink *sink = (TestSink *)arg;
+    char buf[TEST_MSG_LEN * 256];
+    size_t fill = 0, off;
+    int producer, n;
+    ssize_t r;
+
+    while (!__atomic_load_n(&sink->stop, __ATOMIC_ACQUIRE)) {
+        r = (ssize_t)TestRead(sink->fd, buf + fill, sizeof(buf) - fill, 20);
+        if (r <= 0) {
+            continue;
+        }
+        fill += (size_t)r;
+        __atomic_store_n(&sink->bytes, sink->bytes + (size_t)r, __ATOMIC_RELEASE);
+        for (off = 0; off + TEST_MSG_LEN <= fill; off += TEST_MSG_LEN) {
+            if (sscanf(buf + off, "p%2d n%10d", &producer, &n) != 2 || buf[off + TEST_MSG_LEN - 1] != '\n'
+                || producer < 0 || producer >= TEST_PRODUCERS || n != sink->next[producer]) {
+                sink->errors++;
+                return NULL;
+            }
+            sink->next[producer]++;
+        }
+        memmove(buf, buf + off, fill - off);
+        fill -= off;
+    }
+    return NULL;
+}
+
+static void TestBlock(void) {
+
+    static TestSink sink;
+    TestProducer producers[TEST_PRODUCERS];
+    pthread_t threads[TEST_PRODUCERS], reader;
+    const size_t total = (size_t)TEST_PRODUCERS * TEST_MESSAGES;
+    SerialWriterConfig config;
+    SerialWriterStats stats;
+    SerialWriter *writer;
+    SerialHandle fd;
+    int master, i;
+
+    fd = TestOpen(&master);
+    if (fd == SERIAL_INVALID_HANDLE) {
+        return;
+    }
+    // 队列小于发送量, 发送方会等待
+    memset(&config, 0, sizeof(config));
+    config.slots = 64;
+    config.batch_size = 1024;
+    config.policy = SERIAL_BLOCK;
+    writer = OpenSerialWriter(fd, &config);
+    SERIAL_CHECK(writer != NULL);
+    memset(&sink, 0, sizeof(sink));
+    sink.fd = master;
+    if (writer == NULL || pthread_create(&reader, NULL, TestSinkThread, &sink) != 0) {
+        CloseSerialWriter(writer);
+        CloseSerialQuiet(fd);
+        close(master);
+        serial_test_failures++;
+        return;
+    }
+
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        producers[i].writer = writer;
+        producers[i].producer = i;
+        if (pthread_create(&threads[i], NULL, TestProducerThread, &producers[i]) != 0) {
+            TestProducerThread(&producers[i]);
+            threads[i] = 0;
+        }
+    }
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        if (threads[i] != 0) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    // Flush 返回时调用前入队的消息都已写出
+    SerialWriterFlush(writer);
+    SerialWriterGetStats(writer, &stats);
+    SERIAL_CHECK(stats.messages == total);
+    SERIAL_CHECK(stats.bytes == total * TEST_MSG_LEN);
+    SERIAL_CHECK(stats.dropped == 0 && stats.errors == 0);
+    SERIAL_CHECK(stats.writes < total);
+
+    for (i = 0; i < 2000 && __atomic_load_n(&sink.bytes, __ATOMIC_ACQUIRE) < total * TEST_MSG_LEN && !sink.errors; i++) {
+        usleep(1000);
+    }
+    __atomic_store_n(&sink.stop, 1, __ATOMIC_RELEASE);
+    pthread_join(reader, NULL);
+    SERIAL_CHECK(sink.errors == 0);
+    SERIAL_CHECK(sink.bytes == total * TEST_MSG_LEN);
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        SERIAL_CHECK(sink.next[i] == TEST_MESSAGES);
+    }
+
+    SERIAL_CHECK(CloseSerialWriter(writer) == 0);
+    CloseSerialQuiet(fd);
+    close(master);
+}
+
+static void TestClose(void) {
+
+    static char got[100 * TEST_MSG_LEN + 1];
+    char msg[TEST_MSG_LEN + 1];
+    SerialWriter *writer;
+    SerialHandle fd;
+    size_t cap;
+    int master, i;
+    char *slot;
+
+    fd = TestOpen(&master);
+    if (fd == SERIAL_INVALID_HANDLE) {
+        return;
+    }
+
+    // 不调用 Flush 直接关闭: 全部写出
+    writer = OpenSerialWriter(fd, NULL);
+    SERIAL_CHECK(writer != NULL);
+    if (writer != NULL) {
+        for (i = 0; i < 100; i++) {
+            TestMessage(msg, 1, i);
+            SerialWriterSend(writer, msg, TEST_MSG_LEN);
+        }
+        SERIAL_CHECK(CloseSerialWriter(writer) == 0);
+        SERIAL_CHECK(TestRead(master, got, sizeof(got), 200) == 100 * TEST_MSG_LEN);
+        TestMessage(msg, 1, 99);
+        SERIAL_CHECK(memcmp(got + 99 * TEST_MSG_LEN, msg, TEST_MSG_LEN) == 0);
+    }
+
+    // 预留未提交的槽: 之前的消息写出, 之后的消息留在队列中, 关闭返回 -1
+    writer = OpenSerialWriter(fd, NULL);
+    SERIAL_CHECK(writer != NULL);
+    if (writer != NULL) {
+        SERIAL_CHECK(SerialWriterSend(writer, "before\n", 7) == 0);
+        slot = SerialWriterReserve(writer, &cap);
+        SERIAL_CHECK(slot != NULL && cap == 256);
+        SERIAL_CHECK(SerialWriterSend(writer, "after\n", 6) == 0);
+        SERIAL_CHECK(CloseSerialWriter(writer) == -1);
+        SERIAL_CHECK(TestRead(master, got, sizeof(got), 200) == 7 && memcmp(got, "before\n", 7) == 0);
+    }
+
+    // 空队列的 Flush 立即返回
+    writer = OpenSerialWriter(fd, NULL);
+    if (writer != NULL) {
+        SerialWriterFlush(writer);
+        SERIAL_CHECK(CloseSerialWriter(writer) == 0);
+    }
+    CloseSerialQuiet(fd);
+    close(master);
+}
+
+int main(void) {
+
+    TestBlock();
+    TestDrop(SERIAL_DROP_OLDEST);
+    TestDrop(SERIAL_DROP_NEWEST);
+    TestClose();
+    return SERIAL_TEST_RESULT;
+}